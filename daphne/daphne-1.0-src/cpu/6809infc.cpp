@@ -7,6 +7,7 @@
 #include "6809infc.h"
 #include "cpu.h"
 #include "../game/game.h"
+#include "cpu-profile.h"
 
 #ifdef WIN32
 #pragma warning (disable:4244)	// disable the warning about possible loss of data
@@ -28,26 +29,26 @@ static void FetchInstr(INT_MC addr, UCHAR_MC fetch_buffer[])
 
 static INT_MC LoadByte(INT_MC addr)
 {
-	return (g_game->cpu_mem_read(static_cast<uint16_t>(addr)) & 0xff);
+	return (GAME_MEM_READ(static_cast<uint16_t>(addr)) & 0xff);
 }
 
 static INT_MC LoadWord(INT_MC addr)
 {
-	UCHAR_MC high_byte = (g_game->cpu_mem_read(static_cast<uint16_t>(addr)) & 0xff);
-	UCHAR_MC low_byte = (g_game->cpu_mem_read(static_cast<uint16_t>(addr + 1)) & 0xff);
+	UCHAR_MC high_byte = (GAME_MEM_READ(static_cast<uint16_t>(addr)) & 0xff);
+	UCHAR_MC low_byte = (GAME_MEM_READ(static_cast<uint16_t>(addr + 1)) & 0xff);
 
 	return ((high_byte << 8) | low_byte);
 }
 
 static void StoreByte(INT_MC addr, INT_MC value)
 {
-	g_game->cpu_mem_write(static_cast<uint16_t>(addr & 0xffff), (value & 0xff));
+	GAME_MEM_WRITE(static_cast<uint16_t>(addr & 0xffff), (value & 0xff));
 }
 
 static void StoreWord(INT_MC addr, INT_MC value)
 {
-	g_game->cpu_mem_write(static_cast<uint16_t>(addr & 0xffff), ((value >> 8) & 0xff));
-	g_game->cpu_mem_write(static_cast<uint16_t>((addr + 1) & 0xffff), (value & 0xff));
+	GAME_MEM_WRITE(static_cast<uint16_t>(addr & 0xffff), ((value >> 8) & 0xff));
+	GAME_MEM_WRITE(static_cast<uint16_t>((addr + 1) & 0xffff), (value & 0xff));
 }
 
 // I don't know if we'll need this...
@@ -45,6 +45,7 @@
 // own purposes.
 
 #include "cop.h"
+#include "cpu-profile.h"
 //#include <iostream.h>
 //#include <iomanip.h>
 
@@ -110,6 +111,16 @@ void cop421_setmemory(unsigned char *rom)
 	coprom = rom;
 }
 
+unsigned int cop421_get_pc()
+{
+	return PC;
+}
+
+unsigned char cop421_get_ram(unsigned int addr)
+{
+	return copram[(addr >> 4) & 0x3][addr & 0xf];
+}
+
 unsigned int cop421_execute(unsigned int cycles)
 {
 	unsigned int completed_cycles;
@@ -120,6 +131,7 @@ unsigned int cop421_execute(unsigned int cycles)
 		// Store current instruction
 		cur_inst = coprom[PC];
 		inst_pc = PC;
+		CPU_PROFILE_INSN(inst_pc, cur_inst);
 		// Do preinstruction stuff
 		preinst();
 		pc_inc();		
@@ -43,6 +43,8 @@
 unsigned int cop421_execute(unsigned int); // Main function, pass number of cycles to execute
 void cop421_reset(); // Reset COP
 void cop421_setmemory(unsigned char *); // Pass in pointer to internal COP ROM
+unsigned int cop421_get_pc(); // Returns the program counter
+unsigned char cop421_get_ram(unsigned int); // Returns the RAM digit at (Br << 4) | Bd
 
 // Interface functions (these need to be written for the application)
 extern void write_d_port(unsigned char); // Write to D port
@@ -21,42 +21,41 @@
  */
 
 #include "../game/game.h"
-#include "../game/thayers.h"
+#include "copintf.h"
 
-// NOTE : these static_cast's are rather hackish, they assume that only thayer's quest will ever use the COP
-// You may need to fix these later
+// the COP core calls these, and the game that is running decides what is on the other end
 
 void write_d_port(unsigned char stuff) 
 {
-	(static_cast<thayers*> (g_game))->thayers_write_d_port(stuff);
+	g_game->cop_port_write(COP_PORT_D, stuff);
 }
 
 void write_l_port(unsigned char stuff) 
 {
-	(static_cast<thayers*> (g_game))->thayers_write_l_port(stuff);
+	g_game->cop_port_write(COP_PORT_L, stuff);
 }
 
 unsigned char read_l_port(void)
 {
-	return (static_cast<thayers*> (g_game))->thayers_read_l_port();
+	return g_game->cop_port_read(COP_PORT_L);
 }
 
 void write_g_port(unsigned char stuff) 
 {
-	(static_cast<thayers*> (g_game))->thayers_write_g_port(stuff);
+	g_game->cop_port_write(COP_PORT_G, stuff);
 }
 
 unsigned char read_g_port(void)
 {
-	return (static_cast<thayers*> (g_game))->thayers_read_g_port();
+	return g_game->cop_port_read(COP_PORT_G);
 }
 
 void write_so_bit(unsigned char stuff) 
 {
-	(static_cast<thayers*> (g_game))->thayers_write_so_bit(stuff);
+	g_game->cop_port_write(COP_PORT_SIO, stuff);
 }
 
 unsigned char read_si_bit(void)
 {
-	return (static_cast<thayers*> (g_game))->thayers_read_si_bit();
+	return g_game->cop_port_read(COP_PORT_SIO);
 }
@@ -23,6 +23,15 @@
 #ifndef COPINTF_H
 #define COPINTF_H
 
+// which of the COP421's ports the core is reading or writing (passed to game::cop_port_read/cop_port_write)
+enum
+{
+	COP_PORT_D,	// D port (write only)
+	COP_PORT_L,	// L port
+	COP_PORT_G,	// G I/O port
+	COP_PORT_SIO	// SO bit when writing, SI bit when reading
+};
+
 void write_d_port(unsigned char); // Write to D port
 void write_l_port(unsigned char); // Write L port
 unsigned char read_l_port(void); // Read L port
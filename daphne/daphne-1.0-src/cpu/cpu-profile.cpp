@@ -0,0 +1,366 @@
+/*
+ * cpu-profile.cpp
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// cpu-profile.cpp -- a profiler for the emulated cpus (see cpu-profile.h)
+
+#ifdef CPU_PROFILE
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "cpu.h"
+#include "cpu-profile.h"
+#include "../io/conout.h"
+#include "../game/game.h"
+#include "../timer/telemetry.h"
+
+using namespace std;
+
+// Every this many instructions, the PC is sampled (odd so that we don't keep landing on the same spot of a loop)
+#define CPU_PROFILE_SAMPLE_PERIOD 31
+
+// Timing a handler costs more than most handlers do, so only 1 out of every this many calls is timed
+#define CPU_PROFILE_TIME_PERIOD 16
+
+// cpus beyond this many aren't profiled
+#define CPU_PROFILE_MAX_CPUS 4
+
+// how many lines of each section are logged
+#define CPU_PROFILE_TOP 20
+
+enum { PROFILE_MEM_READ, PROFILE_MEM_WRITE, PROFILE_PORT_READ, PROFILE_PORT_WRITE, PROFILE_HANDLER_COUNT };
+
+// Memory addresses are grouped into 256 ranges: 256 bytes each for 16-bit addresses, 4k each for 20-bit addresses.
+// Ports are grouped by their low 8 bits.
+#define CPU_PROFILE_RANGES 256
+
+struct handler_cost
+{
+	uint64_t u64Calls;
+	uint64_t u64TimedCalls;
+	uint64_t u64TimedNs;
+};
+
+struct cpu_profile
+{
+	uint32_t *pPCSamples;	// how many times each PC was sampled (CPU_MEM_SIZE entries)
+	uint64_t u64Samples;
+	uint64_t u64Opcodes[256];	// how many times each (first) opcode byte was executed
+	unsigned int uCountdown;	// instructions until the next sample
+	bool bWideAddresses;	// whether this cpu uses 20-bit addresses
+	handler_cost handlers[PROFILE_HANDLER_COUNT][CPU_PROFILE_RANGES];
+};
+
+extern uint8_t g_active_cpu;	// from cpu.cpp
+
+static cpu_profile g_cpu_profile[CPU_PROFILE_MAX_CPUS];
+
+void cpu_profile_insn(uint32_t pc, uint8_t opcode)
+{
+	if (g_active_cpu >= CPU_PROFILE_MAX_CPUS)
+	{
+		return;
+	}
+
+	cpu_profile *p = &g_cpu_profile[g_active_cpu];
+
+	p->u64Opcodes[opcode]++;
+
+	if (p->uCountdown == 0)
+	{
+		p->uCountdown = CPU_PROFILE_SAMPLE_PERIOD;
+
+		if (!p->pPCSamples)
+		{
+			p->pPCSamples = (uint32_t *) calloc(CPU_MEM_SIZE, sizeof(uint32_t));
+		}
+
+		if (p->pPCSamples)
+		{
+			p->pPCSamples[pc & (CPU_MEM_SIZE - 1)]++;
+			p->u64Samples++;
+		}
+	}
+	--p->uCountdown;
+}
+
+// returns where to count a handler call (or NULL if this cpu isn't profiled), and whether to time it
+static inline handler_cost *get_handler_cost(unsigned int uHandler, unsigned int uRange, bool &bTime)
+{
+	handler_cost *pResult = NULL;
+
+	if (g_active_cpu < CPU_PROFILE_MAX_CPUS)
+	{
+		pResult = &g_cpu_profile[g_active_cpu].handlers[uHandler][uRange & (CPU_PROFILE_RANGES - 1)];
+		bTime = ((pResult->u64Calls++ % CPU_PROFILE_TIME_PERIOD) == 0);
+	}
+
+	return pResult;
+}
+
+static inline void add_handler_time(handler_cost *pCost, uint64_t u64StartNs)
+{
+	pCost->u64TimedNs += telemetry_now_ns() - u64StartNs;
+	pCost->u64TimedCalls++;
+}
+
+uint8_t cpu_profile_mem_read(uint16_t addr)
+{
+	bool bTime = false;
+	handler_cost *pCost = get_handler_cost(PROFILE_MEM_READ, addr >> 8, bTime);
+	uint64_t u64StartNs = bTime ? telemetry_now_ns() : 0;
+	uint8_t result = g_game->cpu_mem_read(addr);
+
+	if (bTime)
+	{
+		add_handler_time(pCost, u64StartNs);
+	}
+	return result;
+}
+
+uint8_t cpu_profile_mem_read(uint32_t addr)
+{
+	bool bTime = false;
+	handler_cost *pCost = get_handler_cost(PROFILE_MEM_READ, addr >> 12, bTime);
+	uint64_t u64StartNs = bTime ? telemetry_now_ns() : 0;
+	uint8_t result = g_game->cpu_mem_read(addr);
+
+	if (g_active_cpu < CPU_PROFILE_MAX_CPUS)
+	{
+		g_cpu_profile[g_active_cpu].bWideAddresses = true;
+	}
+
+	if (bTime)
+	{
+		add_handler_time(pCost, u64StartNs);
+	}
+	return result;
+}
+
+void cpu_profile_mem_write(uint16_t addr, uint8_t value)
+{
+	bool bTime = false;
+	handler_cost *pCost = get_handler_cost(PROFILE_MEM_WRITE, addr >> 8, bTime);
+	uint64_t u64StartNs = bTime ? telemetry_now_ns() : 0;
+
+	g_game->cpu_mem_write(addr, value);
+
+	if (bTime)
+	{
+		add_handler_time(pCost, u64StartNs);
+	}
+}
+
+void cpu_profile_mem_write(uint32_t addr, uint8_t value)
+{
+	bool bTime = false;
+	handler_cost *pCost = get_handler_cost(PROFILE_MEM_WRITE, addr >> 12, bTime);
+	uint64_t u64StartNs = bTime ? telemetry_now_ns() : 0;
+
+	g_game->cpu_mem_write(addr, value);
+
+	if (bTime)
+	{
+		add_handler_time(pCost, u64StartNs);
+	}
+}
+
+uint8_t cpu_profile_port_read(uint16_t port)
+{
+	bool bTime = false;
+	handler_cost *pCost = get_handler_cost(PROFILE_PORT_READ, port, bTime);
+	uint64_t u64StartNs = bTime ? telemetry_now_ns() : 0;
+	uint8_t result = g_game->port_read(port);
+
+	if (bTime)
+	{
+		add_handler_time(pCost, u64StartNs);
+	}
+	return result;
+}
+
+void cpu_profile_port_write(uint16_t port, uint8_t value)
+{
+	bool bTime = false;
+	handler_cost *pCost = get_handler_cost(PROFILE_PORT_WRITE, port, bTime);
+	uint64_t u64StartNs = bTime ? telemetry_now_ns() : 0;
+
+	g_game->port_write(port, value);
+
+	if (bTime)
+	{
+		add_handler_time(pCost, u64StartNs);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// describes which ROM (if any) the cpu address 'addr' is in
+static string get_rom_region(const struct cpudef *cpu, uint32_t addr)
+{
+	string strResult = "";
+	const struct rom_def *rom = g_game->get_rom_list();
+	const uint8_t *p = cpu->mem + addr;
+
+	while (rom && rom->filename)
+	{
+		if ((p >= rom->buf) && (p < rom->buf + rom->size))
+		{
+			char s[160];
+			snprintf(s, sizeof(s), "%s+%05x", rom->filename, (unsigned int) (p - rom->buf));
+			strResult = s;
+			break;
+		}
+		++rom;
+	}
+
+	return strResult;
+}
+
+// sorts (count, index) pairs from the biggest count down
+static bool count_greater(const pair<uint64_t, uint32_t> &a, const pair<uint64_t, uint32_t> &b)
+{
+	return a.first > b.first;
+}
+
+static void report_handlers(unsigned int uCpu, unsigned int uHandler)
+{
+	static const char *names[PROFILE_HANDLER_COUNT] = { "mem read", "mem write", "port read", "port write" };
+	const cpu_profile *p = &g_cpu_profile[uCpu];
+	vector<pair<uint64_t, uint32_t> > vCost;
+	bool bPorts = (uHandler == PROFILE_PORT_READ) || (uHandler == PROFILE_PORT_WRITE);
+	unsigned int uShift = bPorts ? 0 : (p->bWideAddresses ? 12 : 8);
+	struct cpudef *cpu = get_cpu_struct(uCpu);
+
+	for (uint32_t u = 0; u < CPU_PROFILE_RANGES; u++)
+	{
+		const handler_cost *c = &p->handlers[uHandler][u];
+
+		if (c->u64Calls > 0)
+		{
+			// estimate the cost of all calls from the ones that were timed
+			uint64_t u64Ns = c->u64TimedCalls ? ((c->u64TimedNs * c->u64Calls) / c->u64TimedCalls) : 0;
+			vCost.push_back(make_pair(u64Ns, u));
+		}
+	}
+
+	sort(vCost.begin(), vCost.end(), count_greater);
+
+	for (size_t u = 0; (u < vCost.size()) && (u < CPU_PROFILE_TOP); u++)
+	{
+		const handler_cost *c = &p->handlers[uHandler][vCost[u].second];
+		uint32_t uStart = vCost[u].second << uShift;
+		uint32_t uEnd = ((vCost[u].second + 1) << uShift) - 1;
+		string strRom = (bPorts || !cpu) ? "" : get_rom_region(cpu, uStart);
+
+		if (bPorts)
+		{
+			LOGF(LOGLEVEL_INFO, "  %-10s port xx%02x    %12llu calls  %10.3f ms", names[uHandler], uStart,
+				(unsigned long long) c->u64Calls, vCost[u].first / 1000000.0);
+		}
+		else
+		{
+			LOGF(LOGLEVEL_INFO, "  %-10s %05x-%05x  %12llu calls  %10.3f ms  %s", names[uHandler], uStart, uEnd,
+				(unsigned long long) c->u64Calls, vCost[u].first / 1000000.0, strRom.c_str());
+		}
+	}
+}
+
+void cpu_profile_report()
+{
+	static const char *cpu_names[CPU_COUNT] = { "?", "Z80", "X86", "6809", "6502", "COP421", "I88" };
+
+	for (unsigned int uCpu = 0; uCpu < CPU_PROFILE_MAX_CPUS; uCpu++)
+	{
+		cpu_profile *p = &g_cpu_profile[uCpu];
+		struct cpudef *cpu = get_cpu_struct(uCpu);
+		uint64_t u64Insns = 0;
+		vector<pair<uint64_t, uint32_t> > vTop;
+
+		for (unsigned int u = 0; u < 256; u++)
+		{
+			u64Insns += p->u64Opcodes[u];
+		}
+
+		if (!cpu || (u64Insns == 0))
+		{
+			continue;
+		}
+
+		LOGF(LOGLEVEL_INFO, "CPU PROFILE : cpu %u (%s), %llu instructions, %llu PC samples", uCpu,
+			cpu_names[cpu->type < CPU_COUNT ? cpu->type : 0], (unsigned long long) u64Insns,
+			(unsigned long long) p->u64Samples);
+
+		// hottest PCs
+		if (p->pPCSamples && (p->u64Samples > 0))
+		{
+			for (uint32_t u = 0; u < CPU_MEM_SIZE; u++)
+			{
+				if (p->pPCSamples[u] != 0)
+				{
+					vTop.push_back(make_pair((uint64_t) p->pPCSamples[u], u));
+				}
+			}
+			sort(vTop.begin(), vTop.end(), count_greater);
+
+			LOGF(LOGLEVEL_INFO, " hottest PCs:");
+			for (size_t u = 0; (u < vTop.size()) && (u < CPU_PROFILE_TOP); u++)
+			{
+				LOGF(LOGLEVEL_INFO, "  %6.2f%%  pc %05x  %s", (vTop[u].first * 100.0) / p->u64Samples, vTop[u].second,
+					get_rom_region(cpu, vTop[u].second).c_str());
+			}
+		}
+
+		// most common opcodes
+		vTop.clear();
+		for (uint32_t u = 0; u < 256; u++)
+		{
+			if (p->u64Opcodes[u] != 0)
+			{
+				vTop.push_back(make_pair(p->u64Opcodes[u], u));
+			}
+		}
+		sort(vTop.begin(), vTop.end(), count_greater);
+
+		LOGF(LOGLEVEL_INFO, " most common opcodes:");
+		for (size_t u = 0; (u < vTop.size()) && (u < CPU_PROFILE_TOP); u++)
+		{
+			LOGF(LOGLEVEL_INFO, "  %6.2f%%  opcode %02x  (%llu)", (vTop[u].first * 100.0) / u64Insns, vTop[u].second,
+				(unsigned long long) vTop[u].first);
+		}
+
+		// what the game driver's handlers cost, most expensive first
+		LOGF(LOGLEVEL_INFO, " memory/port handlers (estimated time):");
+		for (unsigned int u = 0; u < PROFILE_HANDLER_COUNT; u++)
+		{
+			report_handlers(uCpu, u);
+		}
+
+		free(p->pPCSamples);
+		memset(p, 0, sizeof(*p));
+	}
+}
+
+#endif
+// end #ifdef CPU_PROFILE
@@ -0,0 +1,68 @@
+/*
+ * cpu-profile.h
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// cpu-profile.h -- a profiler for the emulated cpus, to find out which guest code is hot (idle loops, polling of
+//  laserdisc status, busy-wait timers) and what the memory/port handlers of the game driver cost.
+// It only exists if daphne is compiled with CPU_PROFILE defined (ie make FLAGS=-DCPU_PROFILE, which also reaches the C files).
+// Otherwise all of the macros below turn into nothing (or into the plain g_game calls) so there is no cost at all.
+// The results are logged when the cpus are shut down.
+
+#ifndef CPU_PROFILE_H
+#define CPU_PROFILE_H
+
+#include <stdint.h>
+
+#ifdef CPU_PROFILE
+
+// called by the cpu cores right before each instruction is executed
+void cpu_profile_insn(uint32_t pc, uint8_t opcode);
+
+// these call the game driver's memory/port handlers and keep track of what they cost
+uint8_t cpu_profile_mem_read(uint16_t addr);
+uint8_t cpu_profile_mem_read(uint32_t addr);
+void cpu_profile_mem_write(uint16_t addr, uint8_t value);
+void cpu_profile_mem_write(uint32_t addr, uint8_t value);
+uint8_t cpu_profile_port_read(uint16_t port);
+void cpu_profile_port_write(uint16_t port, uint8_t value);
+
+// logs the results (called by cpu_shutdown while the cpus still exist)
+void cpu_profile_report();
+
+#define CPU_PROFILE_INSN(pc, opcode) cpu_profile_insn((uint32_t) (pc), (uint8_t) (opcode))
+#define CPU_PROFILE_REPORT() cpu_profile_report()
+#define GAME_MEM_READ(addr) cpu_profile_mem_read(addr)
+#define GAME_MEM_WRITE(addr, value) cpu_profile_mem_write(addr, value)
+#define GAME_PORT_READ(port) cpu_profile_port_read(port)
+#define GAME_PORT_WRITE(port, value) cpu_profile_port_write(port, value)
+
+#else
+
+#define CPU_PROFILE_INSN(pc, opcode)
+#define CPU_PROFILE_REPORT()
+#define GAME_MEM_READ(addr) g_game->cpu_mem_read(addr)
+#define GAME_MEM_WRITE(addr, value) g_game->cpu_mem_write(addr, value)
+#define GAME_PORT_READ(port) g_game->port_read(port)
+#define GAME_PORT_WRITE(port, value) g_game->port_write(port, value)
+
+#endif // CPU_PROFILE
+
+#endif // CPU_PROFILE_H
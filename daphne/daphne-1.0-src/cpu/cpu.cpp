@@ -34,8 +34,12 @@
 #include "../game/game.h"
 #include "../ldp-out/ldp.h"	// to call pre_think
 #include "../timer/timer.h"
+#include "../timer/telemetry.h"
 #include "../io/input.h"
+#include "../io/movie.h"
+#include "cpu-profile.h"
 #include "../io/conout.h"
+#include "../io/threads.h"
 #include "../sound/sound.h"
 #include "6809infc.h"
 #include "nes6502.h"
@@ -177,6 +181,7 @@ void add_cpu (struct cpudef *candidate)
 		cur->execute_callback = cop421_execute;
 		cur->getcontext_callback = NULL;
 		cur->setcontext_callback = NULL;
+		cur->getpc_callback = cop421_get_pc;
 		cur->setpc_callback = NULL;
 		cur->reset_callback = cop421_reset;
 		break;
@@ -302,6 +307,8 @@ void cpu_init()
 void cpu_shutdown()
 {
 	struct cpudef *cur = g_head;
+
+	CPU_PROFILE_REPORT();	// while the cpus still exist
 	
 	// go through each cpu and shut it down
 	while (cur)
@@ -588,9 +595,6 @@ void cpu_execute_one_cycle()
 		  // 1 ms has elapsed, so notify the LDP to keep it in sync (we must do this after every ms)
 		g_ldp->pre_think();
 
-		// Update the sound buffers for the sound chips
-		update_soundbuffer();
-
 		// BEGIN FORCING EMULATOR TO RUN AT PROPER SPEED
 
 		// we have executed 1 ms worth of cpu cycles before this point, so slow down if 1 ms has not passed
@@ -598,22 +602,35 @@ void cpu_execute_one_cycle()
 
 		// if we're behind, then compute how far behind we are ...
 		if (actual_elapsed_ms > g_expected_elapsed_ms)
+		{
 			g_uCPUMsBehind = actual_elapsed_ms - g_expected_elapsed_ms;
+			telemetry_count(TELEM_CPU_BEHIND);
+		}
 		else
 		{
          // else we're caught up or ahead
 			g_uCPUMsBehind = 0;
 
 			// if not enough time has elapsed, slow down
-			while (g_expected_elapsed_ms > actual_elapsed_ms)
+			if (g_expected_elapsed_ms > actual_elapsed_ms)
 			{
-				SDL_Delay(1);
-				actual_elapsed_ms = elapsed_ms_time(g_cpu_timer);
+				uint64_t u64DelayStart = telemetry_start();
+
+				while (g_expected_elapsed_ms > actual_elapsed_ms)
+				{
+					SDL_Delay(1);
+					actual_elapsed_ms = elapsed_ms_time(g_cpu_timer);
+				}
+
+				telemetry_stop(TELEM_CPU_DELAY, u64DelayStart);
 			}
 		}
 
 		// END FORCING CPU TO RUN AT PROPER SPEED
 
+		// let a recording/playing movie apply its input now that this ms is finished
+		movie_think();
+
 		// 2017.08.18 - RJS - Single input check done here.  There is a lot of flotsam in this cpp.
 		// If this core will live on, it should be eliminated for search  ease.
 		SDL_check_input();	// check for input events (keyboard, joystick, etc)
@@ -624,6 +641,8 @@ void cpu_execute_one_cycle()
 //*********************************************************************************************************************************
 int cpu_execute(void * in_data)
 {
+	threads_setup("cpu");
+
 	/*
 	// Making a lazy flag for init.
 	if (one_cycle_inited == 0) cpu_execute_one_cycle_init();
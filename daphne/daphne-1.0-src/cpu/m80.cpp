@@ -2995,6 +2995,7 @@ uint32_t m80_execute(uint32_t cycles_to_execute)
 			MAME_Debug();
 #endif
 #endif
+			CPU_PROFILE_INSN(PC, opcode_base[PC]);
 			M80_EXEC_CUR_INSTR;
 		}
 
@@ -3008,6 +3009,7 @@ uint32_t m80_execute(uint32_t cycles_to_execute)
 #endif
 #endif
 			g_context.got_EI = 0;	/* clear this flag (it can be set in the next instruction) */
+			CPU_PROFILE_INSN(PC, opcode_base[PC]);
 			M80_EXEC_CUR_INSTR;
 		}
 
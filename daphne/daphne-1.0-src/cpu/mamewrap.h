@@ -272,14 +272,16 @@ void mw_i86_set_mem(uint8_t *mem);
 
 #include "../game/game.h"
 // included to make sure that g_game is defined, for the following macros
+#include "cpu-profile.h"
 
 // MPO : changed all of these to macros to eliminate (possible) function call overhead in case compiler doesn't inline functions
-#define cpu_readmem16(addr) g_game->cpu_mem_read(static_cast<uint16_t>(addr))
-#define cpu_readmem20(addr) g_game->cpu_mem_read(static_cast<uint32_t>(addr))
-#define cpu_writemem16(addr,value) g_game->cpu_mem_write(static_cast<uint16_t>(addr), value)
-#define cpu_writemem20(addr,value) g_game->cpu_mem_write(static_cast<uint32_t>(addr), value)
-#define cpu_readport16(port) g_game->port_read(port)
-#define cpu_writeport16(port,value) g_game->port_write(port, value)
+// (these go through the cpu profiler if it has been compiled in, see cpu-profile.h)
+#define cpu_readmem16(addr) GAME_MEM_READ(static_cast<uint16_t>(addr))
+#define cpu_readmem20(addr) GAME_MEM_READ(static_cast<uint32_t>(addr))
+#define cpu_writemem16(addr,value) GAME_MEM_WRITE(static_cast<uint16_t>(addr), value)
+#define cpu_writemem20(addr,value) GAME_MEM_WRITE(static_cast<uint32_t>(addr), value)
+#define cpu_readport16(port) GAME_PORT_READ(port)
+#define cpu_writeport16(port,value) GAME_PORT_WRITE(port, value)
 #define change_pc16(new_pc) g_game->update_pc(new_pc)
 #define change_pc20(new_pc) g_game->update_pc(new_pc)
 
@@ -2004,6 +2004,7 @@ UINT_MC mc6809_StepExec(UINT_MC ncycles)
 
 		/* on remplit le buffer de fetch */
 		FetchInstr(pc, fetch_buffer);
+		CPU_PROFILE_INSN(pc, fetch_buffer[0]);	// MPO
 		op = (CHAR_MC *)fetch_buffer;
 
 		/* on dcode l'instruction */
@@ -2044,6 +2045,7 @@ INT_MC mc6809_TimeExec(mc6809_clock_t time_limit)
 
 		/* on remplit le buffer de fetch */
 		FetchInstr(pc, fetch_buffer);
+		CPU_PROFILE_INSN(pc, fetch_buffer[0]);	// MPO
 		op = (CHAR_MC *)fetch_buffer;
 
 		/* on dcode l'instruction */
@@ -54,6 +54,7 @@
 //#include "dis6502.h" //DCR
 
 #include "cpu-debug.h"	// MPO
+#include "cpu-profile.h"
 
 //DCR
 #define ASSERT(CONDITION)
@@ -64,7 +65,8 @@
 //#define  NES6502_DISASM
 
 // MPO : we don't want to use the jumptable if we're in CPU_DEBUG mode because otherwise we'll never break
-#if defined(__GNUC__) && !defined(NES6502_DISASM) && !defined(CPU_DEBUG)
+// (the profiler needs to see every instruction too)
+#if defined(__GNUC__) && !defined(NES6502_DISASM) && !defined(CPU_DEBUG) && !defined(CPU_PROFILE)
 #define  NES6502_JUMPTABLE
 #endif /* __GNUC__ */
 
@@ -1478,6 +1480,8 @@ unsigned int nes6502_execute(unsigned int cycles_to_execute)
 #endif
 	  // end MPO
 
+      CPU_PROFILE_INSN(PC, bank_readbyte(PC));
+
       /* Fetch and execute instruction */
       switch (bank_readbyte(PC++))
       {
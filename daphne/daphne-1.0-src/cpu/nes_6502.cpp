@@ -25,6 +25,7 @@
 #include <stdio.h>
 //#include "debug.h"
 #include "../game/game.h"
+#include "cpu-profile.h"
 
 // NOT SAFE FOR MULTIPLE NES_6502'S
 static NES_6502 *NES_6502_nes = NULL;
@@ -94,10 +95,10 @@ void NES_6502::MemoryWrite(uint32_t addr, uint8_t data)
 */
 uint8_t NES_6502::MemoryRead(uint32_t addr)
 {
-  return g_game->cpu_mem_read(static_cast<uint16_t>(addr & 0xffff));
+  return GAME_MEM_READ(static_cast<uint16_t>(addr & 0xffff));
 }
 
 void NES_6502::MemoryWrite(uint32_t addr, uint8_t data)
 {
-  g_game->cpu_mem_write(static_cast<uint16_t>(addr & 0xffff), data);
+  GAME_MEM_WRITE(static_cast<uint16_t>(addr & 0xffff), data);
 }
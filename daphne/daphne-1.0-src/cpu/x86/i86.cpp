@@ -364,6 +364,7 @@ uint32_t i86_execute(uint32_t num_cycles)
 	while (i86_ICount > 0)
 	{
 		CALL_MAME_DEBUG;
+		CPU_PROFILE_INSN(I.pc, cpu_readop(I.pc));
 
 		seg_prefix = FALSE;
 		I.prevpc = I.pc;
@@ -512,6 +513,7 @@ int i186_execute(int num_cycles)
 	while (i86_ICount > 0)
 	{
 		CALL_MAME_DEBUG;
+		CPU_PROFILE_INSN(I.pc, cpu_readop(I.pc));
 
 		seg_prefix = FALSE;
 		I.prevpc = I.pc;
@@ -660,6 +662,7 @@ int v30_execute(int num_cycles)
 	while (i86_ICount > 0)
 	{
 		CALL_MAME_DEBUG;
+		CPU_PROFILE_INSN(I.pc, cpu_readop(I.pc));
 
 		seg_prefix = FALSE;
 		I.prevpc = I.pc;
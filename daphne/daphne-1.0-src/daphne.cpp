@@ -57,8 +57,10 @@ using namespace std;
 
 #include "io/homedir.h"
 #include "io/input.h"
+#include "io/movie.h"
 #include "daphne.h"
 #include "timer/timer.h"
+#include "timer/telemetry.h"
 #include "io/serial.h"
 #include "sound/sound.h"
 #include "io/conout.h"
@@ -66,6 +68,7 @@ using namespace std;
 #include "video/video.h"
 #include "video/led.h"
 #include "ldp-out/ldp.h"
+#include "ldp-out/ldptrace.h"
 #include "io/error.h"
 #include "cpu/cpu-debug.h"
 #include "cpu/cpu.h"
@@ -294,6 +297,9 @@ int main_daphne_shutdown()
 {
 	int result_code = 0;	// daphne will exit without any errors
 
+	// finish the movie before the cpus go away (the cpu thread may still be finishing its last ms)
+	movie_stop();
+
 	if (g_game)
 	{
 		g_game->pre_shutdown();
@@ -316,6 +322,12 @@ int main_daphne_shutdown()
 
 	free_bmps();
 	restore_leds();
+
+	ldptrace_stop();
+	telemetry_dump();
+
+	// make sure everything has made it into the log before we go
+	log_shutdown();
 	return(result_code);
 }
 
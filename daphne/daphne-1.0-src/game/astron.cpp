@@ -1182,6 +1182,20 @@ bool astron::set_bank(uint8_t which_bank, uint8_t value)
 	return result;
 }
 
+// combines the two sprite rom halves into pixel pairs once so draw_sprite doesn't have to
+//  (the sprites are run-length streams rather than fixed-size tiles, so they don't fit gfx_tileset)
+void astron::decode_gfx_roms()
+{
+	for (int x = 0x0000; x < 0x8000; x++)
+	{
+		uint8_t data_lo = sprite[x];
+		uint8_t data_high = sprite[x + 0x8000];
+
+		m_sprite_pixels[x][0] = static_cast<uint8_t>((data_lo >> 0x04) | (data_high & 0xf0));
+		m_sprite_pixels[x][1] = static_cast<uint8_t>((data_lo & 0x0f) | (data_high << 0x04));
+	}
+}
+
 // START modified Mame code
 void astron::draw_sprite(int spr_number)
 {
@@ -1213,20 +1227,16 @@ void astron::draw_sprite(int spr_number)
 
 		while (1)
 		{
-			int data_lo, data_high, data;
-
-			data = sprite[src2 & 0x7fff];
-			data_lo = sprite[src2 & 0x7fff];
-			data_high = sprite[(src2 & 0x7fff) + 0x8000];
+			const uint8_t *pixels = m_sprite_pixels[src2 & 0x7fff];
+			uint8_t pixel1 = pixels[0];
+			uint8_t pixel2 = pixels[1];
 
 			// stop drawing when the sprite data is 0xff
-			if ((data_lo == 0xff) && (data_high == 0xff)) 
+			//  (both rom bytes are 0xff exactly when both pixels are 0xff)
+			if ((pixel1 == 0xff) && (pixel2 == 0xff)) 
 			{
 				break;
 			}
-			
-			uint8_t pixel1 = (data_lo >> 0x04) | (data_high & 0xf0);
-			uint8_t pixel2 = (data_lo & 0x0f) | (data_high << 0x04);
 
 			// draw these guys backwards
 			if (src & 0x8000)
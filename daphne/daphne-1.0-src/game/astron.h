@@ -72,6 +72,7 @@ public:
 	virtual void input_disable(uint8_t);
 	void video_repaint();	// function to repaint video
 	void palette_calculate();
+	void decode_gfx_roms();
 	bool set_bank(uint8_t, uint8_t);
 	virtual void write_ldp(uint8_t, uint16_t);
 	virtual uint8_t read_ldp(uint16_t);
@@ -84,6 +85,7 @@ protected:
 	uint8_t rombank[0x8000];	
 	uint8_t character[0x1000];	
 	uint8_t sprite[0x10000];	
+	uint8_t m_sprite_pixels[0x8000][2];	// sprite rom pre-decoded into pixel pairs (low plane at 0x0000, high plane at 0x8000)
 	uint8_t bankprom[0x200];
 	uint8_t miscprom[0x240];
 	SDL_Color palette_lookup[4096];		// all possible color entries
@@ -566,6 +566,12 @@ void bega::cpu_mem_write(uint16_t addr, uint8_t value)
       // video ram
       else if (addr >= 0x2000 && addr <= 0x3fff)
       {
+         // tile and attribute ram for both tile/sprite generators
+         //  (the tile in each cell only needs to be redrawn if it actually changed)
+         if (((addr & 0x0800) != 0) && (m_cpumem[addr] != value))
+         {
+            m_tilemap.mark_dirty(addr & 0x1f, (addr >> 5) & 0x1f);
+         }
          m_video_overlay_needs_update = true;
       }
 
@@ -642,68 +648,74 @@ void bega::palette_calculate()
 // updates bega's video
 void bega::video_repaint()
 {	
-	//This is much faster!
-	SDL_FillRect(m_video_overlay[m_active_video_overlay], NULL, BEGA_TRANSPARENT_COLOR); // note:  using transparent color
+   SDL_Surface *overlay = m_video_overlay[m_active_video_overlay];
 
-   // now the sprites
-   draw_sprites(0x3800, character1);
-   draw_sprites(0x3be0, character1);
-   draw_sprites(0x2800, character2);
-   draw_sprites(0x2be0, character2);
+   if (!m_tilemap.is_initialized())
+   {
+      m_tilemap.init(32, 32, 8, 8, BEGA_TRANSPARENT_COLOR);
+   }
 
-   // draw tiles first
-   for (int charx = 0; charx < 32; charx++)
+   // RJS START ADD - update game credits, only goes up to 9
    {
-      // don't draw the first or last lines of tiles (this is where the sprite data is)
-      for (int chary = 1; chary < 31; chary++)
-      {
-         int current_character;
+      int nCredits = m_cpumem[22 * 32 + 19 + 0x2800] + 256 * (m_cpumem[22 * 32 + 19 + 0x2c00] & 0x03) - 16;
+      if ((nCredits < 0) || (nCredits > 9)) nCredits = 0;
+      g_game->update_game_credits(0, nCredits);
+   }
+   // RJS END
 
-		 // draw 8x8 tiles from tile/sprite generator 2
-         current_character = m_cpumem[chary * 32 + charx + 0x2800] + 256 * (m_cpumem[chary * 32 + charx + 0x2c00] & 0x03);
+   // redraw the tiles that have changed since the last repaint
+   if (m_tilemap.any_dirty())
+   {
+      SDL_Surface *layer = m_tilemap.get_layer();
 
-		 // RJS START ADD - update game credits, only goes up to 9
-		 if ((chary == 22) && (charx == 19))
-		 {
-			 int nCredits = current_character - 16;
-			 if ((nCredits < 0) || (nCredits > 9)) nCredits = 0;
-			 g_game->update_game_credits(0, nCredits);
+      for (int charx = 0; charx < 32; charx++)
+      {
+         // don't draw the first or last lines of tiles (this is where the sprite data is)
+         for (int chary = 1; chary < 31; chary++)
+         {
+            if (!m_tilemap.is_dirty(charx, chary))
+            {
+               continue;
+            }
 
-		 }
-		 // RJS END
+            m_tilemap.clear_cell(charx, chary);
+
+            int current_character;
+
+            // draw 8x8 tiles from tile/sprite generator 2
+            current_character = m_cpumem[chary * 32 + charx + 0x2800] + 256 * (m_cpumem[chary * 32 + charx + 0x2c00] & 0x03);
+            draw_8x8(layer,
+               current_character, 
+               m_tiles2, 
+               charx*8, chary*8, 
+               0, 0, 
+               6); // this isn't the correct color... i'm not sure where color comes from right now
+
+            // draw 8x8 tiles from tile/sprite generator 1
+            current_character = m_cpumem[chary * 32 + charx + 0x3800] + 256 * (m_cpumem[chary * 32 + charx + 0x3c00] & 0x03);
+            draw_8x8(layer,
+               current_character, 
+               m_tiles1, 
+               charx*8, chary*8, 
+               0, 0, 
+               6); // this isn't the correct color... i'm not sure where color comes from right now
+         }
+      }
 
-         draw_8x8(current_character, 
-            character2, 
-            charx*8, chary*8, 
-            0, 0, 
-            6); // this isn't the correct color... i'm not sure where color comes from right now
+      m_tilemap.clean();
+   }
 
-         // draw 8x8 tiles from tile/sprite generator 1
-         current_character = m_cpumem[chary * 32 + charx + 0x3800] + 256 * (m_cpumem[chary * 32 + charx + 0x3c00] & 0x03);
-         draw_8x8(current_character, 
-            character1, 
-            charx*8, chary*8, 
-            0, 0, 
-            6); // this isn't the correct color... i'm not sure where color comes from right now
+   //This is much faster!
+   SDL_FillRect(overlay, NULL, BEGA_TRANSPARENT_COLOR); // note:  using transparent color
 
-         // draw 8x8 tiles from tile/sprite generator 1
-         //current_character = m_cpumem[chary * 32 + charx + 0x2000] + 256 * 2;
-         //draw_8x8(current_character, 
-         //   character2, 
-         //   chary*8, charx*8, 
-         //   0, 0, 
-         //   6); // this isn't the correct color... i'm not sure where color comes from right now
-
-         // draw 8x8 tiles from tile/sprite generator 1
-         //current_character = m_cpumem[chary * 32 + charx + 0x3000] + 256 * (m_cpumem[chary * 32 + charx + 0x3c00] & 0x03);
-         //draw_8x8(current_character, 
-         //  character1, 
-         //   chary*8, charx*8, 
-         //   0, 0, 
-         //   6); // this isn't the correct color... i'm not sure where color comes from right now			
+   // now the sprites
+   draw_sprites(0x3800, m_sprites1);
+   draw_sprites(0x3be0, m_sprites1);
+   draw_sprites(0x2800, m_sprites2);
+   draw_sprites(0x2be0, m_sprites2);
 
-      }
-   }
+   // the tiles go on top of the sprites
+   m_tilemap.composite(overlay, true);
 }
 
 
@@ -836,92 +848,48 @@ void bega::input_disable(uint8_t move)
 // 60 1 2 3 4 5 6 7 8 9 70 1 2 3 4 5 6 7 8 9 80 1 2 3 4 5 6 7 8 9 90 1 2 3 4 5 6 7 8 9 00 1 2 3 4 5 6 7 8 9 10 1 2 3 4 5 6 7 8 9 20 1 2 3 4 5 6 7 8 9 
 //            !     _              +         0  1 2 3 4 5 6 7 8 9            Ö   A B C D  E F G H I J K L M N  O P Q R S T U V W X  Y Z █
 
-void bega::draw_8x8(int character_number, uint8_t *character_set, int xcoord, int ycoord,
+void bega::draw_8x8(SDL_Surface *dst, int character_number, gfx_tileset &character_set, int xcoord, int ycoord,
                     int xflip, int yflip, int color)
 {
-   uint8_t pixel[8] = {0};
-
-   // RJS START TEST - for character numbers
-   /*
-   if (character_number > 0)
-   {
-      if (character_number == 18)
-		character_number = 18;
-      if (character_number == 53) character_number = 68;
-      if (character_number == 51) character_number = 203;
-      if (character_number == 40) character_number = 30;
-   }
-   */
-   // RJS END
-
-   for (int y = 0; y < 8; y++)
-   {
-      uint8_t byte1 = character_set[character_number*8+y];
-      uint8_t byte2 = character_set[character_number*8+y+0x2000];
-      uint8_t byte3 = character_set[character_number*8+y+0x4000];
-
-      pixel[0] = static_cast<uint8_t>(((byte1 & 0x01) << 2) | ((byte2 & 0x01) << 1) | ((byte3 & 0x01) << 0));
-      pixel[1] = static_cast<uint8_t>(((byte1 & 0x02) << 1) | ((byte2 & 0x02) << 0) | ((byte3 & 0x02) >> 1));
-      pixel[2] = static_cast<uint8_t>(((byte1 & 0x04) << 0) | ((byte2 & 0x04) >> 1) | ((byte3 & 0x04) >> 2));
-      pixel[3] = static_cast<uint8_t>(((byte1 & 0x08) >> 1) | ((byte2 & 0x08) >> 2) | ((byte3 & 0x08) >> 3));
-      pixel[4] = static_cast<uint8_t>(((byte1 & 0x10) >> 2) | ((byte2 & 0x10) >> 3) | ((byte3 & 0x10) >> 4));
-      pixel[5] = static_cast<uint8_t>(((byte1 & 0x20) >> 3) | ((byte2 & 0x20) >> 4) | ((byte3 & 0x20) >> 5));
-      pixel[6] = static_cast<uint8_t>(((byte1 & 0x40) >> 4) | ((byte2 & 0x40) >> 5) | ((byte3 & 0x40) >> 6));
-      pixel[7] = static_cast<uint8_t>(((byte1 & 0x80) >> 5) | ((byte2 & 0x80) >> 6) | ((byte3 & 0x80) >> 7));
-
-      for (int x = 0; x < 8; x++)
-      {
-         if (pixel[x])
-         {
-            *((uint8_t *) m_video_overlay[m_active_video_overlay]->pixels + ((ycoord + (yflip ? y : (7-y))) * BEGA_OVERLAY_W) + (xcoord + (xflip ? (7-x) : x))) = pixel[x] + (8*color);
-         }
-      }
-   }
+   // NOTE : rows are stored bottom to top, hence the inverted yflip
+   character_set.draw(dst, character_number, xcoord, ycoord,
+      xflip != 0, yflip == 0, static_cast<uint8_t>(8*color));
 }
 
-void bega::draw_16x16(int character_number, uint8_t *character_set, int xcoord, int ycoord,
+void bega::draw_16x16(int character_number, gfx_tileset &character_set, int xcoord, int ycoord,
                       int xflip, int yflip, int color)
 {
-   uint8_t pixel[16] = {0};
+   // NOTE : rows are stored bottom to top, hence the inverted yflip
+   character_set.draw(m_video_overlay[m_active_video_overlay], character_number, xcoord, ycoord,
+      xflip != 0, yflip == 0, static_cast<uint8_t>(8*color));
+}
+
+void bega::decode_gfx_roms()
+{
+   // 3 bitplanes, 0x2000 bytes apart, one byte per row, leftmost pixel in bit 0
+   gfx_layout layout8x8 = { 8, 8, 3, { 0, 0x2000 * 8, 0x4000 * 8 }, { 0 }, { 0 }, 8 * 8 };
 
-   for (int y = 0; y < 16; y++)
+   // same as the 8x8 tiles, but the right half of each row is 16 bytes later
+   gfx_layout layout16x16 = { 16, 16, 3, { 0, 0x2000 * 8, 0x4000 * 8 }, { 0 }, { 0 }, 32 * 8 };
+
+   for (unsigned int i = 0; i < 16; i++)
    {
-      uint8_t byte1 = character_set[character_number*32+y];
-      uint8_t byte2 = character_set[character_number*32+y+0x2000];
-      uint8_t byte3 = character_set[character_number*32+y+0x4000];
-      uint8_t byte4 = character_set[character_number*32+y+16];
-      uint8_t byte5 = character_set[character_number*32+y+0x2000+16];
-      uint8_t byte6 = character_set[character_number*32+y+0x4000+16];
-
-      pixel[0]  = static_cast<uint8_t>((((byte1 & 0x01) << 2) | ((byte2 & 0x01) << 1) | ((byte3 & 0x01) << 0)));
-      pixel[1]  = static_cast<uint8_t>((((byte1 & 0x02) << 1) | ((byte2 & 0x02) << 0) | ((byte3 & 0x02) >> 1)));
-      pixel[2]  = static_cast<uint8_t>((((byte1 & 0x04) << 0) | ((byte2 & 0x04) >> 1) | ((byte3 & 0x04) >> 2)));
-      pixel[3]  = static_cast<uint8_t>((((byte1 & 0x08) >> 1) | ((byte2 & 0x08) >> 2) | ((byte3 & 0x08) >> 3)));
-      pixel[4]  = static_cast<uint8_t>((((byte1 & 0x10) >> 2) | ((byte2 & 0x10) >> 3) | ((byte3 & 0x10) >> 4)));
-      pixel[5]  = static_cast<uint8_t>((((byte1 & 0x20) >> 3) | ((byte2 & 0x20) >> 4) | ((byte3 & 0x20) >> 5)));
-      pixel[6]  = static_cast<uint8_t>((((byte1 & 0x40) >> 4) | ((byte2 & 0x40) >> 5) | ((byte3 & 0x40) >> 6)));
-      pixel[7]  = static_cast<uint8_t>((((byte1 & 0x80) >> 5) | ((byte2 & 0x80) >> 6) | ((byte3 & 0x80) >> 7)));
-      pixel[8]  = static_cast<uint8_t>((((byte4 & 0x01) << 2) | ((byte5 & 0x01) << 1) | ((byte6 & 0x01) << 0)));
-      pixel[9]  = static_cast<uint8_t>((((byte4 & 0x02) << 1) | ((byte5 & 0x02) << 0) | ((byte6 & 0x02) >> 1)));
-      pixel[10] = static_cast<uint8_t>((((byte4 & 0x04) << 0) | ((byte5 & 0x04) >> 1) | ((byte6 & 0x04) >> 2)));
-      pixel[11] = static_cast<uint8_t>((((byte4 & 0x08) >> 1) | ((byte5 & 0x08) >> 2) | ((byte6 & 0x08) >> 3)));
-      pixel[12] = static_cast<uint8_t>((((byte4 & 0x10) >> 2) | ((byte5 & 0x10) >> 3) | ((byte6 & 0x10) >> 4)));
-      pixel[13] = static_cast<uint8_t>((((byte4 & 0x20) >> 3) | ((byte5 & 0x20) >> 4) | ((byte6 & 0x20) >> 5)));
-      pixel[14] = static_cast<uint8_t>((((byte4 & 0x40) >> 4) | ((byte5 & 0x40) >> 5) | ((byte6 & 0x40) >> 6)));
-      pixel[15] = static_cast<uint8_t>((((byte4 & 0x80) >> 5) | ((byte5 & 0x80) >> 6) | ((byte6 & 0x80) >> 7)));
-
-      for (int x = 0; x < 16; x++)
+      if (i < 8)
       {
-         if (pixel[x])
-         {
-            *((uint8_t *) m_video_overlay[m_active_video_overlay]->pixels + ((ycoord + (yflip ? y : (15-y))) * BEGA_OVERLAY_W) + (xcoord + (xflip ? (15-x) : x))) = pixel[x] + (8*color);
-         }
-
+         layout8x8.uXOffset[i] = i;
+         layout8x8.uYOffset[i] = i * 8;
       }
+      layout16x16.uXOffset[i] = (i < 8) ? i : ((16 * 8) + (i - 8));
+      layout16x16.uYOffset[i] = i * 8;
    }
+
+   m_tiles1.decode(character1, sizeof(character1), layout8x8, 0x2000 / 8);
+   m_tiles2.decode(character2, sizeof(character2), layout8x8, 0x2000 / 8);
+   m_sprites1.decode(character1, sizeof(character1), layout16x16, 0x2000 / 32);
+   m_sprites2.decode(character2, sizeof(character2), layout16x16, 0x2000 / 32);
 }
 
-void bega::draw_sprites(int offset, uint8_t *character_set)
+void bega::draw_sprites(int offset, gfx_tileset &character_set)
 {
    for (int sprites = 0; sprites < 0x32; sprites += 4)
    {
@@ -25,6 +25,8 @@
 
 #include <stdint.h>
 #include "game.h"
+#include "gfxdecode.h"
+#include "tilemap.h"
 
 #define BEGA_OVERLAY_W 256	// width of overlay
 #define BEGA_OVERLAY_H 256 // height of overlay
@@ -59,6 +61,7 @@ public:
    const char *get_libretro_button_name(unsigned id);
 	void set_version(int);
 	bool set_bank(unsigned char which_bank, unsigned char value);
+	void decode_gfx_roms();
 
 protected:
    uint8_t m_soundchip1_id;   
@@ -66,9 +69,9 @@ protected:
    uint8_t m_soundchip1_address_latch;
    uint8_t m_soundchip2_address_latch;
    uint8_t m_sounddata_latch;
-   void draw_8x8(int, uint8_t *, int, int, int, int, int);
-	void draw_16x16(int, uint8_t *, int, int, int, int, int);
-	void draw_sprites(int, uint8_t *);
+   void draw_8x8(SDL_Surface *, int, gfx_tileset &, int, int, int, int, int);
+	void draw_16x16(int, gfx_tileset &, int, int, int, int, int);
+	void draw_sprites(int, gfx_tileset &);
 	void write_m6850_control(uint8_t);
 	uint8_t read_m6850_status();
 	void write_m6850_data(uint8_t);
@@ -80,6 +83,9 @@ protected:
    uint8_t mc6850_status;
 	uint8_t character1[0x6000];		
 	uint8_t character2[0x6000];		
+	gfx_tileset m_tiles1, m_tiles2;	// 8x8 tiles decoded from character1/character2
+	gfx_tileset m_sprites1, m_sprites2;	// 16x16 sprites decoded from character1/character2
+	gfx_tilemap m_tilemap;	// both tile layers, only redrawn where video ram has changed
 	uint8_t banks[3];				// bega's banks
 		// bank 1 is switches
 		// bank 2 is dip switch 1
@@ -441,7 +441,7 @@ void cobraconv::video_repaint()
 	SDL_FillRect(m_video_overlay[m_active_video_overlay], NULL, 0);
 
 	// draw sprites first(?)
-	draw_sprites(0x2800, character2);
+	draw_sprites(0x2800, m_sprites2);
 
 	// draw tiles
 	for (int charx = 0; charx < 32; charx++)
@@ -452,7 +452,7 @@ void cobraconv::video_repaint()
 			// draw 8x8 tiles from tile/sprite generator 2
 			int current_character = m_cpumem[chary * 32 + charx + 0x2800] + 256 * (m_cpumem[chary * 32 + charx + 0x2c00] & 0x03);
 			draw_8x8(current_character, 
-				character2, 
+				m_tiles2, 
 				charx*8, chary*8, 
 				0, 0, 
 				(m_cpumem[0x1001] >> 4) & 3); // this is a decent guess about the color selection
@@ -460,7 +460,7 @@ void cobraconv::video_repaint()
 			// draw 8x8 tiles from tile/sprite generator 1
 			current_character = m_cpumem[chary * 32 + charx + 0x2000] + 256 * (m_cpumem[chary * 32 + charx + 0x2400] & 0x03);
 			draw_8x8(current_character, 
-				character2, 
+				m_tiles2, 
 				//charx*8, chary*8,  // x/y swapped vs Bega's Battle hardware
 				chary*8, charx*8, 
 				0, 0, 
@@ -629,80 +629,50 @@ void cobraconv::OnLDV1000LineChange(bool bIsStatus, bool bIsEnabled)
 	}
 }
 
-void cobraconv::draw_8x8(int character_number, uint8_t *character_set, int xcoord, int ycoord,
+void cobraconv::draw_8x8(int character_number, gfx_tileset &character_set, int xcoord, int ycoord,
 						 int xflip, int yflip, int color)
 {
-	uint8_t pixel[8] = {0};
-
-	for (int y = 0; y < 8; y++)
-	{
-		uint8_t byte1 = character_set[character_number*8+y];
-		uint8_t byte2 = character_set[character_number*8+y+0x2000];
-		uint8_t byte3 = character_set[character_number*8+y+0x4000];
-
-		pixel[0] = static_cast<uint8_t>(((byte1 & 0x01) << 2) | ((byte2 & 0x01) << 1) | ((byte3 & 0x01) << 0));
-		pixel[1] = static_cast<uint8_t>(((byte1 & 0x02) << 1) | ((byte2 & 0x02) << 0) | ((byte3 & 0x02) >> 1));
-		pixel[2] = static_cast<uint8_t>(((byte1 & 0x04) << 0) | ((byte2 & 0x04) >> 1) | ((byte3 & 0x04) >> 2));
-		pixel[3] = static_cast<uint8_t>(((byte1 & 0x08) >> 1) | ((byte2 & 0x08) >> 2) | ((byte3 & 0x08) >> 3));
-		pixel[4] = static_cast<uint8_t>(((byte1 & 0x10) >> 2) | ((byte2 & 0x10) >> 3) | ((byte3 & 0x10) >> 4));
-		pixel[5] = static_cast<uint8_t>(((byte1 & 0x20) >> 3) | ((byte2 & 0x20) >> 4) | ((byte3 & 0x20) >> 5));
-		pixel[6] = static_cast<uint8_t>(((byte1 & 0x40) >> 4) | ((byte2 & 0x40) >> 5) | ((byte3 & 0x40) >> 6));
-		pixel[7] = static_cast<uint8_t>(((byte1 & 0x80) >> 5) | ((byte2 & 0x80) >> 6) | ((byte3 & 0x80) >> 7));
-
-		for (int x = 0; x < 8; x++)
-		{
-			if (pixel[x])
-			{
-				*((uint8_t *) m_video_overlay[m_active_video_overlay]->pixels + ((ycoord + (yflip ? y : (7-y))) * COBRACONV_OVERLAY_W) + (xcoord + (xflip ? (7-x) : x))) = pixel[x] + (8*color);
-			}
-		}
-	}
+	// NOTE : rows are stored bottom to top, hence the inverted yflip
+	character_set.draw(m_video_overlay[m_active_video_overlay], character_number, xcoord, ycoord,
+		xflip != 0, yflip == 0, static_cast<uint8_t>(8*color));
 }
 
-void cobraconv::draw_16x32(int character_number, uint8_t *character_set, int xcoord, int ycoord,
+void cobraconv::draw_16x32(int character_number, gfx_tileset &character_set, int xcoord, int ycoord,
 						   int xflip, int yflip, int color)
 {
-	uint8_t pixel[16] = {0};
+	// NOTE : these sprites have never been flipped vertically, and start one line down
+	character_set.draw(m_video_overlay[m_active_video_overlay], character_number, xcoord, ycoord + 1,
+		xflip != 0, false, static_cast<uint8_t>(8*color));
+}
 
-	for (int b = 0; b < 8; b+=2) // laid out as four 8-pixel high blocks
+void cobraconv::decode_gfx_roms()
+{
+	// 3 bitplanes, 0x2000 bytes apart, one byte per row, leftmost pixel in bit 0 (rows are stored bottom to top)
+	gfx_layout layout8x8 = { 8, 8, 3, { 0, 0x2000 * 8, 0x4000 * 8 }, { 0 }, { 0 }, 8 * 8 };
+
+	// sprites are laid out as four blocks of 8 rows, each block is 8 bytes of left half and then 8 bytes of right half,
+	//  and the rows in each block are stored bottom to top
+	gfx_layout layout16x32 = { 16, 32, 3, { 0, 0x2000 * 8, 0x4000 * 8 }, { 0 }, { 0 }, 32 * 8 };
+
+	for (unsigned int i = 0; i < 32; i++)
 	{
-		for (int y = 0; y < 8; y++)
+		if (i < 8)
 		{
-			uint8_t byte1 = character_set[character_number*32+y+(b*8)];
-			uint8_t byte2 = character_set[character_number*32+y+0x2000+(b*8)];
-			uint8_t byte3 = character_set[character_number*32+y+0x4000+(b*8)];
-			uint8_t byte4 = character_set[character_number*32+y+((b+1)*8)];
-			uint8_t byte5 = character_set[character_number*32+y+0x2000+((b+1)*8)];
-			uint8_t byte6 = character_set[character_number*32+y+0x4000+((b+1)*8)];
-
-			pixel[0]  = static_cast<uint8_t>((((byte1 & 0x01) << 2) | ((byte2 & 0x01) << 1) | ((byte3 & 0x01) << 0)));
-			pixel[1]  = static_cast<uint8_t>((((byte1 & 0x02) << 1) | ((byte2 & 0x02) << 0) | ((byte3 & 0x02) >> 1)));
-			pixel[2]  = static_cast<uint8_t>((((byte1 & 0x04) << 0) | ((byte2 & 0x04) >> 1) | ((byte3 & 0x04) >> 2)));
-			pixel[3]  = static_cast<uint8_t>((((byte1 & 0x08) >> 1) | ((byte2 & 0x08) >> 2) | ((byte3 & 0x08) >> 3)));
-			pixel[4]  = static_cast<uint8_t>((((byte1 & 0x10) >> 2) | ((byte2 & 0x10) >> 3) | ((byte3 & 0x10) >> 4)));
-			pixel[5]  = static_cast<uint8_t>((((byte1 & 0x20) >> 3) | ((byte2 & 0x20) >> 4) | ((byte3 & 0x20) >> 5)));
-			pixel[6]  = static_cast<uint8_t>((((byte1 & 0x40) >> 4) | ((byte2 & 0x40) >> 5) | ((byte3 & 0x40) >> 6)));
-			pixel[7]  = static_cast<uint8_t>((((byte1 & 0x80) >> 5) | ((byte2 & 0x80) >> 6) | ((byte3 & 0x80) >> 7)));
-			pixel[8]  = static_cast<uint8_t>((((byte4 & 0x01) << 2) | ((byte5 & 0x01) << 1) | ((byte6 & 0x01) << 0)));
-			pixel[9]  = static_cast<uint8_t>((((byte4 & 0x02) << 1) | ((byte5 & 0x02) << 0) | ((byte6 & 0x02) >> 1)));
-			pixel[10] = static_cast<uint8_t>((((byte4 & 0x04) << 0) | ((byte5 & 0x04) >> 1) | ((byte6 & 0x04) >> 2)));
-			pixel[11] = static_cast<uint8_t>((((byte4 & 0x08) >> 1) | ((byte5 & 0x08) >> 2) | ((byte6 & 0x08) >> 3)));
-			pixel[12] = static_cast<uint8_t>((((byte4 & 0x10) >> 2) | ((byte5 & 0x10) >> 3) | ((byte6 & 0x10) >> 4)));
-			pixel[13] = static_cast<uint8_t>((((byte4 & 0x20) >> 3) | ((byte5 & 0x20) >> 4) | ((byte6 & 0x20) >> 5)));
-			pixel[14] = static_cast<uint8_t>((((byte4 & 0x40) >> 4) | ((byte5 & 0x40) >> 5) | ((byte6 & 0x40) >> 6)));
-			pixel[15] = static_cast<uint8_t>((((byte4 & 0x80) >> 5) | ((byte5 & 0x80) >> 6) | ((byte6 & 0x80) >> 7)));
-
-			for (int x = 0; x < 16; x++)
-			{
-				if (pixel[x])
-				{
-					*((uint8_t *) m_video_overlay[m_active_video_overlay]->pixels + ((ycoord + (8-y)+(b*4)) * COBRACONV_OVERLAY_W) + (xcoord + (xflip ? (15-x) : x))) = pixel[x] + (8*color);
-				}			
-			}
+			layout8x8.uXOffset[i] = i;
+			layout8x8.uYOffset[i] = i * 8;
 		}
+		if (i < 16)
+		{
+			layout16x32.uXOffset[i] = (i < 8) ? i : ((8 * 8) + (i - 8));
+		}
+		layout16x32.uYOffset[i] = ((7 - (i & 7)) + ((i >> 3) * 16)) * 8;
 	}
+
+	m_tiles2.decode(character2, sizeof(character2), layout8x8, 0x2000 / 8);
+	m_sprites2.decode(character2, sizeof(character2), layout16x32, 0x2000 / 32);
 }
-void cobraconv::draw_sprites(int offset, uint8_t *character_set)
+
+void cobraconv::draw_sprites(int offset, gfx_tileset &character_set)
 {
 	for (int sprites = 0; sprites < 0x32; sprites += 4)
 	{
@@ -25,6 +25,7 @@
 
 #include <stdint.h>
 #include "game.h"
+#include "gfxdecode.h"
 
 #define COBRACONV_OVERLAY_W 256	// width of overlay
 #define COBRACONV_OVERLAY_H 256 // height of overlay
@@ -50,19 +51,22 @@ public:
    unsigned get_libretro_button_map(unsigned id);
    const char *get_libretro_button_name(unsigned id);
 	bool set_bank(unsigned char, unsigned char);
+	void decode_gfx_roms();
 
 protected:
 	uint8_t m_sounddata_latch;
 	uint8_t m_soundchip_id;
 	uint8_t m_soundchip_address_latch;
 	uint8_t m_cpumem2[0x10000]; // 64k of space for the sound cpu
-	void draw_8x8(int, uint8_t *, int, int, int, int, int);
-	void draw_16x32(int, uint8_t *, int, int, int, int, int);
-	void draw_sprites(int, uint8_t *);
+	void draw_8x8(int, gfx_tileset &, int, int, int, int, int);
+	void draw_16x32(int, gfx_tileset &, int, int, int, int, int);
+	void draw_sprites(int, gfx_tileset &);
 	uint8_t ldp_status;
 	uint8_t character1[0x6000];
 	uint8_t character2[0x6000];
 	uint8_t character[0x8000];
+	gfx_tileset m_tiles2;	// 8x8 tiles decoded from character2
+	gfx_tileset m_sprites2;	// 16x32 sprites decoded from character2
 	uint8_t color_prom[0x200];
 	uint8_t miscprom[0x400];		//stores unused proms, to make sure no one strips them out
 
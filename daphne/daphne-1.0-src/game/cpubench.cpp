@@ -0,0 +1,784 @@
+/*
+ * cpubench.cpp
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// cpubench.cpp -- measures how fast each of daphne's cpu cores runs, without a game attached to them
+// Run it with:
+//  daphne cpubench noldp [-bench_core z80|6809|6502|i86|cop421] [-bench_repeat <n>]
+// Each core runs a couple of small hand-assembled programs out of a flat 1 meg RAM: an ALU loop that mostly
+//  stays in registers and a memory loop that adds one 4k buffer into another.  Every program ends in a
+//  jump-to-self, and what it computed is compared against the same computation done in C, so a core
+//  that gets faster by getting something wrong shows up as a failure instead of as a win.
+// For each program we print the emulated MHz, host ns per guest instruction, and how many memory callbacks
+//  each instruction made along with roughly how much of the run time those callbacks cost.
+// (The programs are not taken from game ROMs, we can't ship those.  To see which loops a real game spends its
+//  time in, build with make FLAGS=-DCPU_PROFILE and run the game itself.)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cpubench.h"
+#include "../daphne.h"	// for get_quitflag/set_quitflag
+#include "../cpu/cpu.h"
+#include "../cpu/cop.h"
+#include "../io/cmdline.h"
+#include "../io/conout.h"
+#include "../io/threads.h"
+#include "../timer/telemetry.h"
+
+// Win32 doesn't use strcasecmp, it uses stricmp (lame)
+#ifdef WIN32
+#define strcasecmp stricmp
+#endif
+
+// how many cycles we give a core before checking whether it has reached the end of its program
+#define CPUBENCH_SLICE 1000
+
+// if a program hasn't finished after this many cycles, it never will
+#define CPUBENCH_MAX_CYCLES 1000000000
+
+// how many calls we time to figure out what a memory callback costs
+#define CPUBENCH_CALIBRATE_CALLS 10000000
+
+// where the memory loops get their data from, where they add it to, and how many times they do it
+#define CPUBENCH_SRC 0x4000
+#define CPUBENCH_DST 0x5000
+#define CPUBENCH_BUF_SIZE 0x1000
+#define CPUBENCH_PASSES 100
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+static uint8_t rotl8(uint8_t u)
+{
+	return (uint8_t) ((u << 1) | (u >> 7));
+}
+
+// puts 'pCode' in memory at 'uAddr'
+static void load_code(uint8_t *mem, uint32_t uAddr, const uint8_t *pCode, unsigned int uSize)
+{
+	memcpy(mem + uAddr, pCode, uSize);
+}
+
+static uint8_t src_byte(unsigned int u)
+{
+	return (uint8_t) ((u * 7) + 3);
+}
+
+static uint8_t dst_byte(unsigned int u)
+{
+	return (uint8_t) (u ^ (u >> 5));
+}
+
+// fills the buffers that the memory loops work on
+static void fill_buffers(uint8_t *mem)
+{
+	for (unsigned int u = 0; u < CPUBENCH_BUF_SIZE; u++)
+	{
+		mem[CPUBENCH_SRC + u] = src_byte(u);
+		mem[CPUBENCH_DST + u] = dst_byte(u);
+	}
+}
+
+// every memory loop does dst[i] += src[i] over the whole buffer, CPUBENCH_PASSES times
+static bool check_buffers(const uint8_t *mem)
+{
+	for (unsigned int u = 0; u < CPUBENCH_BUF_SIZE; u++)
+	{
+		if ((mem[CPUBENCH_SRC + u] != src_byte(u)) ||
+			(mem[CPUBENCH_DST + u] != (uint8_t) (dst_byte(u) + (CPUBENCH_PASSES * src_byte(u)))))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Z80 ALU loop: for 16 * 256 * 256 iterations, e = rotl(e ^ b) and hl += e
+static const uint8_t g_z80_alu[] =
+{
+	0x21, 0x00, 0x00,	// 0000: LD HL,0
+	0x1E, 0x00,			// 0003: LD E,0
+	0x16, 0x10,			// 0005: LD D,16
+	0x0E, 0x00,			// 0007: LD C,0
+	0x06, 0x00,			// 0009: LD B,0
+	0x7B,				// 000B: LD A,E
+	0xA8,				// 000C: XOR B
+	0x07,				// 000D: RLCA
+	0x5F,				// 000E: LD E,A
+	0x85,				// 000F: ADD A,L
+	0x6F,				// 0010: LD L,A
+	0x7C,				// 0011: LD A,H
+	0xCE, 0x00,			// 0012: ADC A,0
+	0x67,				// 0014: LD H,A
+	0x10, 0xF4,			// 0015: DJNZ 000B
+	0x0D,				// 0017: DEC C
+	0x20, 0xEF,			// 0018: JR NZ,0009
+	0x15,				// 001A: DEC D
+	0x20, 0xEA,			// 001B: JR NZ,0007
+	0x22, 0x00, 0x80,	// 001D: LD (8000),HL
+	0x7B,				// 0020: LD A,E
+	0x32, 0x02, 0x80,	// 0021: LD (8002),A
+	0x18, 0xFE			// 0024: JR 0024
+};
+
+static void setup_z80_alu(uint8_t *mem)
+{
+	load_code(mem, 0, g_z80_alu, sizeof(g_z80_alu));
+}
+
+static bool check_z80_alu(const uint8_t *mem)
+{
+	uint16_t hl = 0;
+	uint8_t e = 0;
+
+	for (unsigned int d = 0; d < 16; d++)
+	{
+		for (unsigned int c = 0; c < 256; c++)
+		{
+			// DJNZ counts B down from 0, so B is 0, 255, 254 ... 1 inside the loop
+			for (unsigned int b = 256; b > 0; b--)
+			{
+				e = rotl8(e ^ (uint8_t) b);
+				hl = (uint16_t) (hl + e);
+			}
+		}
+	}
+
+	return (mem[0x8000] == (hl & 0xFF)) && (mem[0x8001] == (hl >> 8)) && (mem[0x8002] == e);
+}
+
+// Z80 memory loop
+static const uint8_t g_z80_mem[] =
+{
+	0x16, CPUBENCH_PASSES,	// 0000: LD D,100
+	0x21, 0x00, 0x40,	// 0002: LD HL,4000
+	0x01, 0x00, 0x50,	// 0005: LD BC,5000
+	0x0A,				// 0008: LD A,(BC)
+	0x86,				// 0009: ADD A,(HL)
+	0x02,				// 000A: LD (BC),A
+	0x23,				// 000B: INC HL
+	0x03,				// 000C: INC BC
+	0x7C,				// 000D: LD A,H
+	0xFE, 0x50,			// 000E: CP 50
+	0x20, 0xF6,			// 0010: JR NZ,0008
+	0x15,				// 0012: DEC D
+	0x20, 0xED,			// 0013: JR NZ,0002
+	0x18, 0xFE			// 0015: JR 0015
+};
+
+static void setup_z80_mem(uint8_t *mem)
+{
+	load_code(mem, 0, g_z80_mem, sizeof(g_z80_mem));
+	fill_buffers(mem);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// 6809 ALU loop: for 4096 * 256 iterations, x += b, a = rotl(a) ^ 0x5A and x += (signed) a
+static const uint8_t g_6809_alu[] =
+{
+	0x8E, 0x00, 0x00,	// 1000: LDX #$0000
+	0x4F,				// 1003: CLRA
+	0x10, 0x8E, 0x10, 0x00,	// 1004: LDY #$1000
+	0x5F,				// 1008: CLRB
+	0x3A,				// 1009: ABX
+	0x48,				// 100A: LSLA
+	0x89, 0x00,			// 100B: ADCA #$00
+	0x88, 0x5A,			// 100D: EORA #$5A
+	0x30, 0x86,			// 100F: LEAX A,X
+	0x5A,				// 1011: DECB
+	0x26, 0xF5,			// 1012: BNE $1009
+	0x31, 0x3F,			// 1014: LEAY -1,Y
+	0x26, 0xF0,			// 1016: BNE $1008
+	0xBF, 0x80, 0x00,	// 1018: STX $8000
+	0xB7, 0x80, 0x02,	// 101B: STA $8002
+	0x20, 0xFE			// 101E: BRA $101E
+};
+
+// 6809 memory loop
+static const uint8_t g_6809_mem[] =
+{
+	0xC6, CPUBENCH_PASSES,	// 1000: LDB #100
+	0x8E, 0x40, 0x00,	// 1002: LDX #$4000
+	0x10, 0x8E, 0x50, 0x00,	// 1005: LDY #$5000
+	0xA6, 0xA4,			// 1009: LDA ,Y
+	0xAB, 0x80,			// 100B: ADDA ,X+
+	0xA7, 0xA0,			// 100D: STA ,Y+
+	0x8C, 0x50, 0x00,	// 100F: CMPX #$5000
+	0x26, 0xF5,			// 1012: BNE $1009
+	0x5A,				// 1014: DECB
+	0x26, 0xEB,			// 1015: BNE $1002
+	0x20, 0xFE			// 1017: BRA $1017
+};
+
+static void setup_6809(uint8_t *mem)
+{
+	// reset vector
+	mem[0xFFFE] = 0x10;
+	mem[0xFFFF] = 0x00;
+}
+
+static void setup_6809_alu(uint8_t *mem)
+{
+	setup_6809(mem);
+	load_code(mem, 0x1000, g_6809_alu, sizeof(g_6809_alu));
+}
+
+static bool check_6809_alu(const uint8_t *mem)
+{
+	uint16_t x = 0;
+	uint8_t a = 0;
+
+	for (unsigned int y = 0; y < 0x1000; y++)
+	{
+		// B is 0, 255, 254 ... 1 inside the loop
+		for (unsigned int b = 256; b > 0; b--)
+		{
+			x = (uint16_t) (x + (b & 0xFF));
+			a = rotl8(a) ^ 0x5A;
+			x = (uint16_t) (x + (int8_t) a);
+		}
+	}
+
+	return (mem[0x8000] == (x >> 8)) && (mem[0x8001] == (x & 0xFF)) && (mem[0x8002] == a);
+}
+
+static void setup_6809_mem(uint8_t *mem)
+{
+	setup_6809(mem);
+	load_code(mem, 0x1000, g_6809_mem, sizeof(g_6809_mem));
+	fill_buffers(mem);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// 6502 ALU loop: for 16 * 256 * 256 iterations, e = rotl(e ^ x) and sum += e (e and sum live in zero page)
+static const uint8_t g_6502_alu[] =
+{
+	0xD8,				// 0200: CLD
+	0xA9, 0x00,			// 0201: LDA #$00
+	0x85, 0x10,			// 0203: STA $10
+	0x85, 0x11,			// 0205: STA $11
+	0x85, 0x12,			// 0207: STA $12
+	0xA9, 0x10,			// 0209: LDA #$10
+	0x85, 0x13,			// 020B: STA $13
+	0xA0, 0x00,			// 020D: LDY #$00
+	0xA2, 0x00,			// 020F: LDX #$00
+	0x8A,				// 0211: TXA
+	0x45, 0x12,			// 0212: EOR $12
+	0x0A,				// 0214: ASL A
+	0x69, 0x00,			// 0215: ADC #$00
+	0x85, 0x12,			// 0217: STA $12
+	0x18,				// 0219: CLC
+	0x65, 0x10,			// 021A: ADC $10
+	0x85, 0x10,			// 021C: STA $10
+	0xA5, 0x11,			// 021E: LDA $11
+	0x69, 0x00,			// 0220: ADC #$00
+	0x85, 0x11,			// 0222: STA $11
+	0xCA,				// 0224: DEX
+	0xD0, 0xEA,			// 0225: BNE $0211
+	0x88,				// 0227: DEY
+	0xD0, 0xE5,			// 0228: BNE $020F
+	0xC6, 0x13,			// 022A: DEC $13
+	0xD0, 0xDF,			// 022C: BNE $020D
+	0x4C, 0x2E, 0x02	// 022E: JMP $022E
+};
+
+// 6502 memory loop, ($10) points into the source and ($12) into the destination
+static const uint8_t g_6502_mem[] =
+{
+	0xD8,				// 0200: CLD
+	0xA9, CPUBENCH_PASSES,	// 0201: LDA #100
+	0x85, 0x14,			// 0203: STA $14
+	0xA9, 0x40,			// 0205: LDA #$40
+	0x85, 0x11,			// 0207: STA $11
+	0xA9, 0x50,			// 0209: LDA #$50
+	0x85, 0x13,			// 020B: STA $13
+	0xA9, 0x00,			// 020D: LDA #$00
+	0x85, 0x10,			// 020F: STA $10
+	0x85, 0x12,			// 0211: STA $12
+	0xA2, 0x10,			// 0213: LDX #$10
+	0xA0, 0x00,			// 0215: LDY #$00
+	0xB1, 0x12,			// 0217: LDA ($12),Y
+	0x18,				// 0219: CLC
+	0x71, 0x10,			// 021A: ADC ($10),Y
+	0x91, 0x12,			// 021C: STA ($12),Y
+	0xC8,				// 021E: INY
+	0xD0, 0xF6,			// 021F: BNE $0217
+	0xE6, 0x11,			// 0221: INC $11
+	0xE6, 0x13,			// 0223: INC $13
+	0xCA,				// 0225: DEX
+	0xD0, 0xED,			// 0226: BNE $0215
+	0xC6, 0x14,			// 0228: DEC $14
+	0xD0, 0xD9,			// 022A: BNE $0205
+	0x4C, 0x2C, 0x02	// 022C: JMP $022C
+};
+
+static void setup_6502(uint8_t *mem)
+{
+	// reset vector
+	mem[0xFFFC] = 0x00;
+	mem[0xFFFD] = 0x02;
+}
+
+static void setup_6502_alu(uint8_t *mem)
+{
+	setup_6502(mem);
+	load_code(mem, 0x200, g_6502_alu, sizeof(g_6502_alu));
+}
+
+static bool check_6502_alu(const uint8_t *mem)
+{
+	uint16_t sum = 0;
+	uint8_t e = 0;
+
+	for (unsigned int k = 0; k < 16; k++)
+	{
+		for (unsigned int y = 0; y < 256; y++)
+		{
+			// X is 0, 255, 254 ... 1 inside the loop
+			for (unsigned int x = 256; x > 0; x--)
+			{
+				e = rotl8(e ^ (uint8_t) x);
+				sum = (uint16_t) (sum + e);
+			}
+		}
+	}
+
+	return (mem[0x10] == (sum & 0xFF)) && (mem[0x11] == (sum >> 8)) && (mem[0x12] == e) && (mem[0x13] == 0);
+}
+
+static void setup_6502_mem(uint8_t *mem)
+{
+	setup_6502(mem);
+	load_code(mem, 0x200, g_6502_mem, sizeof(g_6502_mem));
+	fill_buffers(mem);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// 8088 ALU loop (at 1000:0000): for 16 * 65536 iterations, dl = rotl(dl ^ cl) and bx += dl
+static const uint8_t g_i86_alu[] =
+{
+	0x31, 0xC0,			// 0000: XOR AX,AX
+	0x8E, 0xD8,			// 0002: MOV DS,AX
+	0x31, 0xDB,			// 0004: XOR BX,BX
+	0x30, 0xD2,			// 0006: XOR DL,DL
+	0xBE, 0x10, 0x00,	// 0008: MOV SI,16
+	0x31, 0xC9,			// 000B: XOR CX,CX
+	0x88, 0xD0,			// 000D: MOV AL,DL
+	0x30, 0xC8,			// 000F: XOR AL,CL
+	0xD0, 0xC0,			// 0011: ROL AL,1
+	0x88, 0xC2,			// 0013: MOV DL,AL
+	0x30, 0xE4,			// 0015: XOR AH,AH
+	0x01, 0xC3,			// 0017: ADD BX,AX
+	0xE2, 0xF2,			// 0019: LOOP 000D
+	0x4E,				// 001B: DEC SI
+	0x75, 0xED,			// 001C: JNZ 000B
+	0x89, 0x1E, 0x00, 0x80,	// 001E: MOV [8000],BX
+	0x88, 0x16, 0x02, 0x80,	// 0022: MOV [8002],DL
+	0xEB, 0xFE			// 0026: JMP 0026
+};
+
+// 8088 memory loop (at 1000:0000)
+static const uint8_t g_i86_mem[] =
+{
+	0x31, 0xC0,			// 0000: XOR AX,AX
+	0x8E, 0xD8,			// 0002: MOV DS,AX
+	0xBA, CPUBENCH_PASSES, 0x00,	// 0004: MOV DX,100
+	0xBE, 0x00, 0x40,	// 0007: MOV SI,4000
+	0xBF, 0x00, 0x50,	// 000A: MOV DI,5000
+	0xB9, 0x00, 0x10,	// 000D: MOV CX,1000
+	0x8A, 0x05,			// 0010: MOV AL,[DI]
+	0x02, 0x04,			// 0012: ADD AL,[SI]
+	0x88, 0x05,			// 0014: MOV [DI],AL
+	0x46,				// 0016: INC SI
+	0x47,				// 0017: INC DI
+	0xE2, 0xF6,			// 0018: LOOP 0010
+	0x4A,				// 001A: DEC DX
+	0x75, 0xEA,			// 001B: JNZ 0007
+	0xEB, 0xFE			// 001D: JMP 001D
+};
+
+static void setup_i86_alu(uint8_t *mem)
+{
+	load_code(mem, 0x10000, g_i86_alu, sizeof(g_i86_alu));
+}
+
+static bool check_i86_alu(const uint8_t *mem)
+{
+	uint16_t bx = 0;
+	uint8_t dl = 0;
+
+	for (unsigned int si = 0; si < 16; si++)
+	{
+		// LOOP counts CX down from 0, so CX is 0, FFFF, FFFE ... 1 inside the loop
+		for (unsigned int cx = 0x10000; cx > 0; cx--)
+		{
+			dl = rotl8(dl ^ (uint8_t) cx);
+			bx = (uint16_t) (bx + dl);
+		}
+	}
+
+	return (mem[0x8000] == (bx & 0xFF)) && (mem[0x8001] == (bx >> 8)) && (mem[0x8002] == dl);
+}
+
+static void setup_i86_mem(uint8_t *mem)
+{
+	load_code(mem, 0x10000, g_i86_mem, sizeof(g_i86_mem));
+	fill_buffers(mem);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// COP421 ALU loop.  The COP only has 64 digits of internal RAM, so this one has no memory loop to go with it.
+// M(1,0-3) is a 16-bit counter that runs from 0005 until it wraps, and for each count
+//  M(3,0) ^= M(1,0) and M(2,0) += M(3,0).
+// The instruction count includes the JP's that AISC skips.  The core polls the L port and SI bit before
+//  every instruction, which lands in cop_port_read below and is counted like any other port read.
+static const uint8_t g_cop421_alu[] =
+{
+	0x1F,	// 000: LBI 1,0
+	0x75,	// 001: STII 5
+	0x70,	// 002: STII 0
+	0x70,	// 003: STII 0
+	0x70,	// 004: STII 0
+	0x2F,	// 005: LBI 2,0
+	0x70,	// 006: STII 0
+	0x3F,	// 007: LBI 3,0
+	0x70,	// 008: STII 0
+	0x1F,	// 009: LBI 1,0
+	0x25,	// 00A: LD 2		A = M(1,0), B = (3,0)
+	0x02,	// 00B: XOR
+	0x06,	// 00C: X 0
+	0x15,	// 00D: LD 1		A = M(3,0), B = (2,0)
+	0x31,	// 00E: ADD
+	0x06,	// 00F: X 0
+	0x1F,	// 010: LBI 1,0
+	0x05,	// 011: LD 0
+	0x51,	// 012: AISC 1
+	0xE2,	// 013: JP 022
+	0x04,	// 014: XIS 0
+	0x05,	// 015: LD 0
+	0x51,	// 016: AISC 1
+	0xE2,	// 017: JP 022
+	0x04,	// 018: XIS 0
+	0x05,	// 019: LD 0
+	0x51,	// 01A: AISC 1
+	0xE2,	// 01B: JP 022
+	0x04,	// 01C: XIS 0
+	0x05,	// 01D: LD 0
+	0x51,	// 01E: AISC 1
+	0xE2,	// 01F: JP 022
+	0x06,	// 020: X 0
+	0xE4,	// 021: JP 024
+	0x06,	// 022: X 0
+	0xC9,	// 023: JP 009
+	0xE4	// 024: JP 024
+};
+
+static void setup_cop421_alu(uint8_t *mem)
+{
+	load_code(mem, 0, g_cop421_alu, sizeof(g_cop421_alu));
+}
+
+// the COP's RAM is inside the core, so 'mem' isn't used
+static bool check_cop421_alu(const uint8_t *)
+{
+	uint8_t m20 = 0, m30 = 0;
+
+	for (unsigned int u = 0x0005; u < 0x10000; u++)
+	{
+		m30 ^= (u & 0xF);
+		m20 = (m20 + m30) & 0xF;
+	}
+
+	return (cop421_get_ram(0x10) == 0) && (cop421_get_ram(0x11) == 0) && (cop421_get_ram(0x12) == 0) &&
+		(cop421_get_ram(0x13) == 0) && (cop421_get_ram(0x20) == m20) && (cop421_get_ram(0x30) == m30);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+static const cpubench_program g_programs[] =
+{
+	{ "z80 alu", "z80", CPU_Z80, 4000000, setup_z80_alu, 0x0000, 0x0024, 10498102, check_z80_alu },
+	{ "z80 mem", "z80", CPU_Z80, 4000000, setup_z80_mem, 0x0000, 0x0015, 3277201, check_buffers },
+	{ "6809 alu", "6809", CPU_M6809, 1000000, setup_6809_alu, 0x1000, 0x101E, 7352325, check_6809_alu },
+	{ "6809 mem", "6809", CPU_M6809, 1000000, setup_6809_mem, 0x1000, 0x1017, 2048401, check_buffers },
+	{ "6502 alu", "6502", CPU_M6502, 1000000, setup_6502_alu, 0x0200, 0x022E, 13643831, check_6502_alu },
+	{ "6502 mem", "6502", CPU_M6502, 1000000, setup_6502_mem, 0x0200, 0x022C, 2466603, check_buffers },
+	{ "i86 alu", "i86", CPU_I88, 5000000, setup_i86_alu, 0x10000, 0x10026, 7340087, check_i86_alu },
+	{ "i86 mem", "i86", CPU_I88, 5000000, setup_i86_mem, 0x10000, 0x1001D, 2458103, check_buffers },
+	{ "cop421 alu", "cop421", CPU_COP421, 62500, setup_cop421_alu, 0x000, 0x024, 869384, check_cop421_alu },
+};
+
+static const unsigned int g_uProgramCount = sizeof(g_programs) / sizeof(g_programs[0]);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+cpubench::cpubench() :
+	m_uRepeat(3),
+	m_pThread(NULL),
+	m_u64MemCalls(0)
+{
+	m_shortgamename = "cpubench";
+	m_game_uses_video_overlay = false;
+	SDL_AtomicSet(&m_Stop, 0);
+}
+
+bool cpubench::init()
+{
+	bool bResult = false;
+
+	for (unsigned int u = 0; u < g_uProgramCount; u++)
+	{
+		if (m_strCore.empty() || (strcasecmp(m_strCore.c_str(), g_programs[u].core) == 0))
+		{
+			bResult = true;
+		}
+	}
+
+	// no cpu to initialize yet, each program adds its own
+	if (!bResult)
+	{
+		LOGF(LOGLEVEL_ERROR, "CPUBENCH : there is no core called '%s' (try z80, 6809, 6502, i86 or cop421)", m_strCore.c_str());
+	}
+
+	return bResult;
+}
+
+void cpubench::start()
+{
+	m_pThread = SDL_CreateThread(bench_thread, "CPU_BENCH", this);
+}
+
+void cpubench::shutdown()
+{
+	if (m_pThread)
+	{
+		SDL_AtomicSet(&m_Stop, 1);
+		SDL_WaitThread(m_pThread, NULL);
+		m_pThread = NULL;
+	}
+	cpu_shutdown();
+}
+
+bool cpubench::handle_cmdline_arg(const char *arg)
+{
+	bool bResult = false;
+	char s[81] = { 0 };
+
+	if (strcasecmp(arg, "-bench_core") == 0)
+	{
+		get_next_word(s, sizeof(s));
+		m_strCore = s;
+		bResult = (s[0] != 0);
+	}
+	else if (strcasecmp(arg, "-bench_repeat") == 0)
+	{
+		get_next_word(s, sizeof(s));
+		m_uRepeat = (unsigned int) atoi(s);
+		bResult = (m_uRepeat > 0);
+	}
+
+	return bResult;
+}
+
+uint8_t cpubench::cpu_mem_read(uint16_t addr)
+{
+	++m_u64MemCalls;
+	return m_cpumem[addr];
+}
+
+uint8_t cpubench::cpu_mem_read(uint32_t addr)
+{
+	++m_u64MemCalls;
+	return m_cpumem[addr];
+}
+
+void cpubench::cpu_mem_write(uint16_t addr, uint8_t value)
+{
+	++m_u64MemCalls;
+	m_cpumem[addr] = value;
+}
+
+void cpubench::cpu_mem_write(uint32_t addr, uint8_t value)
+{
+	++m_u64MemCalls;
+	m_cpumem[addr] = value;
+}
+
+uint8_t cpubench::port_read(uint16_t)
+{
+	++m_u64MemCalls;
+	return 0;
+}
+
+void cpubench::port_write(uint16_t, uint8_t)
+{
+	++m_u64MemCalls;
+}
+
+uint8_t cpubench::cop_port_read(uint8_t)
+{
+	++m_u64MemCalls;
+	return 0;
+}
+
+void cpubench::cop_port_write(uint8_t, uint8_t)
+{
+	++m_u64MemCalls;
+}
+
+int cpubench::bench_thread(void *pThis)
+{
+	threads_setup("cpu");	// this takes the place of the cpu thread
+	((cpubench *) pThis)->bench();
+	return 0;
+}
+
+void cpubench::bench()
+{
+	double dCallbackNs = measure_callback_ns();
+	unsigned int uRun = 0, uFailed = 0;
+
+	LOGF(LOGLEVEL_INFO, "CPUBENCH : a memory callback costs about %.2f ns, each program is run %u time(s)", dCallbackNs, m_uRepeat);
+
+	for (unsigned int u = 0; (u < g_uProgramCount) && !get_quitflag() && !SDL_AtomicGet(&m_Stop); u++)
+	{
+		const cpubench_program &prog = g_programs[u];
+		uint64_t u64BestNs = 0, u64Cycles = 0, u64MemCalls = 0;
+		bool bOK = true;
+
+		if (!m_strCore.empty() && (strcasecmp(m_strCore.c_str(), prog.core) != 0))
+		{
+			continue;
+		}
+
+		for (unsigned int uPass = 0; (uPass < m_uRepeat) && bOK; uPass++)
+		{
+			uint64_t u64Ns = 0;
+			bOK = run_program(prog, u64Ns, u64Cycles);
+			if ((uPass == 0) || (u64Ns < u64BestNs))
+			{
+				u64BestNs = u64Ns;
+			}
+			u64MemCalls = m_u64MemCalls;
+		}
+
+		++uRun;
+		if (!bOK)
+		{
+			++uFailed;
+			LOGF(LOGLEVEL_ERROR, "CPUBENCH : %s: FAILED (did not finish, or did not compute the right result)", prog.name);
+			continue;
+		}
+
+		// guard against a clock that didn't move
+		if (u64BestNs == 0)
+		{
+			u64BestNs = 1;
+		}
+
+		double dMHz = (u64Cycles * 1000.0) / u64BestNs;
+		LOGF(LOGLEVEL_INFO, "CPUBENCH : %s: %llu insns, %llu cycles in %.2f ms = %.1f emulated MHz (%.0fx real time), %.2f ns/insn",
+			prog.name, (unsigned long long) prog.u64Insns, (unsigned long long) u64Cycles, u64BestNs / 1000000.0,
+			dMHz, (dMHz * 1000000.0) / prog.hz, (double) u64BestNs / prog.u64Insns);
+		LOGF(LOGLEVEL_INFO, "CPUBENCH : %s: %.2f memory callbacks/insn, ~%.1f%% of the time spent in them, result OK",
+			prog.name, (double) u64MemCalls / prog.u64Insns, (u64MemCalls * dCallbackNs * 100.0) / u64BestNs);
+	}
+
+	LOGF(LOGLEVEL_INFO, "CPUBENCH : %u program(s) run, %u failed", uRun, uFailed);
+
+	// we were only here to run the benchmarks
+	set_quitflag();
+}
+
+bool cpubench::run_program(const cpubench_program &prog, uint64_t &u64Ns, uint64_t &u64Cycles)
+{
+	struct cpudef cpu;
+	struct cpudef *pCpu = NULL;
+	uint64_t u64StartNs = 0;
+	bool bFinished = false;
+
+	memset(m_cpumem, 0, sizeof(m_cpumem));
+	prog.setup(m_cpumem);
+
+	memset(&cpu, 0, sizeof(struct cpudef));
+	cpu.type = prog.type;
+	cpu.hz = prog.hz;
+	cpu.initial_pc = prog.uStartPC;
+	cpu.must_copy_context = false;
+	cpu.mem = m_cpumem;
+	add_cpu(&cpu);
+	cpu_init();
+
+	pCpu = get_cpu_struct(0);
+	m_u64MemCalls = 0;
+	u64Cycles = 0;
+	u64StartNs = telemetry_now_ns();
+
+	// Run until the program is sitting in its final loop.  The last slice may run the final loop a few
+	//  hundred times, which is nothing next to the millions of cycles that the program itself takes.
+	while (u64Cycles < CPUBENCH_MAX_CYCLES)
+	{
+		if (pCpu->getpc_callback() == prog.uDonePC)
+		{
+			bFinished = true;
+			break;
+		}
+		u64Cycles += pCpu->execute_callback(CPUBENCH_SLICE);
+	}
+
+	u64Ns = telemetry_now_ns() - u64StartNs;
+
+	bFinished = bFinished && prog.check(m_cpumem);
+	cpu_shutdown();
+
+	return bFinished;
+}
+
+double cpubench::measure_callback_ns()
+{
+	game *pGame = g_game;	// so the calls go through the vtable the way the cores' calls do
+	uint64_t u64StartNs = 0, u64DirectNs = 0, u64CallbackNs = 0;
+	volatile uint8_t u8Sink = 0;
+	unsigned int u = 0;
+
+	u64StartNs = telemetry_now_ns();
+	for (u = 0; u < CPUBENCH_CALIBRATE_CALLS; u++)
+	{
+		u8Sink += m_cpumem[u & 0xFFFF];
+	}
+	u64DirectNs = telemetry_now_ns() - u64StartNs;
+
+	u64StartNs = telemetry_now_ns();
+	for (u = 0; u < CPUBENCH_CALIBRATE_CALLS; u++)
+	{
+		u8Sink += pGame->cpu_mem_read((uint16_t) u);
+	}
+	u64CallbackNs = telemetry_now_ns() - u64StartNs;
+
+	// only the cost of the call itself, not of reading the byte
+	return (u64CallbackNs > u64DirectNs) ? ((double) (u64CallbackNs - u64DirectNs) / CPUBENCH_CALIBRATE_CALLS) : 0.0;
+}
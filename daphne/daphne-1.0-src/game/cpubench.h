@@ -0,0 +1,86 @@
+/*
+ * cpubench.h
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// cpubench.h -- measures how fast each of daphne's cpu cores runs, without a game attached to them
+
+#ifndef CPUBENCH_H
+#define CPUBENCH_H
+
+#include <string>
+#include <SDL.h>
+#include "game.h"
+
+using namespace std;
+
+// one hand-assembled program that a core runs from reset until it reaches 'uDonePC'
+struct cpubench_program
+{
+	const char *name;	// what we call it in the report
+	const char *core;	// which core it runs on (for -bench_core)
+	int type;	// CPU_Z80, CPU_M6809, etc
+	uint32_t hz;	// what the cpu is typically clocked at in the games we emulate
+	void (*setup)(uint8_t *mem);	// loads the program (and any vectors and data that it needs) into memory
+	uint32_t uStartPC;	// where the program starts (the 6809 and 6502 start from their reset vectors instead)
+	uint32_t uDonePC;	// the program sits in a loop here when it's finished
+	uint64_t u64Insns;	// how many instructions the program executes before it gets to uDonePC
+	bool (*check)(const uint8_t *mem);	// compares the final state against what the program should have computed
+};
+
+class cpubench : public game
+{
+public:
+	cpubench();
+	bool init();
+	void start();
+	void shutdown();
+	bool handle_cmdline_arg(const char *arg);
+
+	// flat RAM that counts how many times the cores call it
+	uint8_t cpu_mem_read(uint16_t addr);
+	uint8_t cpu_mem_read(uint32_t addr);
+	void cpu_mem_write(uint16_t addr, uint8_t value);
+	void cpu_mem_write(uint32_t addr, uint8_t value);
+	uint8_t port_read(uint16_t port);
+	void port_write(uint16_t port, uint8_t value);
+	uint8_t cop_port_read(uint8_t port);
+	void cop_port_write(uint8_t port, uint8_t value);
+
+private:
+	static int bench_thread(void *pThis);
+
+	// runs every program that was selected, returns when finished or when we're told to quit
+	void bench();
+
+	// runs 'prog' once, returns false if it didn't finish or didn't compute what it should have
+	bool run_program(const cpubench_program &prog, uint64_t &u64Ns, uint64_t &u64Cycles);
+
+	// measures how long one call through g_game->cpu_mem_read takes, in ns
+	double measure_callback_ns();
+
+	string m_strCore;	// if not empty, only programs for this core are run
+	unsigned int m_uRepeat;	// how many times each program is run (the fastest run is reported)
+	SDL_Thread *m_pThread;
+	SDL_atomic_t m_Stop;	// set to 1 to make the bench thread quit early
+	uint64_t m_u64MemCalls;	// how many memory/port callbacks the core has made during the current run
+};
+
+#endif // CPUBENCH_H
@@ -40,11 +40,13 @@
 #include <zlib.h>	// for CRC checking
 #include <string>	// STL strings, useful to prevent buffer overrun
 #include <string.h>
+#include <vector>
+#include <map>
 #include "../daphne.h"	// for get_quitflag()
 #include "../io/homedir.h"
 #include "../io/conout.h"
 #include "../io/error.h"
-#include "../io/unzip.h"
+#include "../io/romzip.h"
 #include "../io/mpo_fileio.h"
 #include "../io/mpo_mem.h"	// for better malloc
 #include "../io/numstr.h"
@@ -56,6 +58,7 @@
 #include "../io/logger_console.h"	// for writing to daphne_log.txt file
 #include "../video/video.h"	// for get_screen
 #include "../video/palette.h"
+#include "../video/present.h"
 #include "game.h"
 
 #include "../main_android.h"
@@ -102,7 +105,6 @@ game::game() :
 	m_game_uses_video_overlay(true),	// since most games do use video overlay, we'll default this to true
 	m_overlay_size_is_dynamic(false),	// the overlay size is usually static
 	m_video_overlay_scaled(0),  // " " "
-	m_video_overlay_matrix(0),  //
 	m_video_screen_width(0),	// 
 	m_video_screen_height(0),	// 
 	m_video_screen_size(0),	    // 
@@ -120,6 +122,7 @@ game::game() :
 	m_bMouseEnabled(false)	// mouse is disabled for most games
 {
 	memset(m_video_overlay, 0, sizeof(m_video_overlay));	// clear this structure so we can easily detect whether we are using video overlay or not
+	SDL_AtomicSet(&m_video_overlay_generation, 0);
 	m_uDiscFPKS = 0;
 	m_disc_fps = 0.0;
 //	m_disc_ms_per_frame = 0.0;
@@ -302,6 +305,18 @@ void game::port_write(uint16_t port, uint8_t value)
 
 }
 
+// reads one of the COP421's ports
+// (the COP polls its inputs before every instruction, so unlike port_read this doesn't complain)
+uint8_t game::cop_port_read(uint8_t)
+{
+	return 0;
+}
+
+// writes one of the COP421's ports
+void game::cop_port_write(uint8_t, uint8_t)
+{
+}
+
 // notifies us of the new Program Counter (which most games usually don't care about)
 void game::update_pc(uint32_t new_pc)
 {
@@ -374,12 +389,6 @@ bool game::video_init()
 	int index = 0;
 	int w;
 	int h;
-	int x;
-	int y;
-	float dx;
-	float dy;
-	float srcx;
-	float srcy;
 
     // set instance variables and local variables to the actual screen (or window) dimension
 
@@ -396,37 +405,17 @@ bool game::video_init()
 
             if (m_bFullScale)
 			{
+                // the frontend can't show anything bigger than this
+                if (w > PRESENT_MAX_W) w = PRESENT_MAX_W;
+                if (h > PRESENT_MAX_H) h = PRESENT_MAX_H;
+
                 m_video_overlay_scaled = 
                     SDL_CreateRGBSurface(SDL_SWSURFACE, 
                                         w, 
                                         h, 8, 0, 0, 0, 0); // create an 8-bit surface
 
-                // create matrix for scaling the overlay pixmap to the physical surface
-                // - size of overlay pixmap m_video_overlay_width x m_video_overlay_height
-                // - size of physical surface is get_screen()->w x get_screen()->h
-                // - matrix is created as 2dimensional array of "long" values, with size of 
-                //   the physical surface
-                // each entry in the matrix holds an offset into the overlay pixmap array from
-                // which the pixel is copied into to the corresponding surface pixmap
-                if ( (m_video_overlay_matrix = (long*) MPO_MALLOC(sizeof(long)*w*h)) == NULL) {
-                        printline("MEM ERROR : malloc failed in video_init!");
-                        return false;
-                } /*endif*/
-
-                dx=(float)m_video_overlay_width/(float)w;	// 256/640=0.4
-                dy=(float)m_video_overlay_height/(float)h;	// 256/480=0.5333
-
-                srcx=0;
-                srcy=0;
-
-                for (y=0; y<h; y++) {
-                    srcx=0;
-                    for (x=0; x<w; x++) {
-                        m_video_overlay_matrix[x+(y*w)]=(long)srcx+((long)srcy*m_video_overlay_width);
-                        srcx+=dx;
-                    } /*endfor*/
-                    srcy+=dy;
-                } /*endfor*/
+                // work out which part of the overlay each pixel of the screen comes from
+                m_video_overlay_scaler.init(m_video_overlay_width, m_video_overlay_height, w, h);
             } // end if fullscale is enabled
 
 			// create each buffer
@@ -497,27 +486,8 @@ void game::video_shutdown()
 		m_video_overlay_scaled = NULL;
 	}
 
-	MPO_FREE(m_video_overlay_matrix);
-
 }
 
-// Note: The way it is implemented works only for UPscaling the game-graphics.
-//       If game graphic needs to be DOWNscaled, multiple pixels would have to be
-//       combined into one pixel of the resulting surface.
-void Scale(SDL_Surface* src, SDL_Surface* dst, long* matrix)
-{
-	long i;
-	long m=dst->w*dst->h;
-
-	uint8_t* srcpixmap=(uint8_t*)src->pixels;
-	uint8_t* dstpixmap=(uint8_t*)dst->pixels;
-
-	for (i=0; i<m; i++) {			
-		dstpixmap[i] = srcpixmap[matrix[i]];
-	} /*endfor*/
-}
-// end-add
-
 // generic function to ensure that the video buffer gets drawn to the screen, will call video_repaint()
 void game::video_blit()
 {
@@ -535,34 +505,27 @@ void game::video_blit()
 		video_repaint();	// call game-specific function to get palette refreshed
 		m_video_overlay_needs_update = false;	// game will need to set this value to true next time it becomes needful for us to redraw the screen
 
-		// if we are in non-VLDP mode, then we can blit to the main surface right here,
+		// if we are in non-VLDP mode, then we can hand the overlay to the frontend right here,
 		// otherwise we do nothing because the yuv_callback in ldp-vldp.cpp will take care of it
 		if (!g_ldp->is_vldp())
 		{
 				// If we're not scaling the video
 				if (!m_bFullScale)
 				{
-					// RJS STOPPED HERE
-					vid_blit(m_video_overlay[m_active_video_overlay], 0, 0);
+					present_overlay(m_video_overlay[m_active_video_overlay]);
 				}
 				else
 				{
 					// scale game graphics to the screen dimensions
-					// RJS START - REMOVE - hand scaling should no longer be needed, doc'd for now
-					// to see results, see SDL_RenderSetScale, SDL_RenderSetLogicalSize
-					/*
-					 Scale(m_video_overlay[m_active_video_overlay], 
-						m_video_overlay_scaled, 
-						m_video_overlay_matrix);
-					vid_blit(m_video_overlay_scaled, 0, 0);
-					*/
-					printline("Scaled functionality docd out here!");
-					// RJS END
+					m_video_overlay_scaler.scale(m_video_overlay[m_active_video_overlay], m_video_overlay_scaled);
+					present_overlay(m_video_overlay_scaled);
 				} /*endelse*/
-			vid_flip();
 		} // end if this isn't VLDP
 
 		m_finished_video_overlay = m_active_video_overlay;
+
+		// let ldp-vldp know that it has to re-composite this overlay onto the mpeg frame
+		SDL_AtomicIncRef(&m_video_overlay_generation);
 	}
 }
 
@@ -687,6 +650,50 @@ void game::disable_crc()
 	m_crc_disabled = true;
 }
 
+// how many threads (including the main one) inflate ROMs at once
+#define ROM_LOAD_THREADS 4
+
+// where the CRC's of previously loaded ROMs are remembered (inside the ram directory)
+#define ROM_CRC_CACHE_FILE "romcrc.txt"
+
+// one ROM to be extracted from an archive by rom_load_thread
+struct rom_load_job
+{
+	const rom_archive *archive;
+	const rom_archive_entry *entry;
+	uint8_t *buf;
+	uint32_t size;
+	bool need_crc;	// whether the CRC has to be calculated (it may be known already)
+	uint32_t bytes_read;	// filled in by rom_load_thread
+	uint32_t crc;	// " " (if need_crc is true, otherwise filled in beforehand)
+};
+
+struct rom_load_queue
+{
+	vector<rom_load_job> *pJobs;
+	SDL_atomic_t next;	// index of the next job to be taken
+};
+
+// extracts (and checksums) ROMs until there are none left to do
+static int rom_load_thread(void *data)
+{
+	rom_load_queue *queue = (rom_load_queue *) data;
+	int i = 0;
+
+	while ((i = SDL_AtomicAdd(&queue->next, 1)) < (int) queue->pJobs->size())
+	{
+		rom_load_job &job = (*queue->pJobs)[i];
+
+		job.bytes_read = job.archive->extract(job.entry, job.buf, job.size);
+		if (job.need_crc && (job.bytes_read == job.size))
+		{
+			job.crc = crc32(crc32(0L, Z_NULL, 0), job.buf, job.size);
+		}
+	}
+
+	return 0;
+}
+
 // routine to load roms
 // returns true if there were no errors
 bool game::load_roms()
@@ -697,68 +704,150 @@ bool game::load_roms()
 	if (m_rom_list)
 	{
 		int index = 0;
-		const struct rom_def *rom = &m_rom_list[0];
-		string opened_zip_name = "";	// the name of the zip file that we currently have open (if we have one open)
-		unzFile zip_file = NULL;	// pointer to open zip file (NULL if file is closed)
+		const struct rom_def *rom = NULL;
+		map<string, rom_archive *> mArchives;	// every archive we've tried to open (NULL if it couldn't be opened), so each is only read once
+		vector<rom_load_job> jobs;
+		vector<int> job_index;	// which job (if any) is loading each rom
+		rom_crc_cache crc_cache;
 
-		// go until we get an error or we run out of roms to load
-		do
+		crc_cache.load(g_homedir.get_ramfile(ROM_CRC_CACHE_FILE));
+
+		// first, find out which roms can be extracted from archives ...
+		for (rom = &m_rom_list[0]; rom->filename; rom++)
 		{
-			string path, zip_path = "";
-			unsigned int crc = crc32(0L, Z_NULL, 0);
+			// if this game explicitely specifies a subdirectory, otherwise use shortgamename by default
+			string zip_path = rom->dir ? rom->dir : m_shortgamename;
+			zip_path = g_homedir.get_romfile(zip_path + ".zip"); //Use homedir to locate the compressed rom
 
-			// if this game explicitely specifies a subdirectory
-			if (rom->dir)
+			map<string, rom_archive *>::iterator mi = mArchives.find(zip_path);
+			if (mi == mArchives.end())
 			{
-				path = rom->dir;
-				zip_path = path + ".zip"; // append zip extension ...
+				rom_archive *archive = new rom_archive();
+				if (!archive->open(zip_path.c_str()))
+				{
+					delete archive;
+					archive = NULL;
+				}
+				mi = mArchives.insert(make_pair(zip_path, archive)).first;
 			}
 
-			// otherwise use shortgamename by default
+			const rom_archive_entry *entry = mi->second ? mi->second->find(rom->filename) : NULL;
+			if (entry)
+			{
+				rom_load_job job;
+				job.archive = mi->second;
+				job.entry = entry;
+				job.buf = rom->buf;
+				job.size = rom->size;
+				job.bytes_read = 0;
+				job.crc = 0;
+
+				// we only need a CRC if we're going to check it and we don't remember it from last time
+				job.need_crc = (!m_crc_disabled) && (rom->crc32 != 0) &&
+					!crc_cache.lookup(zip_path + "/" + entry->name, mi->second->get_file_size(),
+						mi->second->get_time_last_modified(), rom->size, job.crc);
+
+				job_index.push_back((int) jobs.size());
+				jobs.push_back(job);
+			}
 			else
 			{
-				path = m_shortgamename;
-				zip_path = path + ".zip"; // append zip extension ...
+				job_index.push_back(-1);
 			}
-			
-			//Use homedir to locate the compressed rom
-			zip_path = g_homedir.get_romfile(zip_path);
+		}
+
+		// ... then inflate them all at once ...
+		if (!jobs.empty())
+		{
+			SDL_Thread *threads[ROM_LOAD_THREADS - 1] = { NULL };
+			rom_load_queue queue;
+			queue.pJobs = &jobs;
+			SDL_AtomicSet(&queue.next, 0);
 
-			// if we have not opened a ZIP file, or if we need to open a new zip file ...
-			if ((!zip_file) || (zip_path.compare(opened_zip_name) != 0))
+			for (unsigned int i = 0; (i < ROM_LOAD_THREADS - 1) && (i + 1 < jobs.size()); i++)
 			{
-				// if we need to open a zip file ...
-				if (!zip_file)
+				threads[i] = SDL_CreateThread(rom_load_thread, "ROM_LOAD", &queue);
+			}
+			rom_load_thread(&queue);	// the main thread helps out
+			for (unsigned int i = 0; i < ROM_LOAD_THREADS - 1; i++)
+			{
+				if (threads[i])
 				{
-					zip_file = unzOpen(zip_path.c_str());
+					SDL_WaitThread(threads[i], NULL);
 				}
+			}
+		}
 
-				// we need to open a different zip file ...
-				else
-				{
-//					string s = "Closing " + opened_zip_name + " and attempting to open " + zip_path;	// just for debugging to make sure this is behaving properly
-					unzClose(zip_file);
-					zip_file = unzOpen(zip_path.c_str());
-				}
+		// ... and finally go through the list in order, reporting on each rom and loading the ones that weren't in an archive
+		index = 0;
+		rom = &m_rom_list[0];
 
-				// if we successfully opened the file ...
-				if (zip_file)
-				{
-					opened_zip_name = zip_path;
-				}
-			}
+		// go until we get an error or we run out of roms to load
+		do
+		{
+			string path = rom->dir ? rom->dir : m_shortgamename;
+			string zip_path = g_homedir.get_romfile(path + ".zip");
+			rom_archive *archive = mArchives[zip_path];
+			unsigned int crc = crc32(0L, Z_NULL, 0);
+			bool crc_known = false;
 
 			result = false;
-			// if we have a zip file open, try to load the ROM from this file first ...
-			if (zip_file)
+
+			// if we have the zip file, the ROM should've come from it ...
+			if (archive)
 			{
-				result = load_compressed_rom(rom->filename, zip_file, rom->buf, rom->size);
+				outstr("Loading compressed ROM image ");
+				outstr(rom->filename);
+				outstr("...");
+
+				if (job_index[index] < 0)
+				{
+					printline("file not found in .ZIP archive!");
+				}
+				else
+				{
+					const rom_load_job &job = jobs[job_index[index]];
+
+					// if we read what we expected to read ...
+					if (job.bytes_read == rom->size)
+					{
+						char s[81];
+						sprintf(s, "%d bytes read.", job.bytes_read);
+						printline(s);
+						result = true;
+
+						if (job.need_crc)
+						{
+							crc_cache.store(zip_path + "/" + job.entry->name, archive->get_file_size(),
+								archive->get_time_last_modified(), rom->size, job.crc);
+						}
+						crc = job.crc;
+						crc_known = true;
+					}
+					else
+					{
+						printline("unexpected read result!");
+					}
+				}
 			}
 
 			// if we were unable to open the rom from a zip file, try to open it as an uncompressed file
 			if (!result)
 			{
-				result = load_rom(rom->filename, path.c_str(), rom->buf, rom->size);
+				uint64_t file_size = 0, time_last_modified = 0;
+				string rom_path = g_homedir.get_romfile(path + "/" + rom->filename);
+
+				result = load_rom(rom->filename, path.c_str(), rom->buf, rom->size, &file_size, &time_last_modified);
+				if (result && (!m_crc_disabled) && (rom->crc32 != 0))
+				{
+					crc_known = crc_cache.lookup(rom_path, file_size, time_last_modified, rom->size, crc);
+					if (!crc_known)
+					{
+						crc = crc32(crc, rom->buf, rom->size);
+						crc_cache.store(rom_path, file_size, time_last_modified, rom->size, crc);
+						crc_known = true;
+					}
+				}
 			}
 
 			// if file was loaded and was proper length, check CRC
@@ -766,7 +855,10 @@ bool game::load_roms()
 			{
 				if (!m_crc_disabled)  //skip if user doesn't care
 				{
-					crc = crc32(crc, rom->buf, rom->size);
+					if (!crc_known)
+					{
+						crc = crc32(crc, rom->buf, rom->size);
+					}
 					if (rom->crc32 == 0)  //skip if crc is set to 0 (game driver doesn't care)
 					{
 						crc=0;  
@@ -811,14 +903,16 @@ bool game::load_roms()
 			rom = &m_rom_list[index];	// move to next entry
 		} while (result && rom->filename);
 
-		// if we had a zip file open, close it now
-		if (zip_file)
+		// we're done with the archives now
+		for (map<string, rom_archive *>::iterator mi = mArchives.begin(); mi != mArchives.end(); mi++)
 		{
-			unzClose(zip_file);
-			zip_file = NULL;
+			delete mi->second;
 		}
+
+		crc_cache.save();
 		
 		patch_roms();
+		decode_gfx_roms();
 	}
 
 	return(result);
@@ -843,27 +937,35 @@ bool game::verify_required_file(const char *filename, const char *gamedir, uint3
 	// if file is opened successfully
 	if (io)
 	{
+		rom_crc_cache crc_cache;
+		unsigned int crc = 0;
 
-		readme_test = new uint8_t[io->size];	// allocate file buffer
+		crc_cache.load(g_homedir.get_ramfile(ROM_CRC_CACHE_FILE));
 
-		if (readme_test)
+		// if we've seen this exact file before, we already know its CRC
+		if (!crc_cache.lookup(uncompressed_path, io->size, io->time_last_modified, (uint32_t) io->size, crc))
 		{
-			unsigned int crc = crc32(0L, Z_NULL, 0);	// zlib crc32
+			MPO_BYTES_READ bytes_read = 0;
+			readme_test = new uint8_t[io->size];	// allocate file buffer
 
-			// if we are able to read in
-			mpo_read(readme_test, io->size, NULL, io);
-
-			crc = crc32(crc, readme_test, io->size);
-			
-			// if the required file has been unaltered, allow user to continue
-			if (crc == filecrc32)
+			// if we are able to read in (a short read must not end up in the cache, or the file would keep failing)
+			if (mpo_read(readme_test, io->size, &bytes_read, io) && (bytes_read == io->size))
 			{
-				passed_test = true;
+				crc = crc32(0L, Z_NULL, 0);	// zlib crc32
+				crc = crc32(crc, readme_test, io->size);
+				crc_cache.store(uncompressed_path, io->size, io->time_last_modified, (uint32_t) io->size, crc);
+				crc_cache.save();
 			}
 
 			delete [] readme_test;	// free allocated mem
 			readme_test = NULL;
 		}
+			
+		// if the required file has been unaltered, allow user to continue
+		if (crc == filecrc32)
+		{
+			passed_test = true;
+		}
 
 		mpo_close(io);
 	}
@@ -875,30 +977,15 @@ bool game::verify_required_file(const char *filename, const char *gamedir, uint3
 		zip_path += ".zip";  // we now have "/gamename.zip"
 		zip_path = g_homedir.get_romfile(zip_path);
 
-		unzFile zip_file = NULL;	// pointer to open zip file (NULL if file is closed)
-		zip_file = unzOpen(zip_path.c_str());
-		if (zip_file)
+		rom_archive archive;
+		if (archive.open(zip_path.c_str()))
 		{
-			if (unzLocateFile(zip_file, filename, 2) == UNZ_OK)
+			// the archive records the CRC of each file, so there's nothing to extract
+			const rom_archive_entry *entry = archive.find(filename);
+			if (entry && (entry->crc32 == filecrc32))
 			{
-				unz_file_info info;
-
-				// get CRC
-				unzGetCurrentFileInfo OF((zip_file,
-					     &info,
-					     NULL,
-					     0,
-					     NULL,
-					     0,
-					     NULL,
-					     0));
-
-				if (info.crc == filecrc32)
-				{
-					passed_test = true;
-				}
+				passed_test = true;
 			}
-			unzClose(zip_file);
 		}
 	}
 
@@ -907,7 +994,7 @@ bool game::verify_required_file(const char *filename, const char *gamedir, uint3
 
 // loads size # of bytes from filename into buf
 // returns true if successful, or false if there was an error
-bool game::load_rom(const char *filename, uint8_t *buf, uint32_t size)
+bool game::load_rom(const char *filename, uint8_t *buf, uint32_t size, uint64_t *pFileSize, uint64_t *pTimeLastModified)
 {
 	struct mpo_io *F;
 	MPO_BYTES_READ bytes_read = 0;
@@ -930,6 +1017,8 @@ bool game::load_rom(const char *filename, uint8_t *buf, uint32_t size)
 		if (bytes_read == size)
 		{
 			result = true;
+			if (pFileSize) *pFileSize = F->size;
+			if (pTimeLastModified) *pTimeLastModified = F->time_last_modified;
 		}
 		// notify the user what the problem is
 		else
@@ -948,69 +1037,26 @@ bool game::load_rom(const char *filename, uint8_t *buf, uint32_t size)
 }
 
 // transition function ...
-bool game::load_rom(const char *filename, const char *directory, uint8_t *buf, uint32_t size)
+bool game::load_rom(const char *filename, const char *directory, uint8_t *buf, uint32_t size, uint64_t *pFileSize, uint64_t *pTimeLastModified)
 {
 	string full_path = directory;
 	full_path += "/";
 	full_path += filename;
-	return load_rom(full_path.c_str(), buf, size);
+	return load_rom(full_path.c_str(), buf, size, pFileSize, pTimeLastModified);
 }
 
-// similar to load_rom except this function loads a rom image from a .zip file
-// the previously-opened zip file is indicated by 'opened_zip_file'
-// true is returned only if the rom was loaded, and it was the expected length
-bool game::load_compressed_rom(const char *filename, unzFile opened_zip_file, uint8_t *buf, uint32_t size)
-{
-	bool result = false;
-
-	outstr("Loading compressed ROM image ");
-	outstr(filename);
-	outstr("...");
-
-	// try to locate requested rom file inside .ZIP archive and proceed if successful
-	// (the '2' indicates case-insensitivity)
-	if (unzLocateFile(opened_zip_file, filename, 2) == UNZ_OK)
-	{
-		// try to open the current file that we've located
-		if (unzOpenCurrentFile(opened_zip_file) == UNZ_OK)
-		{
-			// read this file
-			uint32_t bytes_read = (uint32_t) unzReadCurrentFile(opened_zip_file, buf, size);
-			unzCloseCurrentFile(opened_zip_file);
-
-			// if we read what we expected to read ...
-			if (bytes_read == size)
-			{
-				char s[81];
-				sprintf(s, "%d bytes read.", bytes_read);
-				printline(s);
-				result = true;
-			}
-			else
-			{
-				printline("unexpected read result!");
-			}
-		}
-		else
-		{
-			printline("could not open current file!");
-		}
-	}
-	else
-	{
-		printline("file not found in .ZIP archive!");
-	}
-
-	return result;
-}
-
-
 // modify roms (apply cheats, for example) after they are loaded
 // this can also be used for any post-rom-loading procedure, such as verifying the existence of readme files for DLE/SAE
 void game::patch_roms()
 {
 }
 
+// convert graphics roms (that have been loaded and patched) into something that can be drawn quickly,
+//  such as a gfx_tileset
+void game::decode_gfx_roms()
+{
+}
+
 // how many pixels down to shift video overlay
 int game::get_video_row_offset()
 {
@@ -1054,6 +1100,24 @@ SDL_Surface *game::get_finished_video_overlay()
 	return overlay;
 }
 
+// used by ldp-vldp.cpp to tell whether the overlay has changed since it last composited it
+unsigned int game::get_video_overlay_generation()
+{
+	return (unsigned int) SDL_AtomicGet(&m_video_overlay_generation);
+}
+
+void game::video_overlay_palette_changed()
+{
+	SDL_AtomicIncRef(&m_video_overlay_generation);
+
+	// without VLDP, the overlay is converted to RGB through a lookup table that has to be rebuilt (and the frame presented again)
+	present_palette_changed();
+	if (g_ldp && !g_ldp->is_vldp())
+	{
+		m_video_overlay_needs_update = true;
+	}
+}
+
 // mainly used by ldp-vldp.cpp so it doesn't print a huge warning message if the overlay's size is dynamic
 bool game::is_overlay_size_dynamic()
 {
@@ -1161,6 +1225,11 @@ const char *game::get_shortgamename()
 	return m_shortgamename;
 }
 
+const struct rom_def *game::get_rom_list()
+{
+	return m_rom_list;
+}
+
 #ifdef CPU_DEBUG
 // returns either a name for the address or else NULL if no name exists
 // Used for debugging to improve readability (to assign function and variable names)
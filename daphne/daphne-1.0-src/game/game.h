@@ -57,8 +57,7 @@ enum
 #include "../cpu/cpu.h"	// for CPU_MEM_SIZE
 #include "../io/input.h"	// for SWITCH definitions, most/all games need them
 #include "../io/logger.h"
-
-typedef void * unzFile;	// because including the unzip header file gives some compiler error
+#include "../video/scale.h"
 
 // structure for the cpu debugger... a memory address and its corresponding name
 // This is so when debugging, you can have function names instead of numbers (it is easier to read)
@@ -104,6 +103,8 @@ public:
 	virtual void cpu_mem_write(uint32_t addr, uint8_t value);	// 32-bit addressing memory write routine
 	virtual uint8_t port_read(uint16_t port);		// read from port
 	virtual void port_write(uint16_t port, uint8_t value);		// write to a port
+	virtual uint8_t cop_port_read(uint8_t port);	// read from one of the COP421's ports (COP_PORT_x, see copintf.h)
+	virtual void cop_port_write(uint8_t port, uint8_t value);	// write to one of the COP421's ports
 	virtual void update_pc(uint32_t new_pc);		// update the PC
 	virtual void input_enable(uint8_t);
 	virtual void input_disable(uint8_t);
@@ -163,12 +164,15 @@ public:
 	virtual bool load_roms();	// load roms into memory
 	bool verify_required_file(const char *filename, const char *gamedir, uint32_t filecrc32);	// verifies existence of a required file (such as a readme.txt for DLE)
 	virtual void patch_roms();	// do any modifications (cheats, etc) to roms after they're loaded
+	virtual void decode_gfx_roms();	// convert graphics roms into a faster form for drawing (see gfxdecode.h), called after patch_roms
 	int get_video_row_offset();
 	int get_video_col_offset();
 	unsigned get_video_visible_lines();	// returns m_uVideoOverlayVisibleLines
 	SDL_Surface *get_video_overlay(int index);	// returns pointer to video overlay specified, or NULL if index is out of range
 	SDL_Surface *get_active_video_overlay();	// returns the current active video overlay (that is currently being drawn)
 	SDL_Surface *get_finished_video_overlay();	// returns the last complete video overlay (that isn't currently being drawn)
+	unsigned int get_video_overlay_generation();	// returns a number that changes whenever the finished video overlay (or its palette) changes
+	void video_overlay_palette_changed();	// called when the overlay's colors change even though its pixels didn't
 	bool is_overlay_size_dynamic();	// returns m_overlay_size_is_dynamic
 	SDL_Surface *get_scaled_video_overlay();	// returns pointer to the video overlay which is used for scaling
 	bool IsFullScaleEnabled();	// returns m_bFullScale
@@ -186,6 +190,7 @@ public:
 	bool get_game_paused();
 	void toggle_game_pause();	// toggles whether the game is paused or not
 	const char *get_shortgamename();	// returns short game name
+	const struct rom_def *get_rom_list();	// returns the roms this game loads (NULL if it doesn't have any)
 #ifdef CPU_DEBUG
 	const char *get_address_name(unsigned int addr);	// get a potential name for a memory address (very useful for debugging)
 #endif
@@ -228,7 +233,7 @@ protected:
 
 	// fullscale variables
 	SDL_Surface *m_video_overlay_scaled; // temporary graphic buffer which receives the scaled game graphics from m_video_overlay[...]
-	long* m_video_overlay_matrix;       // the precalculated matrix used for scaling the game graphics to the target screen dimension
+	scaler m_video_overlay_scaler;       // scales the game graphics to the target screen dimension
 	uint32_t m_video_screen_width;	    // the width  of the target screen (according to the graphic mode set by Daphne)
 	uint32_t m_video_screen_height;	    // the height of the target screen (according to the graphic mode set by Daphne)
 	uint32_t m_video_screen_size;	        // m_video_screen_width x m_video_screen_height, just to speedup things a bit
@@ -238,6 +243,7 @@ protected:
 	int m_video_overlay_count;	// how many video overlay buffers we have
 	int m_active_video_overlay;	// index of the active SDL_Surface that serves as our video overlay (the one we make changes to)
 	int m_finished_video_overlay;	// index of the last SDL_Surface to be completely drawn (ie finished)
+	SDL_atomic_t m_video_overlay_generation;	// bumped every time m_finished_video_overlay is redrawn (read by the VLDP thread)
 	int m_palette_color_count;	// the # of colors to be allocated for the color palette, not to exceed 256 (surfaces are only 8-bit)
 	
 	// How many rows down to shift video (can be negative if you want to shift up)
@@ -270,9 +276,9 @@ protected:
 #endif
 
 private:
-	bool load_rom(const char *filename, uint8_t *buf, uint32_t size);
-	bool load_rom(const char *filename, const char *directory, uint8_t *bif, uint32_t size);
-	bool load_compressed_rom(const char *filename, unzFile opened_zip_file, uint8_t *buf, uint32_t size);
+	// loads a rom that isn't in a .ZIP file, optionally returning the size and modification time of the file it came from
+	bool load_rom(const char *filename, uint8_t *buf, uint32_t size, uint64_t *pFileSize = NULL, uint64_t *pTimeLastModified = NULL);
+	bool load_rom(const char *filename, const char *directory, uint8_t *bif, uint32_t size, uint64_t *pFileSize = NULL, uint64_t *pTimeLastModified = NULL);
 
 };
 
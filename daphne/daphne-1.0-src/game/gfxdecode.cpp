@@ -0,0 +1,157 @@
+/*
+ * gfxdecode.cpp
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// gfxdecode.cpp
+// Graphics ROM decoding and tile drawing shared by the game drivers
+
+#include "gfxdecode.h"
+
+// every pixel of the tile is 0, so there is nothing to draw
+#define GFX_TILE_EMPTY	(1 << 0)
+
+// no pixel of the tile is 0, so it can be drawn without checking for transparency
+#define GFX_TILE_OPAQUE	(1 << 1)
+
+gfx_tileset::gfx_tileset() :
+	m_uWidth(0),
+	m_uHeight(0),
+	m_uCount(0),
+	m_uTileSize(0)
+{
+}
+
+void gfx_tileset::decode(const uint8_t *pROM, unsigned int uROMSize, const gfx_layout &layout, unsigned int uCount)
+{
+	m_uWidth = layout.uWidth;
+	m_uHeight = layout.uHeight;
+	m_uCount = uCount;
+	m_uTileSize = m_uWidth * m_uHeight;
+	m_vPixels.assign(m_uTileSize * m_uCount, 0);
+	m_vPixelsXFlip.clear();
+	m_vFlags.assign(m_uCount, 0);
+
+	uint8_t *pDst = m_vPixels.empty() ? NULL : &m_vPixels[0];
+	uint64_t u64ROMBits = (uint64_t) uROMSize << 3;
+
+	for (unsigned int uTile = 0; uTile < m_uCount; uTile++)
+	{
+		bool bEmpty = true, bOpaque = true;
+
+		for (unsigned int y = 0; y < m_uHeight; y++)
+		{
+			for (unsigned int x = 0; x < m_uWidth; x++)
+			{
+				uint8_t u8Pixel = 0;
+
+				for (unsigned int p = 0; p < layout.uPlanes; p++)
+				{
+					uint64_t u64Bit = ((uint64_t) uTile * layout.uTileIncrement) +
+						layout.uPlaneOffset[p] + layout.uYOffset[y] + layout.uXOffset[x];
+					u8Pixel <<= 1;
+
+					if (u64Bit < u64ROMBits)
+					{
+						u8Pixel |= (pROM[u64Bit >> 3] >> (u64Bit & 7)) & 1;
+					}
+				}
+
+				if (u8Pixel) bEmpty = false;
+				else bOpaque = false;
+
+				*pDst++ = u8Pixel;
+			}
+		}
+
+		if (bEmpty) m_vFlags[uTile] |= GFX_TILE_EMPTY;
+		if (bOpaque) m_vFlags[uTile] |= GFX_TILE_OPAQUE;
+	}
+}
+
+const uint8_t *gfx_tileset::get_xflipped()
+{
+	if (m_vPixelsXFlip.size() != m_vPixels.size())
+	{
+		m_vPixelsXFlip.resize(m_vPixels.size());
+
+		// mirror every row of every tile
+		for (unsigned int uRow = 0; uRow < m_uCount * m_uHeight; uRow++)
+		{
+			const uint8_t *pSrc = &m_vPixels[uRow * m_uWidth];
+			uint8_t *pDst = &m_vPixelsXFlip[uRow * m_uWidth];
+
+			for (unsigned int x = 0; x < m_uWidth; x++)
+			{
+				pDst[x] = pSrc[m_uWidth - 1 - x];
+			}
+		}
+	}
+
+	return &m_vPixelsXFlip[0];
+}
+
+void gfx_tileset::draw(SDL_Surface *pDst, unsigned int uTile, int iX, int iY, bool bXFlip, bool bYFlip, uint8_t u8ColorBase)
+{
+	// nothing to draw?
+	if ((uTile >= m_uCount) || (m_vFlags[uTile] & GFX_TILE_EMPTY))
+	{
+		return;
+	}
+
+	// clip to the surface
+	int iXMin = 0, iXMax = (int) m_uWidth, iYMin = 0, iYMax = (int) m_uHeight;
+	if (iX < 0) iXMin = -iX;
+	if (iY < 0) iYMin = -iY;
+	if (iX + iXMax > pDst->w) iXMax = pDst->w - iX;
+	if (iY + iYMax > pDst->h) iYMax = pDst->h - iY;
+	if ((iXMin >= iXMax) || (iYMin >= iYMax))
+	{
+		return;
+	}
+
+	const uint8_t *pTile = (bXFlip ? get_xflipped() : &m_vPixels[0]) + (uTile * m_uTileSize);
+	bool bOpaque = (m_vFlags[uTile] & GFX_TILE_OPAQUE) != 0;
+
+	for (int y = iYMin; y < iYMax; y++)
+	{
+		// the row of the tile that lands on this line
+		const uint8_t *pSrc = pTile + ((bYFlip ? (m_uHeight - 1 - y) : y) * m_uWidth);
+		uint8_t *pLine = (uint8_t *) pDst->pixels + ((iY + y) * pDst->pitch) + iX;
+
+		if (bOpaque)
+		{
+			for (int x = iXMin; x < iXMax; x++)
+			{
+				pLine[x] = (uint8_t) (pSrc[x] + u8ColorBase);
+			}
+		}
+		else
+		{
+			// Pixel 0 is transparent.  This is written as a select instead of an if, so that the compiler can
+			//  vectorize the whole row into a masked blend (gfx_tilemap::composite relies on the same trick).
+			for (int x = iXMin; x < iXMax; x++)
+			{
+				uint8_t u8Pixel = pSrc[x];
+				pLine[x] = u8Pixel ? (uint8_t) (u8Pixel + u8ColorBase) : pLine[x];
+			}
+		}
+	}
+}
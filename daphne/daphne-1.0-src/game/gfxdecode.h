@@ -0,0 +1,82 @@
+/*
+ * gfxdecode.h
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// gfxdecode.h
+
+// Tile and sprite graphics ROMs are stored as bitplanes, which take a lot of shifting and masking to turn
+//  back into pixels.  A gfx_tileset does that once (when the ROMs are loaded, see game::decode_gfx_roms)
+//  and keeps the tiles as chunky 8bpp pixels, so drawing a tile is just a copy.
+
+#ifndef GFXDECODE_H
+#define GFXDECODE_H
+
+#include <stdint.h>
+#include <vector>
+#include <SDL.h>
+
+#define GFX_MAX_PLANES 4	// most bits per pixel we support
+#define GFX_MAX_SIZE 32	// biggest tile width/height we support
+
+// Describes how tiles are laid out in a graphics ROM (much like MAME's gfx_layout).
+// All offsets are in bits.  Bit 'n' of the ROM is (rom[n >> 3] >> (n & 7)) & 1, so bit 0 is the LSB of the first byte.
+// A pixel is made up of one bit from each plane: uPlaneOffset[p] + uYOffset[y] + uXOffset[x] + (tile * uTileIncrement).
+struct gfx_layout
+{
+	unsigned int uWidth;	// width of a tile in pixels
+	unsigned int uHeight;	// height of a tile in pixels
+	unsigned int uPlanes;	// how many bits per pixel
+	unsigned int uPlaneOffset[GFX_MAX_PLANES];	// where each plane begins (most significant plane comes first)
+	unsigned int uXOffset[GFX_MAX_SIZE];	// where each pixel of a row begins
+	unsigned int uYOffset[GFX_MAX_SIZE];	// where each row begins
+	unsigned int uTileIncrement;	// how far apart each tile is
+};
+
+class gfx_tileset
+{
+public:
+	gfx_tileset();
+
+	// decodes 'uCount' tiles from 'pROM' (which is 'uROMSize' bytes long) using 'layout'
+	// Bits past the end of the ROM are treated as 0.
+	void decode(const uint8_t *pROM, unsigned int uROMSize, const gfx_layout &layout, unsigned int uCount);
+
+	// draws tile 'uTile' onto an 8bpp surface with its top left corner at iX, iY (clipped to the surface).
+	// Pixels that are 0 are transparent; the rest get 'u8ColorBase' added to them.
+	// If bXFlip is true, the tile is mirrored left to right.  If bYFlip is true, it is drawn upside down.
+	void draw(SDL_Surface *pDst, unsigned int uTile, int iX, int iY, bool bXFlip, bool bYFlip, uint8_t u8ColorBase);
+
+	unsigned int get_count() const { return m_uCount; }
+
+private:
+	// returns the left-to-right mirrored pixels (which are only created the first time they are needed)
+	const uint8_t *get_xflipped();
+
+	unsigned int m_uWidth;
+	unsigned int m_uHeight;
+	unsigned int m_uCount;	// how many tiles we have
+	unsigned int m_uTileSize;	// bytes per decoded tile (width * height)
+	std::vector<uint8_t> m_vPixels;	// one byte per pixel, tile after tile
+	std::vector<uint8_t> m_vPixelsXFlip;	// same as m_vPixels but with every row mirrored (empty until needed)
+	std::vector<uint8_t> m_vFlags;	// GFX_TILE_xxx flags for each tile
+};
+
+#endif // GFXDECODE_H
@@ -784,34 +784,8 @@ bool interstellar::set_bank(uint8_t which_bank, uint8_t value)
 
 void interstellar::draw_8x8(int character_number, int xcoord, int ycoord, int xflip, int yflip, int palette)
 {
-	uint8_t pixel[8] = {0};
-
-	for (int y = 0; y < 8; y++)
-	{
-		if ((y + ycoord) < INTERSTELLAR_OVERLAY_H)
-		{
-			uint8_t byte3 = character[character_number*8+y];
-			uint8_t byte2 = character[character_number*8+y+0x2000];
-			uint8_t byte1 = character[character_number*8+y+0x4000];
-
-			pixel[0] = static_cast<uint8_t>(((byte1 & 0x80) >> 5) | ((byte2 & 0x80) >> 6) | ((byte3 & 0x80) >> 7));
-			pixel[1] = static_cast<uint8_t>(((byte1 & 0x40) >> 4) | ((byte2 & 0x40) >> 5) | ((byte3 & 0x40) >> 6));
-			pixel[2] = static_cast<uint8_t>(((byte1 & 0x20) >> 3) | ((byte2 & 0x20) >> 4) | ((byte3 & 0x20) >> 5));
-			pixel[3] = static_cast<uint8_t>(((byte1 & 0x10) >> 2) | ((byte2 & 0x10) >> 3) | ((byte3 & 0x10) >> 4));
-			pixel[4] = static_cast<uint8_t>(((byte1 & 0x08) >> 1) | ((byte2 & 0x08) >> 2) | ((byte3 & 0x08) >> 3));
-			pixel[5] = static_cast<uint8_t>(((byte1 & 0x04) << 0) | ((byte2 & 0x04) >> 1) | ((byte3 & 0x04) >> 2));
-			pixel[6] = static_cast<uint8_t>(((byte1 & 0x02) << 1) | ((byte2 & 0x02) << 0) | ((byte3 & 0x02) >> 1));
-			pixel[7] = static_cast<uint8_t>(((byte1 & 0x01) << 2) | ((byte2 & 0x01) << 1) | ((byte3 & 0x01) << 0));
-
-			for (int x = 0; x < 8; x++)
-			{
-				if ((pixel[x]) && ((x + xcoord) < INTERSTELLAR_OVERLAY_W))
-				{
-					*((uint8_t *) m_video_overlay[m_active_video_overlay]->pixels + ((ycoord + (yflip ? (7-y) : y)) * INTERSTELLAR_OVERLAY_W) + (xcoord + (xflip ? (7-x) : x))) = (uint8_t) (pixel[x] | (palette << 3));
-				}
-			}
-		}
-	}
+	m_tiles.draw(m_video_overlay[m_active_video_overlay], character_number, xcoord, ycoord,
+		xflip != 0, yflip != 0, (uint8_t) (palette << 3));
 }
 
 void interstellar::draw_16x16(int character_number, int xcoord, int ycoord, int xflip, int yflip, int palette)
@@ -822,6 +796,20 @@ void interstellar::draw_16x16(int character_number, int xcoord, int ycoord, int
 	draw_8x8((character_number * 4) + 3, xcoord + (xflip?0:8), ycoord + (yflip?0:8), xflip, yflip, palette);
 }
 
+void interstellar::decode_gfx_roms()
+{
+	// 3 bitplanes (most significant plane last), one byte per row, leftmost pixel in bit 7
+	gfx_layout layout = { 8, 8, 3, { 0x4000 * 8, 0x2000 * 8, 0 }, { 0 }, { 0 }, 8 * 8 };
+
+	for (unsigned int i = 0; i < 8; i++)
+	{
+		layout.uXOffset[i] = 7 - i;
+		layout.uYOffset[i] = i * 8;
+	}
+
+	m_tiles.decode(character, sizeof(character), layout, 0x2000 / 8);
+}
+
 unsigned interstellar::get_libretro_button_map(unsigned id)
 {
    return SWITCH_NOTHING;
@@ -28,6 +28,7 @@
 
 #include <stdint.h>
 #include "game.h"
+#include "gfxdecode.h"
 
 #define INTERSTELLAR_OVERLAY_W 256	// width of overlay
 #define INTERSTELLAR_OVERLAY_H 256	// height of overlay
@@ -53,6 +54,7 @@ public:
    unsigned get_libretro_button_map(unsigned id);
    const char *get_libretro_button_name(unsigned id);
 	bool set_bank(uint8_t, uint8_t);
+	void decode_gfx_roms();
 
 private:	
 	bool m_cpu0_nmi_enable;
@@ -62,6 +64,7 @@ private:
 	uint8_t m_soundchip1_id;
 	uint8_t m_soundchip2_id;
    uint8_t character[0x6000];
+	gfx_tileset m_tiles;	// 8x8 tiles decoded from character (sprites are made up of 4 of these)
 	uint8_t color_prom[0x300];
 	uint8_t banks[3];
 	uint8_t m_cpumem2[0x10000]; // memory space for the second z80
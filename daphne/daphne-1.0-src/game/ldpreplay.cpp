@@ -0,0 +1,291 @@
+/*
+ * ldpreplay.cpp
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// ldpreplay.cpp -- replays a laserdisc command trace without emulating a cpu
+// Record a trace while playing a game with -ldptrace <file>, then replay it with:
+//  daphne ldpreplay vldp -framefile <framefile> <tracefile> [-replay_fast]
+// Each search's latency and the number of frames that VLDP decoded are printed when the replay finishes.
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include "ldpreplay.h"
+#include "../daphne.h"	// for get_quitflag/set_quitflag
+#include "../io/conout.h"
+#include "../io/error.h"
+#include "../io/mpo_fileio.h"
+#include "../io/threads.h"
+#include "../ldp-out/ldp.h"
+#include "../timer/timer.h"
+#include "../timer/telemetry.h"
+
+// Win32 doesn't use strcasecmp, it uses stricmp (lame)
+#ifdef WIN32
+#define strcasecmp stricmp
+#endif
+
+ldpreplay::ldpreplay() :
+	m_bFast(false),
+	m_pThread(NULL),
+	m_uReplayMs(0),
+	m_uPaceStartMs(0),
+	m_uPaceStartTicks(0),
+	m_uSeekFailures(0),
+	m_uLateMs(0)
+{
+	m_shortgamename = "ldpreplay";
+	m_game_uses_video_overlay = false;	// we only care about the laserdisc video
+	m_disc_fps = 29.97;
+	SDL_AtomicSet(&m_Stop, 0);
+}
+
+bool ldpreplay::init()
+{
+	bool bResult = false;
+	string strErrMsg;
+
+	// no cpu to initialize, we just need the trace
+	if (m_strTraceFile.empty())
+	{
+		printerror("LDPREPLAY : no trace file was specified on the command line");
+	}
+	else if (!ldptrace_load(m_strTraceFile.c_str(), m_vCmds, strErrMsg))
+	{
+		printerror(("LDPREPLAY : " + strErrMsg).c_str());
+	}
+	else if (m_vCmds.empty())
+	{
+		printerror(("LDPREPLAY : " + m_strTraceFile + " has no commands in it").c_str());
+	}
+	else
+	{
+		LOGF(LOGLEVEL_INFO, "LDPREPLAY : loaded %u commands (%u ms) from %s", (unsigned int) m_vCmds.size(),
+			m_vCmds.back().uMs, m_strTraceFile.c_str());
+		bResult = true;
+	}
+
+	return bResult;
+}
+
+void ldpreplay::start()
+{
+	m_pThread = SDL_CreateThread(replay_thread, "LDP_REPLAY", this);
+}
+
+void ldpreplay::shutdown()
+{
+	if (m_pThread)
+	{
+		SDL_AtomicSet(&m_Stop, 1);
+		SDL_WaitThread(m_pThread, NULL);
+		m_pThread = NULL;
+	}
+}
+
+bool ldpreplay::handle_cmdline_arg(const char *arg)
+{
+	bool bResult = false;
+
+	if (strcasecmp(arg, "-replay_fast") == 0)
+	{
+		m_bFast = true;
+		bResult = true;
+	}
+	else if (m_strTraceFile.empty() && mpo_file_exists(arg))
+	{
+		m_strTraceFile = arg;
+		bResult = true;
+	}
+	else
+	{
+		string strErrMsg = "Trace ";
+		strErrMsg += arg;
+		strErrMsg += " does not exist (or a trace was already specified).";
+		printline(strErrMsg.c_str());
+	}
+
+	return bResult;
+}
+
+int ldpreplay::replay_thread(void *pThis)
+{
+	threads_setup("cpu");	// this takes the place of the cpu thread
+	((ldpreplay *) pThis)->replay();
+	return 0;
+}
+
+void ldpreplay::replay()
+{
+	unsigned int uStartTicks = refresh_ms_time();
+	unsigned int uStartFrames = g_ldp->get_frames_decoded();
+	unsigned int uNext = 0;
+
+	m_uPaceStartTicks = uStartTicks;
+
+	// start the clock at the first command so that we don't wait for however long the game took to boot up
+	m_uReplayMs = m_uPaceStartMs = m_vCmds[0].uMs;
+
+	while ((uNext < m_vCmds.size()) && !get_quitflag() && !SDL_AtomicGet(&m_Stop))
+	{
+		unsigned int uDueMs = m_vCmds[uNext].uMs + m_uLateMs;
+
+		// if it's time to send the next command
+		if (m_uReplayMs >= uDueMs)
+		{
+			// if a seek ran past the point where this command was recorded, then all later commands get pushed back too
+			m_uLateMs += m_uReplayMs - uDueMs;
+			send_command(m_vCmds[uNext]);
+			++uNext;
+		}
+		else
+		{
+			int iStatus = g_ldp->get_status();
+			advance_ms((iStatus == LDP_PAUSED) || (iStatus == LDP_STOPPED) || (iStatus == LDP_ERROR));
+		}
+	}
+
+	report(elapsed_ms_time(uStartTicks), g_ldp->get_frames_decoded() - uStartFrames);
+
+	// we were only here to run the trace
+	set_quitflag();
+}
+
+void ldpreplay::send_command(const ldptrace_cmd &cmd)
+{
+	char frame[FRAME_ARRAY_SIZE] = { 0 };
+	uint64_t u64StartNs = telemetry_now_ns();
+	bool bSeek = true;	// whether this command moves the disc to a different frame
+
+	switch (cmd.uType)
+	{
+	case LDPTRACE_SEARCH:
+		// The game may have used a blocking search, but we always search without blocking so that we can
+		//  keep time moving forward the way the cpu would have.
+		g_ldp->framenum_to_frame((uint16_t) cmd.uArg1, frame);
+		g_ldp->pre_search(frame, false);
+		break;
+	case LDPTRACE_SKIP_FORWARD:
+		g_ldp->pre_skip_forward((uint16_t) cmd.uArg1);
+		break;
+	case LDPTRACE_SKIP_BACKWARD:
+		g_ldp->pre_skip_backward((uint16_t) cmd.uArg1);
+		break;
+	case LDPTRACE_STEP_FORWARD:
+		g_ldp->pre_step_forward();
+		break;
+	case LDPTRACE_STEP_BACKWARD:
+		g_ldp->pre_step_backward();
+		break;
+	case LDPTRACE_PLAY:
+		g_ldp->pre_play();
+		bSeek = false;
+		break;
+	case LDPTRACE_PAUSE:
+		g_ldp->pre_pause();
+		bSeek = false;
+		break;
+	case LDPTRACE_STOP:
+		g_ldp->pre_stop();
+		bSeek = false;
+		break;
+	default:	// LDPTRACE_SPEED
+		g_ldp->pre_change_speed(cmd.uArg1, cmd.uArg2);
+		bSeek = false;
+		break;
+	}
+
+	if (bSeek)
+	{
+		int iStatus = LDP_SEARCHING;
+
+		// wait for the search to finish (the game would not have sent another command until it did)
+		while (((iStatus = g_ldp->get_status()) == LDP_SEARCHING) && !get_quitflag() && !SDL_AtomicGet(&m_Stop))
+		{
+			advance_ms(false);
+		}
+
+		m_vSeekMs.push_back((telemetry_now_ns() - u64StartNs) / 1000000.0);
+
+		if (iStatus == LDP_ERROR)
+		{
+			++m_uSeekFailures;
+		}
+
+		LOGF(LOGLEVEL_INFO, "LDPREPLAY : %u ms: seek to frame %u took %.2f ms%s", cmd.uMs, g_ldp->get_current_frame(),
+			m_vSeekMs.back(), (iStatus == LDP_ERROR) ? " (FAILED)" : "");
+	}
+}
+
+void ldpreplay::advance_ms(bool bMayHurry)
+{
+	g_ldp->pre_think();
+	++m_uReplayMs;
+
+	// if we don't need to wait, then start pacing over from here the next time that we do
+	if (bMayHurry && m_bFast)
+	{
+		m_uPaceStartMs = m_uReplayMs;
+		m_uPaceStartTicks = refresh_ms_time();
+	}
+	// else if we're ahead of real time, then wait for it to catch up (VLDP plays the video according to our clock)
+	else if (elapsed_ms_time(m_uPaceStartTicks) < (m_uReplayMs - m_uPaceStartMs))
+	{
+		MAKE_DELAY(1);
+	}
+}
+
+void ldpreplay::report(unsigned int uWallMs, unsigned int uFramesDecoded)
+{
+	unsigned int uTraceMs = m_vCmds.back().uMs - m_vCmds[0].uMs;
+
+	LOGF(LOGLEVEL_INFO, "LDPREPLAY : replayed %u ms of commands in %u ms (%s)", uTraceMs, uWallMs,
+		m_bFast ? "fast" : "real time");
+
+	if (!m_vSeekMs.empty())
+	{
+		vector<double> vSorted = m_vSeekMs;
+		double dTotal = 0.0;
+		size_t uCount = vSorted.size();
+
+		sort(vSorted.begin(), vSorted.end());
+		for (size_t u = 0; u < uCount; u++)
+		{
+			dTotal += vSorted[u];
+		}
+
+		LOGF(LOGLEVEL_INFO, "LDPREPLAY : %u seeks (%u failed), min %.2f mean %.2f p50 %.2f p90 %.2f p99 %.2f max %.2f ms",
+			(unsigned int) uCount, m_uSeekFailures, vSorted[0], dTotal / uCount, vSorted[uCount / 2],
+			vSorted[(uCount * 9) / 10], vSorted[(uCount * 99) / 100], vSorted[uCount - 1]);
+	}
+	else
+	{
+		LOGF(LOGLEVEL_INFO, "LDPREPLAY : the trace had no seeks");
+	}
+
+	if (m_uLateMs > 0)
+	{
+		LOGF(LOGLEVEL_INFO, "LDPREPLAY : seeks took %u ms longer in total than they did when the trace was recorded", m_uLateMs);
+	}
+
+	LOGF(LOGLEVEL_INFO, "LDPREPLAY : %u frames decoded, %.2f fps", uFramesDecoded,
+		(uWallMs > 0) ? ((uFramesDecoded * 1000.0) / uWallMs) : 0.0);
+}
@@ -0,0 +1,77 @@
+/*
+ * ldpreplay.h
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// ldpreplay.h -- replays a laserdisc command trace (see ldp-out/ldptrace.h) without emulating a cpu,
+//  so that laserdisc/VLDP performance can be measured on its own
+
+#ifndef LDPREPLAY_H
+#define LDPREPLAY_H
+
+#include <string>
+#include <vector>
+#include <SDL.h>
+#include "game.h"
+#include "../ldp-out/ldptrace.h"
+
+using namespace std;
+
+class ldpreplay : public game
+{
+public:
+	ldpreplay();
+	bool init();
+	void start();
+	void shutdown();
+	bool handle_cmdline_arg(const char *arg);
+
+private:
+	static int replay_thread(void *pThis);
+
+	// runs through the whole trace, returns when it's finished or when we're told to quit
+	void replay();
+
+	// sends one command from the trace to the laserdisc player
+	void send_command(const ldptrace_cmd &cmd);
+
+	// lets one emulated millisecond go by.
+	// If 'bMayHurry' is true (and we're in fast mode), the millisecond does not have to take any real time.
+	void advance_ms(bool bMayHurry);
+
+	// prints the results of the replay
+	void report(unsigned int uWallMs, unsigned int uFramesDecoded);
+
+	string m_strTraceFile;	// the trace that we're replaying
+	vector<ldptrace_cmd> m_vCmds;	// the commands that are in the trace
+	bool m_bFast;	// if true, time where the player is idle (paused/stopped) is skipped instead of waited out
+	SDL_Thread *m_pThread;
+	SDL_atomic_t m_Stop;	// set to 1 to make the replay thread quit early
+
+	unsigned int m_uReplayMs;	// how many emulated ms have gone by since the replay started
+	unsigned int m_uPaceStartMs;	// m_uReplayMs at the point where we started pacing against real time
+	unsigned int m_uPaceStartTicks;	// the real time at that point
+
+	vector<double> m_vSeekMs;	// how long (real time) each search/skip/step took, in ms
+	unsigned int m_uSeekFailures;	// how many searches ended with an error
+	unsigned int m_uLateMs;	// how far behind the trace the replay fell because searches took longer than they did when the trace was recorded
+};
+
+#endif // LDPREPLAY_H
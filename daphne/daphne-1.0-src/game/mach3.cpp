@@ -777,13 +777,10 @@ void mach3::cpu_mem_write(uint16_t Addr, uint8_t Value)
 //			printline(s);
 
 			// if it's time to re-calculate
+			// (the mixer takes care of when the write happened, so the DAC only needs the value)
 			if (Value != m_dac_last_val)
 			{
-				uint64_t u64CurCycs = get_total_cycles_executed(1);
-				unsigned int uDiff = (unsigned int) (u64CurCycs - m_dac_last_cycs);
-				m_dac_last_cycs = u64CurCycs;
-
-				audio_write_ctrl_data(uDiff , Value, m_dac_id);
+				audio_write_ctrl_data(0, Value, m_dac_id);
 				m_dac_last_val = Value;
 			}
 		}
@@ -1160,7 +1157,7 @@ void mach3::draw_characters()
 		{
 			// draw 8x8 tiles from character generator 
 			int current_character = m_cpumem[chary * 32 + charx + 0x3800];
-			draw_8x8(current_character, character, charx*8, chary*8);
+			draw_8x8(current_character, charx*8, chary*8);
 		}
 	}
 }
@@ -1172,7 +1169,8 @@ void mach3::draw_sprites()
 	if ((m_cpumem[0x5803] & 0x02))  //bank select bit
 		offset = 0x2000;
 
-	uint8_t * spritebank = (uint8_t *)&sprite[offset];
+	// each bank is 256 sprites (32 bytes per plane each) into the sprite rom
+	unsigned int spritebank = offset / 32;
 
 	//docs say 63 sprites, each 16x16
 	for (int spritenum = 0; spritenum < 62; spritenum++)  
@@ -1195,7 +1193,7 @@ void mach3::draw_sprites()
 			uint8_t xpos = static_cast<uint8_t>((uSpriteInfo & 0x0000FF00) >> 8);
 			//WDO: not sure why characters need to be accessed in reverse order
 			uint8_t current_character = 255 - static_cast<uint8_t>((uSpriteInfo & 0x00FF0000) >> 16);
-			draw_16x16(current_character, spritebank, xpos, ypos);
+			draw_16x16(spritebank + current_character, xpos, ypos);
 		}
 	}  
 
@@ -1205,111 +1203,50 @@ void mach3::draw_sprites()
 	{
 	for (int y = 0; y < 256; y+=16)
 	{
-	draw_16x16(snum++, spritebank, x, y);
+	draw_16x16(snum++, x, y);
 	}
 	} */
 }
 
-void mach3::draw_8x8(uint8_t character_number, uint8_t *character_set, uint8_t xcoord, uint8_t ycoord)
+void mach3::draw_8x8(uint8_t character_number, uint8_t xcoord, uint8_t ycoord)
 {
-	uint8_t pixel[8] = {0};
-
 	//	static uint8_t tmpchar = 0;  // test hack to show the whole character set
 	//  character_number =  tmpchar++;
 
-	for (int y = 0; y < 8; y++)
-	{
-		//characters are contiguous blocks of 4-bpp values (32 bytes total for each 8x8 char)
-		pixel[0] = static_cast<uint8_t>((character_set[(character_number * 32) + 0 + (y * 4)] & 0xF0) >> 4  );
-		pixel[1] = static_cast<uint8_t>((character_set[(character_number * 32) + 0 + (y * 4)] & 0x0F) >> 0  );
-		pixel[2] = static_cast<uint8_t>((character_set[(character_number * 32) + 1 + (y * 4)] & 0xF0) >> 4  );
-		pixel[3] = static_cast<uint8_t>((character_set[(character_number * 32) + 1 + (y * 4)] & 0x0F) >> 0  );
-		pixel[4] = static_cast<uint8_t>((character_set[(character_number * 32) + 2 + (y * 4)] & 0xF0) >> 4  );
-		pixel[5] = static_cast<uint8_t>((character_set[(character_number * 32) + 2 + (y * 4)] & 0x0F) >> 0  );
-		pixel[6] = static_cast<uint8_t>((character_set[(character_number * 32) + 3 + (y * 4)] & 0xF0) >> 4  );
-		pixel[7] = static_cast<uint8_t>((character_set[(character_number * 32) + 3 + (y * 4)] & 0x0F) >> 0  );
-
-		for (int x = 0; x < 8; x++)
-		{
-			if (pixel[x])
-			{
-				*((uint8_t *) m_video_overlay[m_active_video_overlay]->pixels + ((ycoord + y) * MACH3_OVERLAY_W) + (xcoord + x)) = pixel[x];
-			}
-		}
-	}
+	m_characters.draw(m_video_overlay[m_active_video_overlay], character_number, xcoord, ycoord, false, false, 0);
 }
 
-void mach3::draw_16x16(uint8_t character_number, uint8_t *character_set, uint8_t xpos, uint8_t ypos)
+void mach3::draw_16x16(unsigned int sprite_number, uint8_t xpos, uint8_t ypos)
 {
-	uint8_t pixel[16] = {0};
-
-	uint8_t xmin = 0, xmax = 16,  ymin = 0, ymax = 16;
-
 	int ycoord = ypos - 13;   // sprites are offset from tiles (so they can be partially off-screen)
 	int xcoord = xpos - 4;	// used cobram3 ROM to align - cockpit has tiles and sprites that should line up
 
+	// (partially off-screen sprites get clipped)
+	m_sprites.draw(m_video_overlay[m_active_video_overlay], sprite_number, xcoord, ycoord, false, false, 0);
+}
 
-	if (xcoord < 0)
-	{
-		xmin = -xcoord;
-	}
-	if (xcoord > MACH3_OVERLAY_W - 16)
-	{
-		if (xcoord >= MACH3_OVERLAY_W)
-		{
-			xmax = xmin; // don't draw at all if it's somewhere completely off the screen
-		}
-		else
-		{
-			xmax = MACH3_OVERLAY_W - xcoord;  //draw the visible portion
-		}
-	}
+void mach3::decode_gfx_roms()
+{
+	// characters are contiguous blocks of 4-bpp values (32 bytes total for each 8x8 char), leftmost pixel in the high nibble
+	gfx_layout char_layout = { 8, 8, 4, { 3, 2, 1, 0 }, { 0 }, { 0 }, 32 * 8 };
 
-	if (ycoord < 0)
-	{
-		ymin = -ycoord;
-	}
-	if (ycoord > MACH3_OVERLAY_H - 16)
-	{
-		if (ycoord >= MACH3_OVERLAY_H)
-		{
-			ymax = ymin; // don't draw at all if it's somewhere completely off the screen
-		}
-		else
-		{
-			ymax = MACH3_OVERLAY_H - ycoord;  //draw the visible portion
-		}
-	}
+	// sprites are in blocks of 16-pixel lines x 16 rows, across 4 bitplanes 0x4000 bytes apart
+	//  (32 bytes in each bitplane for each 16x16 sprite), leftmost pixel in bit 7
+	gfx_layout sprite_layout = { 16, 16, 4, { 0, 0x4000 * 8, 0x8000 * 8, 0xC000 * 8 }, { 0 }, { 0 }, 32 * 8 };
 
-	for (int y = ymin; y < ymax; y++)
+	for (unsigned int i = 0; i < 16; i++)
 	{
-
-		uint8_t *current_line = &character_set[character_number * 32 + (y * 2)];
-
-		//characters are in blocks of 16-pixel lines x 16 rows, across 4 bitplanes (32 bytes in each bitplane for each 16x16 char)
-		for (int i = 7; i >= 0; i--)
+		if (i < 8)
 		{
-			pixel[15 - (i + 8)] = static_cast<uint8_t>(
-				(((*(current_line + 0 + 0x0000) >> (i) ) & 0x01) << 3) +
-				(((*(current_line + 0 + 0x4000) >> (i) ) & 0x01) << 2) +
-				(((*(current_line + 0 + 0x8000) >> (i) ) & 0x01) << 1) +
-				(((*(current_line + 0 + 0xC000) >> (i) ) & 0x01) << 0));
-
-			pixel[15 - i] = static_cast<uint8_t>(
-				(((*(current_line + 1 + 0x0000) >> (i) ) & 0x01) << 3) +
-				(((*(current_line + 1 + 0x4000) >> (i) ) & 0x01) << 2) +
-				(((*(current_line + 1 + 0x8000) >> (i) ) & 0x01) << 1) +
-				(((*(current_line + 1 + 0xC000) >> (i) ) & 0x01) << 0));
-		}	
-
-		for (int x = xmin; x < xmax; x++)
-		{
-			if (pixel[x])
-			{
-				*((uint8_t *) m_video_overlay[m_active_video_overlay]->pixels + ((ycoord + y) * MACH3_OVERLAY_W) + (xcoord + x)) = pixel[x];
-			}
+			char_layout.uXOffset[i] = ((i >> 1) * 8) + ((i & 1) ? 0 : 4);
+			char_layout.uYOffset[i] = i * 32;
 		}
+		sprite_layout.uXOffset[i] = ((i >> 3) * 8) + (7 - (i & 7));
+		sprite_layout.uYOffset[i] = i * 16;
 	}
+
+	m_characters.decode(character, sizeof(character), char_layout, sizeof(character) / 32);
+	m_sprites.decode(sprite, sizeof(sprite), sprite_layout, 0x4000 / 32);
 }
 
 // to help with debugging
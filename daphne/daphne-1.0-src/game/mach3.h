@@ -28,6 +28,7 @@
 #include <stdint.h>
 
 #include "game.h"
+#include "gfxdecode.h"
 
 #include <queue>	// for testing, can be replaced with array later
 
@@ -66,6 +67,7 @@ public:
 //	void set_version(int);
 //	bool handle_cmdline_arg(const char *arg);
 	void patch_roms();
+	void decode_gfx_roms();
 	uint8_t character[0x2000];  //character gfx ROM (8KB)
 	uint8_t sprite[0x10000];  //sprite gfx ROM (64KB for UVT, 32KB for MACH3)
    uint8_t m_cpumem2[0x10000]; // memory space for first 6502
@@ -90,8 +92,11 @@ protected:
 	void draw_characters();  
 	void draw_sprites();
 
-	void draw_8x8(uint8_t character_number, uint8_t *character_set, uint8_t xcoord, uint8_t ycoord);
-	void draw_16x16(uint8_t character_number, uint8_t *character_set, uint8_t xcoord, uint8_t ycoord);
+	void draw_8x8(uint8_t character_number, uint8_t xcoord, uint8_t ycoord);
+	void draw_16x16(unsigned int sprite_number, uint8_t xcoord, uint8_t ycoord);
+
+	gfx_tileset m_characters;	// 8x8 characters decoded from character
+	gfx_tileset m_sprites;	// 16x16 sprites decoded from sprite (both banks)
 
 	uint8_t m_frame_decoder_select_bit;
 	uint8_t m_audio_ready_bit;
@@ -103,7 +108,6 @@ protected:
    uint8_t m_soundctrl2;
 
    uint8_t m_dac_id;
-   uint64_t m_dac_last_cycs;
    uint8_t m_dac_last_val;
 
    bool m_soundchip2_nmi_enabled;
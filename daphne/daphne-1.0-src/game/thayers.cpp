@@ -43,6 +43,7 @@
 #include "../video/video.h"
 #include "../cpu/cpu.h"
 #include "../cpu/generic_z80.h"
+#include "../cpu/copintf.h"
 
 thayers::thayers()
 {
@@ -195,6 +196,8 @@ void thayers::no_speech()
 
 void thayers::shutdown()
 {
+	ssi263_shutdown();
+
 	if (m_pScoreboard)
 	{
 		m_pScoreboard->PreDeleteInstance();
@@ -272,6 +275,15 @@ void thayers::do_nmi()
 		m_pScoreboard->RepaintIfNeeded();
 	}
 
+	// if a phrase has just started being spoken, show its subtitle
+	{
+		char text[SSI_SUBTITLE_LEN];
+		if (ssi263_get_started_subtitle(text))
+		{
+			show_speech_subtitle(text);
+		}
+	}
+
 	m_message_timer++;
 
 	// Clear any existing message after a few seconds
@@ -437,35 +449,35 @@ void thayers::port_write(uint16_t port, uint8_t value)
 }
  
 // Fetch and clean up text from the SSI-263 speech buffer.
-void thayers::show_speech_subtitle()
+void thayers::get_speech_text(char *text)
+{
+    // TQ stores a copy of the text to be synthesized in game RAM at 0xa500.
+    // 0xa6d3 holds the # of characters in the buffer.
+    int len = m_cpumem[0xa6d3];
+
+    // The buffer holds "raw" text that still has characters that get parsed
+    // out when phoneme rules are applied, so strip them out before display.
+    speech_buffer_cleanup((char *) &m_cpumem[0xa500], text, len);
+}
+
+void thayers::show_speech_subtitle(const char *text)
 {
     if (m_show_speech_subtitle)
     {
-        char text[SSI_PHRASE_BUF_LEN];
-        int len;
-
         if (m_message_timer < 200)
         {
             // Erase previous message that's still showing.
-            memset(text, 0x20, 59);
-            text[60] = '\0';
+            char blank[60];
+            memset(blank, 0x20, 59);
+            blank[59] = '\0';
 
 			if (m_game_uses_video_overlay)
 			{
-				draw_string(text, 0, 17, m_video_overlay[m_active_video_overlay]);
+				draw_string(blank, 0, 17, m_video_overlay[m_active_video_overlay]);
 			}
 
         }
 
-        // TQ stores a copy of the text to be synthesized in game RAM at 0xa500.
-        // 0xa6d3 holds the # of characters in the buffer.
-        len = m_cpumem[0xa6d3];
-        text[len + 1] = '\0';
-
-        // The buffer holds "raw" text that still has characters that get parsed
-        // out when phoneme rules are applied, so strip them out before display.
-        speech_buffer_cleanup((char *) &m_cpumem[0xa500], text, len);
-
         // Reset the timer so text will be cleared after a few seconds.
 		m_message_timer = 0;
 
@@ -777,6 +789,45 @@ void thayers::write_scoreboard(uint8_t address, uint8_t data, int den)
 }
 
 // These functions are used with the COP cpu core
+uint8_t thayers::cop_port_read(uint8_t port)
+{
+	uint8_t result = 0;
+
+	switch (port)
+	{
+	case COP_PORT_L:
+		result = thayers_read_l_port();
+		break;
+	case COP_PORT_G:
+		result = thayers_read_g_port();
+		break;
+	case COP_PORT_SIO:
+		result = thayers_read_si_bit();
+		break;
+	}
+
+	return result;
+}
+
+void thayers::cop_port_write(uint8_t port, uint8_t value)
+{
+	switch (port)
+	{
+	case COP_PORT_D:
+		thayers_write_d_port(value);
+		break;
+	case COP_PORT_L:
+		thayers_write_l_port(value);
+		break;
+	case COP_PORT_G:
+		thayers_write_g_port(value);
+		break;
+	case COP_PORT_SIO:
+		thayers_write_so_bit(value);
+		break;
+	}
+}
+
 void thayers::thayers_write_d_port(unsigned char d)
 {
 	// Data Ready INT
@@ -45,6 +45,8 @@ public:
 	void cpu_mem_write(uint16_t addr, uint8_t value);		// memory write routine
 	uint8_t port_read(uint16_t port);		// read from port
 	void port_write(uint16_t port, uint8_t value);		// write to a port
+	uint8_t cop_port_read(uint8_t port);	// read from the COP421's ports
+	void cop_port_write(uint8_t port, uint8_t value);	// write to the COP421's ports
 	// RJS CHANGE START
 	//void process_keydown(SDLKey);
 	//void process_keyup(SDLKey);
@@ -72,7 +74,11 @@ public:
     void no_speech();
 
     // Called by ssi263.cpp whenever it has something to say <g>.
-    void show_speech_subtitle();
+    // Copies the text about to be spoken out of game RAM, tidied up ('text' must hold SSI_SUBTITLE_LEN bytes).
+    void get_speech_text(char *text);
+
+    // Puts 'text' (from get_speech_text) up as a subtitle, if subtitles are on.
+    void show_speech_subtitle(const char *text);
 
 protected:
 //	void string_draw(char*, int, int);
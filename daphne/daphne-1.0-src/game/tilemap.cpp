@@ -0,0 +1,129 @@
+/*
+ * tilemap.cpp
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+// tilemap.cpp
+// Persistent tile layer with dirty cell tracking, shared by the game drivers
+
+#include <string.h>
+#include "tilemap.h"
+#include "../io/conout.h"
+
+gfx_tilemap::gfx_tilemap() :
+	m_uCols(0),
+	m_uRows(0),
+	m_uCellW(0),
+	m_uCellH(0),
+	m_u8Fill(0),
+	m_bAnyDirty(false),
+	m_pLayer(NULL)
+{
+}
+
+gfx_tilemap::~gfx_tilemap()
+{
+	shutdown();
+}
+
+bool gfx_tilemap::init(unsigned int uCols, unsigned int uRows, unsigned int uCellW, unsigned int uCellH, uint8_t u8Fill)
+{
+	shutdown();
+
+	m_pLayer = SDL_CreateRGBSurface(0, uCols * uCellW, uRows * uCellH, 8, 0, 0, 0, 0);
+	if (!m_pLayer)
+	{
+		printline("gfx_tilemap : SDL_CreateRGBSurface failed!");
+		return false;
+	}
+
+	m_uCols = uCols;
+	m_uRows = uRows;
+	m_uCellW = uCellW;
+	m_uCellH = uCellH;
+	m_u8Fill = u8Fill;
+	m_vDirty.assign(m_uCols * m_uRows, 0);
+	SDL_FillRect(m_pLayer, NULL, m_u8Fill);
+	mark_all_dirty();
+	return true;
+}
+
+void gfx_tilemap::shutdown()
+{
+	if (m_pLayer)
+	{
+		SDL_FreeSurface(m_pLayer);
+		m_pLayer = NULL;
+	}
+	m_vDirty.clear();
+	m_uCols = m_uRows = 0;
+	m_bAnyDirty = false;
+}
+
+void gfx_tilemap::mark_all_dirty()
+{
+	m_vDirty.assign(m_vDirty.size(), 1);
+	m_bAnyDirty = !m_vDirty.empty();
+}
+
+void gfx_tilemap::clear_cell(unsigned int uCol, unsigned int uRow)
+{
+	SDL_Rect rect;
+	rect.x = uCol * m_uCellW;
+	rect.y = uRow * m_uCellH;
+	rect.w = m_uCellW;
+	rect.h = m_uCellH;
+	SDL_FillRect(m_pLayer, &rect, m_u8Fill);
+}
+
+void gfx_tilemap::clean()
+{
+	if (m_bAnyDirty)
+	{
+		memset(&m_vDirty[0], 0, m_vDirty.size());
+		m_bAnyDirty = false;
+	}
+}
+
+void gfx_tilemap::composite(SDL_Surface *pDst, bool bTransparent)
+{
+	const uint8_t u8Fill = m_u8Fill;
+
+	for (int y = 0; y < m_pLayer->h; y++)
+	{
+		const uint8_t *pSrc = (const uint8_t *) m_pLayer->pixels + (y * m_pLayer->pitch);
+		uint8_t *pLine = (uint8_t *) pDst->pixels + (y * pDst->pitch);
+
+		if (!bTransparent)
+		{
+			memcpy(pLine, pSrc, m_pLayer->w);
+		}
+		else
+		{
+			// pixels of the fill color are transparent (see gfx_tileset::draw for why this is a select)
+			for (int x = 0; x < m_pLayer->w; x++)
+			{
+				uint8_t u8Pixel = pSrc[x];
+				pLine[x] = (u8Pixel != u8Fill) ? u8Pixel : pLine[x];
+			}
+		}
+	}
+}
@@ -0,0 +1,93 @@
+/*
+ * tilemap.h
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+// tilemap.h
+
+// Most drivers clear their whole overlay and redraw every tile whenever video RAM is written, even though
+//  usually only a handful of cells (a score, a credit count) actually changed.  A gfx_tilemap keeps the tiles
+//  on a persistent layer of its own.  The driver marks cells dirty from cpu_mem_write, redraws only those
+//  cells into the layer during video_repaint, and then composites the layer onto the overlay along with its sprites.
+// Using it is optional; drivers that don't want it simply keep repainting everything.
+
+#ifndef TILEMAP_H
+#define TILEMAP_H
+
+#include <stdint.h>
+#include <vector>
+#include <SDL.h>
+
+class gfx_tilemap
+{
+public:
+	gfx_tilemap();
+	~gfx_tilemap();
+
+	// creates a layer of uCols x uRows cells, each uCellW x uCellH pixels.
+	// Anything not covered by a tile is u8Fill.  All cells start out dirty.
+	// Returns false if the layer could not be created.
+	bool init(unsigned int uCols, unsigned int uRows, unsigned int uCellW, unsigned int uCellH, uint8_t u8Fill);
+
+	void shutdown();
+
+	bool is_initialized() const { return m_pLayer != NULL; }
+
+	// marks one cell (or all of them) as needing to be redrawn
+	void mark_dirty(unsigned int uCol, unsigned int uRow)
+	{
+		if ((uCol < m_uCols) && (uRow < m_uRows))
+		{
+			m_vDirty[(uRow * m_uCols) + uCol] = 1;
+			m_bAnyDirty = true;
+		}
+	}
+	void mark_all_dirty();
+
+	bool is_dirty(unsigned int uCol, unsigned int uRow) const { return m_vDirty[(uRow * m_uCols) + uCol] != 0; }
+	bool any_dirty() const { return m_bAnyDirty; }
+
+	// fills a cell with the fill color so the driver can draw its new tile(s) into it
+	void clear_cell(unsigned int uCol, unsigned int uRow);
+
+	// call once all the dirty cells have been redrawn
+	void clean();
+
+	// the 8bpp layer that the driver draws its tiles onto
+	SDL_Surface *get_layer() { return m_pLayer; }
+
+	// copies the layer onto pDst (which must be an 8bpp surface at least as big as the layer).
+	// If bTransparent is true, layer pixels that are the fill color are skipped so that
+	//  whatever is already on pDst (sprites, for instance) shows through.
+	void composite(SDL_Surface *pDst, bool bTransparent);
+
+private:
+	unsigned int m_uCols;
+	unsigned int m_uRows;
+	unsigned int m_uCellW;
+	unsigned int m_uCellH;
+	uint8_t m_u8Fill;
+	bool m_bAnyDirty;	// whether any entry in m_vDirty is set (so a clean repaint can skip the scan)
+	std::vector<uint8_t> m_vDirty;	// one entry per cell, non-zero if it needs to be redrawn
+	SDL_Surface *m_pLayer;	// holds the tiles between repaints
+};
+
+#endif // TILEMAP_H
@@ -37,9 +37,12 @@
 #include "numstr.h"
 #include "homedir.h"
 #include "input.h"	// to disable joystick use
+#include "movie.h"
+#include "threads.h"
 #include "../io/numstr.h"
 #include "../video/video.h"
 #include "../video/led.h"
+#include "../timer/telemetry.h"
 #include "../daphne.h"
 #include "../cpu/cpu-debug.h"	// for set_cpu_trace
 #include "../game/lair.h"
@@ -62,11 +65,14 @@
 #include "../game/mach3.h"
 #include "../game/lgp.h"
 #include "../game/timetrav.h"
+#include "../game/ldpreplay.h"
+#include "../game/cpubench.h"
 #ifdef BUILD_SINGE
 #include "../game/singe.h"
 #endif // BUILD_SINGE
 #include "../ldp-out/ldp.h"
 #include "../ldp-out/sony.h"
+#include "../ldp-out/ldptrace.h"
 #include "../ldp-out/pioneer.h"
 #include "../ldp-out/ld-v6000.h"
 #include "../ldp-out/hitachi.h"
@@ -268,6 +274,10 @@ bool parse_game_type()
 	{
 		g_game = new cobram3();
 	}
+	else if (strcasecmp(s, "cpubench")==0)
+	{
+		g_game = new cpubench();
+	}
 	else if (strcasecmp(s, "dle11") == 0)
 	{
 		g_game = new dle11();
@@ -442,6 +452,10 @@ bool parse_game_type()
 		g_game = new lair2();
 		g_game->set_version(1);
 	}
+	else if (strcasecmp(s, "ldpreplay")==0)
+	{
+		g_game = new ldpreplay();
+	}
 	else if (strcasecmp(s, "lgp")==0)
 	{
 		g_game = new lgp();
@@ -609,6 +623,7 @@ bool parse_cmd_line(int argc, char **argv)
 	char s[320] = { 0 };	// in case they pass in a huge directory as part of the framefile
 	int i = 0;
 	bool log_was_disabled = false;	// if we actually get "-nolog" while going through arguments
+	bool bFullScale = false;	// if we get "-fullscale" (checked once everything has been parsed)
 
 	//////////////////////////////////////////////////////////////////////////////////////
 
@@ -873,6 +888,24 @@ bool parse_cmd_line(int argc, char **argv)
 			}
 		}
 
+		// decode the laserdisc audio tracks ahead of time (using up to x megabytes of RAM) so seeking is free
+		else if (strcasecmp(s, "-audio_cache")==0)
+		{
+			ldp_vldp *the_ldp = (ldp_vldp *)(g_ldp);
+
+			get_next_word(s, sizeof(s));
+			i = atoi(s);
+			if ((the_ldp != NULL) && (i > 0) && (i < 2048 * 1024))
+			{
+				the_ldp->set_audio_cache(i);
+			}
+			else
+			{
+				printline("Audio cache only works with VLDP and needs a size in megabytes.");
+				result = false;
+			}
+		}
+
 		// don't force 4:3 aspect ratio regardless of window size
 		else if (strcasecmp(s, "-ignore_aspect_ratio")==0)
 		{
@@ -972,6 +1005,71 @@ bool parse_cmd_line(int argc, char **argv)
 			result = false;
 #endif
 		}
+		// record frame time/seek latency histograms and write them to a file when we quit
+		else if (strcasecmp(s, "-telemetry")==0)
+		{
+			get_next_word(s, sizeof(s));
+			telemetry_enable(s);
+			outstr("Recording telemetry to ");
+			printline(s);
+		}
+		// record every command sent to the laserdisc player so that it can be replayed with the 'ldpreplay' game
+		else if (strcasecmp(s, "-ldptrace")==0)
+		{
+			get_next_word(s, sizeof(s));
+			if (ldptrace_start(s))
+			{
+				outstr("Recording laserdisc commands to ");
+				printline(s);
+			}
+			else
+			{
+				outstr("Could not create laserdisc trace ");
+				printline(s);
+				result = false;
+			}
+		}
+		// pin one of our threads to some cores and/or change its scheduling priority (may be given more than once)
+		else if (strcasecmp(s, "-thread")==0)
+		{
+			get_next_word(s, sizeof(s));
+			if (!threads_parse_option(s))
+			{
+				result = false;
+			}
+		}
+		// record the player's input so that the session can be played back exactly with -playmovie
+		else if (strcasecmp(s, "-recordmovie")==0)
+		{
+			get_next_word(s, sizeof(s));
+			if (movie_record_start(s))
+			{
+				outstr("Recording input movie to ");
+				printline(s);
+			}
+			else
+			{
+				outstr("Could not create input movie ");
+				printline(s);
+				result = false;
+			}
+		}
+		// play back a movie recorded with -recordmovie instead of taking input (daphne quits when the movie ends)
+		else if (strcasecmp(s, "-playmovie")==0)
+		{
+			get_next_word(s, sizeof(s));
+			if (movie_play_start(s))
+			{
+				outstr("Playing back input movie ");
+				printline(s);
+			}
+			else
+			{
+				outstr("Could not load input movie ");
+				printline(s);
+				result = false;
+			}
+		}
 		// added by JFA for -idleexit
 		else if (strcasecmp(s, "-idleexit")==0)
 		{
@@ -1086,17 +1184,7 @@ bool parse_cmd_line(int argc, char **argv)
         // from the dimensions of the game.
 		else if (strcasecmp(s, "-fullscale")==0)
 		{
-			ldp_vldp *cur_ldp = (ldp_vldp *)(g_ldp);	// see if the currently selected LDP is VLDP
-			// if it is a vldp, then this option is not supported
-			if (cur_ldp)
-			{
-				printline("Full Scale mode only works with NOLDP.");
-				result = false;
-			}
-			else
-			{
-				g_game->SetFullScale(true);
-			}
+			bFullScale = true;
 		}
 
 		// check for any game-specific arguments ...
@@ -1116,6 +1204,21 @@ bool parse_cmd_line(int argc, char **argv)
 			result = false;
 		}
 	  } // end for
+
+		// now that we know which LDP is being used, no matter what order the arguments came in
+		if (bFullScale)
+		{
+			// if the currently selected LDP is VLDP, then this option is not supported
+			if (g_ldp->is_vldp())
+			{
+				printline("Full Scale mode only works with NOLDP.");
+				result = false;
+			}
+			else
+			{
+				g_game->SetFullScale(true);
+			}
+		}
 	} // end if we know our game type
 	
 	// if game or ldp was unknown
@@ -26,7 +26,9 @@
 #include <string>
 #include <list>
 #include <stdio.h>
+#include <stdarg.h>
 #include <string.h>
+#include <SDL.h>
 #include "conout.h"
 #include "../daphne.h"
 #include "../video/video.h"
@@ -39,23 +41,424 @@
 
 using namespace std;
 
+// how many slots the log queue has (must be a power of 2)
+#define LOG_RING_SLOTS 1024
+
+// how much text each slot holds, a message that doesn't fit spills over into the following slots
+#define LOG_SLOT_TEXT 116
+
+// the most slots one message can take up (anything longer is cut off)
+#define LOG_MAX_SLOTS 16
+
+// how often the background thread wakes up to write out the log
+#define LOG_WRITE_INTERVAL_MS 10
+
+// bits of log_slot::uKind
+#define LOG_KIND_LEVEL 0x0F	// the LOGLEVEL_
+#define LOG_KIND_NEWLINE 0x10	// end the line after this text
+#define LOG_KIND_ENABLE 0x20	// start writing daphne_log.txt (instead of holding on to the log in memory)
+#define LOG_KIND_DISABLE 0x40	// stop writing daphne_log.txt
+
+// One slot of the log queue.
+// This is a bounded queue in the style of Dmitry Vyukov's: each slot has a sequence number that says whether it's free
+//  for the producer at position N (N), filled in for the consumer (N + 1), or waiting for the next lap around.
+// Sequence numbers are stored relative to the slot's index, so that a zero-filled queue is a valid empty one and no
+//  start-up code has to run before the first message is logged.
+struct log_slot
+{
+	SDL_atomic_t seq;
+	uint8_t uKind;	// LOG_KIND_ bits (first slot of a message only)
+	uint8_t uSlots;	// how many slots the message takes up (first slot of a message only)
+	uint16_t uLen;	// how much text is in this slot
+	char text[LOG_SLOT_TEXT];
+};
+
+static log_slot g_log_ring[LOG_RING_SLOTS];
+static SDL_atomic_t g_log_head;	// position of the next slot to be claimed by a producer
+static SDL_atomic_t g_log_tail;	// position of the next slot to be written out (only changed by the writer)
+static SDL_atomic_t g_log_dropped;	// how many messages were thrown out because the queue was full
+
+// background thread state
+enum
+{
+	LOG_WRITER_NONE,	// not started yet
+	LOG_WRITER_RUNNING,
+	LOG_WRITER_STOPPING,	// log_shutdown is waiting for it
+	LOG_WRITER_SHUTDOWN	// gone, callers write out their own messages from now on
+};
+static SDL_atomic_t g_log_writer_state;
+static SDL_Thread *g_log_writer = NULL;
+static SDL_mutex *g_log_write_mutex = NULL;	// only one thread may be writing out the log at a time
+
+// The rest of these are only touched by whoever is writing out the log.
+
 // false = write log entries to g_lsPendingLog, true = write to daphne_log.txt
 // This should be false until the command line has finished parsing.
-bool g_log_enabled = false;
+static bool g_log_enabled = false;
 
 // used so log can store text until we've been given the green light to write to the log file
 // (using a list because it is faster than a vector)
-list <string> g_lsPendingLog;
+static list <string> g_lsPendingLog;
 
-// Prints a "c string" to the screen
-// Returns 1 on success, 0 on failure
-void outstr(const char *s)
+// log text waiting to be written to daphne_log.txt
+static string g_strLogBatch;
+
+static inline int log_slot_seq(unsigned int uPos)
+{
+	return SDL_AtomicGet(&g_log_ring[uPos & (LOG_RING_SLOTS - 1)].seq) + (int) (uPos & (LOG_RING_SLOTS - 1));
+}
+
+static inline void log_set_slot_seq(unsigned int uPos, unsigned int uSeq)
+{
+	SDL_AtomicSet(&g_log_ring[uPos & (LOG_RING_SLOTS - 1)].seq, (int) (uSeq - (uPos & (LOG_RING_SLOTS - 1))));
+}
+
+static void log_start_writer();
+static void log_write_out();
+
+// queues 'len' bytes of 's', returns false if there was no room
+static bool log_push(unsigned int uKind, const char *s, size_t len)
+{
+	unsigned int uSlots = (unsigned int) ((len + LOG_SLOT_TEXT - 1) / LOG_SLOT_TEXT);
+	unsigned int uPos = 0;
+
+	if (uSlots == 0)
+	{
+		uSlots = 1;
+	}
+	else if (uSlots > LOG_MAX_SLOTS)
+	{
+		uSlots = LOG_MAX_SLOTS;
+		len = LOG_MAX_SLOTS * LOG_SLOT_TEXT;
+	}
+
+	// claim uSlots slots in a row
+	for (;;)
+	{
+		bool bFree = true;
+
+		uPos = (unsigned int) SDL_AtomicGet(&g_log_head);
+		for (unsigned int i = 0; i < uSlots; i++)
+		{
+			int iDiff = log_slot_seq(uPos + i) - (int) (uPos + i);
+
+			// the writer hasn't gotten to this slot from the last time around, so the queue is full
+			if (iDiff < 0)
+			{
+				SDL_AtomicIncRef(&g_log_dropped);
+				return false;
+			}
+			// another thread got here first
+			else if (iDiff > 0)
+			{
+				bFree = false;
+				break;
+			}
+		}
+
+		if (bFree && SDL_AtomicCAS(&g_log_head, (int) uPos, (int) (uPos + uSlots)))
+		{
+			break;
+		}
+	}
+
+	for (unsigned int i = 0; i < uSlots; i++)
+	{
+		log_slot *slot = &g_log_ring[(uPos + i) & (LOG_RING_SLOTS - 1)];
+		size_t chunk = (len > LOG_SLOT_TEXT) ? LOG_SLOT_TEXT : len;
+
+		slot->uKind = (uint8_t) uKind;
+		slot->uSlots = (uint8_t) uSlots;
+		slot->uLen = (uint16_t) chunk;
+		memcpy(slot->text, s, chunk);
+		s += chunk;
+		len -= chunk;
+	}
+
+	// SDL_AtomicSet only has acquire ordering, so without this the text could become visible after the slot does
+	SDL_MemoryBarrierRelease();
+
+	// hand the slots over, the first one last so that the writer never sees part of a message
+	for (unsigned int i = uSlots; i-- > 0; )
+	{
+		log_set_slot_seq(uPos + i, uPos + i + 1);
+	}
+
+	return true;
+}
+
+// queues a message and makes sure that it will get written out
+static void log_message(unsigned int uKind, const char *s, size_t len)
 {
+	int iState = SDL_AtomicGet(&g_log_writer_state);
+
+	if (iState == LOG_WRITER_NONE)
+	{
+		log_start_writer();
+		iState = SDL_AtomicGet(&g_log_writer_state);
+	}
+
+	// if the queue is full and there is no thread to empty it, we'll have to do it ourselves
+	if (!log_push(uKind, s, len) && (iState == LOG_WRITER_SHUTDOWN))
+	{
+		log_write_out();
+		log_push(uKind, s, len);
+	}
+
+	if (iState == LOG_WRITER_SHUTDOWN)
+	{
+		log_write_out();
+	}
+}
+
+// adds a string to the log (writing daphne_log.txt happens at the end of the batch)
+static void log_add(const char *s, size_t len)
+{
+	// if logging is enabled
+	if (g_log_enabled)
+	{
+		g_strLogBatch.append(s, len);
+	}
+	// else logging is disabled, so we have to store log entries to memory
+	else
+	{
+		g_lsPendingLog.push_back(string(s, len));	// store to RAM for now ...
+	}
+}
+
+// writes a batch of log text to daphne_log.txt (creating it first if requested)
+static void log_write_file(bool bCreateFile)
+{
+	if ((!g_log_enabled) || (g_strLogBatch.empty() && !bCreateFile))
+	{
+		return;
+	}
+
+	mpo_io *io = NULL;
+	string logname = g_homedir.get_homedir();
+	logname += "/";
+	logname += LOGNAME;
+
+	if (bCreateFile)	io = mpo_open(logname.c_str(), MPO_OPEN_CREATE);
+	else				io = mpo_open(logname.c_str(), MPO_OPEN_APPEND);
+
+	if (io)
+	{
+		mpo_write(g_strLogBatch.c_str(), g_strLogBatch.size(), NULL, io);
+		mpo_close(io);
+	}
+	// else directory is read-only so we will just ignore for now
+	else
+	{
 #ifdef UNIX
-	fputs(s, stdout);
+		printf("Cannot write to '%s', do you have write permissions?\n", logname.c_str());
 #endif
+	}
 
-	addlog(s); // add to our logfile
+	g_strLogBatch.clear();
+}
+
+// writes out everything in the queue
+static void log_write_out()
+{
+	// Carriage return followed by line feed
+	// So we can read the blasted thing in notepad
+	static const char newline_str[3] = { 13, 10, 0 };
+	char text[LOG_MAX_SLOTS * LOG_SLOT_TEXT];
+	bool bWrote = false;
+
+	SDL_LockMutex(g_log_write_mutex);
+
+	unsigned int uTail = (unsigned int) SDL_AtomicGet(&g_log_tail);
+	for (;;)
+	{
+		// if the next message isn't ready yet (or there isn't one), we're done for now
+		if (log_slot_seq(uTail) != (int) (uTail + 1))
+		{
+			break;
+		}
+		SDL_MemoryBarrierAcquire();	// don't read the slot's contents before we've seen that it's ready
+
+		const log_slot *slot = &g_log_ring[uTail & (LOG_RING_SLOTS - 1)];
+		unsigned int uKind = slot->uKind;
+		unsigned int uSlots = slot->uSlots;
+		size_t len = 0;
+
+		for (unsigned int i = 0; i < uSlots; i++)
+		{
+			slot = &g_log_ring[(uTail + i) & (LOG_RING_SLOTS - 1)];
+			memcpy(text + len, slot->text, slot->uLen);
+			len += slot->uLen;
+			SDL_MemoryBarrierRelease();	// finish reading the slot before a producer can have it back
+			log_set_slot_seq(uTail + i, uTail + i + LOG_RING_SLOTS);	// free for the next time around
+		}
+		uTail += uSlots;
+		SDL_AtomicSet(&g_log_tail, (int) uTail);
+		bWrote = true;
+
+		if (uKind & LOG_KIND_ENABLE)
+		{
+			g_log_enabled = true;
+
+			// first we create the log file, then flush out everything that was logged before it was enabled
+			for (list<string>::iterator i = g_lsPendingLog.begin(); i != g_lsPendingLog.end(); i++)
+			{
+				g_strLogBatch += *i;
+			}
+			g_lsPendingLog.clear();
+			log_write_file(true);
+			continue;
+		}
+		else if (uKind & LOG_KIND_DISABLE)
+		{
+			log_write_file(false);
+			g_log_enabled = false;
+			continue;
+		}
+
+#ifdef UNIX
+		FILE *F = ((uKind & LOG_KIND_LEVEL) <= LOGLEVEL_WARNING) ? stderr : stdout;
+		fwrite(text, 1, len, F);
+		if (uKind & LOG_KIND_NEWLINE) fputc('\n', F);
+#endif
+
+		log_add(text, len);
+		if (uKind & LOG_KIND_NEWLINE) log_add(newline_str, 2);
+	}
+
+	// if messages had to be thrown out, say so now that there's room again
+	int iDropped = SDL_AtomicSet(&g_log_dropped, 0);
+	if (iDropped > 0)
+	{
+		int iLen = sprintf(text, "(%d log messages were dropped because the log queue was full)", iDropped);
+#ifdef UNIX
+		fprintf(stderr, "%s\n", text);
+#endif
+		log_add(text, iLen);
+		log_add(newline_str, 2);
+		bWrote = true;
+	}
+
+	if (bWrote)
+	{
+#ifdef UNIX
+		fflush(stdout);
+#endif
+		log_write_file(false);
+	}
+
+	SDL_UnlockMutex(g_log_write_mutex);
+}
+
+static int log_writer_thread(void *data)
+{
+	while (SDL_AtomicGet(&g_log_writer_state) == LOG_WRITER_RUNNING)
+	{
+		log_write_out();
+		SDL_Delay(LOG_WRITE_INTERVAL_MS);
+	}
+	log_write_out();
+	return 0;
+}
+
+static void log_start_writer()
+{
+	static SDL_atomic_t starting;
+
+	// only the first caller gets to start the thread, everyone else just queues their message and moves on
+	if (SDL_AtomicCAS(&starting, 0, 1))
+	{
+		g_log_write_mutex = SDL_CreateMutex();
+		SDL_AtomicSet(&g_log_writer_state, LOG_WRITER_RUNNING);
+		g_log_writer = SDL_CreateThread(log_writer_thread, "LOG_WRITER", NULL);
+
+		// if we can't have a thread, we'll just have to write out the log ourselves
+		if (!g_log_writer)
+		{
+			SDL_AtomicSet(&g_log_writer_state, LOG_WRITER_SHUTDOWN);
+		}
+	}
+}
+
+void log_printf(int level, const char *fmt, ...)
+{
+	char s[LOG_MAX_SLOTS * LOG_SLOT_TEXT];
+	va_list args;
+	int len = 0;
+
+	va_start(args, fmt);
+	len = vsnprintf(s, sizeof(s), fmt, args);
+	va_end(args);
+
+	if (len < 0)
+	{
+		return;
+	}
+	if (len >= (int) sizeof(s))
+	{
+		len = sizeof(s) - 1;
+	}
+
+	log_message((level & LOG_KIND_LEVEL) | LOG_KIND_NEWLINE, s, len);
+}
+
+bool log_site_allow(log_site *site, unsigned int uIntervalMs)
+{
+	// (if two threads log from the same site at once, the worst that can happen is that both get through)
+	if (site->bUsed && (elapsed_ms_time(site->uLastMs) < uIntervalMs))
+	{
+		site->uSuppressed++;
+		return false;
+	}
+
+	if (site->uSuppressed)
+	{
+		log_printf(LOGLEVEL_INFO, "(%u similar messages were suppressed)", site->uSuppressed);
+		site->uSuppressed = 0;
+	}
+	site->bUsed = true;
+	site->uLastMs = refresh_ms_time();
+	return true;
+}
+
+void log_flush()
+{
+	unsigned int uHead = (unsigned int) SDL_AtomicGet(&g_log_head);
+
+	if (SDL_AtomicGet(&g_log_writer_state) != LOG_WRITER_RUNNING)
+	{
+		if (g_log_write_mutex)
+		{
+			log_write_out();
+		}
+		return;
+	}
+
+	// the writer thread will get there
+	while ((int) (uHead - (unsigned int) SDL_AtomicGet(&g_log_tail)) > 0)
+	{
+		SDL_Delay(1);
+	}
+}
+
+void log_shutdown()
+{
+	log_start_writer();	// (in case nothing has been logged yet)
+
+	if (SDL_AtomicCAS(&g_log_writer_state, LOG_WRITER_RUNNING, LOG_WRITER_STOPPING))
+	{
+		SDL_WaitThread(g_log_writer, NULL);	// it writes out everything on its way out
+		g_log_writer = NULL;
+	}
+	SDL_AtomicSet(&g_log_writer_state, LOG_WRITER_SHUTDOWN);
+	log_write_out();
+}
+
+// Prints a "c string" to the screen
+// Returns 1 on success, 0 on failure
+void outstr(const char *s)
+{
+	log_message(LOGLEVEL_INFO, s, strlen(s));
 }
 
 // Prints a single character to the screen
@@ -79,36 +482,25 @@ void outchr(const char ch)
 // 1 = success
 void printline(const char *s)
 {
-	outstr(s);
-	newline();
+	// (one message, so that another thread's output can't end up in the middle of the line)
+	log_message(LOGLEVEL_INFO | LOG_KIND_NEWLINE, s, strlen(s));
 }
 
 // moves to the next line without printing anything
 void newline()
 {
-
-	// Carriage return followed by line feed
-	// So we can read the blasted thing in notepad
-	static char newline_str[3] = { 13, 10, 0 };
-
-#ifdef UNIX
-	printf("\n");
-#endif
-
-	addlog(newline_str);
-
+	log_message(LOGLEVEL_INFO | LOG_KIND_NEWLINE, "", 0);
 }
 
 // flood-safe printline
 // it only prints every second and anything else is thrown out
 void noflood_printline(char *s)
 {
-	static unsigned int old_timer = 0;
+	static log_site site;
 	
-	if (elapsed_ms_time(old_timer) > 1000)
+	if (log_site_allow(&site, 1000))
 	{
 		printline(s);
-		old_timer = refresh_ms_time();
 	}
 }
 
@@ -154,53 +546,6 @@ void safe_itoa(int num, char *a, int sizeof_a)
 
 void set_log_enabled(bool val)
 {
-	const char EOL[1] = { 0 };
-	g_log_enabled = val;
-	if (val) addlog(EOL, true);
-}
-
-// 2018.02.05 - RJS - Allowed a default value which would creete the log file on this run.
-// adds a string to a log file (creates the logfile if it does not exist)
-void addlog(const char *s, bool fCreateFile)
-{
-	// if logging is enabled
-	if (g_log_enabled)
-	{
-		mpo_io *io = NULL;
-      string logname = g_homedir.get_homedir();
-		logname += "/";
-		logname += LOGNAME;
-
-		if (fCreateFile)	io = mpo_open(logname.c_str(), MPO_OPEN_CREATE);
-		else				io = mpo_open(logname.c_str(), MPO_OPEN_APPEND);
-
-		if (io)
-		{
-			// if our list has stuff in it waiting to be written out to disk, then do so now
-			if (!g_lsPendingLog.empty())
-			{
-				// empty the log of its contents
-				for (list<string>::iterator i = g_lsPendingLog.begin();
-					i != g_lsPendingLog.end(); i++)
-				{
-					mpo_write((*i).c_str(), (*i).size(), NULL, io);
-				}
-				g_lsPendingLog.clear();
-			}
-			mpo_write(s, strlen(s), NULL, io);
-			mpo_close(io);
-		}
-		// else directory is read-only so we will just ignore for now
-		else
-		{
-#ifdef UNIX
-				printf("Cannot write to '%s', do you have write permissions?\n", logname.c_str());
-#endif
-		}
-	}
-	// else logging is disabled, so we have to store log entries to memory
-	else
-	{
-		g_lsPendingLog.push_back(s);	// store to RAM for now ...
-	}
+	// this goes through the queue too, so that everything logged before it stays in order
+	log_message(val ? LOG_KIND_ENABLE : LOG_KIND_DISABLE, "", 0);
 }
@@ -28,6 +28,46 @@
 
 #define LOGNAME "daphne_log.txt"	// name of our logfile if we are using one
 
+// Everything printed here is queued and written out (to the console and daphne_log.txt) by a background thread,
+//  so logging from time-sensitive code never waits on a slow console or disk.  Nothing is allocated on the caller's side.
+// If the queue fills up, messages are dropped (and the number dropped is logged once there is room again).
+
+// how important a message is, most important first
+enum
+{
+	LOGLEVEL_ERROR,
+	LOGLEVEL_WARNING,
+	LOGLEVEL_INFO,
+	LOGLEVEL_DEBUG
+};
+
+// LOGF messages that are less important than this are compiled out entirely (their arguments aren't even evaluated)
+#ifndef LOG_COMPILE_LEVEL
+#ifdef DEBUG
+#define LOG_COMPILE_LEVEL LOGLEVEL_DEBUG
+#else
+#define LOG_COMPILE_LEVEL LOGLEVEL_INFO
+#endif
+#endif
+
+// printf-style logging of one line
+#define LOGF(level, ...) \
+	do { if ((level) <= LOG_COMPILE_LEVEL) log_printf((level), __VA_ARGS__); } while (0)
+
+// same as LOGF, but this call site only logs once every 'interval_ms' milliseconds at most
+//  (for messages that might otherwise flood the log)
+#define LOGF_LIMITED(level, interval_ms, ...) \
+	do { if ((level) <= LOG_COMPILE_LEVEL) { static log_site log_site_; \
+		if (log_site_allow(&log_site_, (interval_ms))) log_printf((level), __VA_ARGS__); } } while (0)
+
+// what LOGF_LIMITED remembers about each call site
+struct log_site
+{
+	bool bUsed;	// whether anything has been logged from here yet
+	unsigned int uLastMs;	// when the last message was logged
+	unsigned int uSuppressed;	// how many messages have been thrown out since then
+};
+
 void outstr(const char *s);
 void outchr(const char ch);
 void printline(const char *s);
@@ -35,10 +75,23 @@ void newline();
 void noflood_printline(char *s);
 void safe_itoa(int num, char *a, int sizeof_a);
 
+// logs one line (formatted like printf) at the given LOGLEVEL_ (use LOGF so that it can be compiled out)
+void log_printf(int level, const char *fmt, ...)
+#ifdef __GNUC__
+	__attribute__ ((format (printf, 2, 3)))
+#endif
+	;
+
+// returns true if a message from 'site' may be logged now (see LOGF_LIMITED)
+bool log_site_allow(log_site *site, unsigned int uIntervalMs);
+
 // enables/disables log from being written to disk
 void set_log_enabled(bool val);
 
-// void addlog(const char *s);
-void addlog(const char *s, bool fCreateFile = false);
+// waits until everything that has been logged so far has been written out
+void log_flush();
+
+// writes out anything still queued and stops the background thread (anything logged after this is written out immediately)
+void log_shutdown();
 
 #endif
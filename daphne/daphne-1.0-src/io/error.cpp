@@ -37,9 +37,10 @@
 // notifies the user of an error that has occurred
 void printerror(const char *s)
 {
-   static const char CRLF[3] = { 13, 10, 0 };	// carriage return / linefeed combo, for the addlog statements in this file
-	addlog(s);
-	addlog(CRLF);
+	log_printf(LOGLEVEL_ERROR, "%s", s);
+
+	// errors are often the last thing we get to say before quitting (or crashing), so don't leave this one in the queue
+	log_flush();
 }
 
 // prints a notice to the screen
@@ -28,6 +28,7 @@
 #include <time.h>
 #include "input.h"
 #include "conout.h"
+#include "../timer/telemetry.h"
 #include "homedir.h"
 #include "../video/video.h"
 #include "../daphne.h"
@@ -36,6 +37,7 @@
 #include "../game/thayers.h"
 #include "../ldp-out/ldp.h"
 #include "fileparse.h"
+#include "movie.h"
 
 #ifndef _WIN32
 #include <strings.h>
@@ -819,9 +821,41 @@ bool input_pause(bool fPause)
 static int fCoinStart_Started_References = 0;
 
 static inline void add_coin_to_queue(bool enabled, uint8_t val);
+static void input_enable_now(uint8_t move);
+static void input_disable_now(uint8_t move);
 
 // if user has pressed a key/moved the joystick/pressed a button
 void input_enable(uint8_t move)
+{
+	// if a movie is recording or playing back, it decides when (and whether) the input gets applied
+	if (!movie_capture(true, move))
+	{
+		input_enable_now(move);
+	}
+}
+
+// if user has released a key/released a button/moved joystick back to center position
+void input_disable(uint8_t move)
+{
+	if (!movie_capture(false, move))
+	{
+		input_disable_now(move);
+	}
+}
+
+void input_apply(bool bEnable, uint8_t move)
+{
+	if (bEnable)
+	{
+		input_enable_now(move);
+	}
+	else
+	{
+		input_disable_now(move);
+	}
+}
+
+static void input_enable_now(uint8_t move)
 {
 	// RJS START ADD - coin start switch
 	if (move == SWITCH_COINSTART)
@@ -867,12 +901,13 @@ void input_enable(uint8_t move)
 		}
 		break;
 	case SWITCH_CONSOLE:
+		// write out the telemetry we have so far (if it's enabled)
+		telemetry_dump();
 		break;
 	}
 }
 
-// if user has released a key/released a button/moved joystick back to center position
-void input_disable(uint8_t move)
+static void input_disable_now(uint8_t move)
 {
 	// RJS START ADD - coin start switch
 	if (move == SWITCH_COINSTART)
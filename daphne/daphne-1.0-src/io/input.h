@@ -79,6 +79,9 @@ bool input_isinverted();
 bool input_pause(bool fPaused);
 void input_enable(uint8_t);
 void input_disable(uint8_t);
+
+// applies input right away, bypassing any movie that is recording or playing back (see movie.h)
+void input_apply(bool bEnable, uint8_t move);
 void reset_idle(void); // added by JFA
 
 #endif // INPUT_H
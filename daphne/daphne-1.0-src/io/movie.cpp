@@ -0,0 +1,406 @@
+/*
+ * movie.cpp
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// movie.cpp -- records the player's input against emulated time and plays it back exactly
+
+// Input normally reaches the game driver from the frontend's thread whenever it happens to arrive, which means that
+//  the cpu can be anywhere when it sees it.  While a movie is recording or playing, input is instead applied by the cpu
+//  thread at the end of an emulated millisecond, and that millisecond is what gets recorded.  Playback applies each
+//  input at the same millisecond, so the game sees it at the same point.
+// Every MOVIE_CHECK_MS, the cpu's cycle count, the laserdisc frame and a CRC of the cpu memory are also recorded, so
+//  that playback can tell if it has stopped doing the same thing as the recording did (for example, because a
+//  laserdisc search took a different amount of time).
+//
+// A movie looks like this:
+//  # daphne input movie
+//  game lair
+//  1500 press 9
+//  1600 release 9
+//  2000 check 8000000 0 1a2b3c4d
+//  ...
+//  90000 end
+
+#include <stdio.h>
+#include <string.h>
+#include <zlib.h>	// for crc32
+#include <string>
+#include <vector>
+#include <SDL.h>
+#include "movie.h"
+#include "input.h"
+#include "conout.h"
+#include "../daphne.h"	// for set_quitflag
+#include "../cpu/cpu.h"
+#include "../game/game.h"
+#include "../ldp-out/ldp.h"
+
+using namespace std;
+
+#define MOVIE_HEADER "# daphne input movie"
+
+// how often (in emulated ms) to check that playback is still doing what the recording did
+#define MOVIE_CHECK_MS 100
+
+enum { MOVIE_NONE, MOVIE_RECORDING, MOVIE_PLAYING };
+
+enum { MOVIE_PRESS, MOVIE_RELEASE, MOVIE_CHECK, MOVIE_END };
+
+struct movie_event
+{
+	unsigned int uMs;	// the emulated ms that this happened on
+	unsigned int uType;	// MOVIE_ enum
+	uint8_t uSwitch;	// which switch (for MOVIE_PRESS/MOVIE_RELEASE)
+	uint64_t u64Cycles;	// cycles that cpu 0 had executed (for MOVIE_CHECK)
+	unsigned int uFrame;	// the laserdisc's current frame (for MOVIE_CHECK)
+	unsigned int uCRC;	// CRC of the memory of every cpu (for MOVIE_CHECK)
+};
+
+static unsigned int g_movie_mode = MOVIE_NONE;
+static unsigned int g_movie_ms = 0;	// how many emulated ms have gone by since the movie started
+
+// recording
+static FILE *g_movie_file = NULL;
+static SDL_mutex *g_movie_mutex = NULL;	// protects everything here from the frontend and shutdown while the cpu thread is using it
+static vector<movie_event> g_movie_pending;	// input that came in from the frontend and is waiting for the cpu thread
+
+// playback
+static vector<movie_event> g_movie_events;
+static unsigned int g_movie_next = 0;	// the next event to play back
+static unsigned int g_movie_checks = 0;	// how many checks we've done
+static unsigned int g_movie_mismatches = 0;	// how many of those checks didn't match the recording
+
+// gets all the things that are compared during playback
+static void movie_get_check(movie_event &ev)
+{
+	uLong uCRC = crc32(0L, Z_NULL, 0);
+
+	for (uint8_t id = 0; ; id++)
+	{
+		struct cpudef *cpu = get_cpu_struct(id);
+
+		if (!cpu)
+		{
+			break;
+		}
+
+		// the COP421's memory is just its ROM
+		if (cpu->mem && (cpu->type != CPU_COP421))
+		{
+			// 16-bit cpus get a whole meg, the rest get 64k
+			unsigned int uSize = ((cpu->type == CPU_I88) || (cpu->type == CPU_X86)) ? CPU_MEM_SIZE : 0x10000;
+			uCRC = crc32(uCRC, cpu->mem, uSize);
+		}
+	}
+
+	ev.uType = MOVIE_CHECK;
+	ev.uMs = g_movie_ms;
+	ev.u64Cycles = get_total_cycles_executed(0);
+	ev.uFrame = g_ldp->get_current_frame();
+	ev.uCRC = (unsigned int) uCRC;
+}
+
+static void movie_write(const movie_event &ev)
+{
+	switch (ev.uType)
+	{
+	case MOVIE_PRESS:
+		fprintf(g_movie_file, "%u press %u\n", ev.uMs, ev.uSwitch);
+		break;
+	case MOVIE_RELEASE:
+		fprintf(g_movie_file, "%u release %u\n", ev.uMs, ev.uSwitch);
+		break;
+	case MOVIE_CHECK:
+		fprintf(g_movie_file, "%u check %llu %u %08x\n", ev.uMs, (unsigned long long) ev.u64Cycles, ev.uFrame, ev.uCRC);
+		break;
+	default:	// MOVIE_END
+		fprintf(g_movie_file, "%u end\n", ev.uMs);
+		break;
+	}
+}
+
+bool movie_record_start(const char *pszPath)
+{
+	bool bResult = false;
+
+	if (g_movie_mode != MOVIE_NONE)
+	{
+		printline("MOVIE : only one movie can be recorded or played at a time");
+	}
+	else if ((g_movie_file = fopen(pszPath, "wt")) != NULL)
+	{
+		// the mutex is never destroyed because the cpu thread may still be finishing its last ms when we shut down
+		if (!g_movie_mutex)
+		{
+			g_movie_mutex = SDL_CreateMutex();
+		}
+		fprintf(g_movie_file, "%s\n", MOVIE_HEADER);
+		fprintf(g_movie_file, "game %s\n", g_game ? g_game->get_shortgamename() : "unknown");
+		g_movie_ms = 0;
+		g_movie_mode = MOVIE_RECORDING;
+		bResult = true;
+	}
+
+	return bResult;
+}
+
+bool movie_play_start(const char *pszPath)
+{
+	FILE *F = NULL;
+	char line[160];
+	unsigned int uLine = 0;
+	bool bResult = true;
+
+	if (g_movie_mode != MOVIE_NONE)
+	{
+		printline("MOVIE : only one movie can be recorded or played at a time");
+		return false;
+	}
+
+	F = fopen(pszPath, "rt");
+	if (!F)
+	{
+		return false;
+	}
+
+	g_movie_events.clear();
+
+	while (bResult && fgets(line, sizeof(line), F))
+	{
+		movie_event ev;
+		char name[32] = { 0 };
+		unsigned int uArg = 0;
+		unsigned long long u64Cycles = 0;
+
+		uLine++;
+
+		// skip comments and blank lines
+		if ((line[0] == '#') || (line[strspn(line, " \t\r\n")] == 0))
+		{
+			continue;
+		}
+
+		memset(&ev, 0, sizeof(ev));
+
+		if (sscanf(line, "game %31s", name) == 1)
+		{
+			if (g_game && (strcmp(name, g_game->get_shortgamename()) != 0))
+			{
+				LOGF(LOGLEVEL_WARNING, "MOVIE : %s was recorded with %s, playback probably won't match", pszPath, name);
+			}
+			continue;
+		}
+		else if (sscanf(line, "%u %31s", &ev.uMs, name) != 2)
+		{
+			bResult = false;
+		}
+		else if ((strcmp(name, "press") == 0) || (strcmp(name, "release") == 0))
+		{
+			ev.uType = (name[0] == 'p') ? MOVIE_PRESS : MOVIE_RELEASE;
+			bResult = (sscanf(line, "%*u %*s %u", &uArg) == 1) && (uArg < SWITCH_COUNT);
+			ev.uSwitch = (uint8_t) uArg;
+		}
+		else if (strcmp(name, "check") == 0)
+		{
+			ev.uType = MOVIE_CHECK;
+			bResult = (sscanf(line, "%*u %*s %llu %u %x", &u64Cycles, &ev.uFrame, &ev.uCRC) == 3);
+			ev.u64Cycles = u64Cycles;
+		}
+		else if (strcmp(name, "end") == 0)
+		{
+			ev.uType = MOVIE_END;
+		}
+		else
+		{
+			bResult = false;
+		}
+
+		// events must be in the order they happened
+		if (bResult && !g_movie_events.empty() && (ev.uMs < g_movie_events.back().uMs))
+		{
+			bResult = false;
+		}
+
+		if (bResult)
+		{
+			g_movie_events.push_back(ev);
+		}
+		else
+		{
+			LOGF(LOGLEVEL_ERROR, "MOVIE : line %u of %s is not valid", uLine, pszPath);
+		}
+	}
+
+	fclose(F);
+
+	if (bResult)
+	{
+		if (!g_movie_mutex)
+		{
+			g_movie_mutex = SDL_CreateMutex();
+		}
+		g_movie_ms = 0;
+		g_movie_next = g_movie_checks = g_movie_mismatches = 0;
+		g_movie_mode = MOVIE_PLAYING;
+	}
+
+	return bResult;
+}
+
+bool movie_capture(bool bEnabled, uint8_t uSwitch)
+{
+	bool bResult = false;
+
+	// these don't affect the game, so they always go straight through
+	if ((uSwitch == SWITCH_QUIT) || (uSwitch == SWITCH_CONSOLE) || (uSwitch == SWITCH_SCREENSHOT))
+	{
+		return false;
+	}
+
+	if (g_movie_mode == MOVIE_RECORDING)
+	{
+		movie_event ev;
+		memset(&ev, 0, sizeof(ev));
+		ev.uType = bEnabled ? MOVIE_PRESS : MOVIE_RELEASE;
+		ev.uSwitch = uSwitch;
+
+		SDL_LockMutex(g_movie_mutex);
+		g_movie_pending.push_back(ev);
+		SDL_UnlockMutex(g_movie_mutex);
+		bResult = true;
+	}
+	// while playing back, the player's input is ignored
+	else if (g_movie_mode == MOVIE_PLAYING)
+	{
+		bResult = true;
+	}
+
+	return bResult;
+}
+
+static void movie_print_results()
+{
+	LOGF(LOGLEVEL_INFO, "MOVIE : played back %u ms, %u of %u checks matched the recording", g_movie_ms,
+		g_movie_checks - g_movie_mismatches, g_movie_checks);
+}
+
+void movie_think()
+{
+	if (g_movie_mode == MOVIE_NONE)
+	{
+		return;
+	}
+
+	SDL_LockMutex(g_movie_mutex);
+
+	++g_movie_ms;
+
+	if (g_movie_mode == MOVIE_RECORDING)
+	{
+		for (size_t u = 0; u < g_movie_pending.size(); u++)
+		{
+			g_movie_pending[u].uMs = g_movie_ms;
+			movie_write(g_movie_pending[u]);
+			input_apply(g_movie_pending[u].uType == MOVIE_PRESS, g_movie_pending[u].uSwitch);
+		}
+		g_movie_pending.clear();
+
+		if ((g_movie_ms % MOVIE_CHECK_MS) == 0)
+		{
+			movie_event ev;
+			movie_get_check(ev);
+			movie_write(ev);
+		}
+	}
+	else if (g_movie_mode == MOVIE_PLAYING)
+	{
+		while ((g_movie_next < g_movie_events.size()) && (g_movie_events[g_movie_next].uMs <= g_movie_ms))
+		{
+			const movie_event &rec = g_movie_events[g_movie_next++];
+			movie_event ev;
+
+			switch (rec.uType)
+			{
+			case MOVIE_PRESS:
+			case MOVIE_RELEASE:
+				input_apply(rec.uType == MOVIE_PRESS, rec.uSwitch);
+				break;
+			case MOVIE_CHECK:
+				movie_get_check(ev);
+				++g_movie_checks;
+
+				if ((ev.u64Cycles != rec.u64Cycles) || (ev.uFrame != rec.uFrame) || (ev.uCRC != rec.uCRC))
+				{
+					// only the first one is interesting, everything after it will probably be different too
+					if (g_movie_mismatches == 0)
+					{
+						LOGF(LOGLEVEL_WARNING, "MOVIE : playback no longer matches the recording at %u ms "
+							"(cycles %llu/%llu, frame %u/%u, crc %08x/%08x)", g_movie_ms,
+							(unsigned long long) ev.u64Cycles, (unsigned long long) rec.u64Cycles,
+							ev.uFrame, rec.uFrame, ev.uCRC, rec.uCRC);
+					}
+					++g_movie_mismatches;
+				}
+				break;
+			default:	// MOVIE_END
+				// the movie is over, and so is the run
+				movie_print_results();
+				g_movie_mode = MOVIE_NONE;
+				set_quitflag();
+				break;
+			}
+		}
+	}
+
+	SDL_UnlockMutex(g_movie_mutex);
+}
+
+void movie_stop()
+{
+	if (g_movie_mode == MOVIE_NONE)
+	{
+		return;
+	}
+
+	SDL_LockMutex(g_movie_mutex);
+
+	if (g_movie_mode == MOVIE_RECORDING)
+	{
+		movie_event ev;
+		memset(&ev, 0, sizeof(ev));
+		ev.uType = MOVIE_END;
+		ev.uMs = g_movie_ms;
+		movie_write(ev);
+
+		fclose(g_movie_file);
+		g_movie_file = NULL;
+		g_movie_pending.clear();
+	}
+	// else if playback didn't make it to the end of the movie
+	else if (g_movie_mode == MOVIE_PLAYING)
+	{
+		movie_print_results();
+	}
+
+	g_movie_mode = MOVIE_NONE;
+
+	SDL_UnlockMutex(g_movie_mutex);
+}
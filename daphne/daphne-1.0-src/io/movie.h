@@ -0,0 +1,50 @@
+/*
+ * movie.h
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// movie.h -- records the player's input against emulated time and plays it back exactly,
+//  so that the same session can be run over and over (for profiling and catching regressions)
+
+#ifndef MOVIE_H
+#define MOVIE_H
+
+#include <stdint.h>
+
+// Starts recording input to 'pszPath'.  Returns false if the file couldn't be created.
+bool movie_record_start(const char *pszPath);
+
+// Loads the movie in 'pszPath' and plays it back instead of taking input from the player.
+// Returns false if the movie couldn't be loaded.
+bool movie_play_start(const char *pszPath);
+
+// Called from input_enable/input_disable with the player's input.
+// Returns true if the movie has taken the input (to apply later or to ignore, because we're playing back),
+//  or false if the input should be applied right away as usual.
+bool movie_capture(bool bEnabled, uint8_t uSwitch);
+
+// Must be called by the cpu thread once every emulated millisecond.
+// This is where recorded input gets applied and where RAM is checked against the recording.
+void movie_think();
+
+// finishes the recording (or prints the playback results)
+void movie_stop();
+
+#endif // MOVIE_H
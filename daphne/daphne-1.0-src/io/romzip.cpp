@@ -0,0 +1,375 @@
+/*
+ * romzip.cpp
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// romzip.cpp
+
+#ifdef _WIN32
+#define _CRT_SECURE_NO_WARNINGS 1
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <zlib.h>
+#include "romzip.h"
+#include "mpo_fileio.h"
+
+// .ZIP signatures
+#define ZIP_LOCAL_HEADER_SIG 0x04034b50
+#define ZIP_CENTRAL_HEADER_SIG 0x02014b50
+#define ZIP_END_OF_CENTRAL_DIR_SIG 0x06054b50
+
+#define ZIP_LOCAL_HEADER_SIZE 30
+#define ZIP_CENTRAL_HEADER_SIZE 46
+#define ZIP_END_OF_CENTRAL_DIR_SIZE 22
+#define ZIP_MAX_COMMENT 0xFFFF
+
+// .ZIP files are always little endian
+static inline uint16_t zip_get16(const uint8_t *p)
+{
+	return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+static inline uint32_t zip_get32(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static string zip_lowercase(const string &s)
+{
+	string result = s;
+	for (unsigned int i = 0; i < result.size(); i++)
+	{
+		result[i] = (char) tolower((unsigned char) result[i]);
+	}
+	return result;
+}
+
+////////////////////////////////////////////////////////////
+
+rom_archive::rom_archive() :
+	m_pData(NULL),
+	m_uFileSize(0),
+	m_uTimeLastModified(0)
+{
+}
+
+rom_archive::~rom_archive()
+{
+	close();
+}
+
+bool rom_archive::open(const char *path)
+{
+	bool result = false;
+	mpo_io *io = NULL;
+
+	close();
+
+	io = mpo_open(path, MPO_OPEN_READONLY);
+	if (io)
+	{
+		// ROM archives are small, so the whole thing is read with one call instead of seeking around in it
+		if ((io->size >= ZIP_END_OF_CENTRAL_DIR_SIZE) && (io->size < 0x80000000))
+		{
+			MPO_BYTES_READ bytes_read = 0;
+
+			m_pData = (uint8_t *) malloc((size_t) io->size);
+			if (m_pData && mpo_read(m_pData, (size_t) io->size, &bytes_read, io) && (bytes_read == io->size))
+			{
+				m_uFileSize = io->size;
+				m_uTimeLastModified = io->time_last_modified;
+				result = parse_central_dir();
+			}
+		}
+		mpo_close(io);
+	}
+
+	if (!result)
+	{
+		close();
+	}
+
+	return result;
+}
+
+void rom_archive::close()
+{
+	free(m_pData);
+	m_pData = NULL;
+	m_uFileSize = 0;
+	m_uTimeLastModified = 0;
+	m_entries.clear();
+	m_mIndex.clear();
+}
+
+bool rom_archive::parse_central_dir()
+{
+	const uint8_t *end_of_dir = NULL;
+	uint64_t search_stop = 0;
+
+	// the end of central directory record is at the very end of the file, unless the archive has a comment
+	if (m_uFileSize > ZIP_END_OF_CENTRAL_DIR_SIZE + ZIP_MAX_COMMENT)
+	{
+		search_stop = m_uFileSize - (ZIP_END_OF_CENTRAL_DIR_SIZE + ZIP_MAX_COMMENT);
+	}
+	for (uint64_t pos = m_uFileSize - ZIP_END_OF_CENTRAL_DIR_SIZE + 1; pos-- > search_stop; )
+	{
+		if (zip_get32(m_pData + pos) == ZIP_END_OF_CENTRAL_DIR_SIG)
+		{
+			end_of_dir = m_pData + pos;
+			break;
+		}
+	}
+	if (!end_of_dir)
+	{
+		return false;
+	}
+
+	unsigned int entry_count = zip_get16(end_of_dir + 10);
+	uint64_t dir_size = zip_get32(end_of_dir + 12);
+	uint64_t dir_offset = zip_get32(end_of_dir + 16);
+
+	if (dir_offset + dir_size > (uint64_t) (end_of_dir - m_pData))
+	{
+		return false;
+	}
+
+	const uint8_t *p = m_pData + dir_offset;
+	const uint8_t *dir_end = p + dir_size;
+
+	m_entries.reserve(entry_count);
+	for (unsigned int i = 0; i < entry_count; i++)
+	{
+		if ((p + ZIP_CENTRAL_HEADER_SIZE > dir_end) || (zip_get32(p) != ZIP_CENTRAL_HEADER_SIG))
+		{
+			return false;
+		}
+
+		unsigned int name_len = zip_get16(p + 28);
+		unsigned int extra_len = zip_get16(p + 30);
+		unsigned int comment_len = zip_get16(p + 32);
+
+		if (p + ZIP_CENTRAL_HEADER_SIZE + name_len > dir_end)
+		{
+			return false;
+		}
+
+		rom_archive_entry entry;
+		entry.name.assign((const char *) p + ZIP_CENTRAL_HEADER_SIZE, name_len);
+		entry.method = zip_get16(p + 10);
+		entry.crc32 = zip_get32(p + 16);
+		entry.compressed_size = zip_get32(p + 20);
+		entry.uncompressed_size = zip_get32(p + 24);
+		entry.local_header_offset = zip_get32(p + 42);
+
+		// if a name is in the archive more than once, the first one wins (like unzLocateFile)
+		m_mIndex.insert(make_pair(zip_lowercase(entry.name), (unsigned int) m_entries.size()));
+		m_entries.push_back(entry);
+
+		p += ZIP_CENTRAL_HEADER_SIZE + name_len + extra_len + comment_len;
+	}
+
+	return true;
+}
+
+const rom_archive_entry *rom_archive::find(const char *filename) const
+{
+	map<string, unsigned int>::const_iterator mi = m_mIndex.find(zip_lowercase(filename));
+
+	if (mi == m_mIndex.end())
+	{
+		return NULL;
+	}
+	return &m_entries[mi->second];
+}
+
+uint32_t rom_archive::extract(const rom_archive_entry *entry, uint8_t *buf, uint32_t size) const
+{
+	uint64_t local = entry->local_header_offset;
+
+	if ((local + ZIP_LOCAL_HEADER_SIZE > m_uFileSize) || (zip_get32(m_pData + local) != ZIP_LOCAL_HEADER_SIG))
+	{
+		return 0;
+	}
+
+	// the local header has its own name and extra field lengths, which don't have to match the central directory's
+	uint64_t data_offset = local + ZIP_LOCAL_HEADER_SIZE + zip_get16(m_pData + local + 26) + zip_get16(m_pData + local + 28);
+
+	if (data_offset + entry->compressed_size > m_uFileSize)
+	{
+		return 0;
+	}
+
+	const uint8_t *data = m_pData + data_offset;
+
+	if (size > entry->uncompressed_size)
+	{
+		size = entry->uncompressed_size;
+	}
+
+	// stored
+	if (entry->method == 0)
+	{
+		if (size > entry->compressed_size)
+		{
+			size = entry->compressed_size;
+		}
+		memcpy(buf, data, size);
+		return size;
+	}
+
+	// deflated
+	else if (entry->method == Z_DEFLATED)
+	{
+		z_stream stream;
+		uint32_t result = 0;
+
+		memset(&stream, 0, sizeof(stream));
+		stream.next_in = (Bytef *) data;
+		stream.avail_in = entry->compressed_size;
+		stream.next_out = buf;
+		stream.avail_out = size;
+
+		// negative window bits means raw deflate data with no zlib header (which is what .ZIP files have)
+		if (inflateInit2(&stream, -MAX_WBITS) == Z_OK)
+		{
+			int err = inflate(&stream, Z_FINISH);
+
+			// Z_BUF_ERROR just means that we stopped early because only the start of the file was asked for
+			if ((err == Z_STREAM_END) || ((err == Z_BUF_ERROR) && (stream.avail_out == 0)))
+			{
+				result = (uint32_t) stream.total_out;
+			}
+			inflateEnd(&stream);
+		}
+		return result;
+	}
+
+	// anything else is too exotic for ROM archives
+	return 0;
+}
+
+////////////////////////////////////////////////////////////
+
+rom_crc_cache::rom_crc_cache() :
+	m_bDirty(false)
+{
+}
+
+void rom_crc_cache::load(const string &path)
+{
+	FILE *F = NULL;
+	char line[2048];
+
+	m_path = path;
+	m_mEntries.clear();
+	m_bDirty = false;
+
+	F = fopen(path.c_str(), "rt");
+	if (!F)
+	{
+		return;
+	}
+
+	// each line is : crc length file_size time_last_modified name
+	while (fgets(line, sizeof(line), F))
+	{
+		char *p = line;
+		crc_entry entry;
+
+		entry.crc = (uint32_t) strtoul(p, &p, 16);
+		entry.length = (uint32_t) strtoul(p, &p, 10);
+		entry.file_size = strtoull(p, &p, 10);
+		entry.time_last_modified = strtoull(p, &p, 10);
+
+		if (*p != ' ')
+		{
+			continue;	// damaged line
+		}
+
+		string name = p + 1;
+		while ((!name.empty()) && ((name[name.size() - 1] == '\n') || (name[name.size() - 1] == '\r')))
+		{
+			name.erase(name.size() - 1);
+		}
+		if (!name.empty())
+		{
+			m_mEntries[name] = entry;
+		}
+	}
+
+	fclose(F);
+}
+
+bool rom_crc_cache::save()
+{
+	FILE *F = NULL;
+
+	if (!m_bDirty)
+	{
+		return true;
+	}
+
+	F = fopen(m_path.c_str(), "wt");
+	if (!F)
+	{
+		return false;
+	}
+
+	for (map<string, crc_entry>::const_iterator mi = m_mEntries.begin(); mi != m_mEntries.end(); mi++)
+	{
+		fprintf(F, "%08x %u %llu %llu %s\n", mi->second.crc, mi->second.length,
+			(unsigned long long) mi->second.file_size, (unsigned long long) mi->second.time_last_modified,
+			mi->first.c_str());
+	}
+
+	fclose(F);
+	m_bDirty = false;
+	return true;
+}
+
+bool rom_crc_cache::lookup(const string &name, uint64_t file_size, uint64_t time_last_modified, uint32_t length, uint32_t &crc) const
+{
+	map<string, crc_entry>::const_iterator mi = m_mEntries.find(name);
+
+	if ((mi == m_mEntries.end()) || (mi->second.file_size != file_size) ||
+		(mi->second.time_last_modified != time_last_modified) || (mi->second.length != length))
+	{
+		return false;
+	}
+
+	crc = mi->second.crc;
+	return true;
+}
+
+void rom_crc_cache::store(const string &name, uint64_t file_size, uint64_t time_last_modified, uint32_t length, uint32_t crc)
+{
+	crc_entry entry;
+	entry.file_size = file_size;
+	entry.time_last_modified = time_last_modified;
+	entry.length = length;
+	entry.crc = crc;
+	m_mEntries[name] = entry;
+	m_bDirty = true;
+}
@@ -0,0 +1,112 @@
+/*
+ * romzip.h
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// romzip.h -- reads ROM images out of .ZIP archives, and remembers their CRC's between runs
+
+#ifndef ROMZIP_H
+#define ROMZIP_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+
+using namespace std;
+
+struct rom_archive_entry
+{
+	string name;	// name of the file inside the archive (including any directories)
+	uint16_t method;	// 0 = stored, 8 = deflated
+	uint32_t crc32;	// CRC32 of the uncompressed data, as recorded in the archive
+	uint32_t compressed_size;
+	uint32_t uncompressed_size;
+	uint32_t local_header_offset;	// where the file's local header starts in the archive
+};
+
+// A .ZIP archive that has been read into memory in one go.
+// The central directory is parsed up front, so finding a file costs nothing and extracting one
+//  never touches the disk, which means several files can be extracted at once from different threads.
+class rom_archive
+{
+public:
+	rom_archive();
+	~rom_archive();
+
+	// reads the archive at 'path' into memory and parses its central directory
+	// returns false if the file can't be read or isn't a .ZIP archive we understand
+	bool open(const char *path);
+	void close();
+
+	// finds 'filename' in the archive (ignoring case), returns NULL if it isn't there
+	const rom_archive_entry *find(const char *filename) const;
+
+	// extracts up to 'size' bytes from the beginning of 'entry' into 'buf'
+	// returns the number of bytes extracted, or 0 if the data is damaged
+	// (safe to call from several threads at once)
+	uint32_t extract(const rom_archive_entry *entry, uint8_t *buf, uint32_t size) const;
+
+	uint64_t get_file_size() const { return m_uFileSize; }
+	uint64_t get_time_last_modified() const { return m_uTimeLastModified; }
+
+private:
+	bool parse_central_dir();
+
+	uint8_t *m_pData;	// the whole archive
+	uint64_t m_uFileSize;
+	uint64_t m_uTimeLastModified;
+	vector<rom_archive_entry> m_entries;
+	map<string, unsigned int> m_mIndex;	// lowercase name -> index into m_entries
+};
+
+// Remembers the CRC32 of ROM images from one run to the next, so that unchanged ROMs don't have to be hashed again.
+// An entry is only trusted if the file it came from still has the same size and modification time.
+class rom_crc_cache
+{
+public:
+	rom_crc_cache();
+
+	// loads the cache from 'path' (a missing file is the same as an empty cache)
+	void load(const string &path);
+
+	// writes the cache back out if anything has been added to it, returns false on error
+	bool save();
+
+	// 'name' identifies the ROM (its path, or archive path + "/" + member name), 'file_size' and 'time_last_modified'
+	//  describe the file that the ROM was read from, 'length' is how many bytes of the ROM were hashed
+	bool lookup(const string &name, uint64_t file_size, uint64_t time_last_modified, uint32_t length, uint32_t &crc) const;
+	void store(const string &name, uint64_t file_size, uint64_t time_last_modified, uint32_t length, uint32_t crc);
+
+private:
+	struct crc_entry
+	{
+		uint64_t file_size;
+		uint64_t time_last_modified;
+		uint32_t length;
+		uint32_t crc;
+	};
+
+	string m_path;
+	map<string, crc_entry> m_mEntries;
+	bool m_bDirty;	// whether anything needs to be saved
+};
+
+#endif // ROMZIP_H
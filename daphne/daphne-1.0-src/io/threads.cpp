@@ -0,0 +1,381 @@
+/*
+ * threads.cpp
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// threads.cpp -- pins our busy threads to chosen cores and raises their scheduling priority, if asked to
+
+// The cpu thread, the VLDP decoder and the frontend's retro_run all keep themselves busy and pace themselves with
+//  short sleeps, so on a machine with few cores they end up fighting each other (and everything else) for cpu time,
+//  and the scheduler moves them from core to core while they do.  This lets each one be given a core (or a set of
+//  cores) of its own and a realtime policy or a better nice level.
+// Realtime policies usually need root (or CAP_SYS_NICE, or an rtprio limit in /etc/security/limits.conf), so if
+//  they can't be had, we fall back to the best nice level that RLIMIT_NICE allows and say so in the log.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "threads.h"
+#include "conout.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <errno.h>
+#endif
+
+enum
+{
+	THREAD_POLICY_NONE,	// leave the scheduling policy alone
+	THREAD_POLICY_FIFO,
+	THREAD_POLICY_RR,
+	THREAD_POLICY_NICE
+};
+
+struct thread_config
+{
+	const char *name;
+	bool bConfigured;
+	uint64_t u64Cores;	// bit N set means core N may be used (0 = leave the placement alone)
+	unsigned int uPolicy;	// THREAD_POLICY_ value
+	int iPriority;	// realtime priority, or nice level for THREAD_POLICY_NICE
+};
+
+static thread_config g_thread_configs[] =
+{
+	{ "cpu", false, 0, THREAD_POLICY_NONE, 0 },
+	{ "vldp", false, 0, THREAD_POLICY_NONE, 0 },
+	{ "frontend", false, 0, THREAD_POLICY_NONE, 0 }
+};
+
+static const unsigned int THREAD_CONFIG_COUNT = sizeof(g_thread_configs) / sizeof(g_thread_configs[0]);
+
+// the most cores that we can keep track of (one per bit of u64Cores)
+static const unsigned int THREAD_MAX_CORES = 64;
+
+static thread_config *find_thread_config(const char *pszName)
+{
+	for (unsigned int u = 0; u < THREAD_CONFIG_COUNT; u++)
+	{
+		if (strcmp(g_thread_configs[u].name, pszName) == 0)
+		{
+			return &g_thread_configs[u];
+		}
+	}
+	return NULL;
+}
+
+// parses a comma separated list of cores (or 'any') into a bitmask, returns false if it can't
+static bool parse_cores(const char *pszCores, uint64_t &u64Cores)
+{
+	u64Cores = 0;
+	if (strcmp(pszCores, "any") == 0)
+	{
+		return true;
+	}
+
+	const char *p = pszCores;
+	for (;;)
+	{
+		char *pEnd = NULL;
+		unsigned long uCore = strtoul(p, &pEnd, 10);
+		if ((pEnd == p) || (uCore >= THREAD_MAX_CORES))
+		{
+			return false;
+		}
+		u64Cores |= ((uint64_t) 1) << uCore;
+
+		if (*pEnd == 0)
+		{
+			break;
+		}
+		if (*pEnd != ',')
+		{
+			return false;
+		}
+		p = pEnd + 1;
+	}
+	return true;
+}
+
+bool threads_parse_option(const char *pszSpec)
+{
+	char s[81];
+	char *pszFields[4] = { NULL, NULL, NULL, NULL };
+	unsigned int uFields = 0;
+	bool bValid = true;
+
+	strncpy(s, pszSpec, sizeof(s) - 1);
+	s[sizeof(s) - 1] = 0;
+
+	// split on colons
+	char *p = s;
+	while (p && (uFields < 4))
+	{
+		pszFields[uFields++] = p;
+		p = strchr(p, ':');
+		if (p)
+		{
+			*p = 0;
+			p++;
+		}
+	}
+
+	thread_config *pConfig = find_thread_config(pszFields[0]);
+	thread_config cfg = { NULL, true, 0, THREAD_POLICY_NONE, 0 };
+
+	// if there was a fifth field, or there were not at least two
+	if (p || (uFields < 2))
+	{
+		bValid = false;
+	}
+	else if (!pConfig)
+	{
+		outstr("-thread: unknown thread ");
+		outstr(pszFields[0]);
+		printline(" (try cpu, vldp or frontend)");
+		return false;
+	}
+	else if (!parse_cores(pszFields[1], cfg.u64Cores))
+	{
+		bValid = false;
+	}
+	else if (uFields >= 3)
+	{
+		if (strcmp(pszFields[2], "fifo") == 0)
+		{
+			cfg.uPolicy = THREAD_POLICY_FIFO;
+			cfg.iPriority = 1;
+		}
+		else if (strcmp(pszFields[2], "rr") == 0)
+		{
+			cfg.uPolicy = THREAD_POLICY_RR;
+			cfg.iPriority = 1;
+		}
+		else if (strcmp(pszFields[2], "nice") == 0)
+		{
+			cfg.uPolicy = THREAD_POLICY_NICE;
+			cfg.iPriority = -5;
+		}
+		else
+		{
+			bValid = false;
+		}
+
+		if (bValid && (uFields == 4))
+		{
+			char *pEnd = NULL;
+			cfg.iPriority = (int) strtol(pszFields[3], &pEnd, 10);
+			if ((pEnd == pszFields[3]) || (*pEnd != 0))
+			{
+				bValid = false;
+			}
+		}
+	}
+
+	if (!bValid)
+	{
+		outstr("-thread: could not understand ");
+		outstr(pszSpec);
+		printline(" (it should look like cpu:2:fifo:10)");
+		return false;
+	}
+
+	cfg.name = pConfig->name;
+	*pConfig = cfg;
+	return true;
+}
+
+#if defined(__linux__)
+
+// the nice level that the calling thread is allowed to lower itself to without any special permission
+// (RLIMIT_NICE allows down to 20 - rlim_cur, but a thread can always stay where it already is)
+static int lowest_permitted_nice()
+{
+	pid_t tid = (pid_t) syscall(SYS_gettid);
+	struct rlimit rl;
+	int iResult = 0;
+
+	errno = 0;
+	iResult = getpriority(PRIO_PROCESS, tid);	// (-1 is a legal nice level, errno tells us if it failed)
+	if (errno != 0)
+	{
+		iResult = 0;
+	}
+
+	if (getrlimit(RLIMIT_NICE, &rl) == 0)
+	{
+		if (rl.rlim_cur == RLIM_INFINITY)
+		{
+			iResult = -20;
+		}
+		else if ((rl.rlim_cur <= 40) && ((20 - (int) rl.rlim_cur) < iResult))
+		{
+			iResult = 20 - (int) rl.rlim_cur;
+		}
+	}
+	return iResult;
+}
+
+// sets the nice level of the calling thread (on linux, each thread has its own), returns false if we weren't allowed
+static bool set_thread_nice(int iNice)
+{
+	pid_t tid = (pid_t) syscall(SYS_gettid);
+	return (setpriority(PRIO_PROCESS, tid, iNice) == 0);
+}
+
+static void apply_affinity(const thread_config *pConfig)
+{
+	long lCores = sysconf(_SC_NPROCESSORS_CONF);
+	cpu_set_t set;
+	CPU_ZERO(&set);
+
+	for (unsigned int u = 0; u < THREAD_MAX_CORES; u++)
+	{
+		if (pConfig->u64Cores & (((uint64_t) 1) << u))
+		{
+			if ((lCores > 0) && (u >= (unsigned int) lCores))
+			{
+				LOGF(LOGLEVEL_WARNING, "THREADS : %s thread can't use core %u, there are only %ld cores", pConfig->name, u, lCores);
+				continue;
+			}
+			CPU_SET(u, &set);
+		}
+	}
+
+	if (CPU_COUNT(&set) == 0)
+	{
+		LOGF(LOGLEVEL_WARNING, "THREADS : %s thread was left where it was, none of its cores exist", pConfig->name);
+		return;
+	}
+
+	int iErr = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+	if (iErr != 0)
+	{
+		LOGF(LOGLEVEL_WARNING, "THREADS : %s thread could not be pinned (%s), it can still run on any core", pConfig->name, strerror(iErr));
+		return;
+	}
+
+	char s[THREAD_MAX_CORES * 3 + 1] = "";
+	for (unsigned int u = 0; u < THREAD_MAX_CORES; u++)
+	{
+		if (CPU_ISSET(u, &set))
+		{
+			char sCore[5];
+			snprintf(sCore, sizeof(sCore), s[0] ? ",%u" : "%u", u);
+			strcat(s, sCore);
+		}
+	}
+	LOGF(LOGLEVEL_INFO, "THREADS : %s thread pinned to core(s) %s", pConfig->name, s);
+}
+
+static void apply_policy(const thread_config *pConfig)
+{
+	if (pConfig->uPolicy == THREAD_POLICY_NICE)
+	{
+		if (set_thread_nice(pConfig->iPriority))
+		{
+			LOGF(LOGLEVEL_INFO, "THREADS : %s thread running at nice %d", pConfig->name, pConfig->iPriority);
+		}
+		else
+		{
+			int iErr = errno;	// (lowest_permitted_nice changes errno)
+			LOGF(LOGLEVEL_WARNING, "THREADS : %s thread could not be set to nice %d (%s), the lowest allowed is %d",
+				pConfig->name, pConfig->iPriority, strerror(iErr), lowest_permitted_nice());
+		}
+		return;
+	}
+
+	int iPolicy = (pConfig->uPolicy == THREAD_POLICY_FIFO) ? SCHED_FIFO : SCHED_RR;
+	const char *pszPolicy = (iPolicy == SCHED_FIFO) ? "SCHED_FIFO" : "SCHED_RR";
+	int iMin = sched_get_priority_min(iPolicy);
+	int iMax = sched_get_priority_max(iPolicy);
+	struct sched_param param;
+	memset(&param, 0, sizeof(param));
+	param.sched_priority = pConfig->iPriority;
+
+	if (param.sched_priority < iMin)
+	{
+		param.sched_priority = iMin;
+	}
+	else if (param.sched_priority > iMax)
+	{
+		param.sched_priority = iMax;
+	}
+	if (param.sched_priority != pConfig->iPriority)
+	{
+		LOGF(LOGLEVEL_WARNING, "THREADS : %s priority must be between %d and %d, using %d", pszPolicy, iMin, iMax, param.sched_priority);
+	}
+
+	int iErr = pthread_setschedparam(pthread_self(), iPolicy, &param);
+	if (iErr == 0)
+	{
+		LOGF(LOGLEVEL_INFO, "THREADS : %s thread running as %s priority %d", pConfig->name, pszPolicy, param.sched_priority);
+		return;
+	}
+
+	// no realtime for us, so get as close as we're allowed to with the nice level instead
+	int iNice = lowest_permitted_nice();
+	if ((iNice < 0) && set_thread_nice(iNice))
+	{
+		LOGF(LOGLEVEL_WARNING, "THREADS : %s thread could not get %s (%s), falling back to nice %d",
+			pConfig->name, pszPolicy, strerror(iErr), iNice);
+	}
+	else
+	{
+		LOGF(LOGLEVEL_WARNING, "THREADS : %s thread could not get %s (%s) or a better nice level, leaving it as it was",
+			pConfig->name, pszPolicy, strerror(iErr));
+	}
+}
+
+void threads_setup(const char *pszName)
+{
+	const thread_config *pConfig = find_thread_config(pszName);
+	if (!pConfig || !pConfig->bConfigured)
+	{
+		return;
+	}
+
+	if (pConfig->u64Cores != 0)
+	{
+		apply_affinity(pConfig);
+	}
+	if (pConfig->uPolicy != THREAD_POLICY_NONE)
+	{
+		apply_policy(pConfig);
+	}
+}
+
+#else
+
+void threads_setup(const char *pszName)
+{
+	const thread_config *pConfig = find_thread_config(pszName);
+	if (pConfig && pConfig->bConfigured)
+	{
+		LOGF(LOGLEVEL_WARNING, "THREADS : thread placement isn't supported on this platform, %s thread left as it was", pszName);
+	}
+}
+
+#endif
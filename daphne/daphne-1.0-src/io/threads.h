@@ -0,0 +1,44 @@
+/*
+ * threads.h
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// threads.h -- pins our busy threads to chosen cores and raises their scheduling priority, if asked to
+
+#ifndef THREADS_H
+#define THREADS_H
+
+// Parses one -thread option, which looks like:
+//  <name>:<cores>[:fifo|rr|nice[:<priority>]]
+// <name> is cpu (the thread that runs the emulated cpus), vldp (the mpeg decoder) or frontend (retro_run),
+// <cores> is a comma separated list of core numbers (starting at 0) or 'any' to leave the placement alone,
+// fifo and rr ask for SCHED_FIFO/SCHED_RR at <priority> (default 1), and nice sets the nice level to <priority>
+//  (default -5).
+// For example, "cpu:2:fifo:10" or "vldp:3:nice:-10".
+// Returns false (and prints why) if the option is not understood.
+bool threads_parse_option(const char *pszSpec);
+
+// Must be called by each of the named threads as soon as it starts (from the thread itself).
+// Applies whatever was asked for with -thread, logging what was done and what had to be fallen back on
+//  (for example, a nice level because there was no permission for a realtime policy).
+// Does nothing if nothing was asked for 'pszName'.
+void threads_setup(const char *pszName);
+
+#endif // THREADS_H
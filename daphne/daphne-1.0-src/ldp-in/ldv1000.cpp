@@ -267,11 +267,7 @@ void write_ldv1000 (unsigned char value)
 			clear();
 			g_ldp->pre_play();
 			g_ldv1000_output = 0x54;	// autostop is active
-			{
-				char s[81];
-				sprintf(s, "LDV1000 : Auto-Stop requested at frame %u", g_ldv1000_autostop_frame);
-				printline(s);
-			}
+			LOGF(LOGLEVEL_INFO, "LDV1000 : Auto-Stop requested at frame %u", g_ldv1000_autostop_frame);
 			break;
 		case 0xFD:	// Play
 			g_ldp->pre_play();
@@ -414,8 +410,7 @@ void write_ldv1000 (unsigned char value)
 			g_ldv1000_output |= 0x80;	// set highbit just in case
 			break;
 		default:	// Unsupported Command
-			sprintf(s,"Unsupported LD-V1000 Command Received: %x", value);
-			printline(s);
+			LOGF_LIMITED(LOGLEVEL_WARNING, 1000, "Unsupported LD-V1000 Command Received: %x", value);
 			break;
 		}
 	}
@@ -47,11 +47,24 @@
 #include <vorbis/codec.h>		// OGG VORBIS specific headers
 #include <vorbis/vorbisfile.h>
 
+#include <vector>
+#include <set>
+#include <algorithm>
+
 // how much uncompressed audio we deal with at a time
 #define AUDIO_BUF_CHUNK	4096
 
-// Macros to lock and unlock the mutex for the audio to make sure we aren't playing audio while
-// we are loading or seeking
+// size of the ring that holds decoded audio (in bytes, must be a power of 2)
+#define AUDIO_RING_SIZE 131072
+
+// how far ahead of the mixer the decoder thread tries to stay (about 400 ms)
+#define AUDIO_DECODE_AHEAD ((AUDIO_FREQ * AUDIO_BYTES_PER_SAMPLE * 2) / 5)
+
+// how long the decoder thread sleeps when it has nothing to do (it also gets woken up when needed)
+#define AUDIO_DECODER_IDLE_MS 5
+
+// Macros to lock and unlock the mutex that protects the ogg stream, to make sure the decoder thread
+// isn't decoding audio while we are loading or seeking.  The audio callback never takes this lock.
 #define OGG_LOCK	SDL_mutexP(g_ogg_mutex)
 #define OGG_UNLOCK	SDL_mutexV(g_ogg_mutex)
 
@@ -61,19 +74,38 @@ typedef void *(*audiocopyproc)(void *dest, const void *src, size_t bytes_to_copy
 audiocopyproc paudiocopy = memcpy;	// pointer to the audio copy procedure (defaults to memcpy)
 
 SDL_mutex *g_ogg_mutex = NULL;
+SDL_cond *g_ogg_cond = NULL;	// wakes up the decoder thread
+SDL_Thread *g_decoder_thread = NULL;
 mpo_io *g_pIOAudioHandle = NULL;
 OggVorbis_File s_ogg;
 
 uint32_t g_audio_filesize = 0;	// total size of the audio stream
 uint32_t g_audio_filepos = 0;	// the position in the file of our audio stream
 uint8_t *g_big_buf = NULL;	// holds entire Ogg stream in RAM :)
-bool g_audio_ready = false;	// whether audio is ready to be parsed
-bool g_audio_playing = false;	// whether the audio is to be playing or not
+SDL_atomic_t g_audio_ready;	// whether audio is ready to be parsed
+SDL_atomic_t g_audio_playing;	// whether the audio is to be playing or not
+SDL_atomic_t g_decoder_quit;	// tells the decoder thread to exit
+SDL_atomic_t g_decoder_eof;	// 1 if the decoder reached the end of the stream, -1 if it got an error
 uint32_t g_playing_timer = 0;	// the time at which we began playing audio
-uint32_t g_samples_played = 0;	// how many samples have played since we've been timing
+SDL_atomic_t g_play_count;	// incremented every time we start playing (so the audio callback can restart its timing)
+uint32_t g_samples_played = 0;	// how many samples have played since we've been timing (only used by the audio callback)
 bool g_audio_left_muted = false;	// left audio channel enabled
 bool g_audio_right_muted = false;	// right audio channel enabled
 
+// The decoded audio ring.  The decoder thread is the only writer and the audio callback is the only reader,
+//  so the positions are all that needs to be shared.  The positions are byte counts that are allowed to wrap.
+uint8_t g_ring[AUDIO_RING_SIZE];
+SDL_atomic_t g_ring_write;	// how many bytes the decoder thread has written
+SDL_atomic_t g_ring_read;	// how many bytes the audio callback has read
+
+// When we seek, everything in the ring before g_flush_pos is stale and must be thrown away.
+// Only the audio callback may move g_ring_read, so it does this once it sees g_flush_count change.
+SDL_atomic_t g_flush_pos;
+SDL_atomic_t g_flush_count;
+int g_last_flush_count = 0;	// the last g_flush_count that the audio callback has seen
+bool g_awaiting_refill = false;	// whether the audio callback has flushed the ring and not gotten any new audio since
+int g_last_play_count = 0;	// the last g_play_count that the audio callback has seen
+
 ///////////////////////////////////////////////////////////////////////////////////
 
 // resets mm states
@@ -172,6 +204,401 @@ long mmtell (void *datasource)
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// SEEK INDEX
+// ov_pcm_seek has to bisect the stream to find the right page every time we seek, so instead we keep a table
+//  of where each page is and what sample it ends on.  Then we only have to decode the pre-roll.
+// The table is cached next to the .ogg file (foo.ogg -> foo.idx) so it only gets built once.
+
+// one entry in the seek index
+struct ogg_index_entry
+{
+	uint64_t u64Granule;	// the position of the last sample that is finished on this page
+	uint32_t uOffset;	// where the page starts in the stream
+	uint32_t uReserved;	// (padding, so the cache file layout is the same everywhere)
+};
+
+// header of the seek index cache file
+struct ogg_index_header
+{
+	char magic[4];	// OGG_INDEX_MAGIC
+	uint32_t uVersion;	// OGG_INDEX_VERSION
+	uint32_t uOggSize;	// size of the .ogg file this index belongs to (so we can tell if it's stale)
+	uint32_t uCount;	// how many entries follow
+	uint64_t u64OggModified;	// when the .ogg file was last modified (mpo_io::time_last_modified), also to tell if it's stale
+};
+
+#define OGG_INDEX_MAGIC "OIDX"
+#define OGG_INDEX_VERSION 2
+
+vector<ogg_index_entry> g_ogg_index;	// seek index for the stream that is open
+
+// for sorting/searching the seek index by sample position
+static bool audio_index_less(const ogg_index_entry &a, const ogg_index_entry &b)
+{
+	return a.u64Granule < b.u64Granule;
+}
+
+// builds the seek index by walking the ogg pages in g_big_buf (no decoding required)
+static void audio_index_scan()
+{
+	uint32_t uPos = 0;
+	uint32_t uSerial = 0;
+	bool bGotSerial = false;
+
+	g_ogg_index.clear();
+
+	// while there is room for a page header
+	while (uPos + 27 <= g_audio_filesize)
+	{
+		const uint8_t *p = g_big_buf + uPos;
+		uint32_t uPageSize = 27 + p[26];
+		uint64_t u64Granule = 0;
+		uint32_t uPageSerial = p[14] | (p[15] << 8) | (p[16] << 16) | ((uint32_t) p[17] << 24);
+
+		// if the stream is damaged or truncated, we'll just have a partial index (seeks past it use ov_pcm_seek)
+		if ((memcmp(p, "OggS", 4) != 0) || (uPageSize > g_audio_filesize - uPos))
+			break;
+
+		for (unsigned int i = 0; i < p[26]; i++)
+			uPageSize += p[27 + i];	// add up the segment table
+
+		// the page's segments have to fit in what's left of the stream too
+		if (uPageSize > g_audio_filesize - uPos)
+			break;
+
+		for (int i = 7; i >= 0; i--)
+			u64Granule = (u64Granule << 8) | p[6 + i];	// granule position is little endian
+
+		if (!bGotSerial)
+		{
+			uSerial = uPageSerial;
+			bGotSerial = true;
+		}
+
+		// pages that don't finish a packet have a granule position of -1, and the header pages have 0
+		if ((uPageSerial == uSerial) && (u64Granule != (uint64_t) -1) && (u64Granule != 0))
+		{
+			ogg_index_entry entry = { u64Granule, uPos, 0 };
+			g_ogg_index.push_back(entry);
+		}
+
+		uPos += uPageSize;
+	}
+}
+
+// returns true if every entry in the seek index points to a page header inside the open stream,
+//  and the entries are in order (so a damaged cache file can't send us outside g_big_buf)
+static bool audio_index_is_sane()
+{
+	for (size_t i = 0; i < g_ogg_index.size(); i++)
+	{
+		if ((g_ogg_index[i].uOffset > g_audio_filesize - 27) ||
+			((i > 0) && (g_ogg_index[i].u64Granule < g_ogg_index[i - 1].u64Granule)))
+			return false;
+	}
+	return true;
+}
+
+// tries to load the seek index from 'strIdxPath', returns true if it exists and matches the open stream
+static bool audio_index_load(const string &strIdxPath)
+{
+	bool result = false;
+	mpo_io *io = mpo_open(strIdxPath.c_str(), MPO_OPEN_READONLY);
+
+	if (io)
+	{
+		ogg_index_header hdr;
+		MPO_BYTES_READ bytes_read = 0;
+
+		if (mpo_read(&hdr, sizeof(hdr), &bytes_read, io) && (bytes_read == sizeof(hdr)) &&
+			(memcmp(hdr.magic, OGG_INDEX_MAGIC, 4) == 0) && (hdr.uVersion == OGG_INDEX_VERSION) &&
+			(hdr.uOggSize == g_audio_filesize) && (hdr.u64OggModified == g_pIOAudioHandle->time_last_modified) &&
+			(g_audio_filesize >= 27) && (io->size == sizeof(hdr) + ((uint64_t) hdr.uCount * sizeof(ogg_index_entry))))
+		{
+			g_ogg_index.resize(hdr.uCount);
+			if ((hdr.uCount == 0) ||
+				(mpo_read(&g_ogg_index[0], hdr.uCount * sizeof(ogg_index_entry), &bytes_read, io) &&
+				(bytes_read == hdr.uCount * sizeof(ogg_index_entry))) && audio_index_is_sane())
+				result = true;
+			else
+				g_ogg_index.clear();
+		}
+		mpo_close(io);
+	}
+
+	return result;
+}
+
+// saves the seek index to 'strIdxPath' (if we can't, we'll just have to build it again next time)
+static void audio_index_save(const string &strIdxPath)
+{
+	mpo_io *io = mpo_open(strIdxPath.c_str(), MPO_OPEN_CREATE);
+
+	if (io)
+	{
+		ogg_index_header hdr;
+		memcpy(hdr.magic, OGG_INDEX_MAGIC, 4);
+		hdr.uVersion = OGG_INDEX_VERSION;
+		hdr.uOggSize = g_audio_filesize;
+		hdr.u64OggModified = g_pIOAudioHandle->time_last_modified;
+		hdr.uCount = (uint32_t) g_ogg_index.size();
+
+		mpo_write(&hdr, sizeof(hdr), NULL, io);
+		if (hdr.uCount)
+			mpo_write(&g_ogg_index[0], hdr.uCount * sizeof(ogg_index_entry), NULL, io);
+		mpo_close(io);
+	}
+	else
+		printline("ldp-vldp-audio.cpp: could not save the audio seek index (it will be rebuilt next time)");
+}
+
+// seeks to 'u64Samples' using the seek index (must be called with OGG_LOCK held)
+// returns false if the index couldn't be used, in which case the caller should use ov_pcm_seek instead
+static bool audio_index_seek(uint64_t u64Samples)
+{
+	static char discard_buf[AUDIO_BUF_CHUNK];
+	ogg_index_entry target = { u64Samples, 0, 0 };
+	vector<ogg_index_entry>::iterator it;
+	ogg_int64_t s64Pos = 0;
+
+	// find the first page that ends after our target sample (our sample is on that page)
+	it = upper_bound(g_ogg_index.begin(), g_ogg_index.end(), target, audio_index_less);
+
+	// We start on the page before it, because the first packet after a raw seek only primes the decoder,
+	//  so decoding starts somewhere on that page.  Near the very beginning, ov_pcm_seek is just as fast.
+	if ((it - g_ogg_index.begin()) < 2)
+		return false;
+	--it;
+
+	if (ov_raw_seek(&s_ogg, it->uOffset) != 0)
+		return false;
+
+	// decode the pre-roll until we reach the sample we want
+	while ((s64Pos = ov_pcm_tell(&s_ogg)) < (ogg_int64_t) u64Samples)
+	{
+		int nop;
+		uint64_t u64Bytes = (u64Samples - s64Pos) * AUDIO_BYTES_PER_SAMPLE;
+		long bytes_read = ov_read(&s_ogg, discard_buf,
+			(u64Bytes < AUDIO_BUF_CHUNK) ? (int) u64Bytes : AUDIO_BUF_CHUNK, 0, 2, 1, &nop);
+
+		if (bytes_read <= 0)
+			return false;
+	}
+
+	// if the raw seek put us past our sample (the index must be wrong), let ov_pcm_seek handle it
+	return (s64Pos == (ogg_int64_t) u64Samples);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// PCM CACHE (optional, see -audio_cache)
+// Decodes every audio track ahead of time (on a few background threads) so that when a track is played,
+//  we just copy samples and a seek is nothing more than changing our position.
+
+// how many threads decode audio tracks for the cache
+#define PCM_CACHE_THREADS 3
+
+enum
+{
+	PCM_CACHE_PENDING,	// waiting to be decoded
+	PCM_CACHE_BUSY,	// being decoded right now
+	PCM_CACHE_READY,	// pPCM holds the entire track
+	PCM_CACHE_FAILED	// couldn't be decoded (or didn't fit in our budget)
+};
+
+struct pcm_cache_entry
+{
+	string strPath;	// full path of the .ogg file
+	SDL_atomic_t state;	// one of the PCM_CACHE_ enums
+	uint8_t *pPCM;	// the decoded audio (16-bit stereo)
+	uint32_t uBytes;	// size of pPCM
+};
+
+// an .ogg file that is held in RAM (so the cache threads don't interfere with the mm* functions)
+struct pcm_cache_source
+{
+	uint8_t *pBuf;
+	uint32_t uSize;
+	uint32_t uPos;
+};
+
+vector<pcm_cache_entry *> g_pcm_cache;	// doesn't change while the cache threads are running
+SDL_Thread *g_pcm_cache_threads[PCM_CACHE_THREADS] = { NULL };
+SDL_atomic_t g_pcm_cache_next;	// index of the next entry that a cache thread should decode
+SDL_atomic_t g_pcm_cache_kb_left;	// how much of our budget is left (in kilobytes)
+SDL_atomic_t g_pcm_cache_quit;	// tells the cache threads to give up
+
+// the track that is being played out of the cache (NULL if we are decoding the .ogg as we go)
+// Only touched with OGG_LOCK held.
+const uint8_t *g_pcm_src = NULL;
+uint32_t g_pcm_src_bytes = 0;
+uint32_t g_pcm_src_pos = 0;
+
+static size_t pcm_cache_read(void *ptr, size_t size, size_t nmemb, void *datasource)
+{
+	pcm_cache_source *src = (pcm_cache_source *) datasource;
+	size_t bytes_to_read = size * nmemb;
+
+	if (bytes_to_read > src->uSize - src->uPos)
+		bytes_to_read = src->uSize - src->uPos;
+	memcpy(ptr, src->pBuf + src->uPos, bytes_to_read);
+	src->uPos += (uint32_t) bytes_to_read;
+	return bytes_to_read;
+}
+
+static int pcm_cache_seek(void *datasource, int64_t offset, int whence)
+{
+	pcm_cache_source *src = (pcm_cache_source *) datasource;
+	int64_t pos = offset;
+
+	if (whence == SEEK_CUR)
+		pos += src->uPos;
+	else if (whence == SEEK_END)
+		pos += src->uSize;
+
+	if ((pos < 0) || (pos > src->uSize))
+		return -1;
+	src->uPos = (uint32_t) pos;
+	return 0;
+}
+
+static long pcm_cache_tell(void *datasource)
+{
+	return ((pcm_cache_source *) datasource)->uPos;
+}
+
+// takes 'uKB' out of the budget, returns false if there isn't enough left
+static bool pcm_cache_reserve(int iKB)
+{
+	int iLeft;
+
+	do
+	{
+		iLeft = SDL_AtomicGet(&g_pcm_cache_kb_left);
+		if (iLeft < iKB)
+			return false;
+	} while (!SDL_AtomicCAS(&g_pcm_cache_kb_left, iLeft, iLeft - iKB));
+
+	return true;
+}
+
+// decodes one .ogg file into 'entry', returns true on success
+static bool pcm_cache_decode(pcm_cache_entry *entry)
+{
+	bool result = false;
+	pcm_cache_source src = { NULL, 0, 0 };
+	ov_callbacks callbacks = { pcm_cache_read, pcm_cache_seek, NULL, pcm_cache_tell };
+	OggVorbis_File vf;
+	MPO_BYTES_READ bytes_read = 0;
+	bool bReadAll = false;
+	mpo_io *io = mpo_open(entry->strPath.c_str(), MPO_OPEN_READONLY);
+
+	if (!io)
+		return false;
+
+	src.uSize = static_cast<uint32_t>(io->size & 0xFFFFFFFF);
+	src.pBuf = new uint8_t[src.uSize];
+	bReadAll = mpo_read(src.pBuf, src.uSize, &bytes_read, io) && (bytes_read == src.uSize);
+	mpo_close(io);
+
+	// if we couldn't read the whole file, leave it out of the cache rather than decode garbage
+	if (bReadAll && (ov_open_callbacks(&src, &vf, NULL, 0, callbacks) == 0))
+	{
+		vorbis_info *info = ov_info(&vf, -1);
+		ogg_int64_t s64Samples = ov_pcm_total(&vf, -1);
+		uint64_t u64Bytes = (uint64_t) s64Samples * AUDIO_BYTES_PER_SAMPLE;
+		int iKB = (int) ((u64Bytes + 1023) / 1024);
+
+		// same requirements as open_audio_stream, and it has to fit in our budget
+		if ((info->channels == 2) && (info->rate == 44100) && (s64Samples > 0) &&
+			(u64Bytes < 0x80000000) && pcm_cache_reserve(iKB))
+		{
+			entry->pPCM = (uint8_t *) malloc((size_t) u64Bytes);
+			entry->uBytes = 0;
+
+			if (entry->pPCM)
+			{
+				while ((entry->uBytes < u64Bytes) && !SDL_AtomicGet(&g_pcm_cache_quit))
+				{
+					int nop;
+					uint32_t uChunk = (uint32_t) u64Bytes - entry->uBytes;
+					long bytes_read = ov_read(&vf, (char *) entry->pPCM + entry->uBytes,
+						(uChunk < AUDIO_BUF_CHUNK) ? uChunk : AUDIO_BUF_CHUNK, 0, 2, 1, &nop);
+
+					if (bytes_read <= 0)
+						break;
+					entry->uBytes += (uint32_t) bytes_read;
+				}
+
+				result = (entry->uBytes == u64Bytes);
+				if (!result)
+				{
+					free(entry->pPCM);
+					entry->pPCM = NULL;
+				}
+			}
+
+			if (!result)
+				SDL_AtomicAdd(&g_pcm_cache_kb_left, iKB);	// give the memory back to the budget
+		}
+		ov_clear(&vf);
+	}
+
+	delete [] src.pBuf;
+	return result;
+}
+
+// a cache thread; they take turns grabbing the next file that needs to be decoded
+static int pcm_cache_thread(void *unused)
+{
+	unsigned int uIdx;
+
+	while (!SDL_AtomicGet(&g_pcm_cache_quit) &&
+		((uIdx = (unsigned int) SDL_AtomicAdd(&g_pcm_cache_next, 1)) < g_pcm_cache.size()))
+	{
+		pcm_cache_entry *entry = g_pcm_cache[uIdx];
+
+		SDL_AtomicSet(&entry->state, PCM_CACHE_BUSY);
+		SDL_AtomicSet(&entry->state, pcm_cache_decode(entry) ? PCM_CACHE_READY : PCM_CACHE_FAILED);
+	}
+
+	return 0;
+}
+
+// returns the cache entry for 'strPath' if it has been decoded, or NULL if it hasn't
+static pcm_cache_entry *pcm_cache_find(const string &strPath)
+{
+	for (vector<pcm_cache_entry *>::iterator it = g_pcm_cache.begin(); it != g_pcm_cache.end(); ++it)
+	{
+		if (((*it)->strPath == strPath) && (SDL_AtomicGet(&(*it)->state) == PCM_CACHE_READY))
+			return *it;
+	}
+	return NULL;
+}
+
+// stops the cache threads and frees the cache
+static void pcm_cache_shutdown()
+{
+	SDL_AtomicSet(&g_pcm_cache_quit, 1);
+	for (unsigned int i = 0; i < PCM_CACHE_THREADS; i++)
+	{
+		if (g_pcm_cache_threads[i])
+		{
+			SDL_WaitThread(g_pcm_cache_threads[i], NULL);
+			g_pcm_cache_threads[i] = NULL;
+		}
+	}
+
+	for (vector<pcm_cache_entry *>::iterator it = g_pcm_cache.begin(); it != g_pcm_cache.end(); ++it)
+	{
+		free((*it)->pPCM);
+		delete *it;
+	}
+	g_pcm_cache.clear();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 // public audio stuff
 
 void ldp_vldp::enable_audio1()
@@ -268,13 +695,171 @@ void ldp_vldp::oggize_path(string &oggpath, string m2vpath)
 	oggpath += ".ogg";
 }
 
+// returns the position that the reader of the ring is effectively at
+// (a flush that the audio callback hasn't gotten to yet counts as read)
+static uint32_t audio_ring_read_pos()
+{
+	uint32_t uRead = (uint32_t) SDL_AtomicGet(&g_ring_read);
+	uint32_t uFlush = (uint32_t) SDL_AtomicGet(&g_flush_pos);
+
+	if ((int32_t) (uFlush - uRead) > 0)
+		uRead = uFlush;
+	return uRead;
+}
+
+// throws away everything that has been decoded so far (must be called with OGG_LOCK held)
+static void audio_ring_flush()
+{
+	SDL_AtomicSet(&g_flush_pos, SDL_AtomicGet(&g_ring_write));
+	SDL_AtomicAdd(&g_flush_count, 1);
+	SDL_AtomicSet(&g_decoder_eof, 0);
+	SDL_CondSignal(g_ogg_cond);	// start decoding from the new position right away
+}
+
+// adds decoded audio to the ring (only called by the decoder thread)
+static void audio_ring_push(const uint8_t *src, uint32_t uBytes)
+{
+	uint32_t uWrite = (uint32_t) SDL_AtomicGet(&g_ring_write);
+	uint32_t uOffset = uWrite & (AUDIO_RING_SIZE - 1);
+	uint32_t uFirst = AUDIO_RING_SIZE - uOffset;
+
+	if (uFirst > uBytes)
+		uFirst = uBytes;
+	memcpy(g_ring + uOffset, src, uFirst);
+	memcpy(g_ring, src + uFirst, uBytes - uFirst);
+
+	SDL_AtomicSet(&g_ring_write, (int) (uWrite + uBytes));	// publish the new audio
+}
+
+// copies up to uBytes from the ring to dst (using paudiocopy) and returns how many bytes were copied
+// If dst is NULL, the audio is just skipped.  Only called by the audio callback.
+static uint32_t audio_ring_pop(uint8_t *dst, uint32_t uBytes)
+{
+	uint32_t uRead = (uint32_t) SDL_AtomicGet(&g_ring_read);
+	uint32_t uAvail = (uint32_t) SDL_AtomicGet(&g_ring_write) - uRead;
+	uint32_t uOffset = uRead & (AUDIO_RING_SIZE - 1);
+	uint32_t uFirst = AUDIO_RING_SIZE - uOffset;
+
+	if (uBytes > uAvail)
+		uBytes = uAvail;
+	if (uFirst > uBytes)
+		uFirst = uBytes;
+
+	if (dst)
+	{
+		paudiocopy(dst, g_ring + uOffset, uFirst);
+		paudiocopy(dst + uFirst, g_ring, uBytes - uFirst);
+	}
+
+	SDL_AtomicSet(&g_ring_read, (int) (uRead + uBytes));	// give the space back to the decoder
+	return uBytes;
+}
+
+// decodes audio ahead of the audio callback, so the callback never has to decode or wait on a lock
+static int audio_decoder_thread(void *unused)
+{
+	static char small_buf[AUDIO_BUF_CHUNK];
+
+	OGG_LOCK;
+
+	while (!SDL_AtomicGet(&g_decoder_quit))
+	{
+		uint32_t uWrite = (uint32_t) SDL_AtomicGet(&g_ring_write);
+		uint32_t uFilled = uWrite - audio_ring_read_pos();	// how much audio is waiting to be played
+		uint32_t uUsed = uWrite - (uint32_t) SDL_AtomicGet(&g_ring_read);	// includes stale audio the callback hasn't flushed yet
+
+		// if there is audio to decode and we aren't far enough ahead yet
+		if (SDL_AtomicGet(&g_audio_ready) && (SDL_AtomicGet(&g_decoder_eof) == 0) &&
+			(uFilled + AUDIO_BUF_CHUNK <= AUDIO_DECODE_AHEAD) && (uUsed + AUDIO_BUF_CHUNK <= AUDIO_RING_SIZE))
+		{
+			int nop;
+			long bytes_read = 0;
+
+			// if the track is in the PCM cache, there is nothing to decode
+			if (g_pcm_src)
+			{
+				bytes_read = g_pcm_src_bytes - g_pcm_src_pos;
+				if (bytes_read > AUDIO_BUF_CHUNK)
+					bytes_read = AUDIO_BUF_CHUNK;
+				memcpy(small_buf, g_pcm_src + g_pcm_src_pos, bytes_read);
+				g_pcm_src_pos += bytes_read;
+			}
+			else
+				bytes_read = ov_read(&s_ogg, &small_buf[0], AUDIO_BUF_CHUNK, 0, 2, 1, &nop);
+
+			if (bytes_read > 0)
+				audio_ring_push((uint8_t *) small_buf, (uint32_t) bytes_read);
+			else if (bytes_read < 0)
+			{
+				printline("Problem reading samples!");
+				SDL_AtomicSet(&g_decoder_eof, -1);
+			}
+			// else we've come to the end of the stream
+			else
+				SDL_AtomicSet(&g_decoder_eof, 1);
+
+			// give a seek a chance to get in between chunks
+			OGG_UNLOCK;
+			OGG_LOCK;
+		}
+		else
+			SDL_CondWaitTimeout(g_ogg_cond, g_ogg_mutex, AUDIO_DECODER_IDLE_MS);
+	}
+
+	OGG_UNLOCK;
+
+	return 0;
+}
+
+// starts decoding every audio track into the PCM cache in the background (see -audio_cache)
+void ldp_vldp::precache_all_audio()
+{
+	set<string> sDupePreventer;	// it's legal for a framefile to have the same file listed more than once
+	string ogg_path;
+
+	for (unsigned int i = 0; i < m_file_index; i++)
+	{
+		oggize_path(ogg_path, m_mpeginfo[i].name);
+		if (sDupePreventer.insert(ogg_path).second)
+		{
+			pcm_cache_entry *entry = new pcm_cache_entry;
+			entry->strPath = m_mpeg_path + ogg_path;
+			SDL_AtomicSet(&entry->state, PCM_CACHE_PENDING);
+			entry->pPCM = NULL;
+			entry->uBytes = 0;
+			g_pcm_cache.push_back(entry);
+		}
+	}
+
+	SDL_AtomicSet(&g_pcm_cache_next, 0);
+	SDL_AtomicSet(&g_pcm_cache_kb_left, (int) (m_uAudioCacheMegs * 1024));
+	SDL_AtomicSet(&g_pcm_cache_quit, 0);
+
+	for (unsigned int i = 0; i < PCM_CACHE_THREADS; i++)
+	{
+		g_pcm_cache_threads[i] = SDL_CreateThread(pcm_cache_thread, "VLDP_PCMCACHE", NULL);
+		if (!g_pcm_cache_threads[i])
+			printline("LDP-VLDP WARNING : could not start an audio cache thread");
+	}
+}
+
 // initializes VLDP audio, returns 1 on success or 0 on failure
 bool ldp_vldp::audio_init()
 {
+	SDL_AtomicSet(&g_audio_ready, 0);
+	SDL_AtomicSet(&g_audio_playing, 0);
+	SDL_AtomicSet(&g_decoder_quit, 0);
+
 	// create a mutex to prevent threads from interfering
 	g_ogg_mutex = SDL_CreateMutex();
-	if (g_ogg_mutex)
-      return true;
+	g_ogg_cond = SDL_CreateCond();
+	if (g_ogg_mutex && g_ogg_cond)
+	{
+		g_decoder_thread = SDL_CreateThread(audio_decoder_thread, "VLDP_AUDIO", NULL);
+		if (g_decoder_thread)
+			return true;
+		printline("ldp-vldp-audio.cpp: could not create the audio decoder thread");
+	}
 
 	return false;
 }
@@ -282,10 +867,27 @@ bool ldp_vldp::audio_init()
 // shuts down VLDP audio
 void ldp_vldp::audio_shutdown()
 {
+	// stop the decoder thread before we tear down what it's using
+	if (g_decoder_thread)
+	{
+		SDL_AtomicSet(&g_decoder_quit, 1);
+		SDL_CondSignal(g_ogg_cond);
+		SDL_WaitThread(g_decoder_thread, NULL);
+		g_decoder_thread = NULL;
+	}
+
 	// if we have an audio file still open, close it
-	if (g_pIOAudioHandle != 0)
+	if ((g_pIOAudioHandle != 0) || g_pcm_src)
 		close_audio_stream();
 
+	pcm_cache_shutdown();
+
+	if (g_ogg_cond)
+	{
+		SDL_DestroyCond(g_ogg_cond);
+		g_ogg_cond = NULL;
+	}
+
 	// if we successfully created a mutex previously, then destroy it now
 	if (g_ogg_mutex)
 	{
@@ -298,9 +900,12 @@ void ldp_vldp::close_audio_stream()
 {
 	OGG_LOCK;
 
-	g_audio_ready = false;
-	g_audio_playing = false;
+	SDL_AtomicSet(&g_audio_ready, 0);
+	SDL_AtomicSet(&g_audio_playing, 0);
 	ov_clear(&s_ogg);
+	g_ogg_index.clear();
+	g_pcm_src = NULL;
+	audio_ring_flush();
 
 	OGG_UNLOCK;
 }
@@ -316,12 +921,25 @@ bool ldp_vldp::open_audio_stream(const string &strFilename)
 		mmtell
 	};
 
-	OGG_LOCK;	// can't have audio callback running during this
+	OGG_LOCK;	// can't have the decoder thread running during this
 
 	// if an audio stream is already open, close it first
-	if (g_pIOAudioHandle != 0)
+	if ((g_pIOAudioHandle != 0) || g_pcm_src)
 		close_audio_stream();
 
+	// if this track has already been decoded, we'll play it straight out of the cache
+	pcm_cache_entry *pCached = pcm_cache_find(m_mpeg_path + strFilename);
+	if (pCached)
+	{
+		g_pcm_src = pCached->pPCM;
+		g_pcm_src_bytes = pCached->uBytes;
+		g_pcm_src_pos = 0;
+		audio_ring_flush();
+		SDL_AtomicSet(&g_audio_ready, 1);
+		OGG_UNLOCK;
+		return true;
+	}
+
 	mmreset();	// reset the mm wrappers for new use
 
 	g_pIOAudioHandle = mpo_open((m_mpeg_path + strFilename).c_str(), MPO_OPEN_READONLY);
@@ -348,7 +966,18 @@ bool ldp_vldp::open_audio_stream(const string &strFilename)
 				// if they meet the proper specification, let them proceed
 				if ((info->channels == 2) && (info->rate == 44100))
 				{
-					g_audio_ready = true;
+					string strIdxPath = m_mpeg_path + strFilename;
+					strIdxPath.replace(strIdxPath.length() - 4, 4, ".idx");
+
+					// the seek index is cached because it has to walk the whole stream to build it
+					if (!audio_index_load(strIdxPath))
+					{
+						audio_index_scan();
+						audio_index_save(strIdxPath);
+					}
+
+					audio_ring_flush();
+					SDL_AtomicSet(&g_audio_ready, 1);
 					result = true;
 				}
 				else
@@ -377,7 +1006,7 @@ bool ldp_vldp::open_audio_stream(const string &strFilename)
 		{
 			mpo_close(g_pIOAudioHandle);
 			g_pIOAudioHandle = NULL;
-			
+
 			// if we have memory allocated, de-allocate it
 			if (g_big_buf)
 			{
@@ -385,11 +1014,11 @@ bool ldp_vldp::open_audio_stream(const string &strFilename)
 				g_big_buf = NULL;
 			}
 		}
-			
+
 	} // end if we could open file
 
 	OGG_UNLOCK;
-		
+
 	return result;
 }
 
@@ -399,17 +1028,29 @@ bool ldp_vldp::seek_audio(uint64_t u64Samples)
 {
 	bool result = false;
 
-	OGG_LOCK;	// can't have audio callback running during this
+	OGG_LOCK;	// can't have the decoder thread running during this
 
-	if (ov_seekable(&s_ogg))
+	// if we're playing from the PCM cache, seeking is just a matter of moving our position
+	if (g_pcm_src)
 	{
-		ov_pcm_seek(&s_ogg, u64Samples);
-		g_audio_playing = false;	// audio should not be playing immediately after a seek
+		uint64_t u64Pos = u64Samples * AUDIO_BYTES_PER_SAMPLE;
+		g_pcm_src_pos = (u64Pos < g_pcm_src_bytes) ? (uint32_t) u64Pos : g_pcm_src_bytes;
+		SDL_AtomicSet(&g_audio_playing, 0);	// audio should not be playing immediately after a seek
+		audio_ring_flush();
+		result = true;
+	}
+	else if (ov_seekable(&s_ogg))
+	{
+		// jump straight to the right page if we can, instead of making vorbisfile bisect the stream
+		if (!audio_index_seek(u64Samples))
+			ov_pcm_seek(&s_ogg, u64Samples);
+		SDL_AtomicSet(&g_audio_playing, 0);	// audio should not be playing immediately after a seek
+		audio_ring_flush();	// the decoder thread refills the ring from the new position
 		result = true;
 	}
 	else
 		printline("DOH!  OGG stream is not seekable!");
-	
+
 	OGG_UNLOCK;
 
 	return result;
@@ -418,183 +1059,111 @@ bool ldp_vldp::seek_audio(uint64_t u64Samples)
 // starts playing the audio
 void ldp_vldp::audio_play(uint32_t timer)
 {
-	OGG_LOCK;
 	g_playing_timer = timer;
-	g_samples_played = 0;
-	g_audio_playing = true;
-	OGG_UNLOCK;
+	SDL_AtomicAdd(&g_play_count, 1);	// the audio callback restarts its timing when it sees this change
+	SDL_AtomicSet(&g_audio_playing, 1);
 }
 
 // pauses the audio at the current position
 void ldp_vldp::audio_pause()
 {
-	OGG_LOCK;
-	g_audio_playing = false;
-	OGG_UNLOCK;
+	SDL_AtomicSet(&g_audio_playing, 0);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////
 
-char g_small_buf[AUDIO_BUF_CHUNK] = { 0 };
-uint8_t g_leftover_buf[AUDIO_BUF_CHUNK] = { 0 };
-int g_leftover_samples = 0;
-
 // our audio callback
+// This only copies audio that the decoder thread has already prepared, so it never blocks.
 void ldp_vldp_audio_callback(uint8_t *stream, int len, int unused)
 {
-	OGG_LOCK;	// make sure nothing changes with any ogg stuff while we decode
+	int flush_count = SDL_AtomicGet(&g_flush_count);
+	int play_count = SDL_AtomicGet(&g_play_count);
+
+	// if a seek has happened, throw away the audio that was decoded before it
+	if (flush_count != g_last_flush_count)
+	{
+		g_last_flush_count = flush_count;
+		SDL_AtomicSet(&g_ring_read, (int) audio_ring_read_pos());
+		g_awaiting_refill = true;
+	}
+
+	// if we've started playing again, restart our timing
+	if (play_count != g_last_play_count)
+	{
+		g_last_play_count = play_count;
+		g_samples_played = 0;
+	}
 
 	// if audio is ready to be read and if it is playing
-	if (g_audio_ready && g_audio_playing)
+	if (SDL_AtomicGet(&g_audio_ready) && SDL_AtomicGet(&g_audio_playing))
 	{
-		bool audio_caught_up = false;
-		int loop_count = 0;
+		uint32_t samples_copied = audio_ring_pop(stream, len);
+		uint32_t correct_samples = 0;	// how many samples we should have played up to this point
 
-		// normally we only want to go through this loop once
-		// The exception is if we are behind, in which case we want to process audio until we're caught up again
-		// we don't want to loop endlessly in here if there is a bug, which is why we have a loop count
-		while ((!audio_caught_up) && (loop_count++ < 10))
+		// if the decoder couldn't keep up or has stopped, fill the rest with silence
+		if (samples_copied < (uint32_t) len)
 		{
-			long samples_read = 0;
-			int samples_copied = 0;
-			uint32_t bytes_to_read = 0;
-			uint32_t correct_samples = 0;	// how many samples we should have played up to this point
-			int nop;
-			
-			// if we have some samples from last time for the audio stream
-			if (g_leftover_samples)
+			memset(stream + samples_copied, 0, len - samples_copied);
+
+			int eof = SDL_AtomicGet(&g_decoder_eof);
+			if (eof != 0)
 			{
-				if (g_leftover_samples <= len)
-				{
-					paudiocopy(stream, g_leftover_buf, g_leftover_samples);
-					samples_copied += g_leftover_samples;
-					g_leftover_samples = 0;
-				}
-				else
-				{
-					paudiocopy(stream, g_leftover_buf, len);
-					memmove(g_leftover_buf, g_leftover_buf + len, g_leftover_samples - len);	// shift remaining buf to front
-					// memmove is used because the memory area overlaps
-					samples_copied = len;
-					g_leftover_samples -= len;
-				}
+				if (eof > 0)
+					printline("End of audio stream detected!");
+				SDL_AtomicSet(&g_audio_playing, 0);
 			}
 
-			while (samples_copied < len)
+			// Right after a seek, the decoder thread needs a moment to refill the ring.  We count the silence
+			//  as played, otherwise the catch-up below would throw away the fresh audio as soon as it arrives.
+			else if (g_awaiting_refill)
 			{
-				samples_read = ov_read(&s_ogg, &g_small_buf[0],
-					AUDIO_BUF_CHUNK,0,2,1, &nop);
-
-				if (samples_read > 0)
-				{
-					bytes_to_read = len - samples_copied;	// how much space we have left to fill
-					// (samples_copied can and often is 0)
-				
-					// if we have more space to fill than samples available, then we only want to read
-					// as many samples as we have available
-					if (bytes_to_read > (uint32_t) samples_read)
-					{
-						bytes_to_read = samples_read;
-					}
-					// else we have to split the buffer
-					else
-					{
-						g_leftover_samples = samples_read - bytes_to_read;
-						memcpy(g_leftover_buf, g_small_buf + bytes_to_read, g_leftover_samples);
-					}
-
-					paudiocopy(stream + samples_copied, g_small_buf, bytes_to_read);
-					samples_copied += bytes_to_read;
-				} // end if samples were read
-
-				// if we got an error
-				else if (samples_read < 0)
-				{
-					printline("Problem reading samples!");
-					g_audio_playing = false;
-					break;
-				}
-
-				// else, samples_read == 0 in which case we've come to the end of the stream
-				else
-				{
-					printline("End of audio stream detected!");
-					g_audio_playing = false;
-					break;
-				}
+				g_samples_played += len - samples_copied;
+			}
+		}
+		if (samples_copied > 0)
+		{
+			g_awaiting_refill = false;
+		}
 
-			} // end while we have not filled the buffer
+		// NOW WE CHECK TO SEE IF THE AUDIO IS LAGGING TOO FAR BEHIND
+		// IF IT IS, WE NEED TO SKIP FORWARD
 
-			// NOW WE CHECK TO SEE IF THE AUDIO IS LAGGING TOO FAR BEHIND
-			// IF IT IS, WE NEED TO SKIP FORWARD
+		g_samples_played += samples_copied;	// update stats on how many samples have played so we can make sure audio is in sync
 
-			g_samples_played += len;	// update stats on how many samples have played so we can make sure audio is in sync
+		unsigned int cur_time = g_ldp->get_elapsed_ms_since_play();
+		// if our timer is set to the current time or some previous time
+		if (g_playing_timer < cur_time)
+		{
+			static const uint64_t uBYTES_PER_S = AUDIO_FREQ * AUDIO_BYTES_PER_SAMPLE;	// needs to be uint64 to prevent overflow from subsequent math
+			correct_samples = (unsigned int) ((uBYTES_PER_S * (cur_time - g_playing_timer)) / 1000);
+			// how many samples should have played
+			// 176.4 = 44.1 samples per millisecond * 2 for stereo * 2 for 16-bit
+		}
+		// our timer is set to some time in the future (used with skipping) so we actually
+		// should not have played any samples at this point
+		// else correct_samples stays 0
 
-			//unsigned int cur_time = refresh_ms_time();
-			unsigned int cur_time = g_ldp->get_elapsed_ms_since_play();
-			// if our timer is set to the current time or some previous time
-			if (g_playing_timer < cur_time)
-			{
-				static const uint64_t uBYTES_PER_S = AUDIO_FREQ * AUDIO_BYTES_PER_SAMPLE;	// needs to be uint64 to prevent overflow from subsequent math
-				correct_samples = (unsigned int) ((uBYTES_PER_S * (cur_time - g_playing_timer)) / 1000);
-				// how many samples should have played
-				// 176.4 = 44.1 samples per millisecond * 2 for stereo * 2 for 16-bit
-			}
-			// our timer is set to some time in the future (used with skipping) so we actually
-			// should not have played any samples at this point
-			else
-			{
-//				fprintf(stderr, "LDP-VLDP-AUDIO : Timer is in the future\n");
-				correct_samples = 0;
-			}
-		
-			// if we're ahead instead of behind, don't loop
-			if (correct_samples <= g_samples_played)
-			{
-				audio_caught_up = true;
-				
-				/*
-				// warn user if we're too far ahead (this should never happen)
-				if ((g_samples_played - correct_samples) > len)
-				{
-					string s = "ldp-vldp-audio callback: audio is too far ahead! played: " +
-						numstr::ToStr(g_samples_played) + ", expected: " + numstr::ToStr(correct_samples);
-					printline(s.c_str());
-				}
-				*/
-			}
+		// if we're a whole buffer or more behind, skip forward to catch up
+		if ((correct_samples > g_samples_played) && ((correct_samples - g_samples_played) >= (uint32_t) len))
+		{
+			uint32_t behind = correct_samples - g_samples_played;
 
-			// if we're not too far behind, don't loop
-			else if ((int32_t) (correct_samples - g_samples_played) < len)
-			{
-				audio_caught_up = true;
-			}
+			// we don't want to skip too much in one go if there is a bug (same limit we've always had)
+			if (behind > (uint32_t) (len * 9))
+				behind = len * 9;
+			behind &= ~(AUDIO_BYTES_PER_SAMPLE - 1);	// stay on a sample boundary
 
-			// if we're too far behind, notify the user for testing purposes
-			else
-			{
-				/*
-				char s[160];
-				sprintf(s, "AUDIO : played %u, expected %u, timer=%u, curtime=%u", g_samples_played, correct_samples, g_playing_timer, g_ldp->get_elapsed_ms_since_play());
-				printline(s);
-				*/
-				audio_caught_up = false;
-				SDL_Delay(0);	// don't starve other processes while trying to catch up
-			}
-		} // end while we're not caught up
+			g_samples_played += audio_ring_pop(NULL, behind);
+		}
 
+		SDL_CondSignal(g_ogg_cond);	// we've made room, so the decoder thread can get back to work
 	} // end if audio is playing
 
 	// Either we have no audio file opened OR
-	// disc is not playing, pause audio and make sure we don't have any extraneous audio lingering around when
-	// we start playing again
+	// disc is not playing, so just fill the audio stream with silence since it will be expecting to get something back from us
+	// (whatever has been decoded stays in the ring for when we start playing again)
 	else
 	{
-		// fill audio stream with silence since it will be expecting to get something back from us
       memset(stream, 0,len);
-
-		g_leftover_samples = 0;
 	}
-
-	OGG_UNLOCK;
 }
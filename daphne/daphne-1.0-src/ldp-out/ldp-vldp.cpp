@@ -39,16 +39,19 @@
 #include <string.h>
 #include <time.h>
 #include <set>
+#include <vector>
 #include "../io/conout.h"
 #include "../io/error.h"
 #include "../video/video.h"
 #include "../timer/timer.h"
+#include "../timer/telemetry.h"
 #include "../daphne.h"	// for get_quitflag, set_quitflag
 #include "../io/homedir.h"
 #include "../io/input.h"
 #include "../io/fileparse.h"
 #include "../io/mpo_mem.h"
 #include "../io/numstr.h"	// for debug
+#include "../io/threads.h"
 #include "../game/game.h"
 #include "../video/rgb2yuv.h"
 #include "ldp-vldp.h"
@@ -112,6 +115,33 @@ int g_vb_waiting_queue[VIDEO_BUFFER_AMOUNT] = { -1, -1, -1, -1 };
 
 VIDEO_BUFFER g_hw_overlay[VIDEO_BUFFER_AMOUNT] = { { VB_STATE_USEABLE, NULL }, { VB_STATE_USEABLE, NULL }, { VB_STATE_USEABLE, NULL }, { VB_STATE_USEABLE, NULL } };
 
+// Change tracking, so that when the disc is paused (or VLDP is idle) we don't keep rebuilding and converting the same frame.
+// A frame is described by which yuv_buf it came from, that buffer's serial number, and the game's overlay generation.
+typedef struct
+{
+	const struct yuv_buf *	buf;	// NULL if nothing has been displayed yet
+	unsigned int			uSerial;
+	unsigned int			uOverlayGen;
+} FRAME_ID;
+
+FRAME_ID g_last_frame = { NULL, 0, 0 };		// the frame that was last handed to display_frame_callback
+FRAME_ID g_prepared_frame = { NULL, 0, 0 };	// the frame that prepare_frame is working on
+bool g_bFrameUnchanged = false;	// if true, prepare_frame found nothing new so display_frame_callback has nothing to do
+
+// returns true if 'buf' (with the overlay generation 'uOverlayGen') looks exactly like the last frame displayed
+// Also remembers it so display_frame_callback can record it once it has been displayed.
+static bool is_frame_unchanged(const struct yuv_buf *buf, unsigned int uOverlayGen)
+{
+	g_prepared_frame.buf = buf;
+	g_prepared_frame.uSerial = buf->uSerial;
+	g_prepared_frame.uOverlayGen = uOverlayGen;
+
+	g_bFrameUnchanged = (g_last_frame.buf == buf) && (g_last_frame.uSerial == buf->uSerial) &&
+		(g_last_frame.uOverlayGen == uOverlayGen);
+
+	return g_bFrameUnchanged;
+}
+
 bool initialize_vb(uint32_t format, uint32_t target_format, int w, int h)
 {
 	for (int i = 0; i < VIDEO_BUFFER_AMOUNT; i++)
@@ -127,6 +157,8 @@ bool initialize_vb(uint32_t format, uint32_t target_format, int w, int h)
 	g_vb_waiting_top		= -1;
 	g_vb_waiting_next		= 0;
 
+	g_last_frame.buf		= NULL;	// the buffers have been thrown away, so the next frame must be rebuilt
+
 	return true;
 }
 
@@ -144,6 +176,8 @@ void teardown_vb()
 	g_vb_filling_queue		= -1;
 	g_vb_waiting_top		= -1;
 	g_vb_waiting_next		= 0;
+
+	g_last_frame.buf		= NULL;	// the buffers have been thrown away, so the next frame must be rebuilt
 }
 
 
@@ -311,21 +345,9 @@ void set_vb_rendering_done(int vb_ndx)
 
 
 struct yuv_buf g_blank_yuv_buf;	// this will contain a blank YUV overlay suitable for search/seek blanking
-uint8_t *g_line_buf = NULL;	// temp sys RAM for doing calculations so we can do fastest copies to slow video RAM
-uint8_t *g_line_buf2 = NULL;	// 2nd buf
-uint8_t *g_line_buf3 = NULL;	// 3rd buf
 
 ////////////////////////////////////////
 
-// 2 pixels of black in YUY2 format (different for big and little endian)
-#ifndef MSB_FIRST
-#define YUY2_BLACK 0x7f007f00
-#else
-#define YUY2_BLACK 0x007f007f
-#endif
-
-/////////////////////////////////////////
-
 // pointer to all functions the VLDP exposes to us ...
 const struct vldp_out_info *g_vldp_info = NULL;
 
@@ -358,6 +380,9 @@ ldp_vldp::ldp_vldp()
 	m_vertical_stretch = 0;
 
 	m_bPreCache = m_bPreCacheForce = false;
+	m_bCoarseIndex = false;
+	m_bPrecisePacing = false;
+	m_uAudioCacheMegs = 0;
 	m_mPreCachedFiles.clear();
 
 	m_uSoundChipID = 0;
@@ -375,7 +400,7 @@ ldp_vldp::~ldp_vldp()
 bool ldp_vldp::init_player()
 {
 	bool result = false;
-	bool need_to_parse = false;	// whether we need to parse all video
+	bool need_to_parse = false;	// whether some video still needs to be parsed
 
 	g_vertical_stretch = m_vertical_stretch;  // callbacks don't have access to m_vertical_stretch
 	
@@ -388,10 +413,7 @@ bool ldp_vldp::init_player()
          // if the last video file has not been parsed, assume none of them have been
          // This is safe because if they have been parsed, it will just skip them
          if (!last_video_file_parsed())
-         {
-            printnotice("Press any key to parse your video file(s). This may take a while. Press ESC if you'd rather quit.");
             need_to_parse = true;
-         }
 
          if (audio_init() && !get_quitflag())
          {
@@ -415,7 +437,12 @@ bool ldp_vldp::init_player()
             g_local_info.render_blank_frame = blank_overlay;
             g_local_info.blank_during_searches = m_blank_on_searches;
             g_local_info.blank_during_skips = m_blank_on_skips;
+            g_local_info.index_fallback_coarse = m_bCoarseIndex;
+            g_local_info.precise_pacing = m_bPrecisePacing;
             g_local_info.GetTicksFunc = GetTicksFunc;
+            g_local_info.report_frame_lateness = report_frame_lateness_callback;
+            g_local_info.thread_started = threads_setup;
+            g_local_info.log_line = log_line_callback;
 
             g_vldp_info = vldp_init(&g_local_info);
 
@@ -434,10 +461,15 @@ bool ldp_vldp::init_player()
                if (m_bPreCache)
                   bPreCacheOK = precache_all_video();
 
-               // if we need to parse all the video
+               // if we need to parse the video, do it in the background so we can boot right away
+               // (VLDP waits for, or scans, a file that isn't ready when it gets opened)
                if (need_to_parse)
                   parse_all_video();
 
+               // if requested, start decoding the audio tracks so seeks won't have to decode anything
+               if (m_uAudioCacheMegs)
+                  precache_all_audio();
+
                // if precaching succeeded or we didn't request precaching
                if (bPreCacheOK)
                {
@@ -999,6 +1031,23 @@ void ldp_vldp::set_vertical_stretch(unsigned int value)
 	m_vertical_stretch = value;
 }
 
+void ldp_vldp::set_audio_cache(unsigned int uMegs)
+{
+	m_uAudioCacheMegs = uMegs;
+}
+
+unsigned int ldp_vldp::get_frames_decoded()
+{
+	unsigned int uResult = 0;
+
+	if (g_vldp_info)
+	{
+		uResult = g_vldp_info->uFramesDecoded;
+	}
+
+	return uResult;
+}
+
 void ldp_vldp::test_helper(unsigned uIterations)
 {
 	// We aren't calling think_delay because we want to have a lot of milliseconds pass quickly without actually waiting.
@@ -1029,6 +1078,12 @@ bool ldp_vldp::handle_cmdline_arg(const char *arg)
 		m_bPreCache = true;
 		m_bPreCacheForce = true;
 	}
+	// if a video file hasn't been parsed yet when we need it, should we scan it ourselves instead of waiting?
+	else if (strcasecmp(arg, "-coarse_index")==0)
+		m_bCoarseIndex = true;
+	// should VLDP sleep until each frame's exact deadline on a high resolution clock?
+	else if (strcasecmp(arg, "-precise_pacing")==0)
+		m_bPrecisePacing = true;
 	
 	// else it's unknown
 	else
@@ -1167,27 +1222,35 @@ bool ldp_vldp::last_video_file_parsed()
    return false;
 }
 
-// opens (and closes) all video files, forcing any unparsed video files to get parsed
+// queues up all video files to be parsed in the background, in framefile order
+// (the first file is needed to boot, so it comes first)
 void ldp_vldp::parse_all_video()
 {
+	vector<string> vFullPaths;
+	vector<const char *> vpszFullPaths;
 	unsigned int i = 0;
 
 	for (i = 0; i < m_file_index; i++)
 	{
-		// if the file can be opened...
-		if (open_and_block(m_mpeginfo[i].name))
-		{
-			g_vldp_info->search_and_block(0, 0);	// search to frame 0 to render it so the user has something to watch while he/she waits
-			think();	// let opengl have a chance to display the frame
-		}
-		else
-		{
-			outstr("LDP-VLDP: Could not parse video because file ");
-			outstr(m_mpeginfo[i].name.c_str());
-			printline(" could not be opened.");
-			break;
-		}
+		vFullPaths.push_back(m_mpeg_path + m_mpeginfo[i].name);
+	}
+
+	// vFullPaths must not change size after this point
+	for (i = 0; i < vFullPaths.size(); i++)
+	{
+		vpszFullPaths.push_back(vFullPaths[i].c_str());
+	}
+
+	// nothing to do if the framefile didn't list any files (and vpszFullPaths[0] wouldn't exist)
+	if (vpszFullPaths.empty())
+	{
+		return;
 	}
+
+	if (g_vldp_info->index_in_background(&vpszFullPaths[0], (unsigned int) vpszFullPaths.size()))
+		printline("LDP-VLDP INFO : parsing video file(s) in the background . . .");
+	else
+		printline("LDP-VLDP WARNING : could not start background parsing, video files will be parsed as they are opened");
 }
 
 bool ldp_vldp::precache_all_video()
@@ -1484,6 +1547,12 @@ bool ldp_vldp::parse_framefile(const char *pszInBuf, const char *pszFramefileFul
 
 int prepare_frame_callback_with_overlay(struct yuv_buf *src)
 {
+	// if neither the mpeg frame nor the game's overlay has changed, the last frame we built is still correct
+	if (is_frame_unchanged(src, g_game->get_video_overlay_generation()))
+	{
+		return VLDP_TRUE;
+	}
+
 	void * g_hw_overlay_pixels	= NULL;
 	SDL_Rect g_hw_overlay_rect	= { 0, 0, 0, 0 };
 	// v0.01 int nPitch = DAPHNE_VIDEO_W * DAPHNE_VIDEO_ByPP;
@@ -1498,6 +1567,10 @@ int prepare_frame_callback_with_overlay(struct yuv_buf *src)
 		g_hw_overlay_rect.h = sw_overlay->h;
 		nPitch = sw_overlay->w * SDL_BYTESPERPIXEL(sw_overlay->format);
 	}
+	else
+	{
+		g_prepared_frame.buf = NULL;	// we aren't building this frame anywhere, so it mustn't be remembered as displayed
+	}
 
 	{
 		// 20xx.xx.xx - RJS - Since I haven't dived all the way through the system, I'm pretty sure this is 
@@ -1521,9 +1594,7 @@ int prepare_frame_callback_with_overlay(struct yuv_buf *src)
 			gamevid_pixels = (uint8_t *) gamevid_pixels - (gamevid->w * (g_vertical_offset - g_vertical_stretch));
 			
 			unsigned int row = 0;
-			unsigned int col = 0;
 
-			uint32_t w_double = g_hw_overlay_rect.w << 1;	// twice the overlay width, to avoid calculating this more than once
 			uint32_t h_half = g_hw_overlay_rect.h >> 1;	// half of the overlay height, to avoid calculating this more than once
 			
 			t_yuv_color* yuv_palette = get_yuv_palette();
@@ -1546,105 +1617,31 @@ int prepare_frame_callback_with_overlay(struct yuv_buf *src)
 				V	+= g_hw_overlay_rect.w;
 			}
 			
+			yuy2_row_src rows;
+			rows.pPalette = yuv_palette;
+			bool bBlend = ((g_filter_type & FILTER_BLEND) != 0);
+			bool bScanlines = ((g_filter_type & FILTER_SCANLINES) != 0);
+
 			// do 2 rows at a time
 			for (row = 0; row < h_half; row++)
 			{
-				// calculate this here to avoid calculating too often
+				// only draw from the video overlay where we safely can
 				int adjusted_row = ((int) row) - g_vertical_offset;
 				bool row_in_range = ((adjusted_row >= 0) && (adjusted_row < gamevid->h));
-				t_yuv_color *palette = NULL;
-				
-				// do 4 bytes at a time, for twice the width of the overlay since we're using YUY2
-				for (col = 0; col < w_double; col += 4)
-				{
-					// if we can safely draw from the video overlay
-					if (row_in_range) palette = &yuv_palette[*gamevid_pixels];
-					
-					// If we are out of range, OR if the current color is transparent,
-					//  then draw the mpeg video pixel instead of the video overlay
-					// (if palette is NULL, the compiler shouldn't try to dereference palette->transparent)
-					if ((palette == NULL) || palette->transparent)
-					{
-						unsigned int Y_chunk = *((uint16_t *) Y);
-						unsigned int Y2_chunk = *((uint16_t *) Y2);
-						unsigned int V_chunk = *V;
-						unsigned int U_chunk = *U;
-						
-#ifndef MSB_FIRST
-						//Little-Endian (Intel)
-						*((uint32_t *) (g_line_buf + col)) = (Y_chunk & 0xFF) | (U_chunk << 8) |
-							((Y_chunk & 0xFF00) << 8) | (V_chunk << 24);
-						*((uint32_t *) (g_line_buf2 + col)) = (Y2_chunk & 0xFF) | (U_chunk << 8) |
-							((Y2_chunk & 0xFF00) << 8) | (V_chunk << 24);
-#else						
-						//Big-Endian (Mac)			
-						*((uint32_t *) (g_line_buf + col)) = ((Y_chunk & 0xFF00) << 16) | ((U_chunk) << 16) |
-							((Y_chunk & 0xFF) << 8) | (V_chunk);
-						*((uint32_t *) (g_line_buf2 + col)) = ((Y2_chunk & 0xFF00) << 16) | ((U_chunk) << 16) |
-							((Y2_chunk & 0xFF) << 8) | (V_chunk);												
-#endif
-					}
-					
-					// if we have an overlay pixel to be drawn
-					else
-					{
-#ifndef MSB_FIRST
-						//Little-Endian (Intel)
-						*((uint32_t *) (g_line_buf + col)) = 
-							*((uint32_t *) (g_line_buf2 + col)) = palette->y | (palette->u << 8)
-							| (palette->y << 16) | (palette->v << 24);						
-#else					
-						//Big-Endian (Mac)
-						*((uint32_t *) (g_line_buf + col)) = 
-							*((uint32_t *) (g_line_buf2 + col)) = (palette->y << 24) | (palette->u << 16)
-							| (palette->y << 8) | (palette->v);
-#endif
-						
-					}
-					Y += 2;
-					Y2 += 2;
-					U++;
-					V++;
-					gamevid_pixels++;
-				}
 
-				// if we're not doing scanlines
-				if (!(g_filter_type & FILTER_SCANLINES))
-				{
-					// no filtering at all
-					if (!(g_filter_type & FILTER_BLEND))
-					{
-						memcpy(dst_ptr, g_line_buf, (g_hw_overlay_rect.w << 1));
-						memcpy(dst_ptr + channel0_pitch, g_line_buf2, (g_hw_overlay_rect.w << 1));
-					}
-					else
-					{
-						g_blend_func();	// blend the two lines into g_line_buf3
-						// this won't affect video overlay because it is already doubled in size anyway
-						memcpy(dst_ptr, g_line_buf3, (g_hw_overlay_rect.w << 1));
-						memcpy(dst_ptr + channel0_pitch, g_line_buf3, (g_hw_overlay_rect.w << 1));
-					}
-				}
-				// if we're doing scanlines
-				else
-				{
-					// do a black YUY2 line (the first line should be black to workaround nvidia bug)
-					for (int i = 0; i < (g_hw_overlay_rect.w << 1); i += 4)
-						*((uint32_t *) (dst_ptr + i)) = YUY2_BLACK;	// this value is black in YUY2 mode
-					
-					if (g_filter_type & FILTER_BLEND)
-					{
-						g_blend_func();	// blend the two lines into g_line_buf3
-						// this won't affect video overlay because it is already doubled in size anyway
-						memcpy(dst_ptr + channel0_pitch, g_line_buf3, (g_hw_overlay_rect.w << 1));
-					}
-					else
-						memcpy(dst_ptr + channel0_pitch, g_line_buf, (g_hw_overlay_rect.w << 1));	// this could be g_line_buf2 also
-				}
+				rows.Y1 = Y;
+				rows.Y2 = Y2;
+				rows.U = U;
+				rows.V = V;
+				rows.pOverlay = row_in_range ? gamevid_pixels : NULL;
+				yuy2_write_rows(dst_ptr, channel0_pitch, rows, g_hw_overlay_rect.w, bBlend, bScanlines);
 
 				dst_ptr += (channel0_pitch << 1);	// we've done 2 rows, so skip a row
-				Y += g_hw_overlay_rect.w;	// we've done 2 vertical Y pixels, so skip a row
-				Y2 += g_hw_overlay_rect.w;
+				Y += (g_hw_overlay_rect.w << 1);	// we've done 2 vertical Y pixels
+				Y2 += (g_hw_overlay_rect.w << 1);
+				U += (g_hw_overlay_rect.w >> 1);
+				V += (g_hw_overlay_rect.w >> 1);
+				gamevid_pixels += gamevid->w;
 			}	
 		} // end if sanity check passed
 		
@@ -1686,6 +1683,12 @@ int prepare_frame_callback_with_overlay(struct yuv_buf *src)
 
 int prepare_frame_callback_without_overlay(struct yuv_buf *buf)
 {
+	// if the mpeg frame hasn't changed, the last frame we built is still correct
+	if (is_frame_unchanged(buf, 0))
+	{
+		return VLDP_TRUE;
+	}
+
 	// if locking the video overlay is successful
 	void * g_hw_overlay_pixels = NULL;
 	int nPitch = 0;
@@ -1696,6 +1699,7 @@ int prepare_frame_callback_without_overlay(struct yuv_buf *buf)
 	if (sw_overlay)
 	{
 		g_hw_overlay_pixels = sw_overlay->pixels;
+		nPitch = sw_overlay->w * SDL_BYTESPERPIXEL(sw_overlay->format);
 
 		int overlay_w = 0;
 		int overlay_h = 0;
@@ -1707,6 +1711,7 @@ int prepare_frame_callback_without_overlay(struct yuv_buf *buf)
       return VLDP_TRUE;
 	}
 	
+	g_prepared_frame.buf = NULL;
 	return VLDP_FALSE;
 }
 
@@ -1735,6 +1740,13 @@ void display_frame_callback(struct yuv_buf *buf)
 	// proven.  Out of pure laziness, "texture" will mean the buffer in these new routines.  Also, not sure if this needs to be
 	// added to dynapis.  Function is: SDL_RJS_SW_CopyYUVToRGB
 
+	// nothing has changed since the last frame was displayed, so the frontend can just show it again
+	if (g_bFrameUnchanged)
+	{
+		g_bFrameUnchanged = false;
+		return;
+	}
+
 	int vb_ndx = -1;
 	SDL_SW_YUVTexture * sw_overlay = NULL;
 	sw_overlay = get_vb_filling(&vb_ndx);
@@ -1754,6 +1766,9 @@ void display_frame_callback(struct yuv_buf *buf)
 	SDL_RJS_SW_CopyYUVToRGB(sw_overlay, &full_rect, sw_overlay->target_format, sw_overlay->w, sw_overlay->h, sw_overlay->planes[0], sw_overlay->pitches[0]);
 
 	set_vb_filling_done(vb_ndx);
+
+	// (only remembered now that it has been displayed, in case prepare_frame was interrupted)
+	g_last_frame = g_prepared_frame;
 }
 
 // This function converts the YV12-formatted 'src' to a YUY2-formatted overlay (which Xbox-Daphne may be using)
@@ -1774,91 +1789,27 @@ void buf2overlay_YUY2(uint8_t *out_pixels, uint16_t in_pitch, int in_h, int in_w
 	// RJS END
 		
 	unsigned int channel0_pitch = dst->pitches;
-	uint8_t *dst_ptr = dst->pixels;			
-	uint8_t *Y = (uint8_t *) src->Y;
-	uint8_t *Y2 = ((uint8_t *) src->Y) + dst->w;
-	uint8_t *U = (uint8_t *) src->U;
-	uint8_t *V = (uint8_t *) src->V;
-	int col, row;
+	uint8_t *dst_ptr = dst->pixels;
+	yuy2_row_src rows;
+	rows.Y1 = (uint8_t *) src->Y;
+	rows.Y2 = ((uint8_t *) src->Y) + dst->w;
+	rows.U = (uint8_t *) src->U;
+	rows.V = (uint8_t *) src->V;
+	rows.pOverlay = NULL;
+	rows.pPalette = NULL;
+	bool bBlend = ((g_filter_type & FILTER_BLEND) != 0);
+	bool bScanlines = ((g_filter_type & FILTER_SCANLINES) != 0);
 	
 	// do 2 rows at a time
-	for (row = 0; row < (dst->h >> 1); row++)
+	for (int row = 0; row < (dst->h >> 1); row++)
 	{
-		// do 4 bytes at a time, but only iterate for w_half
-		for (col = 0; col < (dst->w << 1); col += 4)
-		{
-			unsigned int Y_chunk = *((uint16_t *) Y);
-			unsigned int Y2_chunk = *((uint16_t *) Y2);
-			unsigned int V_chunk = *V;
-			unsigned int U_chunk = *U;
-			
-#ifndef MSB_FIRST
-			
-			//Little-Endian (PC)
-			*((uint32_t *) (g_line_buf + col)) = (Y_chunk & 0xFF) | (U_chunk << 8) |
-				((Y_chunk & 0xFF00) << 8) | (V_chunk << 24);
-			*((uint32_t *) (g_line_buf2 + col)) = (Y2_chunk & 0xFF) | (U_chunk << 8) |
-				((Y2_chunk & 0xFF00) << 8) | (V_chunk << 24);
-			
-#else
-			
-			//Big-Endian (Mac)
-			*((uint32_t *) (g_line_buf + col)) = ((Y_chunk & 0xFF00) << 16) | ((U_chunk) << 16) |
-				((Y_chunk & 0xFF) << 8) | (V_chunk);
-			*((uint32_t *) (g_line_buf2 + col)) = ((Y2_chunk & 0xFF00) << 16) | ((U_chunk) << 16) |
-				((Y2_chunk & 0xFF) << 8) | (V_chunk);	
-			
-#endif
-			
-			Y += 2;
-			Y2 += 2;
-			U++;
-			V++;
-		}
-		
-		// if we're not doing scanlines
-		if (!(g_filter_type & FILTER_SCANLINES))
-		{
-			// no filtering at all
-			if (!(g_filter_type & FILTER_BLEND))
-			{
-				memcpy(dst_ptr, g_line_buf, (dst->w << 1));
-				memcpy(dst_ptr + channel0_pitch, g_line_buf2, (dst->w << 1));
-			}
-			else
-			{
-				g_blend_func();	// blend the two lines into g_line_buf3
-				// this won't affect video overlay because it is already doubled in size anyway
-				memcpy(dst_ptr, g_line_buf3, (dst->w << 1));
-				memcpy(dst_ptr + channel0_pitch, g_line_buf3, (dst->w << 1));
-			}
-		}
-		
-		// if we're doing scanlines
-		else
-		{
-			// do a black YUY2 line first
-			// (on nvidia it makes the top line too bright if the black line doesn't come first!)
-			for (int i = 0; i < (dst->w << 1); i+=4)
-			{
-				*((uint32_t *) (dst_ptr + i)) = YUY2_BLACK;	// this value is black in YUY2 mode
-			}
-			
-			if (g_filter_type & FILTER_BLEND)
-			{
-				g_blend_func();	// blend the two lines into g_line_buf3
-				// this won't affect video overlay because it is already doubled in size anyway
-				memcpy(dst_ptr + channel0_pitch, g_line_buf3, (dst->w << 1));
-			}
-			else
-			{
-				memcpy(dst_ptr + channel0_pitch, g_line_buf, (dst->w << 1));	// this could also be g_line_buf2
-			}			
-		}
-		
+		yuy2_write_rows(dst_ptr, channel0_pitch, rows, dst->w, bBlend, bScanlines);
+
 		dst_ptr += (channel0_pitch << 1);	// we've done 2 rows, so skip a row
-		Y += dst->w;	// we've done 2 vertical Y pixels, so skip a row
-		Y2 += dst->w;
+		rows.Y1 += (dst->w << 1);	// we've done 2 vertical Y pixels
+		rows.Y2 += (dst->w << 1);
+		rows.U += (dst->w >> 1);
+		rows.V += (dst->w >> 1);
 	}
 }
 
@@ -1946,6 +1897,33 @@ void report_parse_progress_callback(double percent_complete_01)
 	}
 }
 
+// records how late VLDP displayed (or dropped) each frame
+void report_frame_lateness_callback(uint64_t u64LateNs, int bDropped)
+{
+	telemetry_record(TELEM_FRAME_LATENESS, u64LateNs);
+	if (bDropped)
+	{
+		telemetry_count(TELEM_VLDP_DROPPED);
+	}
+}
+
+// queues VLDP's messages with the rest of the log, so that VLDP's threads don't wait on the console either
+void log_line_callback(int level, const char *pszLine)
+{
+	switch (level)
+	{
+	case VLDP_LOG_ERROR:
+		log_printf(LOGLEVEL_ERROR, "%s", pszLine);
+		break;
+	case VLDP_LOG_WARNING:
+		log_printf(LOGLEVEL_WARNING, "%s", pszLine);
+		break;
+	default:
+		log_printf(LOGLEVEL_INFO, "%s", pszLine);
+		break;
+	}
+}
+
 ///////////////////
 extern unsigned int g_draw_width, g_draw_height;
 
@@ -2041,41 +2019,14 @@ void report_mpeg_dimensions_callback(int width, int height)
 		memset(g_blank_yuv_buf.U, 127, g_blank_yuv_buf.UV_size);	// blank U color
 		g_blank_yuv_buf.V = MPO_MALLOC(g_blank_yuv_buf.UV_size);
 		memset(g_blank_yuv_buf.V, 127, g_blank_yuv_buf.UV_size);	// blank V color
-		
-		// yuy2 needs twice as much space across for lines
-		g_line_buf = MPO_MALLOC(width * 2);
-		g_line_buf2 = MPO_MALLOC(width * 2);
-		g_line_buf3 = MPO_MALLOC(width * 2);
 	}
 	// else g_hw_overlay exists, so we don't need to re-allocate it
-	
-	// This is some one-time setup stuff that will be used by the blending functions
-	// It will be used by both the prepare w/ overlay and prepare w/o overlay functions
-	if (g_filter_type & FILTER_BLEND)
-	{
-		g_blend_line1 = g_line_buf;
-		g_blend_line2 = g_line_buf2;
-		g_blend_dest = g_line_buf3;
-		// 2017.02.14 - RJS - changes back from apk texutres to surfaces
-		// APK SDL_QueryTexture(g_hw_overlay, NULL, NULL, &g_hw_overlay_w, &g_hw_overlay_h);
-		// SURFACE g_hw_overlay_h = g_hw_overlay->h;
-		// SURFACE g_hw_overlay_w = g_hw_overlay->w;
-		g_hw_overlay_h = DAPHNE_VIDEO_H;
-		g_hw_overlay_w = DAPHNE_VIDEO_W;
-
-		g_blend_iterations = g_hw_overlay_w << 1;
-	}
 }
 
 void free_yuv_overlay()
 {
 	teardown_vb();
 	
-	// free line bufs
-	MPO_FREE(g_line_buf);
-	MPO_FREE(g_line_buf2);
-	MPO_FREE(g_line_buf3);
-	
 	// free blank buf ...
 	MPO_FREE(g_blank_yuv_buf.Y);
 	MPO_FREE(g_blank_yuv_buf.U);
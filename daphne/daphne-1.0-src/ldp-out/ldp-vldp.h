@@ -84,6 +84,8 @@ public:
 	void set_framefile(const char *filename);
 	void set_altaudio(const char *audio_suffix);
 	void set_vertical_stretch(unsigned int);
+	void set_audio_cache(unsigned int uMegs);
+	unsigned int get_frames_decoded();
 
 	void test_helper(unsigned uIterations);
 	
@@ -139,6 +141,9 @@ private:
 	unsigned int m_min_seek_delay;	// min # of milliseconds to force seek to last
 	bool m_bPreCache;	// should we precache all video?
 	bool m_bPreCacheForce;	// should we still precache all video even if we don't have enough RAM?
+	bool m_bCoarseIndex;	// should VLDP scan an unparsed video file itself instead of waiting for the background parser?
+	unsigned int m_uAudioCacheMegs;	// how much RAM the PCM audio cache may use (0 = don't cache audio)
+	bool m_bPrecisePacing;	// should VLDP pace frames against absolute deadlines on a high resolution clock?
 
 	unsigned int m_uSoundChipID;	// so we can delete the soundchip once we're finished
 
@@ -157,6 +162,7 @@ private:
 	void set_audiocopy_callback();
 	void oggize_path(string &, string);
 	bool audio_init();
+	void precache_all_audio();
 	void audio_shutdown();
 	void close_audio_stream();
 	bool open_audio_stream(const string &strFilename);
@@ -175,6 +181,8 @@ void buf2overlay_YUY2(uint8_t *out_pixels, uint16_t in_pitch, int in_h, int in_w
 void update_parse_meter();
 void report_parse_progress_callback(double percent_complete);
 void report_mpeg_dimensions_callback(int, int);
+void report_frame_lateness_callback(uint64_t u64LateNs, int bDropped);
+void log_line_callback(int level, const char *pszLine);
 void free_yuv_overlay();
 void blank_overlay();
 void ldp_vldp_audio_callback(uint8_t *stream, int len, int unused);	// declaration for callback in other function
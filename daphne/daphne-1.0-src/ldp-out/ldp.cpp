@@ -38,6 +38,8 @@
 #include "../io/serial.h"
 #include "ldp.h"
 #include "../timer/timer.h"
+#include "../timer/telemetry.h"
+#include "ldptrace.h"
 #include "../io/conout.h"
 #include "framemod.h"
 #include "../game/game.h"
@@ -74,6 +76,7 @@ ldp::ldp() :
 	m_use_nonblocking_searching(true),
 	m_dont_get_search_result(false),
 	m_sram_continuous_update(false),
+	m_u64SearchStartNs(0),
 	m_noldp_timer(0),
 	m_uCurrentFrame(0),
 	m_uCurrentOffsetFrame(0),
@@ -89,6 +92,7 @@ ldp::ldp() :
 	m_uFramesToSkipPerFrame(0),
 	m_uFramesToStallPerFrame(0),
 	m_uStallFrames(0),
+	m_uTraceDepth(0),
 	m_bPreInitCalled(false)
 {
 	m_bug_log.clear();	// probably redundant, but what the heck..
@@ -199,6 +203,9 @@ bool ldp::pre_search(const char* pszFrame, bool block_until_search_finishes)
 	}
 	// end safety check
 
+	// record the frame as the game asked for it, so that the replay goes through the same frame conversion
+	trace_command(LDPTRACE_SEARCH, (unsigned int) atoi(pszFrame), block_until_search_finishes ? 1 : 0);
+
 	// Get the frame that we are on now, before we do the seek
 	// This is needed in order to calculate artificial seek delay
 	// We must do this before we change 'm_status' due to the way get_current_frame is designed
@@ -220,6 +227,7 @@ bool ldp::pre_search(const char* pszFrame, bool block_until_search_finishes)
 	}
 
 	m_status = LDP_SEARCHING;	// searching can take a while
+	m_u64SearchStartNs = telemetry_start();
 
 	// If we need to alter the frame # before searching
 	if (need_frame_conversion())
@@ -361,6 +369,8 @@ bool ldp::pre_skip_forward(uint16_t frames_to_skip)
 {
 	bool result = false;
 
+	trace_command(LDPTRACE_SKIP_FORWARD, frames_to_skip);
+
 	// only skip if the LDP is playing
 	if (m_status == LDP_PLAYING)
 	{
@@ -369,7 +379,10 @@ bool ldp::pre_skip_forward(uint16_t frames_to_skip)
 
 		m_iSkipOffsetSincePlay += frames_to_skip;
 
+		// skip_forward may be implemented as a search and play, which must not show up in the trace
+		m_uTraceDepth++;
 		result = skip_forward(frames_to_skip, target_frame);
+		m_uTraceDepth--;
 
 		char s[160];
 		snprintf(s, sizeof(s), "Skipped forward %d frames (from %u to %u)", frames_to_skip, uOldCurrentFrame, target_frame);
@@ -389,6 +402,8 @@ bool ldp::pre_skip_backward(uint16_t frames_to_skip)
 {
 	bool result = false;
 
+	trace_command(LDPTRACE_SKIP_BACKWARD, frames_to_skip);
+
 	// only skip if the LDP is playing
 	if (m_status == LDP_PLAYING)
 	{
@@ -397,7 +412,9 @@ bool ldp::pre_skip_backward(uint16_t frames_to_skip)
 
 		m_iSkipOffsetSincePlay -= frames_to_skip;
 
+		m_uTraceDepth++;
 		result = skip_backward(frames_to_skip, target_frame);
+		m_uTraceDepth--;
 
 		char s[81];
 		snprintf(s, sizeof(s), "Skipped backward %d frames (from %u to %u)", frames_to_skip, uOldCurrentFrame, target_frame);
@@ -418,12 +435,16 @@ void ldp::pre_step_forward()
 	char frame[6];
 	uint16_t new_frame = m_uCurrentFrame;
 
+	trace_command(LDPTRACE_STEP_FORWARD);
+
 	// bounds check (if we haven't overflowed)
 	if (new_frame < ((uint16_t) -1))
 	{
 		framenum_to_frame(m_uCurrentFrame + 1, frame);
 		printline("LDP : Stepping forward one frame");
+		m_uTraceDepth++;
 		g_ldp->pre_search(frame, true);
+		m_uTraceDepth--;
 	}
 	else
 	{
@@ -438,6 +459,8 @@ void ldp::pre_step_backward()
 	char frame[6];
 	uint16_t new_frame = m_uCurrentFrame;
 
+	trace_command(LDPTRACE_STEP_BACKWARD);
+
 	// don't step backward before the first frame on the disc
 	if (new_frame > 0)
 	{
@@ -446,7 +469,9 @@ void ldp::pre_step_backward()
 
 	framenum_to_frame(new_frame, frame);
 	printline("LDP : Stepping backward one frame");
+	m_uTraceDepth++;
 	g_ldp->pre_search(frame, true);
+	m_uTraceDepth--;
 }
 
 // skips forward a certain number of frames and continues playing
@@ -486,6 +511,8 @@ void ldp::pre_play()
 {
 	//	uint32_t cpu_hz;	// used to calculate elapsed cycles
 
+	trace_command(LDPTRACE_PLAY);
+
 	// safety check, if they try to play without checking the search result ...
 	// THIS SAFETY CHECK CAN BE REMOVED ONCE ALL LDP DRIVERS HAVE BEEN CONVERTED OVER TO NON-BLOCKING SEEKING
 	if (m_status == LDP_SEARCHING)
@@ -545,6 +572,8 @@ unsigned int ldp::play()
 // prepares to pause
 void ldp::pre_pause()
 {
+	trace_command(LDPTRACE_PAUSE);
+
 	// only send pause command if disc is playing
 	// some games (Super Don) repeatedly flood with a pause command and this doesn't work well with the Hitachi
 	if (m_status == LDP_PLAYING)
@@ -571,6 +600,8 @@ void ldp::pause()
 // the player has to spin up again to begin playing
 void ldp::pre_stop()
 {
+	trace_command(LDPTRACE_STOP);
+
 	m_last_seeked_frame = m_uCurrentFrame = 0;
 	stop();
 	m_status = LDP_STOPPED;
@@ -586,6 +617,8 @@ bool ldp::pre_change_speed(unsigned int uNumerator, unsigned int uDenominator)
 {
 	string strMsg;
 
+	trace_command(LDPTRACE_SPEED, uNumerator, uDenominator);
+
 	// if this is >= 1X
 	if (uDenominator == 1)
 	{
@@ -855,6 +888,20 @@ unsigned int ldp::get_vblank_mini_count()
 	return m_uVblankMiniCount;
 }
 
+unsigned int ldp::get_frames_decoded()
+{
+	return 0;
+}
+
+void ldp::trace_command(unsigned int uType, unsigned int uArg1, unsigned int uArg2)
+{
+	// commands that we send to ourselves (such as the search that a step is made of) are not recorded
+	if (m_uTraceDepth == 0)
+	{
+		ldptrace_record(m_uElapsedMsSinceStart, uType, uArg1, uArg2);
+	}
+}
+
 bool ldp::is_vldp()
 {
 	return m_bIsVLDP;
@@ -887,6 +934,7 @@ int ldp::get_status()
 			m_dont_get_search_result = true;
 			m_last_seeked_frame = m_uCurrentFrame = m_last_try_frame;
 			m_status = LDP_PAUSED;
+			telemetry_stop(TELEM_SEEK_LATENCY, m_u64SearchStartNs);
 
 			// Update sram after every search if user desires it
 			//  (so that the DAPHNE can be improperly terminated, if it's inside a cab and powered off, for example)
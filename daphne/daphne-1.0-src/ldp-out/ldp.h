@@ -187,6 +187,9 @@ public:
 	virtual void set_seek_frames_per_ms(double value);
 	virtual void set_min_seek_delay(unsigned int value);
 
+	// returns how many frames the player has decoded since it was initialized (0 if the player doesn't decode anything)
+	virtual unsigned int get_frames_decoded();
+
 	// END LDP-SPECIFIC SECTION
 
 	bool is_vldp();	// returns true if our ldp type is VLDP
@@ -243,6 +246,7 @@ protected:
 	bool m_use_nonblocking_searching;	// true if ldp-in drivers should use pre_search in non-blocking mode (as of now, blocking mode is more stable but non-blocking mode is more accurate)
 	bool m_dont_get_search_result;	// if we should not be calling get_search_result()
 	bool m_sram_continuous_update;  // if sram is to be updated on a regular basis
+	uint64_t m_u64SearchStartNs;	// when the current search was requested (for telemetry, 0 if telemetry is disabled)
 
 	// timer to be used to simulate search delay when in 'noldp' mode (for debugging)
 	uint32_t m_noldp_timer;
@@ -301,6 +305,12 @@ protected:
 	// State variable to keep track of whether we're stalling (according to m_uFramesToStallPerFrame)
 	unsigned int m_uStallFrames;
 
+	// records a command into the laserdisc command trace (see ldptrace.h)
+	void trace_command(unsigned int uType, unsigned int uArg1 = 0, unsigned int uArg2 = 0);
+
+	// how deep we are in commands that call other commands (only the outermost command gets traced)
+	unsigned int m_uTraceDepth;
+
 private:
 	// set to true if pre_init has been called (used to error checking)
 	bool m_bPreInitCalled;
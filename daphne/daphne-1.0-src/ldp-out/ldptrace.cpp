@@ -0,0 +1,171 @@
+/*
+ * ldptrace.cpp
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// ldptrace.cpp -- records every command sent to the laserdisc player so that it can be replayed later
+
+// A trace looks like this:
+//  # daphne ldp trace
+//  1234 search 5000 0
+//  3456 play
+//  ...
+// Each line is the emulated millisecond that the command was sent, the command, and its arguments (if any).
+
+#include <stdio.h>
+#include <string.h>
+#include "ldptrace.h"
+#include "../io/numstr.h"
+
+#define LDPTRACE_HEADER "# daphne ldp trace"
+
+static const char *g_ldptrace_names[LDPTRACE_COUNT] =
+{
+	"search",
+	"play",
+	"pause",
+	"stop",
+	"skip_forward",
+	"skip_backward",
+	"step_forward",
+	"step_backward",
+	"speed"
+};
+
+// how many arguments each command has
+static const unsigned int g_ldptrace_args[LDPTRACE_COUNT] =
+{
+	2, 0, 0, 0, 1, 1, 0, 0, 2
+};
+
+static FILE *g_ldptrace_file = NULL;
+
+bool ldptrace_start(const char *pszPath)
+{
+	ldptrace_stop();
+
+	g_ldptrace_file = fopen(pszPath, "wt");
+	if (!g_ldptrace_file)
+	{
+		return false;
+	}
+
+	fprintf(g_ldptrace_file, "%s\n", LDPTRACE_HEADER);
+	return true;
+}
+
+void ldptrace_record(unsigned int uMs, unsigned int uType, unsigned int uArg1, unsigned int uArg2)
+{
+	if (!g_ldptrace_file)
+	{
+		return;
+	}
+
+	switch (g_ldptrace_args[uType])
+	{
+	case 0:
+		fprintf(g_ldptrace_file, "%u %s\n", uMs, g_ldptrace_names[uType]);
+		break;
+	case 1:
+		fprintf(g_ldptrace_file, "%u %s %u\n", uMs, g_ldptrace_names[uType], uArg1);
+		break;
+	default:
+		fprintf(g_ldptrace_file, "%u %s %u %u\n", uMs, g_ldptrace_names[uType], uArg1, uArg2);
+		break;
+	}
+}
+
+void ldptrace_stop()
+{
+	if (g_ldptrace_file)
+	{
+		fclose(g_ldptrace_file);
+		g_ldptrace_file = NULL;
+	}
+}
+
+bool ldptrace_load(const char *pszPath, vector<ldptrace_cmd> &vCmds, string &strErrMsg)
+{
+	FILE *F = fopen(pszPath, "rt");
+	char line[160];
+	unsigned int uLine = 0;
+	bool bResult = true;
+
+	vCmds.clear();
+
+	if (!F)
+	{
+		strErrMsg = "Could not open ";
+		strErrMsg += pszPath;
+		return false;
+	}
+
+	while (bResult && fgets(line, sizeof(line), F))
+	{
+		ldptrace_cmd cmd;
+		char name[32] = { 0 };
+		int iFields = 0;
+		unsigned int uType = 0;
+
+		uLine++;
+
+		// skip comments and blank lines
+		if ((line[0] == '#') || (line[strspn(line, " \t\r\n")] == 0))
+		{
+			continue;
+		}
+
+		memset(&cmd, 0, sizeof(cmd));
+		iFields = sscanf(line, "%u %31s %u %u", &cmd.uMs, name, &cmd.uArg1, &cmd.uArg2);
+
+		for (uType = 0; uType < LDPTRACE_COUNT; uType++)
+		{
+			if (strcmp(name, g_ldptrace_names[uType]) == 0)
+			{
+				break;
+			}
+		}
+
+		// each line must have a time, a known command and all of the command's arguments
+		if ((iFields < 2) || (uType == LDPTRACE_COUNT) || (iFields < (int) (2 + g_ldptrace_args[uType])))
+		{
+			strErrMsg = "Line " + numstr::ToStr(uLine) + " of ";
+			strErrMsg += pszPath;
+			strErrMsg += " is not a valid command";
+			bResult = false;
+		}
+		// commands must be in the order they happened
+		else if (!vCmds.empty() && (cmd.uMs < vCmds.back().uMs))
+		{
+			strErrMsg = "Line " + numstr::ToStr(uLine) + " of ";
+			strErrMsg += pszPath;
+			strErrMsg += " is out of order";
+			bResult = false;
+		}
+		else
+		{
+			cmd.uType = uType;
+			vCmds.push_back(cmd);
+		}
+	}
+
+	fclose(F);
+	return bResult;
+}
@@ -0,0 +1,71 @@
+/*
+ * ldptrace.h
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// ldptrace.h -- records every command sent to the laserdisc player so that it can be replayed later (see ldpreplay)
+
+#ifndef LDPTRACE_H
+#define LDPTRACE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// the commands that get recorded
+enum
+{
+	LDPTRACE_SEARCH,	// uArg1 = frame, uArg2 = 1 if the search was blocking
+	LDPTRACE_PLAY,
+	LDPTRACE_PAUSE,
+	LDPTRACE_STOP,
+	LDPTRACE_SKIP_FORWARD,	// uArg1 = how many frames
+	LDPTRACE_SKIP_BACKWARD,	// uArg1 = how many frames
+	LDPTRACE_STEP_FORWARD,
+	LDPTRACE_STEP_BACKWARD,
+	LDPTRACE_SPEED,	// uArg1/uArg2 = the new speed
+	LDPTRACE_COUNT
+};
+
+struct ldptrace_cmd
+{
+	unsigned int uMs;	// emulated time (ms since the laserdisc player started) when the command was sent
+	unsigned int uType;	// LDPTRACE_
+	unsigned int uArg1;
+	unsigned int uArg2;
+};
+
+// Starts recording commands to 'pszPath' (a text file, one command per line).
+// Returns false if the file couldn't be created.
+bool ldptrace_start(const char *pszPath);
+
+// records one command (does nothing if we aren't recording)
+void ldptrace_record(unsigned int uMs, unsigned int uType, unsigned int uArg1 = 0, unsigned int uArg2 = 0);
+
+// stops recording and closes the file
+void ldptrace_stop();
+
+// Loads a trace that was recorded by ldptrace_start into 'vCmds'.
+// Returns false (with an explanation in 'strErrMsg') if the file can't be read or is malformed.
+bool ldptrace_load(const char *pszPath, vector<ldptrace_cmd> &vCmds, string &strErrMsg);
+
+#endif // LDPTRACE_H
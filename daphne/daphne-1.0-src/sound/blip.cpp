@@ -0,0 +1,162 @@
+/*
+ * blip.cpp
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// blip.cpp
+// see blip.h for what this is for
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include "sound.h"
+#include "blip.h"
+
+using namespace std;
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// the step is placed with 1/BLIP_PHASES of a sample precision
+#define BLIP_PHASE_BITS 5
+#define BLIP_PHASES (1 << BLIP_PHASE_BITS)
+
+// how many samples each step is spread across (this is also how many samples of delay the buffer adds)
+#define BLIP_TAPS 16
+
+// kernel values are fixed point with this many fraction bits (so a whole step adds up to 1 << BLIP_KERNEL_BITS)
+#define BLIP_KERNEL_BITS 12
+
+// For each phase, how much of the step lands on each sample.
+// Each row adds up to exactly 1 << BLIP_KERNEL_BITS, so the output always settles on the exact level.
+static int g_blip_kernel[BLIP_PHASES][BLIP_TAPS];
+static bool g_blip_kernel_ready = false;
+
+struct blip_s
+{
+	vector<int> vDeltas;	// steps that haven't been read yet (in kernel units), index 0 is the next sample
+	int iLevel;	// the integrated output level (in kernel units)
+};
+
+// the band-limited step: the integral of a Blackman windowed sinc from -BLIP_TAPS/2 to x
+static double blip_step(double x)
+{
+	const double dHalf = BLIP_TAPS / 2;
+	const double dCutoff = 0.45;	// in cycles per sample (a bit below the nyquist frequency)
+	const int iSlices = 256;	// per sample
+	double dSum = 0.0;
+
+	if (x > dHalf)
+		x = dHalf;
+
+	// midpoint integration is plenty accurate here since the kernel gets normalized anyway
+	for (double t = -dHalf + (0.5 / iSlices); t < x; t += 1.0 / iSlices)
+	{
+		double dSinc = (t == 0.0) ? 1.0 : sin(2.0 * M_PI * dCutoff * t) / (2.0 * M_PI * dCutoff * t);
+		double dWindow = 0.42 + 0.5 * cos(M_PI * t / dHalf) + 0.08 * cos(2.0 * M_PI * t / dHalf);
+		dSum += 2.0 * dCutoff * dSinc * dWindow / iSlices;
+	}
+
+	return dSum;
+}
+
+static void blip_make_kernel()
+{
+	const int iUnity = 1 << BLIP_KERNEL_BITS;
+
+	for (int p = 0; p < BLIP_PHASES; p++)
+	{
+		double dPhase = (double) p / BLIP_PHASES;
+		double dTotal = blip_step(BLIP_TAPS);
+		int iSum = 0, iBiggest = 0;
+
+		for (int j = 0; j < BLIP_TAPS; j++)
+		{
+			double dPart = blip_step(j - dPhase - (BLIP_TAPS / 2) + 1) - blip_step(j - dPhase - (BLIP_TAPS / 2));
+			g_blip_kernel[p][j] = (int) floor((dPart / dTotal) * iUnity + 0.5);
+			iSum += g_blip_kernel[p][j];
+			if (g_blip_kernel[p][j] > g_blip_kernel[p][iBiggest])
+				iBiggest = j;
+		}
+
+		// make sure rounding didn't leave the step a little too big or too small
+		g_blip_kernel[p][iBiggest] += iUnity - iSum;
+	}
+
+	g_blip_kernel_ready = true;
+}
+
+blip_s *blip_new()
+{
+	if (!g_blip_kernel_ready)
+		blip_make_kernel();
+
+	blip_s *pBlip = new blip_s;
+	pBlip->vDeltas.assign(BLIP_TAPS, 0);
+	pBlip->iLevel = 0;
+	return pBlip;
+}
+
+void blip_delete(blip_s *pBlip)
+{
+	delete pBlip;
+}
+
+void blip_add_delta(blip_s *pBlip, uint32_t uTime, int iDelta)
+{
+	unsigned int uSample = uTime >> BLIP_FRAC_BITS;
+	const int *pKernel = g_blip_kernel[(uTime >> (BLIP_FRAC_BITS - BLIP_PHASE_BITS)) & (BLIP_PHASES - 1)];
+
+	if (uSample + BLIP_TAPS > pBlip->vDeltas.size())
+		pBlip->vDeltas.resize(uSample + BLIP_TAPS, 0);
+
+	int *pDst = &pBlip->vDeltas[uSample];
+	for (int j = 0; j < BLIP_TAPS; j++)
+		pDst[j] += iDelta * pKernel[j];
+}
+
+void blip_read_stereo(blip_s *pBlip, uint8_t *stream, unsigned int uSamples)
+{
+	if (uSamples + BLIP_TAPS > pBlip->vDeltas.size())
+		pBlip->vDeltas.resize(uSamples + BLIP_TAPS, 0);
+
+	int *pDeltas = &pBlip->vDeltas[0];
+	int iLevel = pBlip->iLevel;
+
+	for (unsigned int u = 0; u < uSamples; u++)
+	{
+		iLevel += pDeltas[u];
+
+		int iSample = iLevel >> BLIP_KERNEL_BITS;
+		DO_CLIP(iSample);
+
+		// NOTE : stream is little endian
+		stream[0] = stream[2] = (uint8_t) (iSample & 0xFF);
+		stream[1] = stream[3] = (uint8_t) ((iSample >> 8) & 0xFF);
+		stream += 4;
+	}
+	pBlip->iLevel = iLevel;
+
+	// the tails of the steps we just read belong to the next samples
+	memmove(pDeltas, pDeltas + uSamples, BLIP_TAPS * sizeof(int));
+	memset(pDeltas + BLIP_TAPS, 0, (pBlip->vDeltas.size() - BLIP_TAPS) * sizeof(int));
+}
@@ -0,0 +1,51 @@
+/*
+ * blip.h
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// blip.h
+// Band-limited step buffer for square wave sound chips (such as the AY-3-8910 and the TMS9919).
+// Instead of rendering every output sample, a chip records each time its output level changes (with sub-sample
+//  precision), and the buffer turns those steps into samples when they are read.  So the cost depends on how
+//  many edges there are rather than how many samples, and the edges don't alias.
+
+#ifndef BLIP_H
+#define BLIP_H
+
+#include <stdint.h>
+
+// how many fraction bits blip times have (a time of (1 << BLIP_FRAC_BITS) is one output sample)
+#define BLIP_FRAC_BITS 16
+
+struct blip_s;
+
+// creates a new (silent) buffer
+blip_s *blip_new();
+
+void blip_delete(blip_s *pBlip);
+
+// makes the output level step by 'iDelta' at 'uTime', which is relative to the first sample that hasn't been read yet
+void blip_add_delta(blip_s *pBlip, uint32_t uTime, int iDelta);
+
+// writes 'uSamples' stereo samples (both channels the same) to 'stream' and discards them from the buffer
+// All steps before (uSamples << BLIP_FRAC_BITS) need to have been added first.
+void blip_read_stereo(blip_s *pBlip, uint8_t *stream, unsigned int uSamples);
+
+#endif // BLIP_H
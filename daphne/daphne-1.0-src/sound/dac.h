@@ -28,8 +28,9 @@
 // init callback
 int dac_init(uint32_t unused);
 
-// should be called from the game driver
-void dac_ctrl_data(unsigned int uSamplesSinceLastChange, unsigned int uByte, int internal_id);
+// should be called from the game driver (through audio_write_ctrl_data) with the new 8-bit sample value
+// The first argument is ignored, it is only there so that this can be a write_ctrl_data_callback.
+void dac_ctrl_data(unsigned int uUnused, unsigned int uByte, int internal_id);
 
 // called from sound mixer to get audio stream
 void dac_get_stream(uint8_t *stream, int length, int internal_id);
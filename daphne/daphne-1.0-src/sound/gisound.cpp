@@ -23,6 +23,7 @@
 // by Mark Broadhead
 // an attempt at a portable AY-3-8910 emulator
 // We assume that there are 4 bytes per sample
+// The output goes through a band-limited step buffer (see blip.h), so we only do work when something changes.
 #ifdef _WIN32
 #define _CRT_SECURE_NO_WARNINGS 1
 #endif
@@ -33,6 +34,7 @@
 
 #include "sound.h"
 #include "gisound.h"
+#include "blip.h"
 #include "../io/conout.h"
 
 #define MAX_GISOUND_CHIPS 4
@@ -41,27 +43,57 @@ int g_gisoundchip_count = -1;
 gi_sound_chip *g_gi_chips[MAX_GISOUND_CHIPS] = { NULL };
 int16_t g_volumetable[16];
 
+// the shortest time we allow between switches (1 sample, same as it has always been)
+static const int64_t GI_MIN_SWITCH_TIME = (int64_t) 1 << BLIP_FRAC_BITS;
+
+// converts a count of chip clocks into blip time (samples << BLIP_FRAC_BITS)
+static int64_t gisound_clocks_to_time(gi_sound_chip *chip, double dClocks)
+{
+   int64_t s64Time = (int64_t) ((AUDIO_FREQ * dClocks * (double) GI_MIN_SWITCH_TIME / chip->core_clock) + .5);
+   if (s64Time < GI_MIN_SWITCH_TIME)
+   {
+      s64Time = GI_MIN_SWITCH_TIME;
+   }
+   return s64Time;
+}
+
+// the level the chip is outputting right now
+static int gisound_level(gi_sound_chip *chip)
+{
+   return (int16_t) ((g_volumetable[chip->chan_a_amplitude] * 
+      ((chip->tone_a?chip->chan_a_flip:1) 
+      + (chip->noise_a?chip->noise_flip:1)) / 2 +
+      g_volumetable[chip->chan_b_amplitude] * 
+      ((chip->tone_b?chip->chan_b_flip:1) 
+      + (chip->noise_b?chip->noise_flip:1)) / 2 +
+      g_volumetable[chip->chan_c_amplitude] * 
+      ((chip->tone_c?chip->chan_c_flip:1) 
+      + (chip->noise_c?chip->noise_flip:1)) / 2) / 3);
+}
+
 int gisound_initialize(uint32_t core_frequency)
 {
    char s[81] = {0};
    sprintf(s, "GI Sound chip initialized at %d Hz", core_frequency);
    printline(s);
-   g_gi_chips[++g_gisoundchip_count] = new gi_sound_chip;
-   memset(g_gi_chips[g_gisoundchip_count],0,sizeof(gi_sound_chip));
-   g_gi_chips[g_gisoundchip_count]->core_clock = core_frequency;
-   g_gi_chips[g_gisoundchip_count]->chan_a_bytes_per_switch = 4;
-	g_gi_chips[g_gisoundchip_count]->chan_a_bytes_to_go = 0;
-   g_gi_chips[g_gisoundchip_count]->chan_a_flip = 1;
-   g_gi_chips[g_gisoundchip_count]->chan_b_bytes_per_switch = 4;
-	g_gi_chips[g_gisoundchip_count]->chan_b_bytes_to_go = 0;
-   g_gi_chips[g_gisoundchip_count]->chan_b_flip = 1;
-   g_gi_chips[g_gisoundchip_count]->chan_c_bytes_per_switch = 4;
-	g_gi_chips[g_gisoundchip_count]->chan_c_bytes_to_go = 0;
-   g_gi_chips[g_gisoundchip_count]->chan_c_flip = 1;
-   g_gi_chips[g_gisoundchip_count]->noise_bytes_per_switch = 4;
-   g_gi_chips[g_gisoundchip_count]->noise_flip = 1;
-   g_gi_chips[g_gisoundchip_count]->random_seed = 0;
-   g_gi_chips[g_gisoundchip_count]->envelope_period = 4;
+   gi_sound_chip *chip = g_gi_chips[++g_gisoundchip_count] = new gi_sound_chip;
+   memset(chip,0,sizeof(gi_sound_chip));
+   chip->core_clock = core_frequency;
+   chip->chan_a_time_per_switch = GI_MIN_SWITCH_TIME;
+   chip->chan_a_time_to_go = 0;
+   chip->chan_a_flip = 1;
+   chip->chan_b_time_per_switch = GI_MIN_SWITCH_TIME;
+   chip->chan_b_time_to_go = 0;
+   chip->chan_b_flip = 1;
+   chip->chan_c_time_per_switch = GI_MIN_SWITCH_TIME;
+   chip->chan_c_time_to_go = 0;
+   chip->chan_c_flip = 1;
+   chip->noise_time_per_switch = GI_MIN_SWITCH_TIME;
+   chip->noise_flip = 1;
+   chip->random_seed = 0;
+   chip->envelope_period = GI_MIN_SWITCH_TIME;
+   chip->blip = blip_new();
+   chip->last_level = 0;
 
    int i = 0;
 
@@ -90,12 +122,12 @@ int gisound_initialize(uint32_t core_frequency)
 
 void gisound_writedata(uint32_t address, uint32_t data, int index)
 {
+   gi_sound_chip *chip = g_gi_chips[index];
    uint16_t chan_a_tone_period;
    uint16_t chan_b_tone_period;
    uint16_t chan_c_tone_period;
-   g_gi_chips[index]->register_set[address] = data;
-   int old_bytes_per_switch = 0;
-//	char s[81] = {0};
+   chip->register_set[address] = data;
+   int64_t old_time_per_switch = 0;
 	bool old_tone_a, old_tone_b, old_tone_c;
 
    switch (address)
@@ -104,285 +136,291 @@ void gisound_writedata(uint32_t address, uint32_t data, int index)
    case CHANNEL_A_TONE_PERIOD_COARSE:
       // fine adjustment is bottom 8 bits of 12 bit total value
       // coarse adjustment is top 4 bits of 12 bit total value
-      chan_a_tone_period = g_gi_chips[index]->register_set[CHANNEL_A_TONE_PERIOD_FINE] | 
-         (g_gi_chips[index]->register_set[CHANNEL_A_TONE_PERIOD_COARSE] << 8);
-      old_bytes_per_switch = g_gi_chips[index]->chan_a_bytes_per_switch;
-      g_gi_chips[index]->chan_a_bytes_per_switch = (int)((AUDIO_FREQ * (chan_a_tone_period * 16.0) 
-         / g_gi_chips[index]->core_clock * 2) + .5);
-      if (g_gi_chips[index]->chan_a_bytes_per_switch < 4)
-      {
-         g_gi_chips[index]->chan_a_bytes_per_switch = 4;
-      }
-      g_gi_chips[index]->chan_a_bytes_to_go += g_gi_chips[index]->chan_a_bytes_per_switch - old_bytes_per_switch;
+      chan_a_tone_period = chip->register_set[CHANNEL_A_TONE_PERIOD_FINE] | 
+         (chip->register_set[CHANNEL_A_TONE_PERIOD_COARSE] << 8);
+      old_time_per_switch = chip->chan_a_time_per_switch;
+      // the output switches every 8 clocks per period (a full cycle is 16)
+      chip->chan_a_time_per_switch = gisound_clocks_to_time(chip, chan_a_tone_period * 8.0);
+      chip->chan_a_time_to_go += chip->chan_a_time_per_switch - old_time_per_switch;
       break;
    
    case CHANNEL_B_TONE_PERIOD_FINE:
    case CHANNEL_B_TONE_PERIOD_COARSE:
       // fine adjustment is bottom 8 bits of 12 bit total value
       // coarse adjustment is top 4 bits of 12 bit total value
-      chan_b_tone_period = g_gi_chips[index]->register_set[CHANNEL_B_TONE_PERIOD_FINE] | 
-         (g_gi_chips[index]->register_set[CHANNEL_B_TONE_PERIOD_COARSE] << 8);
-      old_bytes_per_switch = g_gi_chips[index]->chan_b_bytes_per_switch;
-      g_gi_chips[index]->chan_b_bytes_per_switch = (int)((AUDIO_FREQ * (chan_b_tone_period * 16.0) 
-         / g_gi_chips[index]->core_clock * 2) + .5);
-      if (g_gi_chips[index]->chan_b_bytes_per_switch < 4)
-      {
-         g_gi_chips[index]->chan_b_bytes_per_switch = 4;
-      }
-      g_gi_chips[index]->chan_b_bytes_to_go += g_gi_chips[index]->chan_b_bytes_per_switch - old_bytes_per_switch;
+      chan_b_tone_period = chip->register_set[CHANNEL_B_TONE_PERIOD_FINE] | 
+         (chip->register_set[CHANNEL_B_TONE_PERIOD_COARSE] << 8);
+      old_time_per_switch = chip->chan_b_time_per_switch;
+      chip->chan_b_time_per_switch = gisound_clocks_to_time(chip, chan_b_tone_period * 8.0);
+      chip->chan_b_time_to_go += chip->chan_b_time_per_switch - old_time_per_switch;
       break;
    
    case CHANNEL_C_TONE_PERIOD_FINE:
    case CHANNEL_C_TONE_PERIOD_COARSE:
       // fine adjustment is bottom 8 bits of 12 bit total value
       // coarse adjustment is top 4 bits of 12 bit total value
-      chan_c_tone_period = g_gi_chips[index]->register_set[CHANNEL_C_TONE_PERIOD_FINE] | 
-         (g_gi_chips[index]->register_set[CHANNEL_C_TONE_PERIOD_COARSE] << 8);
-      old_bytes_per_switch = g_gi_chips[index]->chan_c_bytes_per_switch;
-      g_gi_chips[index]->chan_c_bytes_per_switch = (int)((AUDIO_FREQ * (chan_c_tone_period * 16.0) 
-         / g_gi_chips[index]->core_clock * 2) + .5);
-      if (g_gi_chips[index]->chan_c_bytes_per_switch < 4)
-      {
-         g_gi_chips[index]->chan_c_bytes_per_switch = 4;
-      }
-      g_gi_chips[index]->chan_c_bytes_to_go += g_gi_chips[index]->chan_c_bytes_per_switch - old_bytes_per_switch;
+      chan_c_tone_period = chip->register_set[CHANNEL_C_TONE_PERIOD_FINE] | 
+         (chip->register_set[CHANNEL_C_TONE_PERIOD_COARSE] << 8);
+      old_time_per_switch = chip->chan_c_time_per_switch;
+      chip->chan_c_time_per_switch = gisound_clocks_to_time(chip, chan_c_tone_period * 8.0);
+      chip->chan_c_time_to_go += chip->chan_c_time_per_switch - old_time_per_switch;
       break;
    
    case NOISE_PERIOD:
       // noise period is 5 bits
-      g_gi_chips[index]->noise_period = data & 0x1f;
-      old_bytes_per_switch = g_gi_chips[index]->noise_bytes_per_switch;
-      g_gi_chips[index]->noise_bytes_per_switch = (int)((AUDIO_FREQ * (g_gi_chips[index]->noise_period * 16.0) 
-         / g_gi_chips[index]->core_clock * 2) + .5);
-      if (g_gi_chips[index]->noise_bytes_per_switch < 4)
-      {
-         g_gi_chips[index]->noise_bytes_per_switch = 4;
-      }
-      g_gi_chips[index]->noise_bytes_to_go += g_gi_chips[index]->noise_bytes_per_switch - old_bytes_per_switch;
+      chip->noise_period = data & 0x1f;
+      old_time_per_switch = chip->noise_time_per_switch;
+      chip->noise_time_per_switch = gisound_clocks_to_time(chip, chip->noise_period * 8.0);
+      chip->noise_time_to_go += chip->noise_time_per_switch - old_time_per_switch;
 		g_gi_chips[g_gisoundchip_count]->noise_flip = 1;
       break;
 
    case ENABLE:
 	
-		old_tone_a = g_gi_chips[index]->tone_a;
-		old_tone_b = g_gi_chips[index]->tone_a;
-		old_tone_c = g_gi_chips[index]->tone_a;
+		old_tone_a = chip->tone_a;
+		old_tone_b = chip->tone_a;
+		old_tone_c = chip->tone_a;
 
 		// ENABLE is active low
-		g_gi_chips[index]->iob_in  = (uint8_t)(~(data >> 7)) & 0x01;
-		g_gi_chips[index]->ioa_in  = (uint8_t)(~(data >> 6)) & 0x01;
-		g_gi_chips[index]->noise_c = (uint8_t)(~(data >> 5)) & 0x01;
-		g_gi_chips[index]->noise_b = (uint8_t)(~(data >> 4)) & 0x01;
-		g_gi_chips[index]->noise_a = (uint8_t)(~(data >> 3)) & 0x01;
-		g_gi_chips[index]->tone_c  = (uint8_t)(~(data >> TONE_C_ENABLE)) & 0x01;
-		g_gi_chips[index]->tone_b  = (uint8_t)(~(data >> TONE_B_ENABLE)) & 0x01;
-		g_gi_chips[index]->tone_a  = (uint8_t)(~(data >> TONE_A_ENABLE)) & 0x01;
+		chip->iob_in  = (uint8_t)(~(data >> 7)) & 0x01;
+		chip->ioa_in  = (uint8_t)(~(data >> 6)) & 0x01;
+		chip->noise_c = (uint8_t)(~(data >> 5)) & 0x01;
+		chip->noise_b = (uint8_t)(~(data >> 4)) & 0x01;
+		chip->noise_a = (uint8_t)(~(data >> 3)) & 0x01;
+		chip->tone_c  = (uint8_t)(~(data >> TONE_C_ENABLE)) & 0x01;
+		chip->tone_b  = (uint8_t)(~(data >> TONE_B_ENABLE)) & 0x01;
+		chip->tone_a  = (uint8_t)(~(data >> TONE_A_ENABLE)) & 0x01;
 		
 		// if these were just enabled reset the counters
-		if (g_gi_chips[index]->tone_a && !old_tone_a)
+		if (chip->tone_a && !old_tone_a)
 		{
          g_gi_chips[g_gisoundchip_count]->chan_a_flip = 1;
-			g_gi_chips[index]->chan_a_bytes_to_go = g_gi_chips[index]->chan_a_bytes_per_switch;
+			chip->chan_a_time_to_go = chip->chan_a_time_per_switch;
 		}
-		if (g_gi_chips[index]->tone_b && !old_tone_b)
+		if (chip->tone_b && !old_tone_b)
 		{
          g_gi_chips[g_gisoundchip_count]->chan_b_flip = 1;
-			g_gi_chips[index]->chan_b_bytes_to_go = g_gi_chips[index]->chan_b_bytes_per_switch;
+			chip->chan_b_time_to_go = chip->chan_b_time_per_switch;
 		}
-		if (g_gi_chips[index]->tone_c && !old_tone_c)
+		if (chip->tone_c && !old_tone_c)
 		{
          g_gi_chips[g_gisoundchip_count]->chan_c_flip = 1;
-			g_gi_chips[index]->chan_c_bytes_to_go = g_gi_chips[index]->chan_c_bytes_per_switch;
+			chip->chan_c_time_to_go = chip->chan_c_time_per_switch;
 		}
 		break;
       
    case CHANNEL_A_AMPLITUDE:
       // bits 0-3 are the fixed amplitude level
       // bit 4 is the amplitude level mode
-      g_gi_chips[index]->chan_a_amplitude_mode = (data >> 4) & 0x01;
-      if (!g_gi_chips[index]->chan_a_amplitude_mode)
+      chip->chan_a_amplitude_mode = (data >> 4) & 0x01;
+      if (!chip->chan_a_amplitude_mode)
       {
-         g_gi_chips[index]->chan_a_amplitude = data & 0x0f;
+         chip->chan_a_amplitude = data & 0x0f;
       }
       break;
 
    case CHANNEL_B_AMPLITUDE:
       // bits 0-3 are the fixed amplitude level
       // bit 4 is the amplitude level mode
-      g_gi_chips[index]->chan_b_amplitude_mode = (data >> 4) & 0x01;
-      if (!g_gi_chips[index]->chan_b_amplitude_mode)
+      chip->chan_b_amplitude_mode = (data >> 4) & 0x01;
+      if (!chip->chan_b_amplitude_mode)
       {
-         g_gi_chips[index]->chan_b_amplitude = data & 0x0f;
+         chip->chan_b_amplitude = data & 0x0f;
       }
 		break;
 
    case CHANNEL_C_AMPLITUDE:
       // bits 0-3 are the fixed amplitude level
       // bit 4 is the amplitude level mode
-      g_gi_chips[index]->chan_c_amplitude_mode = (data >> 4) & 0x01;
-      if (!g_gi_chips[index]->chan_c_amplitude_mode)
+      chip->chan_c_amplitude_mode = (data >> 4) & 0x01;
+      if (!chip->chan_c_amplitude_mode)
       {
-         g_gi_chips[index]->chan_c_amplitude = data & 0x0f;
+         chip->chan_c_amplitude = data & 0x0f;
       }
 		break;
 
    case ENVELOPE_PERIOD_FINE:
    case ENVELOPE_PERIOD_COARSE:
       // Envelope Period is a 16 bit number made up of COURSE<<8|FINE
-      g_gi_chips[index]->envelope_period = (int)((AUDIO_FREQ * 256.0 * (g_gi_chips[index]->register_set[ENVELOPE_PERIOD_FINE] 
-         | (g_gi_chips[index]->register_set[ENVELOPE_PERIOD_COARSE] << 8)) / g_gi_chips[index]->core_clock / 4) + 0.5);
+      // (each of the 16 steps lasts 16 clocks per period)
       // if Envelope Period is set to 0 then it is 1/2 the Envelope Period of 1
-      if (g_gi_chips[index]->envelope_period < 4)
-      {
-         g_gi_chips[index]->envelope_period = 4;
-      }
-      g_gi_chips[index]->envelope_cycle_complete = false;
-		g_gi_chips[index]->envelope_bytes_to_go = g_gi_chips[index]->envelope_period;
-		g_gi_chips[index]->envelope_step = 0;
+      chip->envelope_period = gisound_clocks_to_time(chip, 16.0 * (chip->register_set[ENVELOPE_PERIOD_FINE] 
+         | (chip->register_set[ENVELOPE_PERIOD_COARSE] << 8)));
+      chip->envelope_cycle_complete = false;
+		chip->envelope_time_to_go = chip->envelope_period;
+		chip->envelope_step = 0;
       break;
 
    case ENVELOPE_SHAPE_CYCLE:
-      g_gi_chips[index]->envelope_shape_cycle_cont = (data >> 3) & 0x01;
-      g_gi_chips[index]->envelope_shape_cycle_att  = (data >> 2) & 0x01;
-      g_gi_chips[index]->envelope_shape_cycle_alt  = (data >> 1) & 0x01;
-      g_gi_chips[index]->envelope_shape_cycle_hold = (data >> 0) & 0x01;      
+      chip->envelope_shape_cycle_cont = (data >> 3) & 0x01;
+      chip->envelope_shape_cycle_att  = (data >> 2) & 0x01;
+      chip->envelope_shape_cycle_alt  = (data >> 1) & 0x01;
+      chip->envelope_shape_cycle_hold = (data >> 0) & 0x01;      
       break;
    
    case IO_PORT_A_DATA_STORE:
-      g_gi_chips[index]->port_a_data_store = data;
+      chip->port_a_data_store = data;
       break;
 
    case IO_PORT_B_DATA_STORE:
-      g_gi_chips[index]->port_b_data_store = data;
+      chip->port_b_data_store = data;
       break;
    }
 }
 
+// advances the envelope by one step
+static void gisound_envelope_step(gi_sound_chip *chip)
+{
+	if (!chip->envelope_shape_cycle_cont && chip->envelope_cycle_complete)
+	{
+		chip->envelope_amplitude = 0; // always hold it low after a cycle if !cont
+	}
+	else if (chip->envelope_shape_cycle_hold && chip->envelope_cycle_complete)
+	{               
+		// don't do anything (hold it) if hold and the cycle is complete
+		if (chip->envelope_shape_cycle_alt)
+		{
+			chip->envelope_amplitude = chip->envelope_shape_cycle_att?0:15;
+		}
+	}
+	else if (chip->envelope_shape_cycle_alt && chip->envelope_cycle_complete)
+	{
+		chip->envelope_amplitude = (!chip->envelope_shape_cycle_att?
+			chip->envelope_step:15 - chip->envelope_step);
+	}
+	else
+	{
+		chip->envelope_amplitude = (chip->envelope_shape_cycle_att?
+			chip->envelope_step:15 - chip->envelope_step);
+	}
+	// update the volumes
+	if (chip->chan_a_amplitude_mode) 
+	{
+		chip->chan_a_amplitude = chip->envelope_amplitude;
+	}
+	if (chip->chan_b_amplitude_mode)
+	{
+		chip->chan_b_amplitude = chip->envelope_amplitude;
+	}
+	if (chip->chan_c_amplitude_mode)
+	{
+		chip->chan_c_amplitude = chip->envelope_amplitude;
+	}
+	chip->envelope_step++;
+            
+	if (chip->envelope_step > 15)
+	{
+		chip->envelope_step = 0;
+		if (chip->envelope_cycle_complete && chip->envelope_shape_cycle_alt
+			&& chip->envelope_shape_cycle_cont && !chip->envelope_shape_cycle_hold)
+		{
+			chip->envelope_cycle_complete = false;
+		}
+		else
+		{
+			chip->envelope_cycle_complete = true;
+		}
+	}         
+}
+
 void gisound_stream(uint8_t* stream, int length, int index)
 {
-	for (int pos = 0; pos < length; pos += 4)
+	gi_sound_chip *chip = g_gi_chips[index];
+	unsigned int uSamples = length >> 2;
+	int64_t s64Left = (int64_t) uSamples << BLIP_FRAC_BITS;	// how much time is left in this buffer
+	int64_t s64Now = 0;
+	int iLevel = gisound_level(chip);
+
+	// register writes since the last buffer take effect at the beginning of this one
+	if (iLevel != chip->last_level)
+	{
+		blip_add_delta(chip->blip, 0, iLevel - chip->last_level);
+		chip->last_level = iLevel;
+	}
+
+	// jump from one switch to the next instead of going sample by sample
+	for (;;)
 	{
-		// endian-independent! :)
-		// NOTE : assumes stream is in little endian format
-		int16_t sample = 
-			(g_volumetable[g_gi_chips[index]->chan_a_amplitude] * 
-			((g_gi_chips[index]->tone_a?g_gi_chips[index]->chan_a_flip:1) 
-			+ (g_gi_chips[index]->noise_a?g_gi_chips[index]->noise_flip:1)) / 2 +
-			g_volumetable[g_gi_chips[index]->chan_b_amplitude] * 
-			((g_gi_chips[index]->tone_b?g_gi_chips[index]->chan_b_flip:1) 
-			+ (g_gi_chips[index]->noise_b?g_gi_chips[index]->noise_flip:1)) / 2 +
-			g_volumetable[g_gi_chips[index]->chan_c_amplitude] * 
-			((g_gi_chips[index]->tone_c?g_gi_chips[index]->chan_c_flip:1) 
-			+ (g_gi_chips[index]->noise_c?g_gi_chips[index]->noise_flip:1)) / 2) / 3;
-
-		stream[pos] = stream[pos+2] = (uint16_t) (sample) & 0xff; 
-		stream[pos+1] = stream[pos+3] = ((uint16_t) (sample) >> 8) & 0xff; 
-
-		g_gi_chips[index]->chan_a_bytes_to_go -= 4;
-		g_gi_chips[index]->chan_b_bytes_to_go -= 4;
-		g_gi_chips[index]->chan_c_bytes_to_go -= 4;
-		g_gi_chips[index]->noise_bytes_to_go -= 4;
-		g_gi_chips[index]->envelope_bytes_to_go -= 4;
+		int64_t s64Next = chip->chan_a_time_to_go;
+		if (chip->chan_b_time_to_go < s64Next) s64Next = chip->chan_b_time_to_go;
+		if (chip->chan_c_time_to_go < s64Next) s64Next = chip->chan_c_time_to_go;
+		if (chip->noise_time_to_go < s64Next) s64Next = chip->noise_time_to_go;
+		if (chip->envelope_time_to_go < s64Next) s64Next = chip->envelope_time_to_go;
+		if (s64Next < 0) s64Next = 0;	// (a period change can leave a counter behind)
+
+		// if nothing else happens during this buffer
+		if (s64Next >= s64Left)
+		{
+			s64Next = s64Left;
+		}
+
+		chip->chan_a_time_to_go -= s64Next;
+		chip->chan_b_time_to_go -= s64Next;
+		chip->chan_c_time_to_go -= s64Next;
+		chip->noise_time_to_go -= s64Next;
+		chip->envelope_time_to_go -= s64Next;
+		s64Now += s64Next;
+		s64Left -= s64Next;
+
+		if (s64Left == 0)
+		{
+			break;
+		}
          
 		// update channel A if it needs it
-		if (g_gi_chips[index]->chan_a_bytes_to_go <= 0)
+		if (chip->chan_a_time_to_go <= 0)
 		{
-			g_gi_chips[index]->chan_a_bytes_to_go = g_gi_chips[index]->chan_a_bytes_per_switch
-				+ g_gi_chips[index]->chan_a_bytes_to_go;
-			g_gi_chips[index]->chan_a_flip = -g_gi_chips[index]->chan_a_flip;
+			chip->chan_a_time_to_go += chip->chan_a_time_per_switch;
+			chip->chan_a_flip = -chip->chan_a_flip;
 		}
 		// update channel B if it needs it
-		if (g_gi_chips[index]->chan_b_bytes_to_go <= 0)
+		if (chip->chan_b_time_to_go <= 0)
 		{
-			g_gi_chips[index]->chan_b_bytes_to_go = g_gi_chips[index]->chan_b_bytes_per_switch
-				+ g_gi_chips[index]->chan_b_bytes_to_go;
-			g_gi_chips[index]->chan_b_flip = -g_gi_chips[index]->chan_b_flip;
+			chip->chan_b_time_to_go += chip->chan_b_time_per_switch;
+			chip->chan_b_flip = -chip->chan_b_flip;
 		}
 		// update channel C if it needs it
-		if (g_gi_chips[index]->chan_c_bytes_to_go <= 0)
+		if (chip->chan_c_time_to_go <= 0)
 		{
-			g_gi_chips[index]->chan_c_bytes_to_go = g_gi_chips[index]->chan_c_bytes_per_switch
-				+ g_gi_chips[index]->chan_c_bytes_to_go;
-			g_gi_chips[index]->chan_c_flip = -g_gi_chips[index]->chan_c_flip;
+			chip->chan_c_time_to_go += chip->chan_c_time_per_switch;
+			chip->chan_c_flip = -chip->chan_c_flip;
 		}
 		// update noise if it needs it
-		if (g_gi_chips[index]->noise_bytes_to_go <= 0)
+		if (chip->noise_time_to_go <= 0)
 		{
-			g_gi_chips[index]->noise_bytes_to_go = g_gi_chips[index]->noise_bytes_per_switch
-				+ g_gi_chips[index]->noise_bytes_to_go;
+			chip->noise_time_to_go += chip->noise_time_per_switch;
 			// the random number generator is a 17 bit shift register with the output as bit 0, and the input is 
 			// not (bit 0 xor bit 3)
-			g_gi_chips[index]->random_seed = (g_gi_chips[index]->random_seed >> 1)
-				| ((~(g_gi_chips[index]->random_seed ^ (g_gi_chips[index]->random_seed >> 3)) & 0x01) << 16);
-//			sprintf(s,"Random number %d", g_gi_chips[index]->random_number);
-//			printline(s);
+			chip->random_seed = (chip->random_seed >> 1)
+				| ((~(chip->random_seed ^ (chip->random_seed >> 3)) & 0x01) << 16);
 
-			if (g_gi_chips[index]->random_seed & 0x01)
+			if (chip->random_seed & 0x01)
 			{
-				g_gi_chips[index]->noise_flip = -g_gi_chips[index]->noise_flip;
+				chip->noise_flip = -chip->noise_flip;
 			}
 		}
 		// update envelope if it needs it
-		if (g_gi_chips[index]->envelope_bytes_to_go <= 0)
+		if (chip->envelope_time_to_go <= 0)
 		{
-			if (!g_gi_chips[index]->envelope_shape_cycle_cont && g_gi_chips[index]->envelope_cycle_complete)
-			{
-				g_gi_chips[index]->envelope_amplitude = 0; // always hold it low after a cycle if !cont
-			}
-			else if (g_gi_chips[index]->envelope_shape_cycle_hold && g_gi_chips[index]->envelope_cycle_complete)
-			{               
-				// don't do anything (hold it) if hold and the cycle is complete
-				if (g_gi_chips[index]->envelope_shape_cycle_alt)
-				{
-					g_gi_chips[index]->envelope_amplitude = g_gi_chips[index]->envelope_shape_cycle_att?0:15;
-				}
-			}
-			else if (g_gi_chips[index]->envelope_shape_cycle_alt && g_gi_chips[index]->envelope_cycle_complete)
-			{
-				g_gi_chips[index]->envelope_amplitude = (!g_gi_chips[index]->envelope_shape_cycle_att?
-					g_gi_chips[index]->envelope_step:15 - g_gi_chips[index]->envelope_step);
-			}
-			else
-			{
-				g_gi_chips[index]->envelope_amplitude = (g_gi_chips[index]->envelope_shape_cycle_att?
-					g_gi_chips[index]->envelope_step:15 - g_gi_chips[index]->envelope_step);
-			}
-			// update the volumes
-			if (g_gi_chips[index]->chan_a_amplitude_mode) 
-			{
-				g_gi_chips[index]->chan_a_amplitude = g_gi_chips[index]->envelope_amplitude;
-			}
-			if (g_gi_chips[index]->chan_b_amplitude_mode)
-			{
-				g_gi_chips[index]->chan_b_amplitude = g_gi_chips[index]->envelope_amplitude;
-			}
-			if (g_gi_chips[index]->chan_c_amplitude_mode)
-			{
-				g_gi_chips[index]->chan_c_amplitude = g_gi_chips[index]->envelope_amplitude;
-			}
-			g_gi_chips[index]->envelope_bytes_to_go = g_gi_chips[index]->envelope_period 
-				+ g_gi_chips[index]->envelope_bytes_to_go;            
-			g_gi_chips[index]->envelope_step++;
-            
-			if (g_gi_chips[index]->envelope_step > 15)
-			{
-				g_gi_chips[index]->envelope_step = 0;
-				if (g_gi_chips[index]->envelope_cycle_complete && g_gi_chips[index]->envelope_shape_cycle_alt
-					&& g_gi_chips[index]->envelope_shape_cycle_cont && !g_gi_chips[index]->envelope_shape_cycle_hold)
-				{
-					g_gi_chips[index]->envelope_cycle_complete = false;
-				}
-				else
-				{
-					g_gi_chips[index]->envelope_cycle_complete = true;
-				}
-			}         
+			chip->envelope_time_to_go += chip->envelope_period;
+			gisound_envelope_step(chip);
+		}
+
+		// only the edges go into the buffer
+		iLevel = gisound_level(chip);
+		if (iLevel != chip->last_level)
+		{
+			blip_add_delta(chip->blip, (uint32_t) s64Now, iLevel - chip->last_level);
+			chip->last_level = iLevel;
 		}
 	}
+
+	blip_read_stereo(chip->blip, stream, uSamples);
 }
 
 void gisound_shutdown(int index)
 {
+	blip_delete(g_gi_chips[index]->blip);
 	delete g_gi_chips[index];
 	g_gi_chips[index] = NULL;
 }
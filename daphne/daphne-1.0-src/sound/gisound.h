@@ -63,15 +63,16 @@ struct gi_sound_chip {
    // Registers
    uint8_t register_set[16];
 
-   int chan_a_bytes_per_switch;
-   int chan_b_bytes_per_switch;
-   int chan_c_bytes_per_switch;
-   int chan_a_bytes_to_go;
-   int chan_b_bytes_to_go;
-   int chan_c_bytes_to_go;
+   // all times are in blip units (see blip.h)
+   int64_t chan_a_time_per_switch;
+   int64_t chan_b_time_per_switch;
+   int64_t chan_c_time_per_switch;
+   int64_t chan_a_time_to_go;
+   int64_t chan_b_time_to_go;
+   int64_t chan_c_time_to_go;
    uint8_t noise_period;
-   int noise_bytes_per_switch;
-   int noise_bytes_to_go;
+   int64_t noise_time_per_switch;
+   int64_t noise_time_to_go;
    int noise_flip;
    bool iob_in;
    bool ioa_in;
@@ -90,10 +91,10 @@ struct gi_sound_chip {
    uint8_t chan_c_amplitude;
    int chan_c_flip;
    bool chan_c_amplitude_mode;
-   int envelope_period;
+   int64_t envelope_period;
    bool envelope_cycle_complete;
    uint8_t envelope_amplitude;
-   int envelope_bytes_to_go;
+   int64_t envelope_time_to_go;
    uint8_t envelope_step;
    bool envelope_shape_cycle_cont;
    bool envelope_shape_cycle_att;
@@ -102,6 +103,9 @@ struct gi_sound_chip {
    uint8_t port_a_data_store;
    uint8_t port_b_data_store;
    uint32_t random_seed;
+
+   struct blip_s *blip;	// where the output goes
+   int last_level;	// the output level we last gave to 'blip'
 };
 
 #endif
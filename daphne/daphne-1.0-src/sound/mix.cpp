@@ -22,41 +22,145 @@
 
 // mix.cpp
 #include <stdint.h>
+#include <string.h>
 #include "sound.h"
 #include "../io/mpo_mem.h"
 #include "mix.h"
 
+// MSB_FIRST platforms need to byte swap everything, so they always use the plain C kernels
+#if !defined(MSB_FIRST) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+#define MIX_SSE2
+#include <emmintrin.h>
+#elif !defined(MSB_FIRST) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define MIX_NEON
+#include <arm_neon.h>
+#endif
+
 struct mix_s *g_pMixBufs = NULL;
 uint8_t *g_pSampleDst = 0;
 unsigned int g_uBytesToMix = 0;
 
+// stores a 16-bit value in little endian format
+static inline void mix_store16(int16_t *ptr, int val)
+{
+#ifndef MSB_FIRST
+	*ptr = (int16_t) val;
+#else
+	*((uint8_t *) ptr) = val & 0xFF;
+	*(((uint8_t *) ptr) + 1) = (val >> 8) & 0xFF;
+#endif
+}
+
 void mix_c()
 {
-	unsigned int uSamplesToMix = g_uBytesToMix >> 1;
-	uint8_t *stream = g_pSampleDst;
-	unsigned int sample = 0, val_to_store = 0;
+	struct mix_s *cur = g_pMixBufs;
 
-	for (sample = 0; sample < uSamplesToMix; sample += 2)
+	// the first stream doesn't need to be mixed with anything, and then we add the rest in, one at a time
+	if (cur)
 	{
-		int mixed_sample_1 = 0, mixed_sample_2 = 0;	// left/right channels
-		struct mix_s *cur = g_pMixBufs;
-
-		// mix all sound chips
-		while (cur)
+		memcpy(g_pSampleDst, cur->pMixBuf, g_uBytesToMix);
+		for (cur = cur->pNext; cur; cur = cur->pNext)
 		{
-			mixed_sample_1 += LOAD_LIL_SINT16(((short *) cur->pMixBuf) + sample);
-			mixed_sample_2 += LOAD_LIL_SINT16(((short *) cur->pMixBuf) + sample + 1);
-			cur = cur->pNext;
+			mix_add((int16_t *) g_pSampleDst, (const int16_t *) cur->pMixBuf, g_uBytesToMix >> 1);
 		}
+	}
+}
+
+void mix_add(int16_t *dst, const int16_t *src, unsigned int uCount)
+{
+	unsigned int u = 0;
 
-		DO_CLIP(mixed_sample_1);
-		DO_CLIP(mixed_sample_2);
+#if defined(MIX_SSE2)
+	for (; u + 8 <= uCount; u += 8)
+	{
+		__m128i d = _mm_loadu_si128((const __m128i *) (dst + u));
+		__m128i s = _mm_loadu_si128((const __m128i *) (src + u));
+		_mm_storeu_si128((__m128i *) (dst + u), _mm_adds_epi16(d, s));
+	}
+#elif defined(MIX_NEON)
+	for (; u + 8 <= uCount; u += 8)
+	{
+		vst1q_s16(dst + u, vqaddq_s16(vld1q_s16(dst + u), vld1q_s16(src + u)));
+	}
+#endif
 
-		// note: sample2 needs to be on top because this is little endian, hence LSB
-		val_to_store = 
-			(((unsigned short) mixed_sample_2) << 16) | ((unsigned short) mixed_sample_1);
+	// whatever is left over (or everything, if we have no SIMD)
+	for (; u < uCount; u++)
+	{
+		int iMixed = LOAD_LIL_SINT16(dst + u) + LOAD_LIL_SINT16(src + u);
+		DO_CLIP(iMixed);
+		mix_store16(dst + u, iMixed);
+	}
+}
+
+void mix_add_with_volume(int16_t *dst, const int16_t *src, unsigned int uCount, unsigned int uVolL, unsigned int uVolR)
+{
+	unsigned int u = 0;
 
-		STORE_LIL_UINT32(stream, val_to_store);
-		stream += 4;
+#if defined(MIX_SSE2)
+	// After interleaving the samples with zeroes, madd multiplies each sample by its volume into a 32-bit result.
+	const __m128i vol = _mm_setr_epi16((short) uVolL, 0, (short) uVolR, 0, (short) uVolL, 0, (short) uVolR, 0);
+	const __m128i zero = _mm_setzero_si128();
+	for (; u + 8 <= uCount; u += 8)
+	{
+		__m128i d = _mm_loadu_si128((const __m128i *) (dst + u));
+		__m128i s = _mm_loadu_si128((const __m128i *) (src + u));
+		__m128i lo = _mm_srai_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(s, zero), vol), AUDIO_MAX_VOL_POWER);
+		__m128i hi = _mm_srai_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(s, zero), vol), AUDIO_MAX_VOL_POWER);
+		_mm_storeu_si128((__m128i *) (dst + u), _mm_adds_epi16(d, _mm_packs_epi32(lo, hi)));
+	}
+#elif defined(MIX_NEON)
+	const int16_t vols[4] = { (int16_t) uVolL, (int16_t) uVolR, (int16_t) uVolL, (int16_t) uVolR };
+	const int16x4_t vol = vld1_s16(vols);
+	for (; u + 8 <= uCount; u += 8)
+	{
+		int16x8_t s = vld1q_s16(src + u);
+		int16x4_t lo = vqshrn_n_s32(vmull_s16(vget_low_s16(s), vol), AUDIO_MAX_VOL_POWER);
+		int16x4_t hi = vqshrn_n_s32(vmull_s16(vget_high_s16(s), vol), AUDIO_MAX_VOL_POWER);
+		vst1q_s16(dst + u, vqaddq_s16(vld1q_s16(dst + u), vcombine_s16(lo, hi)));
+	}
+#endif
+
+	for (; u < uCount; u += 2)
+	{
+		// multiply by the volume and then dividing by the max volume (by shifting right, which is much faster)
+		int iMixed1 = LOAD_LIL_SINT16(dst + u) + (int16_t) ((LOAD_LIL_SINT16(src + u) * (int) uVolL) >> AUDIO_MAX_VOL_POWER);
+		int iMixed2 = LOAD_LIL_SINT16(dst + u + 1) + (int16_t) ((LOAD_LIL_SINT16(src + u + 1) * (int) uVolR) >> AUDIO_MAX_VOL_POWER);
+		DO_CLIP(iMixed1);
+		DO_CLIP(iMixed2);
+		mix_store16(dst + u, iMixed1);
+		mix_store16(dst + u + 1, iMixed2);
+	}
+}
+
+void mix_add_mono(int16_t *dst, const int16_t *src, unsigned int uCount)
+{
+	unsigned int u = 0;
+
+#if defined(MIX_SSE2)
+	for (; u + 8 <= uCount; u += 8)
+	{
+		// load 4 mono samples and duplicate each of them for the left and right channels
+		__m128i s = _mm_loadl_epi64((const __m128i *) (src + (u >> 1)));
+		__m128i d = _mm_loadu_si128((const __m128i *) (dst + u));
+		_mm_storeu_si128((__m128i *) (dst + u), _mm_adds_epi16(d, _mm_unpacklo_epi16(s, s)));
+	}
+#elif defined(MIX_NEON)
+	for (; u + 8 <= uCount; u += 8)
+	{
+		int16x4x2_t s = vzip_s16(vld1_s16(src + (u >> 1)), vld1_s16(src + (u >> 1)));
+		vst1q_s16(dst + u, vqaddq_s16(vld1q_s16(dst + u), vcombine_s16(s.val[0], s.val[1])));
+	}
+#endif
+
+	for (; u < uCount; u += 2)
+	{
+		int i16Sample = LOAD_LIL_SINT16(src + (u >> 1));
+		int iMixed1 = LOAD_LIL_SINT16(dst + u) + i16Sample;
+		int iMixed2 = LOAD_LIL_SINT16(dst + u + 1) + i16Sample;
+		DO_CLIP(iMixed1);
+		DO_CLIP(iMixed2);
+		mix_store16(dst + u, iMixed1);
+		mix_store16(dst + u + 1, iMixed2);
 	}
 }
@@ -43,6 +43,20 @@ struct mix_s
 // we always want this function defined for the purpose of testing (releasetest.cpp)
 void mix_c();
 
+// MIX KERNELS
+// These work on a whole buffer at a time (so the caller loops through the sound chips, and the kernel loops
+//  through the samples), and use SSE2 or NEON saturating math when it's available.
+// 'uCount' is the number of 16-bit values (2 per stereo sample) and must be even.
+
+// dst = clip(dst + src)
+void mix_add(int16_t *dst, const int16_t *src, unsigned int uCount);
+
+// dst = clip(dst + ((src * volume) >> AUDIO_MAX_VOL_POWER)), using uVolL for the left channel and uVolR for the right
+void mix_add_with_volume(int16_t *dst, const int16_t *src, unsigned int uCount, unsigned int uVolL, unsigned int uVolR);
+
+// same as mix_add, except 'src' is mono and gets added to both channels ('uCount' is still the size of 'dst')
+void mix_add_mono(int16_t *dst, const int16_t *src, unsigned int uCount);
+
 extern mix_s *g_pMixBufs;
 extern uint8_t *g_pSampleDst;
 extern uint32_t g_uBytesToMix;
@@ -2,11 +2,13 @@
 
 #include <stdint.h>
 #include <string.h>	// for memset
+#include <SDL.h>
 
 #include "../game/game.h"	// to get sound names
 #include "../io/conout.h"
 #include "../io/mpo_mem.h"	// for endian-independent macros
 #include "samples.h"
+#include "mix.h"
 
 //using namespace std;
 
@@ -39,6 +41,11 @@ struct sample_data_s g_SampleStates[MAX_DYNAMIC_SAMPLES];
 // so that we don't need to scan through to find a free slot in the dynamic samples array
 unsigned int g_uNextSampleIdx = 0;
 
+// protects g_SampleStates and g_uNextSampleIdx, because samples are started from the cpu thread (and the
+//  SSI-263 speech thread) while the mixer is playing them.
+// Finished callbacks are called with this held (SDL mutexes are recursive, so they may start another sample).
+SDL_mutex *g_samples_mutex = NULL;
+
 // init callback
 int samples_init(unsigned int unused)
 {
@@ -57,11 +64,21 @@ int samples_init(unsigned int unused)
 		s->finishedCallback = NULL;
 	}
 
+	if (!g_samples_mutex)
+	{
+		g_samples_mutex = SDL_CreateMutex();
+	}
+
 	return iResult;
 }
 
 void samples_shutdown(int unused)
 {
+	if (g_samples_mutex)
+	{
+		SDL_DestroyMutex(g_samples_mutex);
+		g_samples_mutex = NULL;
+	}
 }
 
 // called from sound mixer to get audio stream
@@ -75,6 +92,8 @@ void samples_get_stream(uint8_t *stream, int length, int unused)
 
 	unsigned int u = 0;
 
+	SDL_LockMutex(g_samples_mutex);
+
 	// check to see if any sample is playing ...
 	for (u = 0; u < MAX_DYNAMIC_SAMPLES; ++u)
 	{
@@ -82,56 +101,37 @@ void samples_get_stream(uint8_t *stream, int length, int unused)
 
 		if (data->bActive)
 		{
-			uint8_t *ptrStream = stream;
+			// how many stereo samples (4 bytes) we have left to mix in from this sample
+			unsigned int uBytesPerSample = data->uChannels << 1;
+			unsigned int uSamplesLeft = (data->uLength - data->uPos) / uBytesPerSample;
+			unsigned int uSamplesToMix = (uSamplesLeft < uTotalSamples) ? uSamplesLeft : uTotalSamples;
 
-			// do each sample
-			for (unsigned int uSample = 0; uSample < uTotalSamples; ++uSample)
+			if (data->uChannels == 2)
 			{
-				// if there is still some sample data to be mixed to this stream
-				if (data->uPos < data->uLength)
-				{
-					int iMixedSample1 = LOAD_LIL_SINT16((int16_t *) ptrStream);
-					int iMixedSample2 = LOAD_LIL_SINT16(((int16_t *) ptrStream) + 1);
-
-					int16_t i16Sample1 = LOAD_LIL_SINT16(data->pu8Buf + data->uPos);
-					iMixedSample1 += i16Sample1;
-					data->uPos += 2;
-
-					// if this is a stereo sample
-					if (data->uChannels == 2)
-					{
-						iMixedSample2 += LOAD_LIL_SINT16(data->pu8Buf + data->uPos);
-						data->uPos += 2;
-					}
-					// else this is a mono sample, so just duplicate the last sample we read in
-					else
-					{
-						iMixedSample2 += i16Sample1;
-					}
-
-					DO_CLIP(iMixedSample1);	// prevent overflow
-					DO_CLIP(iMixedSample2);
-
-					// yes, sample2 should be the most significant, sample1 least significant.. releasetest tests this
-					unsigned int val_to_store = (((uint16_t) iMixedSample2) << 16) | (uint16_t) iMixedSample1;
-					STORE_LIL_UINT32(ptrStream, val_to_store);
-					ptrStream += 4;
-				}
-				// else this sample is done, so get rid of the entry ...
-				else
-				{
-					data->bActive = false;
+				mix_add((int16_t *) stream, (const int16_t *) (data->pu8Buf + data->uPos), uSamplesToMix << 1);
+			}
+			// else this is a mono sample, so it gets added to both channels
+			else
+			{
+				mix_add_mono((int16_t *) stream, (const int16_t *) (data->pu8Buf + data->uPos), uSamplesToMix << 1);
+			}
+			data->uPos += uSamplesToMix * uBytesPerSample;
 
-					// if caller has requested to be notified when this sample is done ...
-					if (data->finishedCallback != NULL)
-					{
-						data->finishedCallback(data->pu8Buf, u);
-					}
-					break;
+			// if this sample is done, get rid of the entry ...
+			if (uSamplesToMix < uTotalSamples)
+			{
+				data->bActive = false;
+
+				// if caller has requested to be notified when this sample is done ...
+				if (data->finishedCallback != NULL)
+				{
+					data->finishedCallback(data->pu8Buf, u);
 				}
-			} // end going through stream buffer
+			}
 		} // end while we have states to be addressed
 	} // end looping through all sample slots
+
+	SDL_UnlockMutex(g_samples_mutex);
 }
 
 int samples_play_sample(uint8_t *pu8Buf, unsigned int uLength, unsigned int uChannels, int iSlot,
@@ -140,6 +140,8 @@ int samples_play_sample(uint8_t *pu8Buf, unsigned int uLength, unsigned int uCha
 	int iResult = -1;
 	sample_data_s *state = NULL;
 
+	SDL_LockMutex(g_samples_mutex);
+
 	// range check
 	if ((uChannels == 1) || (uChannels == 2))
 	{
@@ -203,6 +205,8 @@ int samples_play_sample(uint8_t *pu8Buf, unsigned int uLength, unsigned int uCha
 	} // end if channels are ok
 	// else channels are out of range
 
+	SDL_UnlockMutex(g_samples_mutex);
+
 	return iResult;
 }
 
@@ -211,7 +215,9 @@ bool samples_is_sample_playing(unsigned int uSlot)
 	bool bResult = false;
 	if (uSlot < MAX_DYNAMIC_SAMPLES)
 	{
+		SDL_LockMutex(g_samples_mutex);
 		bResult = g_SampleStates[uSlot].bActive;
+		SDL_UnlockMutex(g_samples_mutex);
 	}
 	else
 	{
@@ -46,6 +46,7 @@
 #include "../game/game.h"
 #include "../daphne.h"
 #include "../ldp-out/ldp-vldp.h" // added by JFA for -startsilent
+#include "../cpu/cpu.h"
 // grant- ADD - needed for home directory
 #include "../io/homedir.h"
 
@@ -73,6 +74,22 @@ uint16_t g_u16SoundBufSamples = 44100 / 60;
 // # of bytes each individual sound chip should be allocated for its buffer
 unsigned int g_uSoundChipBufSize = g_u16SoundBufSamples * AUDIO_BYTES_PER_SAMPLE;
 
+// how many cpu's we track the sound clock for (more than any game uses)
+#define SOUND_MAX_CPUS 8
+
+// total cycles each cpu had executed when the sound chip buffers were last emptied.
+// Chip buffers are filled up to the current emulated time right before a register write (or when the mixer pulls),
+//  so this is what we measure the current emulated time against.
+// Only the emulation thread touches these: the cycle counts can only be trusted from there (a cpu that is
+//  swapped out doesn't have its elapsed cycles loaded), so the mixer just bumps g_sound_buffer_gen and each cpu
+//  re-bases itself the next time it writes to a sound chip.
+uint64_t g_u64SoundCycleBase[SOUND_MAX_CPUS] = { 0 };
+int g_iSoundCycleGen[SOUND_MAX_CPUS] = { 0 };	// the g_sound_buffer_gen that each cpu's base belongs to
+SDL_atomic_t g_sound_buffer_gen;	// incremented by the mixer every time it empties the sound chip buffers
+
+// the mixer and the emulation thread both render into the chip buffers (and talk to the chips), so they take turns
+SDL_mutex *g_sound_chip_mutex = NULL;
+
 // the volume (user adjustable) of the VLDP audio stream
 unsigned int g_uVolumeVLDP = AUDIO_MAX_VOLUME;
 
@@ -129,6 +146,12 @@ bool sound_init()
 	// if the user has not disabled sound from the command line
 	if (is_sound_enabled())
 	{
+		// created once and never destroyed, since the mixer may call us at any time
+		if (!g_sound_chip_mutex)
+		{
+			g_sound_chip_mutex = SDL_CreateMutex();
+		}
+
 		// if SDL audio initialization was successful
 		{
 			// this stuff doesn't need to be filled in supposedly ...
@@ -579,29 +602,78 @@ void mixWithMaxVolume(uint8_t *stream, int length)
 //  (this is the slowest callback)
 void mixWithMults(uint8_t *stream, int length)
 {
-	struct sounddef *cur;
+	// start from silence and add each sound chip buffer in, one at a time
+	memset(stream, 0, length);
 
-	// mix all sound chip buffers together
-	// NOTE : this algorithm is accurate but NOT OPTIMIZED and probably should be optimized,
-	//  because it is called constantly.
-	for (int sample = 0; sample < (length >> 1); sample += 2)
+	for (struct sounddef *cur = g_soundchip_head; cur; cur = cur->next_soundchip)
 	{
-		int32_t mixed_sample_1 = 0, mixed_sample_2 = 0;	// left/right channels, 32-bit to support adding many 16-bit samples
-		cur = g_soundchip_head;
-		while (cur)
+		mix_add_with_volume((int16_t *) stream, (const int16_t *) cur->buffer, length >> 1, cur->uVolume[0], cur->uVolume[1]);
+	}
+}
+
+// returns how far (in bytes) into the sound chip buffers the currently executing cpu is
+static unsigned int sound_get_buffer_pos()
+{
+	unsigned int uResult = 0;
+	uint8_t u8CpuID = cpu_getactivecpu();
+
+	if (u8CpuID < SOUND_MAX_CPUS)
+	{
+		uint64_t u64Cycles = get_total_cycles_executed(u8CpuID);
+		uint32_t u32Hz = get_cpu_hz(u8CpuID);
+		int iGen = SDL_AtomicGet(&g_sound_buffer_gen);
+
+		// if the mixer has emptied the buffers since we last looked (or the cpu timers were flushed), start over from here
+		if ((g_iSoundCycleGen[u8CpuID] != iGen) || (u64Cycles < g_u64SoundCycleBase[u8CpuID]))
 		{
-			// multiply by the volume and then dividing by the max volume (by shifting right, which is much faster)
-			mixed_sample_1 += (int16_t) ((LOAD_LIL_SINT16(((int16_t *) cur->buffer) + sample) * cur->uVolume[0]) >> AUDIO_MAX_VOL_POWER);
-			mixed_sample_2 += (int16_t) ((LOAD_LIL_SINT16(((int16_t *) cur->buffer) + sample + 1) * cur->uVolume[1]) >> AUDIO_MAX_VOL_POWER);
-			cur = cur->next_soundchip;
+			g_u64SoundCycleBase[u8CpuID] = u64Cycles;
+			g_iSoundCycleGen[u8CpuID] = iGen;
 		}
 
-		DO_CLIP(mixed_sample_1);
-		DO_CLIP(mixed_sample_2);
+		uint64_t u64Elapsed = u64Cycles - g_u64SoundCycleBase[u8CpuID];
 
-		uint32_t val_to_store = (((uint16_t) mixed_sample_2) << 16) | (uint16_t) mixed_sample_1;
-		STORE_LIL_UINT32(stream, val_to_store);
-		stream += 4;
+		// anything past the end of the buffer gets thrown away anyway (this also keeps the multiply from overflowing)
+		if ((u32Hz != 0) && (u64Elapsed < u32Hz))
+		{
+			uint64_t u64Samples = (u64Elapsed * AUDIO_FREQ) / u32Hz;
+			uResult = (unsigned int) (u64Samples * AUDIO_BYTES_PER_SAMPLE);
+		}
+		else
+		{
+			uResult = g_uSoundChipBufSize;
+		}
+
+		if (uResult > g_uSoundChipBufSize)
+		{
+			uResult = g_uSoundChipBufSize;
+		}
+	}
+
+	return uResult;
+}
+
+// renders a sound chip's buffer up to 'uPos' bytes (if it hasn't gotten that far already)
+static void sound_render_until(struct sounddef *cur, unsigned int uPos)
+{
+	unsigned int uRendered = g_uSoundChipBufSize - cur->bytes_left;
+
+	if (uPos > uRendered)
+	{
+		unsigned int uBytes = uPos - uRendered;
+		cur->stream_callback(cur->buffer_pointer, uBytes, cur->internal_id);
+		cur->bytes_left -= uBytes;
+		cur->buffer_pointer += uBytes;
+	}
+}
+
+// gets a chip that is about to be written to caught up to the current emulated time,
+//  so that the write takes effect on the sample that it actually happened on
+static void sound_catch_up(struct sounddef *cur)
+{
+	// chips that don't care when they are written to just get rendered when the mixer pulls
+	if (cur->bNeedsConstantUpdates)
+	{
+		sound_render_until(cur, sound_get_buffer_pos());
 	}
 }
 
@@ -610,6 +682,8 @@ void audio_callback ( void *data, uint8_t *stream, int length )
 	// now go through the sound chips and mix them in
 	struct sounddef *cur = g_soundchip_head;
 
+	if (g_sound_chip_mutex) SDL_LockMutex(g_sound_chip_mutex);
+
 	// fill remaining buffer space for each sound chip
 	while (cur)
 	{
@@ -621,6 +695,11 @@ void audio_callback ( void *data, uint8_t *stream, int length )
 
 	// do the actual mixing now
 	g_soundmix_callback(stream, length);
+
+	// the next buffer begins at the current emulated time (see g_u64SoundCycleBase)
+	SDL_AtomicAdd(&g_sound_buffer_gen, 1);
+
+	if (g_sound_chip_mutex) SDL_UnlockMutex(g_sound_chip_mutex);
 }
 
 void audio_writedata(uint8_t id, uint8_t data)
@@ -629,14 +708,18 @@ void audio_writedata(uint8_t id, uint8_t data)
 	if (g_sound_initialized)
 	{
 		struct sounddef *cur = g_soundchip_head;
+
+		SDL_LockMutex(g_sound_chip_mutex);
 		while (cur)
 		{
 			if (cur->id == id)
 			{
+				sound_catch_up(cur);
 				cur->writedata_callback(data, cur->internal_id);
 			}      
 			cur = cur->next_soundchip;
 		}
+		SDL_UnlockMutex(g_sound_chip_mutex);
 	}
 }
 
@@ -647,14 +730,18 @@ void audio_write_ctrl_data(unsigned int uCtrl, unsigned int uData, uint8_t id)
 	if (g_sound_initialized)
 	{
 		struct sounddef *cur = g_soundchip_head;
+
+		SDL_LockMutex(g_sound_chip_mutex);
 		while (cur)
 		{
 			if (cur->id == id)
 			{
+				sound_catch_up(cur);
 				cur->write_ctrl_data_callback(uCtrl, uData, cur->internal_id);
 			}
 			cur = cur->next_soundchip;
 		}
+		SDL_UnlockMutex(g_sound_chip_mutex);
 	}
 }
 
@@ -792,6 +879,8 @@ void update_soundchip_volumes()
 void shutdown_soundchip()
 {
 	struct sounddef *cur = g_soundchip_head;
+
+	if (g_sound_chip_mutex) SDL_LockMutex(g_sound_chip_mutex);
 	while (cur)
 	{
 		// if there is a shutdown callback defined, call it
@@ -809,31 +898,5 @@ void shutdown_soundchip()
 	g_soundchip_head = NULL;
 	g_uSoundChipNextID = 0;
 	// RJS ADD END
-}
-
-void update_soundbuffer()
-{
-	// we don't want to update the sound buffer, if sound isn't initialized
-	if (g_sound_initialized)
-	{
-		// to ensure that the audio callback doesn't get called while we're in this function
-		struct sounddef *cur = g_soundchip_head;
-		while (cur)
-		{
-			// only update if needed, to save CPU cycles
-			if (cur->bNeedsConstantUpdates)
-			{
-				if (cur->bytes_left >= G_1MS_BUF_SIZE)
-				{
-					cur->stream_callback(cur->buffer_pointer, G_1MS_BUF_SIZE, cur->internal_id);
-					cur->bytes_left -= G_1MS_BUF_SIZE;
-					cur->buffer_pointer += G_1MS_BUF_SIZE;
-				}
-				// else we throw away the new data
-				// should we handle this some other way?
-			}
-			// else doesn't need to be updated so often, so don't do it ...
-			cur = cur->next_soundchip;
-		}
-	}
+	if (g_sound_chip_mutex) SDL_UnlockMutex(g_sound_chip_mutex);
 }
@@ -53,9 +53,6 @@
 // This is true even for big-endian platforms
 #define AUDIO_FORMAT AUDIO_S16LSB
 
-// how many audio bytes needed to fill 1 millisecond of space
-static const unsigned int G_1MS_BUF_SIZE = (AUDIO_FREQ * AUDIO_BYTES_PER_SAMPLE) / 1000;
-
 enum { SOUNDCHIP_UNDEFINED, SOUNDCHIP_SAMPLES, SOUNDCHIP_VLDP, SOUNDCHIP_SN76496, SOUNDCHIP_AY_3_8910,
 	SOUNDCHIP_PC_BEEPER, SOUNDCHIP_DAC, SOUNDCHIP_TONEGEN };
 
@@ -115,12 +112,13 @@ struct sounddef
 	int type;	// type of sound chip (See enum's)
 	uint32_t hz;	// speed of sound chip in Hz
 
-	// Should be true if sound quality of chip is better the more often it is updated.
-	//  An example is Super Don's sound chip.
-	// Should be false if sound doesn't change no matter how fast it is updated.
+	// Should be true if the chip's output depends on exactly when its registers are written.
+	//  An example is Super Don's sound chip.  Right before each write, such a chip's buffer is rendered
+	//  up to the current emulated time (taken from the cycle count of the cpu doing the write),
+	//  so the write takes effect on the right sample.
+	// Should be false if sound doesn't depend on when it's written to.
 	//  An example is VLDP which has constant pre-defined audio.
-	// FIXME : in the future this should be changed to define how frequent of updates are
-	//  needed, because the less frequent of updates, the better.
+	// Either way, whatever is left of the buffer is rendered when the mixer pulls.
 	bool bNeedsConstantUpdates;	
 };
 
@@ -180,7 +178,6 @@ void set_soundchip_nonvldp_volume(unsigned int uVolume);
 void update_soundchip_volumes();
 
 void shutdown_soundchip();
-void update_soundbuffer(); // update the sound buffers with 1 ms worth of data
 void set_soundbuf_size(uint16_t newbufsize);
 bool sound_init();
 void sound_shutdown();
@@ -39,6 +39,7 @@
 
 #include <stdint.h>
 #include <string.h>
+#include <string>
 #include "tqsynth.h"
 #include "samples.h"
 #include "../daphne.h"
@@ -65,7 +66,26 @@ static thayers *m_thayers = NULL;       // Need to call into the TQ class to
                                         // subtitle the speech buffer text.
 
 // Forward declarations of local funtions.
-void ssi263_say_phones(char *phonemes, int len);
+void ssi263_say_phones(char *phonemes, int len, const std::string &subtitle);
+int ssi263_speech_thread(void *unused);
+
+// Phrases are synthesized and spoken on their own thread, so the Z80 never has to wait on rsynth.
+// Only one phrase waits to be spoken: if the game says something else before it gets its turn,
+// the old phrase is dropped, so speech never falls more than a phrase behind the game.
+// The subtitle goes up (on the cpu thread, see ssi263_get_started_subtitle) when the phrase
+// actually starts playing.
+// m_speech_mutex protects everything below it.  It and m_speech_cond are never destroyed,
+// because the mixer can still finish a phrase after ssi263_shutdown.
+static SDL_Thread *m_speech_thread = NULL;
+static SDL_mutex *m_speech_mutex = NULL;
+static SDL_cond *m_speech_cond = NULL;     // signalled when a phrase is queued, has finished playing, or we quit
+static bool m_speech_quit = false;
+static bool m_phrase_pending = false;      // whether m_pending_phones/m_pending_subtitle are waiting to be spoken
+static std::string m_pending_phones;
+static std::string m_pending_subtitle;
+static bool m_phrase_playing = false;      // set by the speech thread, cleared when the mixer finishes the phrase
+static std::string m_started_subtitle;     // subtitle of the phrase that just started playing
+static SDL_atomic_t m_subtitle_started;    // set when m_started_subtitle is waiting to be shown
 
 // Duration/Phoneme
 // Working theory: top 2 bits are for duration, the rest is for the phoneme
@@ -169,27 +189,28 @@ void ssi263_reg0(unsigned char value, uint8_t *irq_status)
 		// Zero stops the speech chip requesting phonemes (stops raising IRQs).
 		else if (value == 0)
 		{
-            // Call into the thayer class to display the speech text buffer,
+            // Call into the thayer class to get the speech text buffer,
             // as it has the game's RAM memory. Besides, it's controlling the
             // video overlay anyway...
-            m_thayers->show_speech_subtitle();
+            char subtitle[SSI_SUBTITLE_LEN];
+            m_thayers->get_speech_text(subtitle);
 
-            if (m_speech_enabled)
+            // Done concatenating phonemes, so speak if have something to say.
+            if (m_speech_enabled && phones_len)
             {
-                // Done concatenating phonemes, so speak if have something to say.
-                if (phones_len)
-                {
-                    // Since the speech output will likely a while,
-					// the cpu timer is 'paused' here
-
-					cpu_pause();	// MPO : this replaces flush_cpu_timers
-
-                    // Synthesize and speak the phonemes.
-                    ssi263_say_phones(phones_text, phones_len);
-
-					cpu_unpause();
-
-                }
+                // Hand the phonemes off to the speech thread, which will synthesize and
+                // speak them (and show the subtitle) once the current phrase is done.
+                // If a phrase is still waiting, it's stale now, so this one replaces it.
+                SDL_LockMutex(m_speech_mutex);
+                m_pending_phones.assign(phones_text, phones_len);
+                m_pending_subtitle = subtitle;
+                m_phrase_pending = true;
+                SDL_CondSignal(m_speech_cond);
+                SDL_UnlockMutex(m_speech_mutex);
+            }
+            else
+            {
+                m_thayers->show_speech_subtitle(subtitle);
             }
 
             *irq_status |= 0x04; // Done requesting data (set IRQ control bit 2).
@@ -368,7 +389,26 @@ bool ssi263_init(bool init_speech)
         {
             // Request voice to have an F0 base frequency of 110Hz.
             tqsynth_init(AUDIO_FREQ, AUDIO_FORMAT, AUDIO_CHANNELS, 1100);
-            m_speech_enabled = true;
+
+            if (!m_speech_mutex)
+            {
+                m_speech_mutex = SDL_CreateMutex();
+                m_speech_cond = SDL_CreateCond();
+            }
+            m_speech_quit = false;
+            m_phrase_pending = false;
+            m_phrase_playing = false;
+            SDL_AtomicSet(&m_subtitle_started, 0);
+            m_speech_thread = SDL_CreateThread(ssi263_speech_thread, "SSI263_SPEECH", NULL);
+
+            if (m_speech_thread)
+            {
+                m_speech_enabled = true;
+            }
+            else
+            {
+                printline("ssi263_init: could not create speech thread, speech is disabled");
+            }
         }
 
         result = true;
@@ -377,34 +417,85 @@ bool ssi263_init(bool init_speech)
     return result;
 }
 
-bool g_bSamplePlaying = false;
+void ssi263_shutdown()
+{
+    if (m_speech_thread)
+    {
+        SDL_LockMutex(m_speech_mutex);
+        m_speech_quit = true;
+        m_phrase_pending = false;
+        SDL_CondSignal(m_speech_cond);
+        SDL_UnlockMutex(m_speech_mutex);
+
+        SDL_WaitThread(m_speech_thread, NULL);
+        m_speech_thread = NULL;
+    }
+
+    m_speech_enabled = false;
+}
+
+// Speaks phrases one at a time until ssi263_shutdown is called.
+int ssi263_speech_thread(void *unused)
+{
+    SDL_LockMutex(m_speech_mutex);
+
+    while (!m_speech_quit)
+    {
+        // wait for something to say (and for the last phrase to finish, so phrases never overlap)
+        if (!m_phrase_pending || m_phrase_playing)
+        {
+            SDL_CondWait(m_speech_cond, m_speech_mutex);
+            continue;
+        }
+
+        std::string phones = m_pending_phones;
+        std::string subtitle = m_pending_subtitle;
+        m_phrase_pending = false;
+
+        // don't hold up the Z80 while we synthesize
+        // (nor the mixer, which takes m_speech_mutex in ssi263_finished_callback)
+        SDL_UnlockMutex(m_speech_mutex);
+        ssi263_say_phones(&phones[0], (int) phones.size(), subtitle);
+        SDL_LockMutex(m_speech_mutex);
+    }
+
+    SDL_UnlockMutex(m_speech_mutex);
+    return 0;
+}
 
 // Take phoneme text and ship it off to get turned into a speech wavefile. We
 // request a raw waveform because it provides an opportunity exercise a little
 // more control over the playback (could have done this in the tqsynth code,
 // but wanted tqsynth to be somewhat independent of the Daphne code).
-void ssi263_say_phones(char *phonemes, int len)
+// Returns as soon as the phrase has started playing (ssi263_finished_callback tells us when it's done).
+void ssi263_say_phones(char *phonemes, int len, const std::string &subtitle)
 {
     sample_s the_sample;
-    unsigned int channel;
 
 	the_sample.pu8Buf = NULL;
 	the_sample.uLength = 0;
 
 	if (tqsynth_phones_to_wave(phonemes, len, &the_sample))
 	{
-		g_bSamplePlaying = true;	// so that we don't overlap samples (only happens at the very beginning of boot-up)
-		channel = samples_play_sample(the_sample.pu8Buf, the_sample.uLength, AUDIO_CHANNELS, -1, ssi263_finished_callback);
-
-		// Wait for sample to stop playing
-		// NOTE : This is a hack and isn't proper emulation.
-		// The proper fix to this is to return to the ROM some signal that our sample has finished playing.
-		while ((g_bSamplePlaying) && (!get_quitflag()))
+		// so that we don't overlap samples
+		// (set before the sample starts, in case it finishes before samples_play_sample returns)
+		SDL_LockMutex(m_speech_mutex);
+		m_phrase_playing = true;
+		m_started_subtitle = subtitle;
+		SDL_UnlockMutex(m_speech_mutex);
+
+		if (samples_play_sample(the_sample.pu8Buf, the_sample.uLength, AUDIO_CHANNELS, -1, ssi263_finished_callback) >= 0)
 		{
-			SDL_Delay(10);
-			SDL_check_input();
+			SDL_AtomicSet(&m_subtitle_started, 1);	// the cpu thread puts the subtitle up from here
+		}
+		else
+		{
+			printline("SSI263_SAY_PHONES error : no sample slot was free, phrase dropped");
+			SDL_LockMutex(m_speech_mutex);
+			m_phrase_playing = false;
+			SDL_UnlockMutex(m_speech_mutex);
+			tqsynth_free_chunk(the_sample.pu8Buf);
 		}
-
     }
 	else
 	{
@@ -412,9 +503,30 @@ void ssi263_say_phones(char *phonemes, int len)
 	}
 }
 
-// gets called when sample has finished playing
+// gets called (by the mixer) when sample has finished playing
 void ssi263_finished_callback(uint8_t *pu8Buf, unsigned int uSlot)
 {
-	g_bSamplePlaying = false;
+	SDL_LockMutex(m_speech_mutex);
+	m_phrase_playing = false;
+	SDL_CondSignal(m_speech_cond);	// the speech thread can start on the next phrase
+	SDL_UnlockMutex(m_speech_mutex);
+
 	tqsynth_free_chunk(pu8Buf);
 }
+
+bool ssi263_get_started_subtitle(char *text)
+{
+	bool bResult = false;
+
+	if (SDL_AtomicGet(&m_subtitle_started))
+	{
+		SDL_LockMutex(m_speech_mutex);
+		strncpy(text, m_started_subtitle.c_str(), SSI_SUBTITLE_LEN - 1);
+		text[SSI_SUBTITLE_LEN - 1] = 0;
+		SDL_AtomicSet(&m_subtitle_started, 0);
+		SDL_UnlockMutex(m_speech_mutex);
+		bResult = true;
+	}
+
+	return bResult;
+}
@@ -31,6 +31,9 @@
 
 // Buffer set aside in game RAM to hold SSI-263 speech text.
 #define SSI_PHRASE_BUF_LEN 256
+
+// Room for a subtitle made from that text (tidying it up can add a space after each comma).
+#define SSI_SUBTITLE_LEN (SSI_PHRASE_BUF_LEN * 2)
 	
 void ssi263_reg0(unsigned char value, uint8_t *irq_status);
 void ssi263_reg1(unsigned char value);
@@ -38,4 +41,9 @@ void ssi263_reg2(unsigned char value);
 void ssi263_reg3(unsigned char value);
 void ssi263_reg4(unsigned char value);
 bool ssi263_init(bool init_speech);
+void ssi263_shutdown();
 void ssi263_finished_callback(uint8_t *pu8Buf, unsigned int uSlot);
+
+// Called periodically by the cpu thread.  If a phrase has started playing since the last call,
+//  copies its subtitle into 'text' (SSI_SUBTITLE_LEN bytes) and returns true.
+bool ssi263_get_started_subtitle(char *text);
@@ -34,6 +34,7 @@
 #include "sound.h"	// to get max volume
 #include "tms9919.hpp"
 #include "tms9919-sdl.hpp"
+#include "blip.h"
 //#include "tms5220.hpp"
 
 //DBG_REGISTER ( __FILE__ );
@@ -55,7 +56,9 @@ cSdlTMS9919::cSdlTMS9919 () :
     m_MasterVolume ( 0 ),
     m_ShiftRegister ( NOISE_RESET ),
     m_NoiseGenerator ( 0 ),
-    m_MixBuffer ( NULL )
+    m_MixBuffer ( NULL ),
+    m_pBlip ( NULL ),
+    m_LastLevel ( 0 )
 {
 //    FUNCTION_ENTRY ( this, "cSdlTMS9919 ctor", true );
 
@@ -63,6 +66,8 @@ cSdlTMS9919::cSdlTMS9919 () :
     memset ( &m_AudioSpec, 0, sizeof ( m_AudioSpec ));
     memset ( m_Info, 0, sizeof ( m_Info ));
 
+    m_pBlip = blip_new ();
+
     SetMasterVolume ( 50 );
 
     float volume = 128.0 / 4.0;
@@ -117,6 +122,7 @@ cSdlTMS9919::~cSdlTMS9919 ()
     }
 
     delete [] m_MixBuffer;
+    blip_delete ( m_pBlip );
 }
 
 void cSdlTMS9919::_AudioCallback ( void *data, uint8_t *stream, int length )
@@ -126,79 +132,95 @@ void cSdlTMS9919::_AudioCallback ( void *data, uint8_t *stream, int length )
     (( cSdlTMS9919 * ) data)->AudioCallback ( stream, length );
 }
 
+// make sure that attenuation (volume) isn't 15 = off and we have a frequency
+bool cSdlTMS9919::VoiceActive ( int i ) const
+{
+    return ( m_Attenuation [i] != 15 ) && ( m_Info [i].period >= (( int64_t ) 1 << BLIP_FRAC_BITS ));
+}
+
+// the level all four voices add up to right now
+int cSdlTMS9919::GetLevel () const
+{
+    int level = 0;
+    for ( int i = 0; i < 4; i++ ) {
+        if ( VoiceActive ( i )) level += m_Info [i].setting;
+    }
+
+    // the voices have always gone into the high byte of each sample
+    return level << 8;
+}
+
+void cSdlTMS9919::ToggleVoice ( int i )
+{
+    sVoiceInfo *info = &m_Info [i];
+
+    info->toggle += info->period;
+
+    if ( i < 3 ) {
+        // Tone
+        info->setting = -info->setting;
+    } else {
+        // Noise
+        if ( m_ShiftRegister & 1 ) {
+            m_ShiftRegister ^= m_NoiseGenerator;
+            // Protect against 0
+            if ( m_ShiftRegister == 0 ) {
+                m_ShiftRegister = NOISE_RESET;
+            }
+            info->setting = -info->setting;
+        }
+        m_ShiftRegister >>= 1;
+    }
+}
+
 void cSdlTMS9919::AudioCallback ( uint8_t *stream, int length )
 {
 //    FUNCTION_ENTRY ( this, "cSdlTMS9919::AudioCallback", false );
 
 //	int volume = ( m_MasterVolume * AUDIO_MAX_VOLUME ) / 100;
 
-    bool mix = false;
-    memset ( stream, m_AudioSpec.silence, length );
+    unsigned int samples = length / 4;
+    int64_t left = ( int64_t ) samples << BLIP_FRAC_BITS;  // how much time is left in this buffer
+    int64_t now = 0;
 
-    for ( int i = 0; i < 4; i++ ) {
-        // set info to this voice's information
-		sVoiceInfo *info = &m_Info [i];
-        
-		// make sure that attenuation (volume) isn't 15 = off and we have a frequency
-		if (( m_Attenuation [i] != 15 ) && ( info->period >= 1.0 )) 
-		{
-            // new data so we'll need to mix
-			mix = true;
-            
-			// set left = length (number of samples we need to process)
-			int left = length/4, j = 1;
-            
-			// now calculate all the samples for the buffer
-			do 
-			{
-                // how many samples do we copy before we toggle
-				int count = ( info->toggle < left ) ? ( int ) info->toggle : left;
-                
-				// we are going to do (count) samples so minus them from how many left to do
-				left -= count;
-                
-				// also minus that amount from toggle
-				info->toggle -= count;
-                
-				// now copy the frequency to the stream
-				while ( count-- ) 
-				{
-                    // copy to both channels
-                    stream [j] += info->setting;
-                    stream [j + 2] = stream[j];
-                    j+=4;
-                }
-                
-				if ( info->toggle < 1.0 ) 
-				{
-                    info->toggle += info->period;
-                    
-					if ( i < 3 ) 
-					{
-                        // Tone
-                        info->setting = -info->setting;
-                    } 
-					else 
-					{
-                        // Noise
-                        if ( m_ShiftRegister & 1 ) 
-						{
-                            m_ShiftRegister ^= m_NoiseGenerator;
-                            // Protect against 0
-                            if ( m_ShiftRegister == 0 ) 
-							{
-                                m_ShiftRegister = NOISE_RESET;
-                            }
-                            info->setting = -info->setting;
-                        }
-                        m_ShiftRegister >>= 1;
-                    }
-                }
-            } 
-			while ( left > 0 );
+    // register writes since the last buffer take effect at the beginning of this one
+    int level = GetLevel ();
+    if ( level != m_LastLevel ) {
+        blip_add_delta ( m_pBlip, 0, level - m_LastLevel );
+        m_LastLevel = level;
+    }
+
+    // jump from one toggle to the next instead of going sample by sample
+    for ( ;; ) {
+        int64_t next = left;
+        for ( int i = 0; i < 4; i++ ) {
+            if ( VoiceActive ( i ) && ( m_Info [i].toggle < next )) next = m_Info [i].toggle;
+        }
+        if ( next < 0 ) next = 0;
+
+        // (silent voices are frozen, just like they always have been)
+        for ( int i = 0; i < 4; i++ ) {
+            if ( VoiceActive ( i )) m_Info [i].toggle -= next;
+        }
+        now  += next;
+        left -= next;
+
+        if ( left == 0 ) break;
+
+        for ( int i = 0; i < 4; i++ ) {
+            if ( VoiceActive ( i ) && ( m_Info [i].toggle <= 0 )) ToggleVoice ( i );
+        }
+
+        // only the edges go into the buffer
+        level = GetLevel ();
+        if ( level != m_LastLevel ) {
+            blip_add_delta ( m_pBlip, ( uint32_t ) now, level - m_LastLevel );
+            m_LastLevel = level;
         }
     }
 
+    blip_read_stereo ( m_pBlip, stream, samples );
+
 //    if ( m_pSpeechSynthesizer != NULL ) {
 //        mix |= m_pSpeechSynthesizer->AudioCallback ( m_MixBuffer, length );
 //    }
@@ -246,10 +268,10 @@ void cSdlTMS9919::SetNoise ( NOISE_COLOR_E color, int type )
 
         if ( m_Frequency [3] != 0 ) {
             int volume = m_VolumeTable [ m_Attenuation [3]];
-            info->period  = ( float ) m_AudioSpec.freq / ( float ) m_Frequency [3];
+            info->period  = (( int64_t ) m_AudioSpec.freq << BLIP_FRAC_BITS ) / m_Frequency [3];
             info->setting = ( info->setting > 0 ) ? volume : -volume;
         } else {
-            info->period = 0.0;
+            info->period = 0;
         }
     }
 }
@@ -268,10 +290,10 @@ void cSdlTMS9919::SetFrequency ( int tone, int freq )
 
         if (( freq < m_AudioSpec.freq / 2 ) && ( freq != 0)) {
             int volume = m_VolumeTable [ m_Attenuation [ tone ]];
-            info->period  = ( float ) ( m_AudioSpec.freq / freq / 2.0 );
+            info->period  = (( int64_t ) m_AudioSpec.freq << BLIP_FRAC_BITS ) / ( freq * 2 );
             info->setting = ( info->setting > 0 ) ? volume : -volume;
         } else {
-            info->period  = 0.0;
+            info->period  = 0;
         }
 
         // If we changed voice 2, see if the noise channel needs to be updated
@@ -280,10 +302,10 @@ void cSdlTMS9919::SetFrequency ( int tone, int freq )
             sVoiceInfo *info = &m_Info [3];
             if ( m_Frequency [3] != 0 ) {
                 int volume = m_VolumeTable [ m_Attenuation [3]];
-                info->period  = ( float ) m_AudioSpec.freq / ( float ) m_Frequency [3];
+                info->period  = (( int64_t ) m_AudioSpec.freq << BLIP_FRAC_BITS ) / m_Frequency [3];
                 info->setting = ( info->setting > 0 ) ? volume : -volume;
             } else {
-                info->period = 0.0;
+                info->period = 0;
             }
         }
     }
@@ -37,11 +37,13 @@
 
 #define SIZE sizeof
 
+struct blip_s;
+
 class cSdlTMS9919 : public cTMS9919 {
 
     struct sVoiceInfo {
-        float  period;
-        float  toggle;
+        int64_t period;     // in blip time (samples << BLIP_FRAC_BITS), 0 = silent
+        int64_t toggle;     // time left until the next toggle
         int    setting;
         uint8_t *buffer;
     };	     
@@ -56,8 +58,14 @@ class cSdlTMS9919 : public cTMS9919 {
     int                 m_ShiftRegister;
     int                 m_NoiseGenerator;
     uint8_t              *m_MixBuffer;
+    blip_s              *m_pBlip;
+    int                 m_LastLevel;
 
     static void _AudioCallback ( void *, uint8_t *, int );
+
+    bool VoiceActive ( int ) const;
+    int  GetLevel () const;
+    void ToggleVoice ( int );
  
     virtual void SetNoise ( NOISE_COLOR_E, int );
     virtual void SetFrequency ( int, int );
@@ -36,6 +36,9 @@
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
+#include <string>
+#include <map>
+#include <list>
 #include "tqsynth.h"
 #include "../io/conout.h"
 #include "../io/mpo_mem.h"
@@ -2035,12 +2038,68 @@ bool audio_get_chunk(int num_samples, short *samples, sample_s *ptrSample)
     return bResult;
 }
 
+// Thayer's Quest says the same phrases over and over again, so we hang on to the
+// chunks we've already synthesized (converted, ready to play) and hand out copies.
+#define TQSYNTH_CACHE_BYTES (16 * 1024 * 1024)
+
+typedef std::pair<long, std::string> phrase_key_t;  // base F0, phonemes
+
+std::map<phrase_key_t, std::string> g_tqsynth_cache;
+std::list<phrase_key_t> g_tqsynth_cache_order;      // oldest phrase first
+unsigned int g_tqsynth_cache_bytes = 0;
+
+// Copy a cached phrase into a new chunk, returns false if it isn't cached.
+static bool tqsynth_cache_find(const phrase_key_t &key, sample_s *ptrSample)
+{
+    std::map<phrase_key_t, std::string>::const_iterator mi = g_tqsynth_cache.find(key);
+    bool bResult = false;
+
+    if (mi != g_tqsynth_cache.end())
+    {
+        unsigned int uLength = (unsigned int) mi->second.size();
+        ptrSample->pu8Buf = (uint8_t *) MPO_MALLOC(uLength);
+
+        if (NULL != ptrSample->pu8Buf)
+        {
+            memcpy(ptrSample->pu8Buf, mi->second.data(), uLength);
+            ptrSample->uLength = uLength;
+            bResult = true;
+        }
+    }
+
+    return bResult;
+}
+
+// Remember a freshly synthesized chunk, forgetting the oldest phrases if we're over budget.
+static void tqsynth_cache_add(const phrase_key_t &key, const sample_s *ptrSample)
+{
+    if (ptrSample->uLength > TQSYNTH_CACHE_BYTES) return;
+
+    while (g_tqsynth_cache_bytes + ptrSample->uLength > TQSYNTH_CACHE_BYTES)
+    {
+        std::map<phrase_key_t, std::string>::iterator mi = g_tqsynth_cache.find(g_tqsynth_cache_order.front());
+        g_tqsynth_cache_bytes -= (unsigned int) mi->second.size();
+        g_tqsynth_cache.erase(mi);
+        g_tqsynth_cache_order.pop_front();
+    }
+
+    g_tqsynth_cache[key].assign((const char *) ptrSample->pu8Buf, ptrSample->uLength);
+    g_tqsynth_cache_order.push_back(key);
+    g_tqsynth_cache_bytes += ptrSample->uLength;
+}
+
 // Take a string of phonemes and synthesize to wave data.
 bool tqsynth_phones_to_wave(char *phonemes, int len, sample_s *ptrSample)
 {
     darray_t elm;
     unsigned frames;
 	bool bResult = false;
+    phrase_key_t key(def_pars.F0hz10, std::string(phonemes, len));
+
+    if (tqsynth_cache_find(key, ptrSample))
+    {
+        return true;
+    }
 
     darray_init(&elm, sizeof(char), len);
 
@@ -2057,6 +2116,11 @@ bool tqsynth_phones_to_wave(char *phonemes, int len, sample_s *ptrSample)
 
             bResult = audio_get_chunk(nsamp, samp, ptrSample);
             free(samp);
+
+            if (bResult)
+            {
+                tqsynth_cache_add(key, ptrSample);
+            }
         }
 		// else malloc failed ...
     }
@@ -0,0 +1,463 @@
+/*
+ * telemetry.cpp
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// telemetry.cpp -- latency histograms and counters for tuning how smoothly we run
+
+// Every thread that records something gets its own set of histograms (a 'shard'), which only that thread
+//  ever writes to, so recording a sample is just a few plain increments with no locks or atomic operations.
+// The shards are added together when the results are dumped.
+// The histograms are log-linear (like HdrHistogram): each power of 2 is split into 16 buckets, so any value
+//  is known to within about 3%, from 1 ns up to about half an hour, in a fixed amount of memory.
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <SDL.h>
+#include "telemetry.h"
+#include "../io/conout.h"
+
+using namespace std;
+
+// how many buckets each power of 2 is split into (as a power of 2)
+#define TELEM_SUB_BITS 4
+#define TELEM_SUB_BUCKETS (1 << TELEM_SUB_BITS)
+
+// the largest value that gets a bucket of its own (anything bigger goes in the last bucket)
+#define TELEM_MAX_MSB 40
+
+#define TELEM_BUCKETS ((TELEM_MAX_MSB - TELEM_SUB_BITS + 2) * TELEM_SUB_BUCKETS)
+
+// how many threads can record samples (any more than this are counted in g_telem_unrecorded)
+#define TELEM_MAX_THREADS 16
+
+static const char *g_telem_hist_names[TELEM_HIST_COUNT] =
+{
+	"retro_run",
+	"video_interval",
+	"seek_latency",
+	"vldp_frame_lateness",
+	"cpu_delay"
+};
+
+static const char *g_telem_counter_names[TELEM_COUNTER_COUNT] =
+{
+	"vldp_frames_dropped",
+	"cpu_slices_behind"
+};
+
+struct telem_shard
+{
+	uint32_t uBuckets[TELEM_HIST_COUNT][TELEM_BUCKETS];
+	uint64_t u64Count[TELEM_HIST_COUNT];
+	uint64_t u64Sum[TELEM_HIST_COUNT];
+	uint64_t u64Min[TELEM_HIST_COUNT];
+	uint64_t u64Max[TELEM_HIST_COUNT];
+	uint64_t u64Counters[TELEM_COUNTER_COUNT];
+};
+
+// the sum of every shard's histogram (when dumping)
+struct telem_totals
+{
+	uint64_t u64Buckets[TELEM_BUCKETS];
+	uint64_t u64Count;
+	uint64_t u64Sum;
+	uint64_t u64Min;
+	uint64_t u64Max;
+};
+
+bool g_telemetry_enabled = false;
+
+static telem_shard g_telem_shards[TELEM_MAX_THREADS];
+
+// which thread owns each shard (NULL if nobody has claimed it yet)
+static void *g_telem_shard_owner[TELEM_MAX_THREADS];
+
+static SDL_atomic_t g_telem_unrecorded;	// samples thrown out because every shard was taken
+static string g_telem_path;	// where telemetry_dump writes to
+static uint64_t g_telem_start_ns = 0;	// when telemetry was enabled
+
+void telemetry_enable(const char *pszDumpPath)
+{
+	g_telem_path = pszDumpPath;
+	g_telem_start_ns = telemetry_now_ns();
+	g_telemetry_enabled = true;
+}
+
+uint64_t telemetry_now_ns()
+{
+#ifdef WIN32
+	static LARGE_INTEGER freq = { 0 };
+	LARGE_INTEGER now;
+	if (freq.QuadPart == 0)
+	{
+		QueryPerformanceFrequency(&freq);
+	}
+	QueryPerformanceCounter(&now);
+	return (uint64_t) ((now.QuadPart / freq.QuadPart) * 1000000000 + ((now.QuadPart % freq.QuadPart) * 1000000000) / freq.QuadPart);
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t) ts.tv_sec * 1000000000) + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+// returns the shard belonging to the calling thread, or NULL if there are none left
+static telem_shard *telem_get_shard()
+{
+	// (+1 so that no thread's ID can look like an unclaimed shard)
+	void *pID = (void *) (uintptr_t) (SDL_ThreadID() + 1);
+
+	for (unsigned int i = 0; i < TELEM_MAX_THREADS; i++)
+	{
+		void *pOwner = SDL_AtomicGetPtr(&g_telem_shard_owner[i]);
+
+		if (pOwner == pID)
+		{
+			return &g_telem_shards[i];
+		}
+		// we haven't got a shard yet, so try to claim this one
+		else if (!pOwner && SDL_AtomicCASPtr(&g_telem_shard_owner[i], NULL, pID))
+		{
+			return &g_telem_shards[i];
+		}
+	}
+
+	return NULL;
+}
+
+// returns which bucket 'u64Value' goes in
+static unsigned int telem_bucket(uint64_t u64Value)
+{
+	unsigned int uMsb = 0;
+
+	// small values get a bucket each
+	if (u64Value < TELEM_SUB_BUCKETS)
+	{
+		return (unsigned int) u64Value;
+	}
+
+#ifdef __GNUC__
+	uMsb = 63 - __builtin_clzll(u64Value);
+#else
+	for (uint64_t u64 = u64Value >> 1; u64; u64 >>= 1)
+	{
+		uMsb++;
+	}
+#endif
+
+	if (uMsb > TELEM_MAX_MSB)
+	{
+		return TELEM_BUCKETS - 1;
+	}
+
+	// the top TELEM_SUB_BITS + 1 bits of the value pick the bucket within its power of 2
+	unsigned int uShift = uMsb - TELEM_SUB_BITS;
+	return (uShift * TELEM_SUB_BUCKETS) + (unsigned int) (u64Value >> uShift);
+}
+
+// returns the smallest value that goes into bucket 'uBucket'
+static uint64_t telem_bucket_low(unsigned int uBucket)
+{
+	if (uBucket < 2 * TELEM_SUB_BUCKETS)
+	{
+		return uBucket;
+	}
+
+	unsigned int uShift = (uBucket / TELEM_SUB_BUCKETS) - 1;
+	return ((uint64_t) ((uBucket % TELEM_SUB_BUCKETS) + TELEM_SUB_BUCKETS)) << uShift;
+}
+
+// returns the largest value that goes into bucket 'uBucket'
+static uint64_t telem_bucket_high(unsigned int uBucket)
+{
+	return (uBucket == TELEM_BUCKETS - 1) ? ~((uint64_t) 0) : telem_bucket_low(uBucket + 1) - 1;
+}
+
+void telemetry_record(unsigned int uHist, uint64_t u64ValueNs)
+{
+	telem_shard *pShard = NULL;
+
+	if (!g_telemetry_enabled)
+	{
+		return;
+	}
+
+	pShard = telem_get_shard();
+	if (!pShard)
+	{
+		SDL_AtomicIncRef(&g_telem_unrecorded);
+		return;
+	}
+
+	pShard->uBuckets[uHist][telem_bucket(u64ValueNs)]++;
+	if ((pShard->u64Count[uHist] == 0) || (u64ValueNs < pShard->u64Min[uHist]))
+	{
+		pShard->u64Min[uHist] = u64ValueNs;
+	}
+	if (u64ValueNs > pShard->u64Max[uHist])
+	{
+		pShard->u64Max[uHist] = u64ValueNs;
+	}
+	pShard->u64Sum[uHist] += u64ValueNs;
+	pShard->u64Count[uHist]++;
+}
+
+void telemetry_count(unsigned int uCounter, unsigned int uAmount)
+{
+	telem_shard *pShard = NULL;
+
+	if (!g_telemetry_enabled)
+	{
+		return;
+	}
+
+	pShard = telem_get_shard();
+	if (!pShard)
+	{
+		SDL_AtomicIncRef(&g_telem_unrecorded);
+		return;
+	}
+
+	pShard->u64Counters[uCounter] += uAmount;
+}
+
+// adds up histogram 'uHist' from every shard
+static void telem_add_shards(unsigned int uHist, telem_totals *pTotals)
+{
+	memset(pTotals, 0, sizeof(*pTotals));
+
+	for (unsigned int i = 0; i < TELEM_MAX_THREADS; i++)
+	{
+		const telem_shard *pShard = &g_telem_shards[i];
+
+		if (pShard->u64Count[uHist] == 0)
+		{
+			continue;
+		}
+
+		for (unsigned int j = 0; j < TELEM_BUCKETS; j++)
+		{
+			pTotals->u64Buckets[j] += pShard->uBuckets[uHist][j];
+		}
+		if ((pTotals->u64Count == 0) || (pShard->u64Min[uHist] < pTotals->u64Min))
+		{
+			pTotals->u64Min = pShard->u64Min[uHist];
+		}
+		if (pShard->u64Max[uHist] > pTotals->u64Max)
+		{
+			pTotals->u64Max = pShard->u64Max[uHist];
+		}
+		pTotals->u64Sum += pShard->u64Sum[uHist];
+		pTotals->u64Count += pShard->u64Count[uHist];
+	}
+}
+
+// returns the value (in nanoseconds) that 'dFraction' of all samples are less than or equal to
+static uint64_t telem_percentile(const telem_totals *pTotals, double dFraction)
+{
+	uint64_t u64Total = 0;
+	uint64_t u64Seen = 0;
+	uint64_t u64Rank = 0;
+
+	// (we go by the buckets rather than u64Count because a thread might be in the middle of adding a sample)
+	for (unsigned int i = 0; i < TELEM_BUCKETS; i++)
+	{
+		u64Total += pTotals->u64Buckets[i];
+	}
+
+	u64Rank = (uint64_t) (dFraction * (double) u64Total + 0.5);
+	if (u64Rank < 1)
+	{
+		u64Rank = 1;
+	}
+
+	for (unsigned int i = 0; i < TELEM_BUCKETS; i++)
+	{
+		u64Seen += pTotals->u64Buckets[i];
+		if (u64Seen >= u64Rank)
+		{
+			// the middle of the bucket, but never outside of what we've actually seen
+			uint64_t u64Low = telem_bucket_low(i);
+			uint64_t u64High = telem_bucket_high(i);
+			uint64_t u64Value = u64Low + (((u64High > pTotals->u64Max) ? pTotals->u64Max : u64High) - u64Low) / 2;
+
+			if (u64Value < pTotals->u64Min) u64Value = pTotals->u64Min;
+			if (u64Value > pTotals->u64Max) u64Value = pTotals->u64Max;
+			return u64Value;
+		}
+	}
+
+	return pTotals->u64Max;
+}
+
+static const double TELEM_PERCENTILES[] = { 0.50, 0.90, 0.99, 0.999 };
+static const char *TELEM_PERCENTILE_NAMES[] = { "p50", "p90", "p99", "p999" };
+#define TELEM_PERCENTILE_COUNT (sizeof(TELEM_PERCENTILES) / sizeof(TELEM_PERCENTILES[0]))
+
+static double telem_us(uint64_t u64Ns)
+{
+	return (double) u64Ns / 1000.0;
+}
+
+static void telem_write_json(FILE *F)
+{
+	telem_totals totals;
+	uint64_t u64Counter = 0;
+
+	fprintf(F, "{\n\t\"elapsed_s\": %.3f,\n\t\"unit\": \"us\",\n\t\"histograms\": {\n",
+		(double) (telemetry_now_ns() - g_telem_start_ns) / 1000000000.0);
+
+	for (unsigned int uHist = 0; uHist < TELEM_HIST_COUNT; uHist++)
+	{
+		bool bFirst = true;
+
+		telem_add_shards(uHist, &totals);
+		fprintf(F, "\t\t\"%s\": {\"count\": %llu", g_telem_hist_names[uHist], (unsigned long long) totals.u64Count);
+		if (totals.u64Count)
+		{
+			fprintf(F, ", \"min\": %.1f, \"mean\": %.1f", telem_us(totals.u64Min), telem_us(totals.u64Sum / totals.u64Count));
+			for (unsigned int i = 0; i < TELEM_PERCENTILE_COUNT; i++)
+			{
+				fprintf(F, ", \"%s\": %.1f", TELEM_PERCENTILE_NAMES[i], telem_us(telem_percentile(&totals, TELEM_PERCENTILES[i])));
+			}
+			fprintf(F, ", \"max\": %.1f", telem_us(totals.u64Max));
+		}
+
+		// [lowest value, highest value, count] of every bucket that has anything in it
+		fprintf(F, ", \"buckets\": [");
+		for (unsigned int i = 0; i < TELEM_BUCKETS; i++)
+		{
+			if (totals.u64Buckets[i])
+			{
+				fprintf(F, "%s[%.3f, %.3f, %llu]", bFirst ? "" : ", ", telem_us(telem_bucket_low(i)),
+					telem_us((i == TELEM_BUCKETS - 1) ? totals.u64Max : telem_bucket_high(i)), (unsigned long long) totals.u64Buckets[i]);
+				bFirst = false;
+			}
+		}
+		fprintf(F, "]}%s\n", (uHist + 1 < TELEM_HIST_COUNT) ? "," : "");
+	}
+
+	fprintf(F, "\t},\n\t\"counters\": {\n");
+	for (unsigned int uCounter = 0; uCounter < TELEM_COUNTER_COUNT; uCounter++)
+	{
+		u64Counter = 0;
+		for (unsigned int i = 0; i < TELEM_MAX_THREADS; i++)
+		{
+			u64Counter += g_telem_shards[i].u64Counters[uCounter];
+		}
+		fprintf(F, "\t\t\"%s\": %llu,\n", g_telem_counter_names[uCounter], (unsigned long long) u64Counter);
+	}
+	fprintf(F, "\t\t\"unrecorded_samples\": %d\n\t}\n}\n", SDL_AtomicGet(&g_telem_unrecorded));
+}
+
+static void telem_write_csv(FILE *F)
+{
+	telem_totals totals;
+	uint64_t u64Counter = 0;
+
+	fprintf(F, "name,count,min_us,mean_us");
+	for (unsigned int i = 0; i < TELEM_PERCENTILE_COUNT; i++)
+	{
+		fprintf(F, ",%s_us", TELEM_PERCENTILE_NAMES[i]);
+	}
+	fprintf(F, ",max_us\n");
+
+	for (unsigned int uHist = 0; uHist < TELEM_HIST_COUNT; uHist++)
+	{
+		telem_add_shards(uHist, &totals);
+		fprintf(F, "%s,%llu", g_telem_hist_names[uHist], (unsigned long long) totals.u64Count);
+		if (totals.u64Count)
+		{
+			fprintf(F, ",%.1f,%.1f", telem_us(totals.u64Min), telem_us(totals.u64Sum / totals.u64Count));
+			for (unsigned int i = 0; i < TELEM_PERCENTILE_COUNT; i++)
+			{
+				fprintf(F, ",%.1f", telem_us(telem_percentile(&totals, TELEM_PERCENTILES[i])));
+			}
+			fprintf(F, ",%.1f", telem_us(totals.u64Max));
+		}
+		fprintf(F, "\n");
+	}
+
+	// counters only have a count
+	for (unsigned int uCounter = 0; uCounter < TELEM_COUNTER_COUNT; uCounter++)
+	{
+		u64Counter = 0;
+		for (unsigned int i = 0; i < TELEM_MAX_THREADS; i++)
+		{
+			u64Counter += g_telem_shards[i].u64Counters[uCounter];
+		}
+		fprintf(F, "%s,%llu\n", g_telem_counter_names[uCounter], (unsigned long long) u64Counter);
+	}
+	fprintf(F, "unrecorded_samples,%d\n", SDL_AtomicGet(&g_telem_unrecorded));
+}
+
+bool telemetry_dump()
+{
+	telem_totals totals;
+	FILE *F = NULL;
+	bool bCSV = false;
+
+	if (!g_telemetry_enabled)
+	{
+		return false;
+	}
+
+	// a short summary for the log
+	for (unsigned int uHist = 0; uHist < TELEM_HIST_COUNT; uHist++)
+	{
+		telem_add_shards(uHist, &totals);
+		if (totals.u64Count)
+		{
+			LOGF(LOGLEVEL_INFO, "Telemetry : %s: %llu samples, p50 %.1f us, p99 %.1f us, max %.1f us", g_telem_hist_names[uHist],
+				(unsigned long long) totals.u64Count, telem_us(telem_percentile(&totals, 0.50)),
+				telem_us(telem_percentile(&totals, 0.99)), telem_us(totals.u64Max));
+		}
+	}
+
+	bCSV = (g_telem_path.size() >= 4) && (strcasecmp(g_telem_path.c_str() + g_telem_path.size() - 4, ".csv") == 0);
+
+	F = fopen(g_telem_path.c_str(), "wt");
+	if (!F)
+	{
+		LOGF(LOGLEVEL_ERROR, "Telemetry : could not write to %s", g_telem_path.c_str());
+		return false;
+	}
+
+	if (bCSV)
+	{
+		telem_write_csv(F);
+	}
+	else
+	{
+		telem_write_json(F);
+	}
+
+	fclose(F);
+	LOGF(LOGLEVEL_INFO, "Telemetry : wrote %s", g_telem_path.c_str());
+	return true;
+}
@@ -0,0 +1,85 @@
+/*
+ * telemetry.h
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// telemetry.h -- latency histograms and counters for tuning how smoothly we run
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+// The histograms that we keep (every value is a duration in nanoseconds)
+enum
+{
+	TELEM_RUN_TIME,	// how long each retro_run call took
+	TELEM_VIDEO_INTERVAL,	// time between frames being handed to the frontend
+	TELEM_SEEK_LATENCY,	// from a search command (ldp::pre_search) until the player is paused on the target frame
+	TELEM_FRAME_LATENESS,	// how late VLDP displayed each frame, relative to when it was due
+	TELEM_CPU_DELAY,	// how long the cpu thread slept to stay in sync, each time it had to
+	TELEM_HIST_COUNT
+};
+
+// The counters that we keep
+enum
+{
+	TELEM_VLDP_DROPPED,	// frames VLDP dropped because it was too far behind to display them
+	TELEM_CPU_BEHIND,	// 1 ms cpu timeslices that finished late (so there was no time to sleep)
+	TELEM_COUNTER_COUNT
+};
+
+// Nothing is recorded unless this is true (set by telemetry_enable).
+extern bool g_telemetry_enabled;
+
+// Starts recording.  'pszDumpPath' is where telemetry_dump writes the results
+//  (as CSV if it ends in .csv, JSON otherwise).
+void telemetry_enable(const char *pszDumpPath);
+
+// returns a monotonic clock in nanoseconds
+uint64_t telemetry_now_ns();
+
+// returns the current time to pass to telemetry_stop, or 0 if telemetry is disabled
+inline uint64_t telemetry_start()
+{
+	return g_telemetry_enabled ? telemetry_now_ns() : 0;
+}
+
+// adds one sample to a TELEM_ histogram
+void telemetry_record(unsigned int uHist, uint64_t u64ValueNs);
+
+// records the time since 'u64StartNs' (from telemetry_start) in a TELEM_ histogram
+inline void telemetry_stop(unsigned int uHist, uint64_t u64StartNs)
+{
+	if (u64StartNs != 0)
+	{
+		telemetry_record(uHist, telemetry_now_ns() - u64StartNs);
+	}
+}
+
+// adds to a TELEM_ counter
+void telemetry_count(unsigned int uCounter, unsigned int uAmount = 1);
+
+// Writes everything recorded so far to the file given to telemetry_enable (and a summary to the log).
+// This can be called at any time from any thread; samples being recorded at the same time may or may not make it in.
+// Returns false if telemetry is disabled or the file couldn't be written.
+bool telemetry_dump();
+
+#endif // TELEMETRY_H
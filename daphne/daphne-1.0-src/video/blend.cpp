@@ -23,22 +23,234 @@
 // blend.cpp
 
 #include <stdint.h>
+#include <string.h>
 #include "blend.h"
 
-uint8_t *g_blend_line1 = 0;
-uint8_t *g_blend_line2 = 0;
-uint8_t *g_blend_dest = 0;
-uint32_t g_blend_iterations = 0;
+// YUY2 is stored as Y0 U Y1 V bytes on every platform, so everything here works on bytes and
+//  doesn't care about endianness
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define BLEND_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define BLEND_NEON
+#include <arm_neon.h>
+#endif
 
-void blend_c()
+// 2 pixels of black in YUY2 format
+static const uint8_t g_yuy2_black[4] = { 0x00, 0x7f, 0x00, 0x7f };
+
+// the YUY2 pixel pair for an overlay color
+static inline void yuy2_overlay_pair(uint8_t *pPair, const t_yuv_color *color)
+{
+	pPair[0] = color->y;
+	pPair[1] = color->u;
+	pPair[2] = color->y;
+	pPair[3] = color->v;
+}
+
+// averages two pixel pairs, rounding down (the way blending has always been done)
+static inline void yuy2_average_pair(uint8_t *pDst, const uint8_t *p1, const uint8_t *p2)
 {
-	register uint8_t *ptr1 = g_blend_line1;
-	register uint8_t *ptr2 = g_blend_line2;
-	
-	for (unsigned int col = 0; col < g_blend_iterations; col++)
-	{
-		g_blend_dest[col] = (uint8_t) ((*ptr1 + *ptr2) >> 1);	// average fields together
-		ptr1++;
-		ptr2++;
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		pDst[i] = (uint8_t) ((p1[i] + p2[i]) >> 1);
+	}
+}
+
+// builds and writes one pixel pair of both rows (the scalar version of the loop below)
+static inline void yuy2_write_pair(uint8_t *pRow1, uint8_t *pRow2, const yuy2_row_src &src, unsigned int uPair,
+								   bool bBlend, bool bScanlines)
+{
+	uint8_t p1[4], p2[4];
+	const t_yuv_color *color = NULL;
+
+	if (src.pOverlay)
+	{
+		color = &src.pPalette[src.pOverlay[uPair]];
+	}
+
+	if ((color == NULL) || color->transparent)
+	{
+		p1[0] = src.Y1[uPair << 1];
+		p1[1] = src.U[uPair];
+		p1[2] = src.Y1[(uPair << 1) + 1];
+		p1[3] = src.V[uPair];
+		p2[0] = src.Y2[uPair << 1];
+		p2[1] = p1[1];
+		p2[2] = src.Y2[(uPair << 1) + 1];
+		p2[3] = p1[3];
+	}
+	// the overlay is already doubled vertically, so it's the same on both rows
+	else
+	{
+		yuy2_overlay_pair(p1, color);
+		memcpy(p2, p1, sizeof(p2));
+	}
+
+	if (bBlend)
+	{
+		yuy2_average_pair(p1, p1, p2);
+		memcpy(p2, p1, sizeof(p2));
+	}
+
+	if (bScanlines)
+	{
+		// the black line must come first (on nvidia it makes the top line too bright otherwise)
+		memcpy(pRow1, g_yuy2_black, 4);
+		memcpy(pRow2, p1, 4);
+	}
+	else
+	{
+		memcpy(pRow1, p1, 4);
+		memcpy(pRow2, p2, 4);
+	}
+}
+
+void yuy2_write_rows(uint8_t *pDst, unsigned int uPitch, const yuy2_row_src &src, unsigned int uWidth,
+					 bool bBlend, bool bScanlines)
+{
+	uint8_t *pRow1 = pDst;
+	uint8_t *pRow2 = pDst + uPitch;
+	unsigned int uPairs = uWidth >> 1;
+	unsigned int uPair = 0;
+
+#if defined(BLEND_SSE2) || defined(BLEND_NEON)
+	// 16 pixels (8 pixel pairs, 32 bytes of YUY2) per row each time through
+	for (; uPair + 8 <= uPairs; uPair += 8)
+	{
+		unsigned int uX = uPair << 1;	// luma index
+		unsigned int uOpaque = 0;	// bit N set means overlay pixel N covers the mpeg pixel pair
+
+		if (src.pOverlay)
+		{
+			for (unsigned int i = 0; i < 8; i++)
+			{
+				if (!src.pPalette[src.pOverlay[uPair + i]].transparent)
+				{
+					uOpaque |= (1 << i);
+				}
+			}
+		}
+
+#ifdef BLEND_SSE2
+		__m128i y1 = _mm_loadu_si128((const __m128i *) (src.Y1 + uX));
+		__m128i y2 = _mm_loadu_si128((const __m128i *) (src.Y2 + uX));
+		__m128i uv = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (src.U + uPair)),
+			_mm_loadl_epi64((const __m128i *) (src.V + uPair)));
+		__m128i r1lo = _mm_unpacklo_epi8(y1, uv);
+		__m128i r1hi = _mm_unpackhi_epi8(y1, uv);
+		__m128i r2lo = _mm_unpacklo_epi8(y2, uv);
+		__m128i r2hi = _mm_unpackhi_epi8(y2, uv);
+
+		// rare enough (most of the screen is usually transparent) that a trip through memory is fine
+		if (uOpaque)
+		{
+			uint8_t row1[32], row2[32];
+			_mm_storeu_si128((__m128i *) row1, r1lo);
+			_mm_storeu_si128((__m128i *) (row1 + 16), r1hi);
+			_mm_storeu_si128((__m128i *) row2, r2lo);
+			_mm_storeu_si128((__m128i *) (row2 + 16), r2hi);
+			for (unsigned int i = 0; i < 8; i++)
+			{
+				if (uOpaque & (1 << i))
+				{
+					yuy2_overlay_pair(row1 + (i << 2), &src.pPalette[src.pOverlay[uPair + i]]);
+					memcpy(row2 + (i << 2), row1 + (i << 2), 4);
+				}
+			}
+			r1lo = _mm_loadu_si128((const __m128i *) row1);
+			r1hi = _mm_loadu_si128((const __m128i *) (row1 + 16));
+			r2lo = _mm_loadu_si128((const __m128i *) row2);
+			r2hi = _mm_loadu_si128((const __m128i *) (row2 + 16));
+		}
+
+		if (bBlend)
+		{
+			// pavgb rounds up, so take the carry back off to keep the old rounding
+			const __m128i one = _mm_set1_epi8(1);
+			r1lo = _mm_sub_epi8(_mm_avg_epu8(r1lo, r2lo), _mm_and_si128(_mm_xor_si128(r1lo, r2lo), one));
+			r1hi = _mm_sub_epi8(_mm_avg_epu8(r1hi, r2hi), _mm_and_si128(_mm_xor_si128(r1hi, r2hi), one));
+			r2lo = r1lo;
+			r2hi = r1hi;
+		}
+
+		if (bScanlines)
+		{
+			const __m128i black = _mm_set1_epi16(0x7f00);
+			_mm_storeu_si128((__m128i *) (pRow1 + (uPair << 2)), black);
+			_mm_storeu_si128((__m128i *) (pRow1 + (uPair << 2) + 16), black);
+			_mm_storeu_si128((__m128i *) (pRow2 + (uPair << 2)), r1lo);
+			_mm_storeu_si128((__m128i *) (pRow2 + (uPair << 2) + 16), r1hi);
+		}
+		else
+		{
+			_mm_storeu_si128((__m128i *) (pRow1 + (uPair << 2)), r1lo);
+			_mm_storeu_si128((__m128i *) (pRow1 + (uPair << 2) + 16), r1hi);
+			_mm_storeu_si128((__m128i *) (pRow2 + (uPair << 2)), r2lo);
+			_mm_storeu_si128((__m128i *) (pRow2 + (uPair << 2) + 16), r2hi);
+		}
+#else
+		// interleaving store: lane 0 = Y0 Y2 .., lane 1 = U .., lane 2 = Y1 Y3 .., lane 3 = V ..
+		uint8x8x2_t y1 = vld2_u8(src.Y1 + uX);
+		uint8x8x2_t y2 = vld2_u8(src.Y2 + uX);
+		uint8x8_t u = vld1_u8(src.U + uPair);
+		uint8x8_t v = vld1_u8(src.V + uPair);
+		uint8x8x4_t r1, r2;
+		r1.val[0] = y1.val[0];
+		r1.val[1] = u;
+		r1.val[2] = y1.val[1];
+		r1.val[3] = v;
+		r2.val[0] = y2.val[0];
+		r2.val[1] = u;
+		r2.val[2] = y2.val[1];
+		r2.val[3] = v;
+
+		if (uOpaque)
+		{
+			uint8_t row1[32], row2[32];
+			vst4_u8(row1, r1);
+			vst4_u8(row2, r2);
+			for (unsigned int i = 0; i < 8; i++)
+			{
+				if (uOpaque & (1 << i))
+				{
+					yuy2_overlay_pair(row1 + (i << 2), &src.pPalette[src.pOverlay[uPair + i]]);
+					memcpy(row2 + (i << 2), row1 + (i << 2), 4);
+				}
+			}
+			r1 = vld4_u8(row1);
+			r2 = vld4_u8(row2);
+		}
+
+		if (bBlend)
+		{
+			// vhadd rounds down, same as the old blending
+			for (unsigned int i = 0; i < 4; i++)
+			{
+				r1.val[i] = vhadd_u8(r1.val[i], r2.val[i]);
+			}
+			r2 = r1;
+		}
+
+		if (bScanlines)
+		{
+			uint8x8x4_t black;
+			black.val[0] = black.val[2] = vdup_n_u8(0x00);
+			black.val[1] = black.val[3] = vdup_n_u8(0x7f);
+			vst4_u8(pRow1 + (uPair << 2), black);
+			vst4_u8(pRow2 + (uPair << 2), r1);
+		}
+		else
+		{
+			vst4_u8(pRow1 + (uPair << 2), r1);
+			vst4_u8(pRow2 + (uPair << 2), r2);
+		}
+#endif
+	}
+#endif
+
+	for (; uPair < uPairs; uPair++)
+	{
+		yuy2_write_pair(pRow1 + (uPair << 2), pRow2 + (uPair << 2), src, uPair, bBlend, bScanlines);
 	}
 }
@@ -27,23 +27,30 @@
 #define BLEND_H
 
 #include <stdint.h>
-
-// TO USE THE BLEND FUNCTIONS:
-// 1 - set g_blend_line1 to the first line of bytes to be averaged
-// 2 - set g_blend_line2 to the second line of bytes to be averaged
-// 3 - set g_blend_dest to the line of bytes that will be the destination
-// 4 - set g_blend_iterations to how many bytes long all lines are (they all must be the same length).
-//	IMPORTANT : g_blend_iterations must be a multiple of 8, and must be >= 8!
-// 5 - run g_blend_func() and you're done!
-
-// we always want this function defined for the purpose of testing (releasetest.cpp)
-void blend_c();
-
-extern uint8_t *g_blend_line1;
-extern uint8_t *g_blend_line2;
-extern uint8_t *g_blend_dest;
-extern uint32_t g_blend_iterations;
-#define g_blend_func blend_c
+#include "palette.h"
+
+// Builds the YUY2 laserdisc picture for ldp-vldp, one pair of rows at a time.
+// A YV12 picture has one row of U/V for every two rows of Y, so each pair of output rows shares
+//  its chroma.  The field filter is applied as the rows are built, and both rows are written
+//  straight to the destination (no intermediate line buffers):
+//  - no filter : row 1 and row 2 as they are
+//  - bBlend : both rows become the average of the two fields (cheap de-interlace)
+//  - bScanlines : the top row is black and the bottom row is row 1 (or the average, if bBlend is also set)
+
+struct yuy2_row_src
+{
+	const uint8_t *Y1;	// first row of luma (uWidth bytes)
+	const uint8_t *Y2;	// second row of luma (uWidth bytes)
+	const uint8_t *U;	// shared row of chroma (uWidth / 2 bytes)
+	const uint8_t *V;
+	const uint8_t *pOverlay;	// one 8-bit game overlay pixel for every 2 mpeg pixels, or NULL if there is no overlay on these rows
+	const t_yuv_color *pPalette;	// palette for pOverlay (ignored when pOverlay is NULL)
+};
+
+// writes rows 'pDst' and 'pDst + uPitch', 'uWidth' pixels each (uWidth must be even)
+// Overlay pixels that aren't transparent replace the mpeg pixels underneath them.
+void yuy2_write_rows(uint8_t *pDst, unsigned int uPitch, const yuy2_row_src &src, unsigned int uWidth,
+					 bool bBlend, bool bScanlines);
 
 /////////////////////////////
 
@@ -158,6 +158,9 @@ void palette_finalize()
 			// SDL_SetColors(g_game->get_scaled_video_overlay(), g_rgb_palette, 0, g_palette_size);
 			SDL_SetPaletteColors(g_game->get_scaled_video_overlay()->format->palette, g_rgb_palette, 0, g_palette_size);
 		}
+	
+		// the overlay's pixels haven't changed but what they look like has
+		g_game->video_overlay_palette_changed();
 	}
 
 	g_palette_modified = false;
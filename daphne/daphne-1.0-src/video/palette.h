@@ -20,7 +20,11 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#ifndef PALETTE_H
+#define PALETTE_H
+
 #include <stdint.h>
+#include <SDL.h>	// for SDL_Color
 
 typedef struct
 {
@@ -47,3 +51,5 @@ void palette_finalize ();
 void palette_shutdown (void);
 t_yuv_color *get_yuv_palette(void);
 uint32_t *get_rgba_palette(void);
+
+#endif
@@ -0,0 +1,303 @@
+/*
+ * present.cpp
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// present.cpp
+// Converts the game's 8bpp overlay into RGB frames for the frontend (see present.h)
+
+#include <string.h>
+#include "present.h"
+#include "palette.h"
+#include "../io/mpo_mem.h"
+
+#define PRESENT_BUFFER_COUNT 3	// one being shown by the frontend, one ready to be shown, one being built
+
+// The lookup tables hold each color already repeated across a 32-bit (or 64-bit) word, so that doubling a pixel
+//  horizontally (the usual case) is a single load and a single store.  This is faster than a vector gather
+//  for a table this small, and works on every CPU.
+static uint16_t g_lut16[256];	// RGB565
+static uint32_t g_lut16x2[256];	// RGB565, two pixels
+static uint32_t g_lut32[256];	// XRGB8888
+static uint64_t g_lut32x2[256];	// XRGB8888, two pixels
+
+static PRESENT_FORMAT g_present_format = PRESENT_RGB565;
+static bool g_bLutDirty = true;	// the palette has changed since the tables were built
+
+struct present_buffer
+{
+	uint8_t *pPixels;
+	unsigned int uWidth;
+	unsigned int uHeight;
+	unsigned int uPitch;	// in bytes
+};
+
+static present_buffer g_buffers[PRESENT_BUFFER_COUNT];
+static int g_iReady = -1;	// buffer waiting to be picked up by present_get_frame (-1 if none)
+static int g_iShowing = -1;	// buffer that present_get_frame last handed out (-1 if none)
+static SDL_mutex *g_present_mutex = NULL;
+
+static void present_build_lut()
+{
+	const uint32_t *pRGBA = get_rgba_palette();
+
+	for (unsigned int i = 0; i < 256; i++)
+	{
+		uint32_t uRGBA = pRGBA[i];
+		uint32_t r = uRGBA & 0xFF, g = (uRGBA >> 8) & 0xFF, b = (uRGBA >> 16) & 0xFF;
+
+		// there is no video behind the overlay, so transparent colors are black
+		if ((uRGBA & 0xFF000000) == 0)
+		{
+			r = g = b = 0;
+		}
+
+		g_lut16[i] = (uint16_t) (((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+		g_lut16x2[i] = g_lut16[i] | ((uint32_t) g_lut16[i] << 16);
+		g_lut32[i] = (r << 16) | (g << 8) | b;
+		g_lut32x2[i] = g_lut32[i] | ((uint64_t) g_lut32[i] << 32);
+	}
+
+	g_bLutDirty = false;
+}
+
+// converts one row of 'uWidth' 8bpp pixels, repeating each one uScale times
+static void present_row16(const uint8_t *pSrc, unsigned int uWidth, unsigned int uScale, uint16_t *pDst)
+{
+	unsigned int x = 0;
+
+	if (uScale == 2)
+	{
+		uint32_t *pDst32 = (uint32_t *) pDst;
+
+		// 4 pixels at a time
+		for (; x + 4 <= uWidth; x += 4)
+		{
+			pDst32[x + 0] = g_lut16x2[pSrc[x + 0]];
+			pDst32[x + 1] = g_lut16x2[pSrc[x + 1]];
+			pDst32[x + 2] = g_lut16x2[pSrc[x + 2]];
+			pDst32[x + 3] = g_lut16x2[pSrc[x + 3]];
+		}
+		for (; x < uWidth; x++)
+		{
+			pDst32[x] = g_lut16x2[pSrc[x]];
+		}
+	}
+	else if (uScale == 1)
+	{
+		for (; x < uWidth; x++)
+		{
+			pDst[x] = g_lut16[pSrc[x]];
+		}
+	}
+	else
+	{
+		for (; x < uWidth; x++)
+		{
+			uint16_t u16Color = g_lut16[pSrc[x]];
+			for (unsigned int i = 0; i < uScale; i++)
+			{
+				*pDst++ = u16Color;
+			}
+		}
+	}
+}
+
+static void present_row32(const uint8_t *pSrc, unsigned int uWidth, unsigned int uScale, uint32_t *pDst)
+{
+	unsigned int x = 0;
+
+	if (uScale == 2)
+	{
+		uint64_t *pDst64 = (uint64_t *) pDst;
+
+		for (; x + 4 <= uWidth; x += 4)
+		{
+			pDst64[x + 0] = g_lut32x2[pSrc[x + 0]];
+			pDst64[x + 1] = g_lut32x2[pSrc[x + 1]];
+			pDst64[x + 2] = g_lut32x2[pSrc[x + 2]];
+			pDst64[x + 3] = g_lut32x2[pSrc[x + 3]];
+		}
+		for (; x < uWidth; x++)
+		{
+			pDst64[x] = g_lut32x2[pSrc[x]];
+		}
+	}
+	else if (uScale == 1)
+	{
+		for (; x < uWidth; x++)
+		{
+			pDst[x] = g_lut32[pSrc[x]];
+		}
+	}
+	else
+	{
+		for (; x < uWidth; x++)
+		{
+			uint32_t u32Color = g_lut32[pSrc[x]];
+			for (unsigned int i = 0; i < uScale; i++)
+			{
+				*pDst++ = u32Color;
+			}
+		}
+	}
+}
+
+bool present_init()
+{
+	bool result = true;
+
+	if (!g_present_mutex)
+	{
+		for (int i = 0; i < PRESENT_BUFFER_COUNT; i++)
+		{
+			g_buffers[i].pPixels = (uint8_t *) MPO_MALLOC(PRESENT_MAX_W * PRESENT_MAX_H * 4);
+			result = result && (g_buffers[i].pPixels != NULL);
+		}
+		g_present_mutex = SDL_CreateMutex();
+
+		// without all of our buffers (or the mutex), present_overlay must do nothing
+		if (!result || !g_present_mutex)
+		{
+			present_shutdown();
+			result = false;
+		}
+	}
+
+	return result;
+}
+
+void present_set_format(PRESENT_FORMAT format)
+{
+	g_present_format = format;
+}
+
+void present_palette_changed()
+{
+	g_bLutDirty = true;
+}
+
+void present_overlay(SDL_Surface *overlay)
+{
+	if ((overlay == NULL) || (overlay->format->BytesPerPixel != 1) || (g_present_mutex == NULL))
+	{
+		return;
+	}
+
+	if (g_bLutDirty)
+	{
+		present_build_lut();
+	}
+
+	// the biggest whole number scale that fits (overlays bigger than the frame get cropped)
+	unsigned int uSrcW = overlay->w, uSrcH = overlay->h;
+	unsigned int uScale = PRESENT_MAX_W / uSrcW;
+	if (PRESENT_MAX_H / uSrcH < uScale) uScale = PRESENT_MAX_H / uSrcH;
+	if (uScale < 1) uScale = 1;
+	if (uSrcW * uScale > PRESENT_MAX_W) uSrcW = PRESENT_MAX_W;
+	if (uSrcH * uScale > PRESENT_MAX_H) uSrcH = PRESENT_MAX_H;
+
+	unsigned int uBytesPerPixel = (g_present_format == PRESENT_RGB565) ? 2 : 4;
+
+	// pick a buffer that isn't being shown and isn't waiting to be shown
+	SDL_LockMutex(g_present_mutex);
+	int iBuild = 0;
+	while ((iBuild == g_iReady) || (iBuild == g_iShowing))
+	{
+		iBuild++;
+	}
+	SDL_UnlockMutex(g_present_mutex);
+
+	present_buffer *pBuf = &g_buffers[iBuild];
+	pBuf->uWidth = uSrcW * uScale;
+	pBuf->uHeight = uSrcH * uScale;
+	pBuf->uPitch = pBuf->uWidth * uBytesPerPixel;
+
+	const uint8_t *pSrc = (const uint8_t *) overlay->pixels;
+	uint8_t *pDst = pBuf->pPixels;
+
+	for (unsigned int y = 0; y < uSrcH; y++)
+	{
+		if (g_present_format == PRESENT_RGB565)
+		{
+			present_row16(pSrc, uSrcW, uScale, (uint16_t *) pDst);
+		}
+		else
+		{
+			present_row32(pSrc, uSrcW, uScale, (uint32_t *) pDst);
+		}
+
+		// repeat the row for vertical scaling
+		for (unsigned int i = 1; i < uScale; i++)
+		{
+			memcpy(pDst + (i * pBuf->uPitch), pDst, pBuf->uPitch);
+		}
+
+		pSrc += overlay->pitch;
+		pDst += pBuf->uPitch * uScale;
+	}
+
+	SDL_LockMutex(g_present_mutex);
+	g_iReady = iBuild;
+	SDL_UnlockMutex(g_present_mutex);
+}
+
+const void *present_get_frame(unsigned int *puWidth, unsigned int *puHeight, unsigned int *puPitch)
+{
+	const void *pResult = NULL;
+
+	if (!g_present_mutex)
+	{
+		return NULL;
+	}
+
+	SDL_LockMutex(g_present_mutex);
+	if (g_iReady != -1)
+	{
+		g_iShowing = g_iReady;
+		g_iReady = -1;
+
+		present_buffer *pBuf = &g_buffers[g_iShowing];
+		*puWidth = pBuf->uWidth;
+		*puHeight = pBuf->uHeight;
+		*puPitch = pBuf->uPitch;
+		pResult = pBuf->pPixels;
+	}
+	SDL_UnlockMutex(g_present_mutex);
+
+	return pResult;
+}
+
+void present_shutdown()
+{
+	for (int i = 0; i < PRESENT_BUFFER_COUNT; i++)
+	{
+		MPO_FREE(g_buffers[i].pPixels);
+		g_buffers[i].uWidth = g_buffers[i].uHeight = g_buffers[i].uPitch = 0;
+	}
+	g_iReady = g_iShowing = -1;
+	g_bLutDirty = true;
+
+	if (g_present_mutex)
+	{
+		SDL_DestroyMutex(g_present_mutex);
+		g_present_mutex = NULL;
+	}
+}
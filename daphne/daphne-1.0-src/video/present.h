@@ -0,0 +1,66 @@
+/*
+ * present.h
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// present.h
+
+// When there is no mpeg video to composite it onto (noldp/fast_noldp, or games that only have an overlay),
+//  the game's finished 8bpp overlay is turned straight into a frame for the frontend here, through a
+//  256-entry palette lookup table, instead of going through the generic SDL blitters.
+// The overlay is upscaled by the largest whole number that still fits in PRESENT_MAX_W x PRESENT_MAX_H.
+
+#ifndef PRESENT_H
+#define PRESENT_H
+
+#include <stdint.h>
+#include <SDL.h>
+
+// biggest frame we will hand to the frontend (matches the mpeg frames from VLDP)
+#define PRESENT_MAX_W 640
+#define PRESENT_MAX_H 480
+
+typedef enum
+{
+	PRESENT_RGB565,		// 16 bits per pixel
+	PRESENT_XRGB8888	// 32 bits per pixel
+} PRESENT_FORMAT;
+
+// must be called before the game thread starts presenting (and before the frontend asks for frames)
+// returns false if the frame buffers couldn't be allocated
+bool present_init();
+
+// chooses which pixel format frames are built in (RGB565 is the default)
+void present_set_format(PRESENT_FORMAT format);
+
+// called when the palette changes, so the lookup table gets rebuilt before the next frame
+void present_palette_changed();
+
+// converts an 8bpp overlay into the next frame for the frontend (called from the game thread)
+void present_overlay(SDL_Surface *overlay);
+
+// returns the newest frame if one has been presented since the last call, or NULL if not.
+// The frame stays valid until the next call.
+const void *present_get_frame(unsigned int *puWidth, unsigned int *puHeight, unsigned int *puPitch);
+
+// frees the frame buffers
+void present_shutdown();
+
+#endif // PRESENT_H
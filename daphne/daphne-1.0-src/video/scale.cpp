@@ -0,0 +1,214 @@
+/*
+ * scale.cpp
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// scale.cpp
+// Scales 8bpp overlays (see scale.h)
+
+#include <string.h>
+#include "scale.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define SCALE_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SCALE_NEON
+#include <arm_neon.h>
+#endif
+
+// the most distinct colors we keep count of in one cell when shrinking (any more are ignored)
+#define SCALE_MAX_CELL_COLORS 16
+
+scaler::scaler() :
+	m_uSrcW(0), m_uSrcH(0), m_uDstW(0), m_uDstH(0),
+	m_uIntScale(0),
+	m_bShrinking(false)
+{
+}
+
+void scaler::make_spans(std::vector<span> &vSpans, unsigned int uSrc, unsigned int uDst)
+{
+	vSpans.resize(uDst);
+
+	for (unsigned int d = 0; d < uDst; d++)
+	{
+		// integer math so that there is no drift across the line
+		unsigned int uStart = (d * uSrc) / uDst;
+		unsigned int uEnd = ((d + 1) * uSrc) / uDst;
+
+		// when enlarging, several destination pixels share one source pixel
+		if (uEnd <= uStart)
+		{
+			uEnd = uStart + 1;
+		}
+
+		vSpans[d].uStart = (uint16_t) uStart;
+		vSpans[d].uEnd = (uint16_t) uEnd;
+	}
+}
+
+void scaler::init(unsigned int uSrcW, unsigned int uSrcH, unsigned int uDstW, unsigned int uDstH)
+{
+	m_uSrcW = uSrcW;
+	m_uSrcH = uSrcH;
+	m_uDstW = uDstW;
+	m_uDstH = uDstH;
+
+	m_uIntScale = 0;
+	for (unsigned int u = 1; u <= 3; u++)
+	{
+		if ((uDstW == uSrcW * u) && (uDstH == uSrcH * u))
+		{
+			m_uIntScale = u;
+		}
+	}
+
+	m_bShrinking = (uDstW < uSrcW) || (uDstH < uSrcH);
+	make_spans(m_vColumns, uSrcW, uDstW);
+	make_spans(m_vRows, uSrcH, uDstH);
+}
+
+// enlarges (or copies) one row using the column table
+void scaler::scale_row_nearest(const uint8_t *pSrc, uint8_t *pDst)
+{
+	unsigned int x = 0;
+
+	switch (m_uIntScale)
+	{
+	case 1:
+		memcpy(pDst, pSrc, m_uDstW);
+		break;
+	case 2:
+#if defined(SCALE_SSE2)
+		// interleaving a vector with itself doubles every byte
+		for (; (x + 16) <= m_uSrcW; x += 16)
+		{
+			__m128i v = _mm_loadu_si128((const __m128i *) (pSrc + x));
+			_mm_storeu_si128((__m128i *) (pDst + (x << 1)), _mm_unpacklo_epi8(v, v));
+			_mm_storeu_si128((__m128i *) (pDst + (x << 1) + 16), _mm_unpackhi_epi8(v, v));
+		}
+#elif defined(SCALE_NEON)
+		for (; (x + 16) <= m_uSrcW; x += 16)
+		{
+			uint8x16_t v = vld1q_u8(pSrc + x);
+			uint8x16x2_t vv = { { v, v } };
+			vst2q_u8(pDst + (x << 1), vv);
+		}
+#endif
+		for (; x < m_uSrcW; x++)
+		{
+			pDst[(x << 1)] = pDst[(x << 1) + 1] = pSrc[x];
+		}
+		break;
+	case 3:
+		for (; x < m_uSrcW; x++)
+		{
+			pDst[0] = pDst[1] = pDst[2] = pSrc[x];
+			pDst += 3;
+		}
+		break;
+	default:
+		{
+			const span *pColumns = &m_vColumns[0];
+			for (; x < m_uDstW; x++)
+			{
+				pDst[x] = pSrc[pColumns[x].uStart];
+			}
+		}
+		break;
+	}
+}
+
+// shrinks one row, picking the most common color in each cell
+void scaler::scale_cell_area(const SDL_Surface *src, const span &row, uint8_t *pDst)
+{
+	for (unsigned int x = 0; x < m_uDstW; x++)
+	{
+		const span &col = m_vColumns[x];
+		uint8_t u8Colors[SCALE_MAX_CELL_COLORS];
+		unsigned int uCounts[SCALE_MAX_CELL_COLORS];
+		unsigned int uColors = 0, uBest = 0;
+
+		for (unsigned int y = row.uStart; y < row.uEnd; y++)
+		{
+			const uint8_t *pSrc = (const uint8_t *) src->pixels + (y * src->pitch);
+
+			for (unsigned int sx = col.uStart; sx < col.uEnd; sx++)
+			{
+				uint8_t u8Color = pSrc[sx];
+				unsigned int i = 0;
+
+				while ((i < uColors) && (u8Colors[i] != u8Color))
+				{
+					i++;
+				}
+
+				if (i == uColors)
+				{
+					if (uColors == SCALE_MAX_CELL_COLORS)
+					{
+						continue;
+					}
+					u8Colors[i] = u8Color;
+					uCounts[i] = 0;
+					uColors++;
+				}
+
+				// ties go to whichever color was seen first (the top left one)
+				if (++uCounts[i] > uCounts[uBest])
+				{
+					uBest = i;
+				}
+			}
+		}
+
+		pDst[x] = u8Colors[uBest];
+	}
+}
+
+void scaler::scale(const SDL_Surface *src, SDL_Surface *dst)
+{
+	uint8_t *pDst = (uint8_t *) dst->pixels;
+	int iLastSrcRow = -1;	// the source row that the previous destination row came from
+	uint8_t *pLastDst = NULL;
+
+	for (unsigned int y = 0; y < m_uDstH; y++, pDst += dst->pitch)
+	{
+		const span &row = m_vRows[y];
+
+		if (m_bShrinking)
+		{
+			scale_cell_area(src, row, pDst);
+		}
+
+		// when enlarging, rows that come from the same source row are identical, so just copy the previous one
+		else if ((int) row.uStart == iLastSrcRow)
+		{
+			memcpy(pDst, pLastDst, m_uDstW);
+		}
+		else
+		{
+			scale_row_nearest((const uint8_t *) src->pixels + (row.uStart * src->pitch), pDst);
+			iLastSrcRow = row.uStart;
+			pLastDst = pDst;
+		}
+	}
+}
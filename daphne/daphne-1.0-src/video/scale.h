@@ -0,0 +1,69 @@
+/*
+ * scale.h
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// scale.h
+
+// Scales an 8bpp overlay to a different size (used by -fullscale to stretch the game's graphics to the screen).
+// The source position of every destination column and row is worked out once, in init(), and kept in two small
+//  tables (instead of one table entry per destination pixel).
+// Exact 2x and 3x enlargements have their own fast paths.  When shrinking, each destination pixel takes the
+//  most common color of the source pixels it covers (the palette equivalent of averaging them).
+
+#ifndef SCALE_H
+#define SCALE_H
+
+#include <stdint.h>
+#include <vector>
+#include <SDL.h>
+
+class scaler
+{
+public:
+	scaler();
+
+	// prepares to scale uSrcW x uSrcH surfaces to uDstW x uDstH
+	void init(unsigned int uSrcW, unsigned int uSrcH, unsigned int uDstW, unsigned int uDstH);
+
+	// scales 'src' into 'dst' (both 8bpp, and the sizes given to init)
+	void scale(const SDL_Surface *src, SDL_Surface *dst);
+
+private:
+	// for each destination column (or row), the range of source columns (or rows) it covers, [start, end)
+	struct span
+	{
+		uint16_t uStart;
+		uint16_t uEnd;
+	};
+
+	static void make_spans(std::vector<span> &vSpans, unsigned int uSrc, unsigned int uDst);
+
+	void scale_row_nearest(const uint8_t *pSrc, uint8_t *pDst);
+	void scale_cell_area(const SDL_Surface *src, const span &row, uint8_t *pDst);
+
+	unsigned int m_uSrcW, m_uSrcH, m_uDstW, m_uDstH;
+	unsigned int m_uIntScale;	// 1, 2 or 3 if the destination is exactly that many times the source (0 otherwise)
+	bool m_bShrinking;	// whether either direction gets smaller (so some destination pixels cover several source pixels)
+	std::vector<span> m_vColumns;
+	std::vector<span> m_vRows;
+};
+
+#endif // SCALE_H
@@ -36,7 +36,35 @@
 #include <stdio.h>
 #include <string.h>
 
-static unsigned char g_vidbuf[TMS9128NL_OVERLAY_W * TMS9128NL_OVERLAY_H];	// video buffer needed because we clobber the SDL_Surface buffer when we do real-time scaling
+#define CHAR_WIDTH 8
+#define CHAR_HEIGHT 8
+
+#define TMS_CELL_COLS (TMS9128NL_OVERLAY_W / CHAR_WIDTH)	/* 8x8 cells across the overlay */
+#define TMS_CELL_ROWS (TMS9128NL_OVERLAY_H / CHAR_HEIGHT)	/* 8x8 cells down the overlay */
+#define TMS_HALF_COLS (TMS_CELL_COLS << 1)	/* transparency is tracked for each 4x8 half cell, because mode 2 draws 4 pixels off of the cell grid */
+
+// how many video overlays we can keep separate dirty cells for (the game double buffers)
+#define TMS_MAX_OVERLAYS 4
+
+// Characters are drawn into g_vidbuf as foreground (TMS_FG_COLOR) and background (0) only.
+// Whether the background of a spot is transparent is an attribute of its half cell, so that flipping
+//  transparency on and off doesn't have to touch any pixels.  The overlay is built from the two when it is repainted.
+static unsigned char g_vidbuf[TMS9128NL_OVERLAY_W * TMS9128NL_OVERLAY_H];
+static bool g_cell_transparent[TMS_CELL_ROWS][TMS_HALF_COLS];	// whether each half cell's background is TMS_TRANSPARENT_COLOR
+
+// the 8 pixels (TMS_FG_COLOR or 0) of each possible line of a character, leftmost pixel first
+static uint8_t g_char_line[256][CHAR_WIDTH];
+
+// the cells that have changed since each video overlay was last repainted (bit N of a row is column N)
+struct tms_overlay_cells
+{
+	SDL_Surface *surface;	// which overlay these belong to (NULL if the slot is free)
+	bool stretched;	// whether the overlay was last drawn stretched (mode 2)
+	uint64_t dirty[TMS_CELL_ROWS];
+};
+static tms_overlay_cells g_overlay_cells[TMS_MAX_OVERLAYS];
+static unsigned int g_next_overlay_cells = 0;	// which slot to give to the next overlay we haven't seen before
+static unsigned int g_palette_key = 0;	// tms9128nl_palette_key() as of the last palette update
 static unsigned char vidmem[32767] = { 0 };	// video memory
 static unsigned char lowbyte = 0;
 static unsigned char highbyte = 0;
@@ -65,6 +93,92 @@ int g_transparency_latch = 0;
 int introHack = 0;
 int prevg_vidmode = 0;
 void tms9128nl_clear_overlay();
+static void tms9128nl_stretch_line(uint8_t *ptr320, const uint8_t *ptr256);
+
+// marks every cell of every video overlay as needing to be redrawn
+static void tms9128nl_mark_all_dirty()
+{
+	for (unsigned int i = 0; i < TMS_MAX_OVERLAYS; i++)
+	{
+		memset(g_overlay_cells[i].dirty, 0xFF, sizeof(g_overlay_cells[i].dirty));
+	}
+}
+
+// marks the cells touched by the 'w' pixels starting at 'x' (which may be off of the cell grid) on cell row 'cell_row'
+static void tms9128nl_mark_dirty(int x, int w, unsigned int cell_row)
+{
+	unsigned int first = x / CHAR_WIDTH;
+	unsigned int last = (x + w - 1) / CHAR_WIDTH;
+	uint64_t bits = 0;
+
+	if ((cell_row >= TMS_CELL_ROWS) || (first >= TMS_CELL_COLS))
+	{
+		return;
+	}
+	if (last >= TMS_CELL_COLS)
+	{
+		last = TMS_CELL_COLS - 1;
+	}
+	for (unsigned int col = first; col <= last; col++)
+	{
+		bits |= ((uint64_t) 1) << col;
+	}
+	for (unsigned int i = 0; i < TMS_MAX_OVERLAYS; i++)
+	{
+		g_overlay_cells[i].dirty[cell_row] |= bits;
+	}
+}
+
+// sets the transparency of the half cells behind the 8 pixels starting at 'x' on cell row 'cell_row'
+static void tms9128nl_set_cell_transparency(int x, unsigned int cell_row, bool transparent)
+{
+	unsigned int half = x >> 2;
+
+	if (cell_row >= TMS_CELL_ROWS)
+	{
+		return;
+	}
+	for (unsigned int i = half; (i < half + 2) && (i < TMS_HALF_COLS); i++)
+	{
+		if (g_cell_transparent[cell_row][i] != transparent)
+		{
+			g_cell_transparent[cell_row][i] = transparent;
+			tms9128nl_mark_dirty(i << 2, 4, cell_row);
+		}
+	}
+}
+
+// sets the transparency of the whole viewable area (the borders are never transparent)
+static void tms9128nl_set_all_transparency(bool transparent)
+{
+	for (unsigned int row = 0; row < TMS_CELL_ROWS; row++)
+	{
+		bool viewable = (row >= (TMS_VERTICAL_OFFSET / CHAR_HEIGHT)) && (row < ((TMS9128NL_OVERLAY_H - TMS_VERTICAL_OFFSET) / CHAR_HEIGHT));
+		for (unsigned int half = 0; half < TMS_HALF_COLS; half++)
+		{
+			g_cell_transparent[row][half] = transparent && viewable;
+		}
+	}
+	tms9128nl_mark_all_dirty();
+}
+
+// everything that tms9128nl_palette_update's result depends on, rolled into one number
+static unsigned int tms9128nl_palette_key()
+{
+	return g_tms_foreground_color | (g_tms_background_color << 4) | ((g_vidmode == 2) << 8) | ((g_transparency_latch != 0) << 9);
+}
+
+// changes the foreground/background colors, only recalculating the palette if it would actually change (this isn't cheap,
+//  and mode 2 sets the colors for every character it draws)
+static void tms9128nl_set_colors(unsigned char foreground, unsigned char background)
+{
+	g_tms_foreground_color = foreground;
+	g_tms_background_color = background;
+	if (tms9128nl_palette_key() != g_palette_key)
+	{
+		tms9128nl_palette_update();
+	}
+}
 ////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////
 
@@ -93,6 +207,18 @@ void tms9128nl_reset()
 	g_transparency_latch = 0;
 	introHack = 0;
 	prevg_vidmode = 0;
+
+	for (unsigned int value = 0; value < 256; value++)
+	{
+		for (unsigned int bit = 0; bit < CHAR_WIDTH; bit++)
+		{
+			g_char_line[value][bit] = (value & (0x80 >> bit)) ? TMS_FG_COLOR : 0;
+		}
+	}
+
+	// forget the overlays, they may have been re-created
+	memset(g_overlay_cells, 0, sizeof(g_overlay_cells));
+	g_next_overlay_cells = 0;
 }
 
 bool tms9128nl_int_enabled()
@@ -469,19 +595,16 @@ void tms9128nl_convert_color(unsigned char color_src, SDL_Color *color)
 	}
 }
 
-#define CHAR_WIDTH 8
-#define CHAR_HEIGHT 8
-
 // draws a character to the Cliff video display
 // 40 columns by 24 rows
 // uses Cliffy's video memory to retrieve 8x8 character bitmap
 void tms9128nl_drawchar(unsigned char ch, int col, int row)
 {
 	int bmp_index = (ch * 8) + (g_tms_pgt_addr << 11); // index in vid mem where bmp data is located
-	int i = 0, j = 0;	// temp indices
+	int i = 0;	// temp index
 	int x = col * CHAR_WIDTH;
 	int y = row * CHAR_HEIGHT;
-	unsigned char line = 0;
+	unsigned int cell_row = (y + TMS_VERTICAL_OFFSET) / CHAR_HEIGHT;
 	unsigned char background_color = TMS_BG_COLOR;
 
 	// if character is 0 and we're in transparency mode, make bitmap transparent	
@@ -521,9 +644,7 @@ void tms9128nl_drawchar(unsigned char ch, int col, int row)
 			// correct values in here.  Someone should fix this sometime :)
 			if (row <= 11)
 			{
-				g_tms_foreground_color = 0x5;	// Light Blue 
-				g_tms_background_color = 0x1; // Black
-				tms9128nl_palette_update();
+				tms9128nl_set_colors(0x5, 0x1);	// Light Blue on Black
 				bmp_index = (ch * 8) + 8*256 * (row > 7);
 			}
 			else
@@ -537,9 +658,7 @@ void tms9128nl_drawchar(unsigned char ch, int col, int row)
 		else
 		{
 			x += 4;
-			g_tms_foreground_color = 0x0;           // Black
-			g_tms_background_color = 0x5;           // Light Blue
-			tms9128nl_palette_update();
+			tms9128nl_set_colors(0x0, 0x5);	// Black on Light Blue
 			
 			if(col != 0)
 			{
@@ -555,47 +674,27 @@ void tms9128nl_drawchar(unsigned char ch, int col, int row)
 		}
 	}
 
-	// draw each line of character into new surface
+	// draw each line of character into the video buffer
 	for (i = 0; i < CHAR_HEIGHT; i++)
 	{
-		line = vidmem[bmp_index + i];	// get a line
-
-		// handle each pixel across
-		for (j = CHAR_WIDTH - 1; j >= 0; j--)
-		{
-			// if rightmost bit is 1, it means draw the pixel
-			if (line & 1)
-			{
-				*((uint8_t *) g_vidbuf + ((y+i+TMS_VERTICAL_OFFSET) * TMS9128NL_OVERLAY_W) + (x+j)) = TMS_FG_COLOR;
-			}
-			// else draw the background
-			else
-			{
-				*((uint8_t *) g_vidbuf + ((y+i+TMS_VERTICAL_OFFSET) * TMS9128NL_OVERLAY_W) + (x+j)) = background_color;
-			}
-			line = (unsigned char) (line >> 1);
-		}
-	} // end for loop
+		memcpy(g_vidbuf + ((y+i+TMS_VERTICAL_OFFSET) * TMS9128NL_OVERLAY_W) + x, g_char_line[vidmem[bmp_index + i]], CHAR_WIDTH);
+	}
+	tms9128nl_mark_dirty(x, CHAR_WIDTH, cell_row);
+	tms9128nl_set_cell_transparency(x, cell_row, (background_color == TMS_TRANSPARENT_COLOR));
 
 	// In transparency mode, if we draw a solid character, we need to make the character after it non-transparent
 	// This seems to be how Cliff Hanger behaves.  I haven't found it documented anywhere though.
 	if ((g_transparency_latch) && (ch != 0) && (ch != 0xFF))
 	{
-			int row, col;
-			uint8_t *ptr = ((uint8_t *) g_vidbuf) + ((y + TMS_VERTICAL_OFFSET) * TMS9128NL_OVERLAY_W) + x + CHAR_WIDTH;
-			for (row = 0; row < CHAR_HEIGHT; row++)
-			{
-				for (col = 0; col < CHAR_WIDTH; col++)
-				{
-					// make it non-transparent if it is
-					if (*ptr == TMS_TRANSPARENT_COLOR)
-					{
-						*ptr = TMS_BG_COLOR;
-					}
-					ptr++;
-				}
-				ptr += (TMS9128NL_OVERLAY_W - CHAR_WIDTH);	// move to the next line
-			}
+		// (after the last column, that's the first character of the next row)
+		if (x + CHAR_WIDTH < TMS9128NL_OVERLAY_W)
+		{
+			tms9128nl_set_cell_transparency(x + CHAR_WIDTH, cell_row, false);
+		}
+		else
+		{
+			tms9128nl_set_cell_transparency(0, cell_row + 1, false);
+		}
 	}
 
 	g_game->set_video_overlay_needs_update(true);
@@ -631,6 +730,7 @@ void tms9128nl_palette_update()
 
 	palette_set_color(0, back);
 	palette_set_color(255, fore);
+	g_palette_key = tms9128nl_palette_key();
 
 	// if we should do extra calculations for stretching
 	if (g_vidmode == 2)
@@ -662,37 +762,57 @@ void tms9128nl_palette_calculate()
 	tms9128nl_reset();
 }
 
+// builds line 'y' of the overlay (before any stretching) from the video buffer and the transparency of its cells
+static void tms9128nl_build_line(uint8_t *dst, unsigned int y)
+{
+	const uint8_t *src = g_vidbuf + (y * TMS9128NL_OVERLAY_W);
+	const bool *transparent = g_cell_transparent[y / CHAR_HEIGHT];
+
+	for (unsigned int half = 0; half < TMS_HALF_COLS; half++)
+	{
+		// foreground pixels are TMS_FG_COLOR (all bits set) and background pixels are 0, so OR'ing in the
+		//  transparent color only changes the background
+		uint8_t background = transparent[half] ? TMS_TRANSPARENT_COLOR : 0;
+		for (unsigned int i = 0; i < 4; i++)
+		{
+			dst[i] = (uint8_t) (src[i] | background);
+		}
+		dst += 4;
+		src += 4;
+	}
+}
+
+// finds the dirty cells that belong to 'overlay', starting it out with every cell dirty if we haven't drawn to it before
+static tms_overlay_cells *tms9128nl_get_overlay_cells(SDL_Surface *overlay)
+{
+	tms_overlay_cells *cells = NULL;
+
+	for (unsigned int i = 0; i < TMS_MAX_OVERLAYS; i++)
+	{
+		if (g_overlay_cells[i].surface == overlay)
+		{
+			return &g_overlay_cells[i];
+		}
+	}
+
+	cells = &g_overlay_cells[g_next_overlay_cells];
+	g_next_overlay_cells = (g_next_overlay_cells + 1) % TMS_MAX_OVERLAYS;
+	cells->surface = overlay;
+	cells->stretched = false;
+	memset(cells->dirty, 0xFF, sizeof(cells->dirty));
+	return cells;
+}
+
 void tms9128nl_video_repaint()
 {
 	// if the transparency state has changed
 	if (g_transparency_enabled != g_transparency_latch)
 	{
-	int i = 0; 	 
-
-		uint8_t *ptr = (uint8_t *) g_vidbuf + (TMS9128NL_OVERLAY_W * TMS_VERTICAL_OFFSET);
-
 		// I don't believe we want to do the stretched overlay here
 
-		// if transparency was off and is now on and we're in vidmode 1 (HACK)
-		if ((g_transparency_enabled) && (g_vidmode == 1))
-		{
-
-			for (i = 0; i < TMS9128NL_OVERLAY_W * (TMS9128NL_OVERLAY_H - (TMS_VERTICAL_OFFSET << 1)); i++)
-			{
-				// if color is a background color, make it 0x7F (transparency color)
-				if (*ptr == 0) *ptr = TMS_TRANSPARENT_COLOR;
-				ptr++;
-			}
-		}
-		else
-		{
-			for (i = 0; i < TMS9128NL_OVERLAY_W * (TMS9128NL_OVERLAY_H - (TMS_VERTICAL_OFFSET << 1)); i++)
-			{
-				// if color is transparent (0x7F), make it a background color
-				if (*ptr == TMS_TRANSPARENT_COLOR) *ptr = 0;
-				ptr++;
-			}
-		}
+		// if transparency was off and is now on and we're in vidmode 1 (HACK), the background becomes transparent,
+		//  otherwise it all becomes the background color
+		tms9128nl_set_all_transparency((g_transparency_enabled) && (g_vidmode == 1));
 
 		g_transparency_latch = g_transparency_enabled;
 	}
@@ -700,33 +820,62 @@ void tms9128nl_video_repaint()
 	g_transparency_enabled = 0;	// apparently this has to be set to true every pulse of the NMI in order
 	// to maintain the transparency.  The Cliff ROM does this.
 
-	// if we're in video mode 2, we have to display our stretched overlay instead of our regular one
-	if (g_vidmode == 2)
+	SDL_Surface *overlay = g_game->get_active_video_overlay();
+	tms_overlay_cells *cells = tms9128nl_get_overlay_cells(overlay);
+	bool stretched = (g_vidmode == 2);	// in video mode 2, we have to display our stretched overlay instead of our regular one
+
+	// switching between stretched and regular changes every pixel
+	if (stretched != cells->stretched)
 	{
-		tms9128nl_video_repaint_stretched();
+		memset(cells->dirty, 0xFF, sizeof(cells->dirty));
+		cells->stretched = stretched;
 	}
-	
-	// if we're not in mode 2, display our non-stretched overlay
-	else
+
+	for (unsigned int cell_row = 0; cell_row < TMS_CELL_ROWS; cell_row++)
 	{
-		memcpy(g_game->get_active_video_overlay()->pixels, g_vidbuf, TMS9128NL_OVERLAY_W * TMS9128NL_OVERLAY_H);
-	}
-	
+		uint64_t dirty = cells->dirty[cell_row];
+
+		if (!dirty)
+		{
+			continue;
+		}
+		cells->dirty[cell_row] = 0;
+
+		for (unsigned int y = cell_row * CHAR_HEIGHT; y < (cell_row + 1) * CHAR_HEIGHT; y++)
+		{
+			uint8_t line[TMS9128NL_OVERLAY_W];
+			uint8_t *dst = (uint8_t *) overlay->pixels + (y * overlay->pitch);
 
+			tms9128nl_build_line(line, y);
+
+			// the stretch blends neighboring pixels together, so the whole line gets redone
+			if (stretched)
+			{
+				tms9128nl_stretch_line(dst, line);
+			}
+			// otherwise only the cells that changed need to be copied
+			else
+			{
+				for (unsigned int col = 0; col < TMS_CELL_COLS; col++)
+				{
+					if (dirty & (((uint64_t) 1) << col))
+					{
+						memcpy(dst + (col * CHAR_WIDTH), line + (col * CHAR_WIDTH), CHAR_WIDTH);
+					}
+				}
+			}
+		}
+	}
 }
 
-// creates the stretched overlay, using the contents of the normal overlay as its source
+// creates a line of the stretched overlay, using a line of the normal overlay as its source
 // the stretched overlay is simply a 256x192 window scaled to 320x192 using a hard-coded algorithm (hopefully it's fast)
-void tms9128nl_video_repaint_stretched()
+static void tms9128nl_stretch_line(uint8_t *ptr320, const uint8_t *ptr256)
 {
 	int x256 = 0;
-	int y = 0;
-
-	uint8_t *ptr256 = (uint8_t *) g_vidbuf;	// source ...
-	uint8_t *ptr320 = (uint8_t *) g_game->get_active_video_overlay()->pixels;	// destination ...
 
 	// these values correspond to colors in the color palette	
-	unsigned char blend[4][2] = 
+	static const unsigned char blend[4][2] = 
 	{
 		{ 0, 0 },
 		{ 3, 1 },
@@ -734,82 +883,49 @@ void tms9128nl_video_repaint_stretched()
 		{ 1, 3 },
 	};
 
-	// do every row	
-	for (y = 0; y < TMS9128NL_OVERLAY_H; y++)
+	// do each pixel, but divide it up into smallest integer sections so we can use a hard-coded algorithm
+	// there is a 4:5 correspondance between the 256 and 320 surfaces
+	for (x256 = 0; x256 < 256; x256 += 4)
 	{
-		// do each pixel, but divide it up into smallest integer sections so we can use a hard-coded algorithm
-		// there is a 4:5 correspondance between the 256 and 320 surfaces
-		for (x256 = 0; x256 < 256; x256 += 4)
+		// PIXEL +0
+		*(ptr320) = *(ptr256);
+		
+		// PIXEL +1 to PIXEL +3 (blending possibly required)
+		for (int i = 1; i < 4; i++)
 		{
-			// PIXEL +0
-			*(ptr320) = *(ptr256);
-			
-			// PIXEL +1 to PIXEL +3 (blending possibly required)
-			for (int i = 1; i < 4; i++)
+			// if prev pixel is not the same as cur pixel, blending is required
+			if (*(ptr256+i-1) != *(ptr256+i))
 			{
-				// if prev pixel is not the same as cur pixel, blending is required
-				if (*(ptr256+i-1) != *(ptr256+i))
+				// if prev pixel is background color, cur pixel must be foreground
+				if (*(ptr256+i-1) == 0)
 				{
-					// if prev pixel is background color, cur pixel must be foreground
-					if (*(ptr256+i-1) == 0)
-					{
-						*(ptr320+i) = blend[i][0];
-					}
-					// else prev pixel is foreground, and therefore cur pixel must be background
-					else
-					{
-						*(ptr320+i) = blend[i][1];
-					}
+					*(ptr320+i) = blend[i][0];
+				}
+				// else prev pixel is foreground, and therefore cur pixel must be background
+				else
+				{
+					*(ptr320+i) = blend[i][1];
 				}
-				else *(ptr320+i) = *(ptr256+i);	// else no blending required
 			}
-
-			// PIXEL +4			
-			*(ptr320+4) = *(ptr256+3);
-			
-			ptr320 += 5;
-			ptr256 += 4;
+			else *(ptr320+i) = *(ptr256+i);	// else no blending required
 		}
-		ptr256 += (320-256);	// move to the next line, ptr320 is already at the next line
+
+		// PIXEL +4			
+		*(ptr320+4) = *(ptr256+3);
+		
+		ptr320 += 5;
+		ptr256 += 4;
 	}
 }
 
 void tms9128nl_clear_overlay()
 {
-	uint8_t clear_color = TMS_BG_COLOR;
-
-	int i = 0;
-
-	uint8_t *ptr = g_vidbuf;
-	
 //	printf("Overlay is being cleared, transparency is %d, latch is %d\n", g_transparency_enabled, g_transparency_latch);
-	
-	// if transparency mode is on ...
-	if (g_transparency_latch)
-	{
-		clear_color = TMS_TRANSPARENT_COLOR;
-	}
-
-	// top area always gets border color and is never transparent
-	for (i = 0; i < TMS9128NL_OVERLAY_W * TMS_VERTICAL_OFFSET; i++)
-	{
-
-		*ptr = 0;
-		ptr++;
-	}
-	
-	// erase viewable area with either the background color or the transparent color
-	for (i = 0; i < TMS9128NL_OVERLAY_W * (TMS9128NL_OVERLAY_H - (TMS_VERTICAL_OFFSET << 1)); i++)
-	{
-		*ptr = clear_color;
-		ptr++;
-	}
 
-	// bottom area always gets border color and is never transparent
-	for (i = 0; i < TMS9128NL_OVERLAY_W * TMS_VERTICAL_OFFSET; i++)
-	{
-		*ptr = 0;
-	}
+	// the top and bottom areas always get the border color and are never transparent,
+	//  the viewable area is erased with either the background color or the transparent color (if transparency mode is on)
+	memset(g_vidbuf, 0, sizeof(g_vidbuf));
+	tms9128nl_set_all_transparency(g_transparency_latch != 0);
 
 	g_game->set_video_overlay_needs_update(true);
 }
@@ -65,7 +65,6 @@ void tms9128nl_outcommand(char *s,int col,int row);
 void tms9128nl_palette_update();
 void tms9128nl_palette_calculate();
 void tms9128nl_video_repaint();
-void tms9128nl_video_repaint_stretched();
 void tms9128nl_set_transparency();
 
 #endif
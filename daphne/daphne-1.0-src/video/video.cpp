@@ -35,6 +35,7 @@
 #include <string>	// for some error messages
 #include "video.h"
 #include "palette.h"
+#include "present.h"
 #include "SDL_DrawText.h"
 #include "../io/conout.h"
 #include "../io/error.h"
@@ -81,6 +82,13 @@ bool init_display()
 
 	// if we were able to initialize the video properly
 	{
+		// before any thread can present a frame or ask for one
+		if (!present_init())
+		{
+			printerror("Could not allocate the frame buffers for the overlay");
+			return false;
+		}
+
 		// go through each standard resolution size to see if we are using a standard resolution
 		for (x=0; x < (sizeof(cg_normalwidths) / sizeof(uint16_t)); x++)
 		{
@@ -157,6 +165,7 @@ bool init_display()
 void shutdown_display()
 {
 	printline("Shutting down video display...");
+	present_shutdown();
 }
 
 void vid_flip()
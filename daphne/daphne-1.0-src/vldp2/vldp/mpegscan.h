@@ -20,7 +20,48 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#ifndef MPEGSCAN_H
+#define MPEGSCAN_H
+
+#include <stdint.h>
+
 enum { P_ERROR, P_IN_PROGRESS, P_FINISHED_FRAMES, P_FINISHED_FIELDS };
 
-void init_mpegscan();
-int parse_video_stream(FILE *datafile, unsigned int length);
+// offset that gets reported for pictures that are not I frames
+#define MPEGSCAN_NOT_IFRAME 0xFFFFFFFF
+
+// all the state of one parse, so that more than one stream can be parsed at the same time
+// (for example, the background indexer and the VLDP thread)
+struct mpegscan_s
+{
+	unsigned char last_three[3];		// the last 3 bytes read
+	unsigned int last_three_loc[3];	// the position of the last 3 bytes read
+	int last_three_pos;
+	int iframe_count;
+	int gop_count;	// group of picture count
+	int curframe;
+	unsigned int goppos;
+	unsigned int filepos;	// where we are in the file
+	unsigned int frame_type;	// I, P, B frame, etc
+	unsigned int last_header_pos;	// the position of the last header we've parsed
+	int fields_detected;	// whether the stream uses fields
+	int frames_detected;	// whether the stream uses frames (these are both here to detect errors)
+	int status;	// whether we are in a special area (inside a picture header, for example)
+	int rel_pos;	// which byte of the special area we are in (relative position)
+	unsigned char ext_type;	// 1 = sequence_ext, 2 = sequence_display_ext, 8 = picture_coding_ext
+
+	// gets called once for every picture that is found, in stream order.
+	// 'offset' is the position of the I frame in the stream, or MPEGSCAN_NOT_IFRAME
+	void (*report_picture)(void *user, uint32_t offset);
+	void *user;
+};
+
+// resets 'scan' so a new stream can be parsed from the beginning
+void init_mpegscan(struct mpegscan_s *scan, void (*report_picture)(void *, uint32_t), void *user);
+
+// parses the next 'length' bytes of the stream held in 'buf'
+// A 'length' of 0 means that the end of the stream has been reached.
+// Returns P_IN_PROGRESS until the end of the stream, then one of the P_FINISHED codes (or P_ERROR)
+int parse_video_stream(struct mpegscan_s *scan, const unsigned char *buf, unsigned int length);
+
+#endif // MPEGSCAN_H
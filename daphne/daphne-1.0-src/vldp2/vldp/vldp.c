@@ -28,9 +28,11 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <stdarg.h>
 #include <string.h>
 #include "vldp.h"
 #include "vldp_common.h"
+#include "vldp_index.h"
 
 //////////////////////////////////////////////////////////////////////////////////////
 
@@ -43,8 +45,8 @@ SDL_Thread *private_thread = NULL;
 
 int p_initialized = 0;	// whether VLDP has been initialized
 
-uint8_t g_req_cmdORcount = CMDORCOUNT_INITIAL;	// the current command parent thread requests of the child thread
-unsigned int g_ack_count = ACK_COUNT_INITIAL;	// the result returned by the internal child thread
+SDL_atomic_t g_req_cmdORcount = { CMDORCOUNT_INITIAL };	// the current command parent thread requests of the child thread
+SDL_atomic_t g_ack_count = { ACK_COUNT_INITIAL };	// the result returned by the internal child thread
 char g_req_file[STRSIZE];	// requested mpeg filename
 uint32_t g_req_timer = 0;	// requests timer value to be used for mpeg playback
 uint16_t g_req_frame = 0;		// requested frame to search to
@@ -56,8 +58,80 @@ unsigned int g_req_stall_per_frame = 0;	// how many frames to stall per frame (f
 struct vldp_out_info g_out_info;	// contains info that the parent thread should have access to
 const struct vldp_in_info *g_in_info;	// contains info from parent thread that VLDP should have access to
 
+static SDL_mutex *s_mailbox_mutex = NULL;	// protects the mailbox (command, ack count and status)
+static SDL_cond *s_cmd_cond = NULL;	// signalled when the parent thread posts a new command
+static SDL_cond *s_reply_cond = NULL;	// signalled when the VLDP thread acknowledges a command or changes its status
+
 /////////////////////////////////////////////////////////////////////
 
+int vldp_mailbox_init(void)
+{
+	if (!s_mailbox_mutex)
+		s_mailbox_mutex = SDL_CreateMutex();
+	if (!s_cmd_cond)
+		s_cmd_cond = SDL_CreateCond();
+	if (!s_reply_cond)
+		s_reply_cond = SDL_CreateCond();
+
+	return (s_mailbox_mutex && s_cmd_cond && s_reply_cond);
+}
+
+void vldp_mailbox_shutdown(void)
+{
+	if (s_reply_cond)
+	{
+		SDL_DestroyCond(s_reply_cond);
+		s_reply_cond = NULL;
+	}
+	if (s_cmd_cond)
+	{
+		SDL_DestroyCond(s_cmd_cond);
+		s_cmd_cond = NULL;
+	}
+	if (s_mailbox_mutex)
+	{
+		SDL_DestroyMutex(s_mailbox_mutex);
+		s_mailbox_mutex = NULL;
+	}
+}
+
+int vldp_mailbox_wait_cmd(uint8_t old_cmdORcount, unsigned int uTimeoutMs)
+{
+	int result = 0;
+
+	SDL_LockMutex(s_mailbox_mutex);
+	if ((uint8_t) SDL_AtomicGet(&g_req_cmdORcount) == old_cmdORcount)
+		SDL_CondWaitTimeout(s_cmd_cond, s_mailbox_mutex, uTimeoutMs);
+	result = ((uint8_t) SDL_AtomicGet(&g_req_cmdORcount) != old_cmdORcount);
+	SDL_UnlockMutex(s_mailbox_mutex);
+
+	return result;
+}
+
+void vldp_mailbox_ack(uint8_t *pold_cmdORcount)
+{
+	SDL_LockMutex(s_mailbox_mutex);
+	*pold_cmdORcount = (uint8_t) SDL_AtomicGet(&g_req_cmdORcount);
+	SDL_AtomicAdd(&g_ack_count, 1);	// here is where we acknowledge
+	SDL_CondBroadcast(s_reply_cond);
+	SDL_UnlockMutex(s_mailbox_mutex);
+}
+
+void vldp_mailbox_set_status(int status)
+{
+	SDL_LockMutex(s_mailbox_mutex);
+	g_out_info.status = status;
+	SDL_CondBroadcast(s_reply_cond);
+	SDL_UnlockMutex(s_mailbox_mutex);
+}
+
+// how many ms we have left before 'uStartTime' + VLDP_TIMEOUT
+static uint32_t vldp_ms_left(uint32_t uStartTime)
+{
+	uint32_t uElapsed = g_in_info->GetTicksFunc() - uStartTime;
+	return (uElapsed < VLDP_TIMEOUT) ? (VLDP_TIMEOUT - uElapsed) : 0;
+}
+
 // issues a command to the internal thread and returns 1 if the internal thread acknowledged our command
 // or 0 if we timed out without getting a response
 // NOTE : this does not mean that the internal thread has finished executing our requested command, only
@@ -66,30 +140,38 @@ int vldp_cmd(int cmd)
 {
 	int result = 0;
 	uint32_t cur_time = g_in_info->GetTicksFunc();
-	uint8_t tmp = g_req_cmdORcount;	// we want to replace the real value atomically so we use a tmp variable first
+	uint32_t ms_left = VLDP_TIMEOUT;
+	uint8_t tmp = 0;
 	static unsigned int old_ack_count = ACK_COUNT_INITIAL;
 
+	SDL_LockMutex(s_mailbox_mutex);
+
+	tmp = (uint8_t) SDL_AtomicGet(&g_req_cmdORcount);
 	tmp++;	// increment the counter so child thread knows we're issuing a new command
 	tmp &= 0xF;	// strip off old command
 	tmp |= cmd;	// replace it with new command
-	g_req_cmdORcount = tmp;	// here is the atomic replacement
-	
-	// loop until we timeout or get a response
-	while ((g_in_info->GetTicksFunc() - cur_time) < VLDP_TIMEOUT)
+	SDL_AtomicSet(&g_req_cmdORcount, tmp);	// here is the atomic replacement
+	SDL_CondSignal(s_cmd_cond);	// wake up the VLDP thread if it's sleeping
+
+	// sleep until we timeout or get a response
+	while (ms_left > 0)
 	{
 		// if the count has changed, it means the other thread has acknowledged our new command
-		if (g_ack_count != old_ack_count)
+		if ((unsigned int) SDL_AtomicGet(&g_ack_count) != old_ack_count)
 		{
 			result = 1;
-			old_ack_count = g_ack_count;	// prepare to receive the next command
+			old_ack_count = SDL_AtomicGet(&g_ack_count);	// prepare to receive the next command
 			break;
 		}
-		SDL_Delay(0);	// switch to other thread
+		SDL_CondWaitTimeout(s_reply_cond, s_mailbox_mutex, ms_left);
+		ms_left = vldp_ms_left(cur_time);
 	}
 
+	SDL_UnlockMutex(s_mailbox_mutex);
+
 	// if we weren't able to communicate, notify user
 	if (!result)
-		fprintf(stderr, "VLDP error!  Timed out waiting for internal thread to accept command!\n");
+		vldp_log(VLDP_LOG_ERROR, "VLDP error!  Timed out waiting for internal thread to accept command!");
 	
 	return result;
 }
@@ -101,30 +183,35 @@ int vldp_cmd(int cmd)
 int vldp_wait_for_status(int stat)
 {
 	int result        = 0;	// assume error unless we explicitly
-	int done          = 0;
 	uint32_t cur_time = g_in_info->GetTicksFunc();
+	uint32_t ms_left  = VLDP_TIMEOUT;
+
+	SDL_LockMutex(s_mailbox_mutex);
 
-	while (!done && ((g_in_info->GetTicksFunc() - cur_time) < VLDP_TIMEOUT))
+	while (ms_left > 0)
 	{
 		if (g_out_info.status == stat)
 		{
-			done = 1;
 			result = 1;
+			break;
 		}
 		else if (g_out_info.status == STAT_ERROR)
-			done = 1;
+			break;
 
-		// else keep waiting
-		SDL_Delay(0);	// switch to other thread, timing is critical so we delay for 0
+		// else sleep until the status changes
+		SDL_CondWaitTimeout(s_reply_cond, s_mailbox_mutex, ms_left);
+		ms_left = vldp_ms_left(cur_time);
 	}
 
 	// if we timed out but are busy, indicate that
-	if (g_out_info.status == STAT_BUSY)
+	if ((result == 0) && (g_out_info.status == STAT_BUSY))
 		result = 2;
 
 	// else if we timed out
-	else if ((g_in_info->GetTicksFunc() - cur_time) >= VLDP_TIMEOUT)
-		fprintf(stderr, "VLDP ERROR!!!!  Timed out with getting our expected response!\n");
+	else if (ms_left == 0)
+		vldp_log(VLDP_LOG_ERROR, "VLDP ERROR!!!!  Timed out with getting our expected response!");
+
+	SDL_UnlockMutex(s_mailbox_mutex);
 
 	return result;
 }
@@ -136,8 +223,11 @@ void vldp_shutdown()
 	// only shutdown if we have previous initialized
 	if (p_initialized)
 	{
+		ivldp_index_abort();	// in case the private thread is waiting on the indexer
 		vldp_cmd(VLDP_REQ_QUIT);
 		SDL_WaitThread(private_thread, NULL);	// wait for private thread to terminate
+		ivldp_index_shutdown();
+		vldp_mailbox_shutdown();
 	}
 	p_initialized = 0;
 }
@@ -160,7 +250,7 @@ int vldp_open(const char *filename)
 			return vldp_cmd(VLDP_REQ_OPEN);
 		}
 		else
-			fprintf(stderr, "VLDP ERROR : can't open file %s\n", filename);
+			vldp_log(VLDP_LOG_ERROR, "VLDP ERROR : can't open file %s", filename);
 	}
 
 	return 0;
@@ -305,6 +395,30 @@ VLDP_BOOL vldp_unlock(unsigned int uTimeoutMs)
 	return VLDP_FALSE;
 }
 
+VLDP_BOOL vldp_index_in_background(const char * const *ppszFilenames, unsigned int uCount)
+{
+	if (p_initialized)
+		return ivldp_index_start(ppszFilenames, uCount);
+	return VLDP_FALSE;
+}
+
+///////////////////////////////////////////////////////////////////////////
+
+void vldp_log(int level, const char *fmt, ...)
+{
+	char s[STRSIZE * 2];
+	va_list args;
+
+	va_start(args, fmt);
+	vsnprintf(s, sizeof(s), fmt, args);
+	va_end(args);
+
+	if (g_in_info && g_in_info->log_line)
+		g_in_info->log_line(level, s);
+	else
+		fprintf(stderr, "%s\n", s);
+}
+
 ///////////////////////////////////////////////////////////////////////////
 
 // This comes at the end so I can avoid putting function declarations in vldp.h
@@ -332,9 +446,13 @@ const struct vldp_out_info *vldp_init(const struct vldp_in_info *in_info)
 	g_out_info.speedchange = vldp_speedchange;
 	g_out_info.lock = vldp_lock;
 	g_out_info.unlock = vldp_unlock;
+	g_out_info.index_in_background = vldp_index_in_background;
+
+	if (!vldp_mailbox_init())
+		return NULL;
 
 	// RJS CHANGE - new parm for SDL2
-	private_thread = SDL_CreateThread(idle_handler, "PRIVATE", NULL);	// start our internal thread
+	private_thread = SDL_CreateThread(idle_handler, "VLDP_DECODER", NULL);	// start our internal thread
 	
 	// if private thread was created successfully
 	if (private_thread)
@@ -48,6 +48,7 @@ struct yuv_buf
 	unsigned char *V;	// V channel
 	unsigned int Y_size;	// size in bytes of Y
 	unsigned int UV_size;	// size in bytes of U and V
+	unsigned int uSerial;	// changes every time new picture data is put into this buffer (so unchanged frames don't have to be rebuilt)
 };
 
 // safe strcpy that null-terminates the end of a string
@@ -59,6 +60,9 @@ struct yuv_buf
 // enum { VLDP_FALSE=0, VLDP_TRUE=1 } typedef VLDP_BOOL;
 enum { VLDP_FALSE = 0, VLDP_TRUE = 1 }; typedef int VLDP_BOOL;
 
+// how important a message passed to vldp_in_info's log_line is, most important first
+enum { VLDP_LOG_ERROR, VLDP_LOG_WARNING, VLDP_LOG_INFO };
+
 // callback functions and state information provided to VLDP from the parent thread
 struct vldp_in_info
 {
@@ -89,9 +93,30 @@ struct vldp_in_info
 	int blank_during_skips;	// if this is non-zero, VLDP will call render_blank_frame before every skip
 	unsigned int uMsTimer;	// the timer that VLDP will use for everything (replaces SDL_GetTicks()). Calling thread is responsible for updating this timer!!
 
+	// If this is non-zero and a file is opened before the background indexer has created its .DAT file,
+	//  VLDP won't wait for the .DAT file but will scan the mpeg itself, only as far as each search needs.
+	// Otherwise VLDP waits for just that file to be indexed.
+	int index_fallback_coarse;
+
+	// If this is non-zero, VLDP paces frames against its own monotonic clock (sleeping until each frame's
+	//  exact deadline) instead of uMsTimer, and prints how late frames were displayed whenever a file is closed.
+	int precise_pacing;
+
 	// Callback to get an arbitrary millisecond timer (such as SDL_GetTicks)
 	// (for instances when we know uMsTimer will not be updated, we will call this function instead)
 	unsigned int (*GetTicksFunc)();
+
+	// If this isn't NULL, VLDP calls it every time a frame is displayed or dropped, with how late the frame was
+	//  (in nanoseconds).  'bDropped' is VLDP_TRUE if the frame was too late to be displayed at all.
+	void (*report_frame_lateness)(uint64_t u64LateNs, VLDP_BOOL bDropped);
+
+	// If this isn't NULL, VLDP's decoder thread calls it (with "vldp") as soon as it starts, so that the parent can
+	//  set the thread's core affinity and priority.
+	void (*thread_started)(const char *pszName);
+
+	// If this isn't NULL, VLDP passes each message it has to say here (one line, with no line ending) instead of
+	//  printing it to stderr.  'level' is one of the VLDP_LOG_ values.  It may be called from any of VLDP's threads.
+	void (*log_line)(int level, const char *pszLine);
 };
 
 // functions and state information provided to the parent thread from VLDP
@@ -165,6 +190,12 @@ struct vldp_out_info
 	
 	// Unlocks a previous lock operation. Returns true if unlock was successful, or false if we timed out.
 	VLDP_BOOL (*unlock)(unsigned int uTimeoutMs);
+
+	// Starts creating the .DAT files for 'uCount' mpegs on a background thread and returns immediately.
+	// Files are indexed in the order given.  Opening a file that hasn't been indexed yet is still legal
+	//  (see index_fallback_coarse).
+	// Returns VLDP_TRUE if the background thread was started.
+	VLDP_BOOL (*index_in_background)(const char * const *ppszFilenames, unsigned int uCount);
 	
 	////////////////////////////////////////////////////////////
 
@@ -177,6 +208,7 @@ struct vldp_out_info
 	int status;	// the current status of the VLDP (see STAT_ enum's)
 	unsigned int current_frame;	// the current frame of the opened mpeg that we are on
 	unsigned int uLastCachedIndex;	// the index of the file that was last precached (if any)
+	unsigned int uFramesDecoded;	// how many pictures libmpeg2 has finished since VLDP started (including ones that were skipped)
 };
 
 enum
@@ -61,9 +61,9 @@ extern uint32_t g_req_timer;
 extern unsigned int g_req_idx;	// multipurpose index
 extern unsigned int g_req_precache;
 extern char g_req_file[];	// which file to open
-extern uint8_t g_req_cmdORcount;	// the current command count OR'd with the current command of parent thread
-								// made 8-bit to ensure that it's atomic
-extern unsigned int g_ack_count;	// how many times we've acknowledged a command
+extern SDL_atomic_t g_req_cmdORcount;	// the current command count OR'd with the current command of parent thread
+								// (only the lower 8 bits are used)
+extern SDL_atomic_t g_ack_count;	// how many times we've acknowledged a command
 
 extern struct vldp_out_info g_out_info;	// contains info that the parent thread should have access to
 extern const struct vldp_in_info *g_in_info;	// contains info from parent thread that VLDP should have access to
@@ -73,6 +73,32 @@ extern unsigned int g_req_stall_per_frame;	// how many frames to stall per frame
 
 int idle_handler(void *);
 
+// formats a message like printf and hands it to g_in_info->log_line (or prints it to stderr if there isn't one)
+void vldp_log(int level, const char *fmt, ...)
+#ifdef __GNUC__
+	__attribute__ ((format (printf, 2, 3)))
+#endif
+	;
+
+// The command mailbox between the parent thread and the VLDP thread.
+// The parent thread posts one command at a time (and waits for it to be acknowledged), so the
+//  'queue' never needs to be more than one deep.  Both sides sleep on condition variables
+//  instead of spinning, so a command or status change wakes the other side right away.
+
+// creates the mutex/condition variables (returns VLDP_FALSE on failure)
+int vldp_mailbox_init(void);
+void vldp_mailbox_shutdown(void);
+
+// VLDP thread: sleeps until g_req_cmdORcount is no longer 'old_cmdORcount', or until 'uTimeoutMs' has passed
+// returns 1 if there is a new command, 0 if we timed out
+int vldp_mailbox_wait_cmd(uint8_t old_cmdORcount, unsigned int uTimeoutMs);
+
+// VLDP thread: acknowledges the command that is currently in the mailbox
+void vldp_mailbox_ack(uint8_t *pold_cmdORcount);
+
+// VLDP thread: changes g_out_info.status and wakes up the parent thread if it's waiting for a status
+void vldp_mailbox_set_status(int status);
+
 // how ms to wait for responses from the private thread before we give up and return an error
 // NOTE : increased from 5000 now that artificial seek delay functionality is added
 #define VLDP_TIMEOUT	7500
@@ -0,0 +1,473 @@
+/*
+ * vldp_index.c
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of VLDP, a virtual laserdisc player.
+ *
+ * VLDP is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * VLDP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Creates the .DAT files that hold the offset of every I frame in an mpeg.
+// Used to be done by the VLDP thread for every file before the game could boot,
+//  now all files are queued up on a background thread and the VLDP thread only
+//  waits for the file it actually needs.
+
+#ifdef _WIN32
+#define _CRT_SECURE_NO_WARNINGS 1
+#pragma warning (disable:4996)
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>	// for malloc/free
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <SDL.h>
+
+#include "vldp_internal.h"
+#include "vldp_common.h"
+#include "vldp_index.h"
+#include "mpegscan.h"
+
+// how many bytes of mpeg we parse at a time
+#define PARSE_CHUNK 200000
+
+struct index_entry_s
+{
+	char szName[STRSIZE];	// full path of the mpeg
+	int iState;	// INDEX_ enum
+};
+
+static struct index_entry_s s_entries[MAX_INDEX_FILES];
+static unsigned int s_uEntryCount = 0;
+
+static SDL_Thread *s_index_thread = NULL;
+static SDL_mutex *s_index_mutex = NULL;	// protects s_entries
+static SDL_cond *s_index_cond = NULL;	// signalled every time an entry changes state
+
+static SDL_atomic_t s_bIndexQuit;	// set when VLDP is shutting down, aborts any parse in progress
+static SDL_atomic_t s_iIndexProgress;	// how far the background parse has got, in tenths of a percent
+
+/////////////////////////////////////////////////////////////////////
+
+static void ivldp_index_write_picture(void *user, uint32_t offset)
+{
+	fwrite(&offset, sizeof(offset), 1, (FILE *) user);
+}
+
+// returns the size of the file, or 0 if it can't be found
+static unsigned int ivldp_index_file_size(const char *filename)
+{
+	struct stat the_stat;
+	if (stat(filename, &the_stat) == 0)
+		return (unsigned int) the_stat.st_size;
+	return 0;
+}
+
+// returns the index of 'mpeg_name' in s_entries, or -1 if it isn't there
+// (s_index_mutex must be locked)
+static int ivldp_index_find(const char *mpeg_name)
+{
+	unsigned int u = 0;
+	for (u = 0; u < s_uEntryCount; u++)
+	{
+		if (strcmp(s_entries[u].szName, mpeg_name) == 0)
+			return (int) u;
+	}
+	return -1;
+}
+
+// changes the state of an entry and wakes up anyone waiting for it
+static void ivldp_index_set_state(int iIdx, int iState)
+{
+	SDL_LockMutex(s_index_mutex);
+	s_entries[iIdx].iState = iState;
+	SDL_CondBroadcast(s_index_cond);
+	SDL_UnlockMutex(s_index_mutex);
+}
+
+void ivldp_index_dat_name(char *dst, const char *mpeg_name, size_t size)
+{
+	size_t len = 0;
+
+	// change extension of file to be dat instead of (presumably) m2v
+	SAFE_STRCPY(dst, mpeg_name, size);
+	len = strlen(dst);
+	if ((len >= 3) && (len + 1 <= size))
+		strcpy(&dst[len-3], "dat");
+}
+
+VLDP_BOOL ivldp_index_dat_is_valid(const char *datafilename, unsigned int mpeg_size)
+{
+	VLDP_BOOL result = VLDP_FALSE;
+	FILE *data_file = fopen(datafilename, "rb");
+
+	if (data_file)
+	{
+		struct dat_header header;
+
+		// if version, file size, or finished are wrong, the dat file is no good and has to be regenerated
+		if ((fread(&header, sizeof(header), 1, data_file) == 1) &&
+			(header.length == mpeg_size) && (header.version == DAT_VERSION) && (header.finished == 1))
+		{
+			result = VLDP_TRUE;
+		}
+		fclose(data_file);
+	}
+
+	return result;
+}
+
+// does the actual parsing
+// 'bBackground' is true if this is being called from the indexer thread, in which case progress only goes into
+//  s_iIndexProgress.  The parent thread's parse meter may only be touched while it is blocked waiting on the VLDP
+//  thread (it tears the overlay down afterwards), so ivldp_index_wait passes the progress along if it needs to.
+static VLDP_BOOL ivldp_index_build(const char *mpeg_name, VLDP_BOOL report, VLDP_BOOL bBackground)
+{
+	char datafilename[STRSIZE] = { 0 };
+	char tmpfilename[STRSIZE + 4] = { 0 };
+	FILE *mpeg_file = NULL;
+	FILE *data_file = NULL;
+	unsigned char *buf = NULL;
+	unsigned int mpeg_size = ivldp_index_file_size(mpeg_name);
+	struct dat_header header;	// header to put inside .DAT file
+	struct mpegscan_s scan;
+	int parse_result = P_ERROR;
+
+	ivldp_index_dat_name(datafilename, mpeg_name, sizeof(datafilename));
+
+	// the .DAT is written under a temporary name and renamed once it's finished,
+	//  so that nobody ever reads a half-written one
+	SAFE_STRCPY(tmpfilename, datafilename, sizeof(tmpfilename));
+	strcat(tmpfilename, ".tmp");
+
+	mpeg_file = fopen(mpeg_name, "rb");
+	if (!mpeg_file)
+	{
+		vldp_log(VLDP_LOG_ERROR, "VLDP ERROR : Could not open %s for parsing", mpeg_name);
+		return VLDP_FALSE;
+	}
+
+	buf = (unsigned char *) malloc(PARSE_CHUNK);	// allocate a chunk of memory to read in file
+	data_file = fopen(tmpfilename, "wb");	// create file
+
+	// if we could create the file successfully, then we need to populate it
+	if (data_file && buf)
+	{
+		uint32_t pos = 0;	// position in the file
+		int count = 0;
+
+		header.version = DAT_VERSION;
+		header.finished = 0;
+		header.uses_fields = 0;
+		header.length = mpeg_size;
+		fwrite(&header, sizeof(header), 1, data_file);
+		// first thing that goes in the file is the .DAT header
+		// That way we can re-use the file another time with confidence that it's
+		// the right one
+
+		init_mpegscan(&scan, ivldp_index_write_picture, data_file);
+
+		SDL_AtomicSet(&s_iIndexProgress, 0);
+		if (report && !bBackground)
+			g_in_info->report_parse_progress(-1);	// notify other thread that we're starting
+
+		// keep reading the file while there is a file left to be read
+		do
+		{
+			unsigned int bytes_read = (unsigned int) fread(buf, 1, PARSE_CHUNK, mpeg_file);
+
+			parse_result = parse_video_stream(&scan, buf, bytes_read);
+			pos += bytes_read;
+
+			// we want to give the user updates but don't want to flood them
+			if (count > 10)
+			{
+				count = 0;
+
+				// report progress to parent thread
+				if (bBackground)
+					SDL_AtomicSet(&s_iIndexProgress, (int) (((double) pos / mpeg_size) * 1000));
+				else if (report)
+					g_in_info->report_parse_progress((double) pos / mpeg_size);
+			}
+			count++;
+
+			// if VLDP is being shut down, don't make it wait for us
+			if (SDL_AtomicGet(&s_bIndexQuit))
+				parse_result = P_ERROR;
+
+		} while (parse_result == P_IN_PROGRESS);
+
+		if (report && !bBackground)
+			g_in_info->report_parse_progress(1);	// notify other thread that we're done
+
+		// if parse finished, then we have to update the header
+		if (parse_result != P_ERROR)
+		{
+			header.finished = 1;
+			header.uses_fields = 0;
+			if (parse_result == P_FINISHED_FIELDS)
+				header.uses_fields = 1;
+			fseek(data_file, 0L, SEEK_SET);
+			fwrite(&header, sizeof(header), 1, data_file);	// save changes
+		}
+
+		fclose(data_file);
+		data_file = NULL;
+
+		// if the mpeg did not finish parsing gracefully, we've got problems
+		// NOTE : I separated this from the other if above to guarantee that the file gets closed
+		if (parse_result == P_ERROR)
+		{
+			vldp_log(VLDP_LOG_ERROR, "There was an error parsing the MPEG file.");
+			vldp_log(VLDP_LOG_ERROR, "Either there is a bug in the parser or the MPEG file is corrupt.");
+			vldp_log(VLDP_LOG_ERROR, "OR the user aborted the decoding process :)");
+			unlink(tmpfilename);
+		}
+		else
+		{
+			unlink(datafilename);	// rename won't replace an existing file on every platform
+			if (rename(tmpfilename, datafilename) != 0)
+			{
+				vldp_log(VLDP_LOG_ERROR, "Could not rename %s to %s", tmpfilename, datafilename);
+				unlink(tmpfilename);
+				parse_result = P_ERROR;
+			}
+		}
+	} // end if we could create the file successfully
+
+	// we couldn't create data file which means no write permission probably
+	// this is probably a good time to shut VLDP down =]
+	else
+	{
+		if (data_file)
+		{
+			fclose(data_file);
+			unlink(tmpfilename);
+		}
+		vldp_log(VLDP_LOG_ERROR, "Could not create file %s", tmpfilename);
+		vldp_log(VLDP_LOG_ERROR, "This probably means you don't have permission to create the file");
+	}
+
+	free(buf);
+	fclose(mpeg_file);
+
+	return (parse_result != P_ERROR) ? VLDP_TRUE : VLDP_FALSE;
+}
+
+VLDP_BOOL ivldp_index_build_dat(const char *mpeg_name, VLDP_BOOL report)
+{
+	return ivldp_index_build(mpeg_name, report, VLDP_FALSE);
+}
+
+// background thread that works through the queue
+static int ivldp_index_thread(void *data)
+{
+	for (;;)
+	{
+		int iIdx = -1;
+		unsigned int u = 0;
+
+		// grab the next file in line
+		SDL_LockMutex(s_index_mutex);
+		for (u = 0; u < s_uEntryCount; u++)
+		{
+			if (s_entries[u].iState == INDEX_PENDING)
+			{
+				iIdx = (int) u;
+				s_entries[u].iState = INDEX_BUSY;
+				break;
+			}
+		}
+		SDL_UnlockMutex(s_index_mutex);
+
+		// if we're out of work or have been asked to quit
+		if ((iIdx == -1) || SDL_AtomicGet(&s_bIndexQuit))
+		{
+			if (iIdx != -1)
+				ivldp_index_set_state(iIdx, INDEX_FAILED);
+			break;
+		}
+
+		// only parse if there isn't already a good .DAT file
+		{
+			char datafilename[STRSIZE];
+			const char *mpeg_name = s_entries[iIdx].szName;
+			VLDP_BOOL bReady = VLDP_TRUE;
+
+			ivldp_index_dat_name(datafilename, mpeg_name, sizeof(datafilename));
+			if (!ivldp_index_dat_is_valid(datafilename, ivldp_index_file_size(mpeg_name)))
+			{
+				bReady = ivldp_index_build(mpeg_name, VLDP_FALSE, VLDP_TRUE);
+			}
+
+			ivldp_index_set_state(iIdx, bReady ? INDEX_READY : INDEX_FAILED);
+		}
+	}
+
+	// make sure nobody waits on a file that will never be indexed
+	{
+		unsigned int u = 0;
+		SDL_LockMutex(s_index_mutex);
+		for (u = 0; u < s_uEntryCount; u++)
+		{
+			if (s_entries[u].iState == INDEX_PENDING)
+				s_entries[u].iState = INDEX_FAILED;
+		}
+		SDL_CondBroadcast(s_index_cond);
+		SDL_UnlockMutex(s_index_mutex);
+	}
+
+	return 0;
+}
+
+VLDP_BOOL ivldp_index_start(const char * const *ppszFiles, unsigned int uCount)
+{
+	unsigned int u = 0;
+
+	// only one indexer at a time
+	if (s_index_thread)
+		return VLDP_FALSE;
+
+	if (!s_index_mutex)
+		s_index_mutex = SDL_CreateMutex();
+	if (!s_index_cond)
+		s_index_cond = SDL_CreateCond();
+	if (!s_index_mutex || !s_index_cond)
+		return VLDP_FALSE;
+
+	SDL_LockMutex(s_index_mutex);
+	s_uEntryCount = 0;
+	for (u = 0; (u < uCount) && (s_uEntryCount < MAX_INDEX_FILES); u++)
+	{
+		// it's legal for a framefile to have the same file listed more than once
+		if (ivldp_index_find(ppszFiles[u]) == -1)
+		{
+			SAFE_STRCPY(s_entries[s_uEntryCount].szName, ppszFiles[u], sizeof(s_entries[s_uEntryCount].szName));
+			s_entries[s_uEntryCount].iState = INDEX_PENDING;
+			++s_uEntryCount;
+		}
+	}
+	SDL_UnlockMutex(s_index_mutex);
+
+	SDL_AtomicSet(&s_bIndexQuit, 0);
+	s_index_thread = SDL_CreateThread(ivldp_index_thread, "VLDP_INDEX", NULL);
+
+	return (s_index_thread != NULL) ? VLDP_TRUE : VLDP_FALSE;
+}
+
+void ivldp_index_abort(void)
+{
+	SDL_AtomicSet(&s_bIndexQuit, 1);
+
+	if (s_index_thread)
+	{
+		SDL_WaitThread(s_index_thread, NULL);
+		s_index_thread = NULL;
+	}
+}
+
+void ivldp_index_shutdown(void)
+{
+	ivldp_index_abort();
+
+	// the VLDP thread is gone by now, so it's safe to tear everything down
+	if (s_index_cond)
+	{
+		SDL_DestroyCond(s_index_cond);
+		s_index_cond = NULL;
+	}
+	if (s_index_mutex)
+	{
+		SDL_DestroyMutex(s_index_mutex);
+		s_index_mutex = NULL;
+	}
+	s_uEntryCount = 0;
+	SDL_AtomicSet(&s_bIndexQuit, 0);	// so VLDP can parse again if it gets re-initialized
+}
+
+int ivldp_index_get_state(const char *mpeg_name)
+{
+	int iState = INDEX_UNKNOWN;
+
+	if (s_index_mutex)
+	{
+		int iIdx = -1;
+		SDL_LockMutex(s_index_mutex);
+		iIdx = ivldp_index_find(mpeg_name);
+		if (iIdx != -1)
+			iState = s_entries[iIdx].iState;
+		SDL_UnlockMutex(s_index_mutex);
+	}
+
+	return iState;
+}
+
+VLDP_BOOL ivldp_index_wait(const char *mpeg_name)
+{
+	VLDP_BOOL bResult = VLDP_FALSE;
+	int iIdx = -1;
+
+	if (!s_index_mutex)
+		return VLDP_FALSE;
+
+	SDL_LockMutex(s_index_mutex);
+	iIdx = ivldp_index_find(mpeg_name);
+
+	if (iIdx != -1)
+	{
+		// If the indexer hasn't gotten to this file yet, take it away from the indexer and
+		//  parse it right now.  That way we only wait for the file we need, not for the
+		//  ones in line ahead of it.
+		if (s_entries[iIdx].iState == INDEX_PENDING)
+		{
+			s_entries[iIdx].iState = INDEX_BUSY;
+			SDL_UnlockMutex(s_index_mutex);
+
+			bResult = ivldp_index_build_dat(mpeg_name, VLDP_TRUE);
+			ivldp_index_set_state(iIdx, bResult ? INDEX_READY : INDEX_FAILED);
+			return bResult;
+		}
+
+		// else the indexer is working on it, so wait for it to finish
+		// (passing its progress on to the parent thread, which is waiting on us)
+		if (s_entries[iIdx].iState == INDEX_BUSY)
+		{
+			g_in_info->report_parse_progress(-1);
+			while (s_entries[iIdx].iState == INDEX_BUSY)
+			{
+				SDL_CondWaitTimeout(s_index_cond, s_index_mutex, 100);
+				g_in_info->report_parse_progress(SDL_AtomicGet(&s_iIndexProgress) / 1000.0);
+			}
+			g_in_info->report_parse_progress(1);
+		}
+
+		bResult = (s_entries[iIdx].iState == INDEX_READY) ? VLDP_TRUE : VLDP_FALSE;
+	}
+
+	SDL_UnlockMutex(s_index_mutex);
+
+	return bResult;
+}
@@ -0,0 +1,75 @@
+/*
+ * vldp_index.h
+ *
+ * Copyright (C) 2026 The DAPHNE contributors
+ *
+ * This file is part of VLDP, a virtual laserdisc player.
+ *
+ * VLDP is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * VLDP is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// builds the .DAT (frame offset) files for mpegs, either right away or on a background thread
+// should only be used by VLDP itself!
+
+#ifndef VLDP_INDEX_H
+#define VLDP_INDEX_H
+
+#include <stddef.h>
+#include "vldp.h"	// for VLDP_BOOL
+
+// the state of a file that the background indexer has been asked about
+enum
+{
+	INDEX_UNKNOWN,	// the indexer was never given this file
+	INDEX_PENDING,	// waiting in the queue
+	INDEX_BUSY,	// being parsed right now
+	INDEX_READY,	// .DAT file is complete
+	INDEX_FAILED	// parsing failed (the VLDP thread should try on its own)
+};
+
+// maximum number of files that can be queued for background indexing
+#define MAX_INDEX_FILES 500
+
+// computes the .DAT filename for 'mpeg_name' (replaces the extension)
+void ivldp_index_dat_name(char *dst, const char *mpeg_name, size_t size);
+
+// returns VLDP_TRUE if 'datafilename' is a finished .DAT file that matches an mpeg of 'mpeg_size' bytes
+VLDP_BOOL ivldp_index_dat_is_valid(const char *datafilename, unsigned int mpeg_size);
+
+// parses 'mpeg_name' and writes its .DAT file (blocks until finished)
+// The .DAT file only appears once it is complete, so readers never see a half-written one.
+// If 'report' is true, progress is sent to the parent thread via report_parse_progress.
+VLDP_BOOL ivldp_index_build_dat(const char *mpeg_name, VLDP_BOOL report);
+
+// starts a background thread that creates the .DAT files for 'uCount' mpegs, in the order given
+// (so the first file, which is needed to boot, is ready first)
+VLDP_BOOL ivldp_index_start(const char * const *ppszFiles, unsigned int uCount);
+
+// stops the background thread and makes any parse in progress give up (any unfinished .DAT file is discarded)
+// Call this before telling the VLDP thread to quit, in case it is waiting on the indexer.
+void ivldp_index_abort(void);
+
+// frees everything; only call once the VLDP thread has terminated
+void ivldp_index_shutdown(void);
+
+// returns one of the INDEX_ enums for 'mpeg_name'
+int ivldp_index_get_state(const char *mpeg_name);
+
+// blocks until 'mpeg_name' has been indexed.  If the indexer hasn't started on it yet, it gets
+//  parsed right away on the calling thread, so we never wait on the files queued up ahead of it.
+// returns VLDP_TRUE if the .DAT file is ready, or VLDP_FALSE if the indexer gave up on it
+VLDP_BOOL ivldp_index_wait(const char *mpeg_name);
+
+#endif // VLDP_INDEX_H
@@ -25,6 +25,10 @@
 #ifdef _WIN32
 #define _CRT_SECURE_NO_WARNINGS 1
 #pragma warning (disable:4996)
+#elif defined(__linux__)
+// glibc hides clock_gettime/clock_nanosleep under -std=c99 (BSD and macOS show what they have by default,
+//  and defining this there would hide their extensions instead)
+#define _POSIX_C_SOURCE 200112L
 #endif
 
 #include <stdint.h>
@@ -39,6 +43,8 @@
 #include <direct.h>
 #else
 #include <unistd.h>
+#include <time.h>
+#include <errno.h>
 #endif
 
 #include <SDL.h>
@@ -46,6 +52,7 @@
 #include "vldp_internal.h"
 #include "vldp_common.h"
 #include "mpegscan.h"
+#include "vldp_index.h"
 
 
 #include "../include/mpeg2.h"
@@ -56,12 +63,20 @@
 /////////////////////////////
 #define YUV_BUF_COUNT 3        // libmpeg2 needs 3 buffers to do its thing ...
 struct yuv_buf g_yuv_buf[YUV_BUF_COUNT];
+static unsigned int s_uYUVSerial = 0;	// the last serial number given to a picture in g_yuv_buf (see struct yuv_buf)
+
+#define PACING_NS_PER_MS ((uint64_t) 1000000)
+
+// when precise pacing, how close to the deadline we stop waiting on the mailbox (which only has
+//  millisecond resolution) and sleep until the exact deadline instead
+#define PACING_FINE_SLEEP_NS (2 * PACING_NS_PER_MS)
 
 //// forward declarations
 static void paused_handler(void);
 static void play_handler(void);
 static void vldp_process_sequence_header(void);
 static int ivldp_got_new_command(void);
+static unsigned int ivldp_cur_cmd(void);
 static void ivldp_ack_command(void);
 static void ivldp_lock_handler(void);
 static void ivldp_respond_req_play(void);
@@ -70,8 +85,8 @@ static void idle_handler_search(int skip);
 static void idle_handler_open(void);
 static void idle_handler_precache(void);
 static void idle_handler_play(void);
-static VLDP_BOOL ivldp_parse_mpeg_frame_offsets(char *datafilename,
-      uint32_t mpeg_size);
+static VLDP_BOOL ivldp_coarse_index_begin(void);
+static void ivldp_coarse_index_extend(unsigned int uFrame);
 static VLDP_BOOL ivldp_get_mpeg_frame_offsets(char *mpeg_name);
 
 static VLDP_BOOL io_open_precached(unsigned int uIdx);
@@ -83,6 +98,14 @@ static unsigned int io_read(void *buf, unsigned int uBytesToRead);
 static void io_close(void);
 static void ivldp_respond_req_speedchange(void);
 static void ivldp_respond_req_pause_or_step(void);
+static VLDP_BOOL ivldp_stall_check_cmd(void);
+static void ivldp_set_timer(uint32_t uTimer);
+static uint64_t ivldp_now_ns(void);
+static void ivldp_sleep_until_ns(uint64_t u64DeadlineNs);
+static VLDP_BOOL ivldp_stall_until_ns(uint64_t u64DeadlineNs);
+static uint64_t ivldp_frame_late_ns(uint64_t u64DeadlineNs, int32_t correct_elapsed_ms);
+static void ivldp_pacing_stats_add(uint64_t u64LateNs);
+static void ivldp_pacing_stats_report(void);
 
 #pragma warning (push)
 #pragma warning (disable:4018)
@@ -91,6 +114,13 @@ static void vo_null_draw(uint8_t * const * buf, void *id)
    int32_t correct_elapsed_ms = 0;	// we want this signed since we compare against actual_elapsed_ms
    int32_t actual_elapsed_ms = 0;	// we want this signed because it could be negative
    unsigned int uStallFrames = 0;	// how many frames we have to stall during the loop (for multi-speed playback)
+   uint64_t u64DeadlineNs = 0;	// when the frame is due on the monotonic clock (precise pacing only)
+   VLDP_BOOL bOnTime = VLDP_FALSE;	// whether we are caught up enough to display the frame
+
+   // libmpeg2 has just finished a new picture in this buffer.  If we end up looping below (while paused or stalled),
+   //  the serial stays the same so the callbacks can tell that it's the same picture as last time.
+   g_yuv_buf[(intptr_t) id].uSerial = ++s_uYUVSerial;
+   g_out_info.uFramesDecoded++;
 
    // if we don't need to skip any frames
    if (!(s_frames_to_skip | s_skip_all))
@@ -116,12 +146,27 @@ static void vo_null_draw(uint8_t * const * buf, void *id)
             s_extra_delay_ms;
          actual_elapsed_ms = g_in_info->uMsTimer - s_timer;
 
+         if (g_in_info->precise_pacing)
+         {
+            // The deadline is recomputed from the frame count every time (instead of adding one frame's
+            //  duration to the previous deadline) so that the fractional part of the frame period
+            //  never accumulates into drift.
+            u64DeadlineNs = s_u64TimerNs +
+               ((uint64_t) s_uFramesShownSinceTimer * PACING_NS_PER_MS * 1000000) / g_out_info.uFpks +
+               ((uint64_t) s_extra_delay_ms * PACING_NS_PER_MS);
+            bOnTime = (ivldp_now_ns() < u64DeadlineNs + ((uint64_t) g_out_info.u2milDivFpks * PACING_NS_PER_MS));
+         }
+         else
+         {
+            bOnTime = (actual_elapsed_ms < (correct_elapsed_ms + g_out_info.u2milDivFpks));
+         }
+
          // the extra delay should only be 'used' once, so for safety reasons we reset
          // it here, where we can guarantee that it only will be used once.
          s_extra_delay_ms = 0;
 
          // if we are caught up enough that we don't need to skip any frames, then display the frame
-         if (actual_elapsed_ms < (correct_elapsed_ms + g_out_info.u2milDivFpks))
+         if (bOnTime)
          {
             // this is the potentially expensive callback that gets the hardware overlay
             // ready to be displayed, so we do this before we sleep
@@ -130,42 +175,24 @@ static void vo_null_draw(uint8_t * const * buf, void *id)
             {
 
                // stall if we are playing too quickly and if we don't have a command waiting for us
-               while (((int32_t) (g_in_info->uMsTimer - s_timer) < correct_elapsed_ms)
+               if (g_in_info->precise_pacing)
+                  bFrameNotShownDueToCmd = ivldp_stall_until_ns(u64DeadlineNs);
+               else while (((actual_elapsed_ms = (int32_t) (g_in_info->uMsTimer - s_timer)) < correct_elapsed_ms)
                      && (!bFrameNotShownDueToCmd))
                {
-                  // IMPORTANT: this delay should come before the check for ivldp_got_new_command,
+                  // IMPORTANT: this sleep should come before the check for ivldp_got_new_command,
                   //  so that if we get a new command, we exit the loop immediately without
-                  //  delaying, so that we don't have to check a second time for a new command.
-                  SDL_Delay(1);	// note, if this is set to 0, we don't get commands as quickly
+                  //  sleeping, so that we don't have to check a second time for a new command.
+                  // uMsTimer follows the wall clock, so we sleep until the frame is due
+                  //  (or until a command wakes us up).
+                  vldp_mailbox_wait_cmd(s_old_req_cmdORcount, correct_elapsed_ms - actual_elapsed_ms);
 
                   // Breaking when getting a new commend before our frame has expired
                   //  will shorten 1 frame's length.  However, it could speed skips up,
                   //  so I am leaving it in.
                   // Also, if we get a new command, uMsTimer may not advance until
                   //  we acknowledge the new command.
-                  if (ivldp_got_new_command())
-                  {
-                     // strip off count and examine command
-                     switch(g_req_cmdORcount & 0xF0)
-                     {
-                        case VLDP_REQ_PAUSE:
-                        case VLDP_REQ_STEP_FORWARD:
-                           ivldp_respond_req_pause_or_step();
-                           break;
-                        case VLDP_REQ_SPEEDCHANGE:
-                           ivldp_respond_req_speedchange();
-                           break;
-                        case VLDP_REQ_NONE:
-                           break;
-
-                           // Anything else, we will not show the next frame and will
-                           //  immediately exit this loop in order to handle the command
-                           //  elsewhere.
-                        default:
-                           bFrameNotShownDueToCmd = VLDP_TRUE;
-                           break;
-                     }
-                  }
+                  bFrameNotShownDueToCmd = ivldp_stall_check_cmd();
                }
 
                // If a command comes in at the last second,
@@ -174,12 +201,30 @@ static void vo_null_draw(uint8_t * const * buf, void *id)
                // draw the frame
                // we are using the pointer 'id' as an index, kind of risky, but convenient :)
                if (!bFrameNotShownDueToCmd)
+               {
+                  if (g_in_info->precise_pacing | (g_in_info->report_frame_lateness != NULL))
+                  {
+                     uint64_t u64LateNs = ivldp_frame_late_ns(u64DeadlineNs, correct_elapsed_ms);
+
+                     if (g_in_info->precise_pacing)
+                        ivldp_pacing_stats_add(u64LateNs);
+                     if (g_in_info->report_frame_lateness)
+                        g_in_info->report_frame_lateness(u64LateNs, VLDP_FALSE);
+                  }
                   g_in_info->display_frame(&g_yuv_buf[(int) id]);
+               }
                // end if we didn't get a new command to interrupt the frame being displayed
             } // end if the frame was prepared properly
             // else maybe we couldn't get a lock on the buffer fast enough, so we'll have to wait ...
 
          } // end if we don't drop any frames
+         else
+         {
+            if (g_in_info->precise_pacing)
+               ++s_uPacingDropped;
+            if (g_in_info->report_frame_lateness)
+               g_in_info->report_frame_lateness(ivldp_frame_late_ns(u64DeadlineNs, correct_elapsed_ms), VLDP_TRUE);
+         }
 
          // if the frame was either displayed or dropped (due to lag) ...
          if (!bFrameNotShownDueToCmd)
@@ -349,6 +394,17 @@ unsigned int s_uSkipAllCount = 0;
 
 uint32_t s_timer = 0;	// FPS timer used by the blitting code to run at the right speed
 
+// s_timer converted to the monotonic clock (in nanoseconds), used when precise pacing is enabled
+uint64_t s_u64TimerNs = 0;
+
+// precise pacing statistics, for how late each frame was displayed relative to its deadline
+// (reset every time a file is opened)
+unsigned int s_uPacingFrames = 0;	// how many frames were displayed
+unsigned int s_uPacingDropped = 0;	// how many frames were dropped because we were too far behind
+unsigned int s_uPacingOver1Ms = 0;	// how many frames were displayed more than 1 ms late
+uint64_t s_u64PacingSumNs = 0;	// sum of all lateness (to compute the mean)
+uint64_t s_u64PacingMaxNs = 0;	// the worst lateness we've seen
+
 // any extra delay that null_draw_frame() will use before drawing a frame (intended for laserdisc seek delay simulation)
 // NOTE : this value gets reset to 0 after it has been 'used'
 uint32_t s_extra_delay_ms = 0;
@@ -379,6 +435,14 @@ static mpeg2dec_t *g_mpeg_data = NULL;	// structure for libmpeg2's state
 static uint32_t g_frame_position[MAX_LDP_FRAMES] = { 0 };	// the file position of each I frame
 static uint16_t g_totalframes = 0;	// total # of frames in the current mpeg
 
+// If the .DAT file isn't ready yet (and we were told not to wait for it), we find the I frames ourselves,
+//  but only scan as far into the mpeg as the searches need us to.
+#define COARSE_CHUNK 65536
+static VLDP_BOOL s_bCoarseIndex = VLDP_FALSE;	// whether g_frame_position is only partially filled in
+static struct mpegscan_s s_coarse_scan;	// parser state, so we can pick up where we left off
+static unsigned int s_uCoarseScanPos = 0;	// how far into the mpeg we've scanned
+static uint8_t s_coarse_buf[COARSE_CHUNK];
+
 #define BUFFER_SIZE 262144
 static uint8_t g_buffer[BUFFER_SIZE];	// buffer to hold mpeg2 file as we read it in
 
@@ -399,6 +463,11 @@ int idle_handler(void *surface)
 {
 	int done = 0;
 
+	if (g_in_info->thread_started)
+	{
+		g_in_info->thread_started("vldp");
+	}
+
 	vo_null_open();	// open 'null' driver (we just pass decoded frames to parent thread)
    g_mpeg_data = mpeg2_init();
 
@@ -411,13 +480,14 @@ int idle_handler(void *surface)
 		while (ivldp_got_new_command() && !done)
 		{
 			// examine the actual command (strip off the count)
-			switch(g_req_cmdORcount & 0xF0)
+			switch(ivldp_cur_cmd())
 			{
 			case VLDP_REQ_QUIT:
 				done = 1;
             io_close();
+            ivldp_pacing_stats_report();
 
-            g_out_info.status = STAT_ERROR;
+            vldp_mailbox_set_status(STAT_ERROR);
             mpeg2_close(g_mpeg_data);	// shutdown libmpeg2
             vo_null_close();		// shutdown null driver
 
@@ -447,26 +517,27 @@ int idle_handler(void *surface)
 				break;
 			case VLDP_REQ_PAUSE:	// pause command while we're already idle?  this is an error
 			case VLDP_REQ_STOP:	// stop command while we're already idle? this is an error
-				g_out_info.status = STAT_ERROR;
+				vldp_mailbox_set_status(STAT_ERROR);
 				ivldp_ack_command();
 				break;
 			case VLDP_REQ_LOCK:
 				ivldp_lock_handler();
 				break;
 			default:
-				fprintf(stderr, "VLDP WARNING : Idle handler received command which it is ignoring\n");
+				vldp_log(VLDP_LOG_WARNING, "VLDP WARNING : Idle handler received command which it is ignoring");
 				break;
 			} // end switch
-			SDL_Delay(0);	// give other threads some breathing room (but not much hehe)
 		} // end if we got a new command
 
+		// no need to draw anything or sleep if we've been told to quit
+		if (done)
+			break;
+
 		g_in_info->render_blank_frame();	// This makes sure that the video overlay gets drawn even if there is no video being played
 
-		// we need to delay here because otherwise, this idle loop will execute at 100% cpu speed and really slow things down
-		// It shouldn't hurt us when we get a command that requires immediate attention (such as skip) because of the
-		// inner while loop above (while ivldp_got_new_command)
-		// NOTE : we want to delay for about 1 frame (or field) here
-		SDL_Delay(16);	// 1 field is 16.666ms assuming 60 hz
+		// Sleep for about 1 frame (or field) so this idle loop doesn't run at 100% cpu, but wake up
+		//  immediately if a command comes in.
+		vldp_mailbox_wait_cmd(s_old_req_cmdORcount, 16);	// 1 field is 16.666ms assuming 60 hz
 
 	} // end while we have not received a quit command
 
@@ -477,18 +548,23 @@ int idle_handler(void *surface)
 static int ivldp_got_new_command(void)
 {
 	// if they are no longer equal	
-	if (g_req_cmdORcount != s_old_req_cmdORcount)
+	if ((uint8_t) SDL_AtomicGet(&g_req_cmdORcount) != s_old_req_cmdORcount)
 		return 1;
 	
 	return 0;
 }
 
+// returns the command that is waiting for us (with the count stripped off)
+static unsigned int ivldp_cur_cmd(void)
+{
+	return SDL_AtomicGet(&g_req_cmdORcount) & 0xF0;
+}
+
 // acknowledges a command sent by the parent thread
 // NOTE : We don't check to see if parent thread got our acknowledgement because it creates too much latency
 static void ivldp_ack_command(void)
 {
-	s_old_req_cmdORcount = g_req_cmdORcount;
-	g_ack_count++;	// here is where we acknowledge
+	vldp_mailbox_ack(&s_old_req_cmdORcount);
 }
 
 static void ivldp_lock_handler(void)
@@ -500,17 +576,16 @@ static void ivldp_lock_handler(void)
 		// the user should unlock immediately after locking, so we need not check for other commands
 		while (bLocked == VLDP_TRUE)
 		{
-			SDL_Delay(1);
-			if (ivldp_got_new_command())
+			if (vldp_mailbox_wait_cmd(s_old_req_cmdORcount, VLDP_TIMEOUT))
 			{
-				switch (g_req_cmdORcount & 0xF0)
+				switch (ivldp_cur_cmd())
 				{
 				case VLDP_REQ_UNLOCK:
 					ivldp_ack_command();
 					bLocked = VLDP_FALSE;
 					break;
 				default:
-					fprintf(stderr, "WARNING : lock handler received a command %x that wasn't to unlock it\n", g_req_cmdORcount);
+					vldp_log(VLDP_LOG_WARNING, "WARNING : lock handler received a command %x that wasn't to unlock it", SDL_AtomicGet(&g_req_cmdORcount));
 					break;
 				}
 			}
@@ -525,10 +600,10 @@ static void paused_handler(void)
 	// the moment we render the still frame, we need to reset the FPS timer so we don't try to catch-up
 	if (g_out_info.status != STAT_PAUSED)
 	{
-		g_out_info.status = STAT_PAUSED;
+		vldp_mailbox_set_status(STAT_PAUSED);
 
 		// reset these vars because otherwise null_draw_frame will loop redundantly for no good reason
-		s_timer = g_in_info->uMsTimer;	// since we have just rendered the frame we searched to, we refresh the timer
+		ivldp_set_timer(g_in_info->uMsTimer);	// since we have just rendered the frame we searched to, we refresh the timer
 		s_uFramesShownSinceTimer = 1;	// this gives us a little breathing room
 	}
 
@@ -536,7 +611,7 @@ static void paused_handler(void)
 	if (ivldp_got_new_command())
 	{
 		// strip off the count and examine the command
-		switch (g_req_cmdORcount & 0xF0)
+		switch (ivldp_cur_cmd())
 		{
 		case VLDP_REQ_PLAY:
 			ivldp_respond_req_play();
@@ -560,7 +635,7 @@ static void paused_handler(void)
 			ivldp_lock_handler();
 			break;
 		default:	// else if we get a pause command or another command we don't know how to handle, just ignore it
-			fprintf(stderr, "WARNING : pause handler received command %x that it is ignoring\n", g_req_cmdORcount);
+			vldp_log(VLDP_LOG_WARNING, "WARNING : pause handler received command %x that it is ignoring", SDL_AtomicGet(&g_req_cmdORcount));
 			ivldp_ack_command();	// acknowledge the command
 			break;
 		} // end switch
@@ -575,7 +650,7 @@ static void play_handler(void)
 	if (ivldp_got_new_command())
 	{
 		// strip off count and examine command
-		switch(g_req_cmdORcount & 0xF0)
+		switch(ivldp_cur_cmd())
 		{
 		case VLDP_REQ_NONE:	// no incoming command
 			break;
@@ -599,7 +674,7 @@ static void play_handler(void)
 			break;
 		default:	// unknown or redundant command, just ignore
 			ivldp_ack_command();
-			fprintf(stderr, "WARNING : play handler received command which it is ignoring\n");
+			vldp_log(VLDP_LOG_WARNING, "WARNING : play handler received command which it is ignoring");
 			break;
 		}
 	} // end if we got a new command
@@ -638,7 +713,7 @@ static void ivldp_set_framerate(uint8_t frame_rate_code)
 		break;
 	default:
 		// else we got an invalid frame rate code
-		fprintf(stderr, "ERROR : Invalid frame rate code!\n");
+		vldp_log(VLDP_LOG_ERROR, "ERROR : Invalid frame rate code!");
 		g_out_info.uFpks = 1000;	// to avoid divide by 0 error
 		break;
 	} // end switch
@@ -668,7 +743,7 @@ static void decode_mpeg2(uint8_t *current, uint8_t *end)
 		    /* might set fbufs */
 		    if (vo_null_setup (info->sequence->width,
 				       info->sequence->height, &setup_result))
-				fprintf (stderr, "display setup failed\n");	// this should never happen
+				vldp_log(VLDP_LOG_ERROR, "display setup failed");	// this should never happen
 	
 		    if (setup_result.convert)
 				mpeg2_convert (g_mpeg_data, setup_result.convert, NULL);
@@ -719,7 +794,7 @@ void vldp_cache_sequence_header()
 		index++;	// advance the end pointer
 		if (index > HEADER_BUF_SIZE)
 		{
-			fprintf(stderr, "VLDP : Could not find first frame in 0x%x bytes.  Modify source code to increase buffer!\n", HEADER_BUF_SIZE);
+			vldp_log(VLDP_LOG_ERROR, "VLDP : Could not find first frame in 0x%x bytes.  Modify source code to increase buffer!", HEADER_BUF_SIZE);
 			break;
 		}
 	}
@@ -749,7 +824,7 @@ static void idle_handler_open()
 
 	// NOTE : it is very important that we change our status to BUSY before acknowledging the command, because
 	//  our previous status could be STAT_ERROR, which causes problems with the *_and_block commands.
-	g_out_info.status = STAT_BUSY;	// make us busy while opening the file
+	vldp_mailbox_set_status(STAT_BUSY);	// make us busy while opening the file
 	ivldp_ack_command();	// acknowledge open command
 
 	// reset libmpeg2 so it is prepared to begin reading from a new m2v file
@@ -759,6 +834,7 @@ static void idle_handler_open()
 	if (io_is_open())
 	{
 		io_close();
+		ivldp_pacing_stats_report();
 
 		// since the overlay is double buffered, we want to blank it 
 		// twice before closing it.  This is to avoid a 'flicker effect' that we can
@@ -805,13 +881,13 @@ static void idle_handler_open()
 
 				io_seek(0);	// seek back to beginning of file
 
-				g_out_info.status = STAT_STOPPED;	// now that the file is open, we're ready to play
+				vldp_mailbox_set_status(STAT_STOPPED);	// now that the file is open, we're ready to play
 			}
 			else
 			{
 				io_close();
-				fprintf(stderr, "VLDP PARSE ERROR : Is the video stream damaged?\n");
-				g_out_info.status = STAT_ERROR;	// change from BUSY to ERROR
+				vldp_log(VLDP_LOG_ERROR, "VLDP PARSE ERROR : Is the video stream damaged?");
+				vldp_mailbox_set_status(STAT_ERROR);	// change from BUSY to ERROR
 			}
 		} // end if a proper mpeg header was found
 		
@@ -819,14 +895,14 @@ static void idle_handler_open()
 		else
 		{
 			io_close();
-			fprintf(stderr, "VLDP ERROR : Did not find expected header.  Is this mpeg stream demultiplexed??\n");
-			g_out_info.status = STAT_ERROR;
+			vldp_log(VLDP_LOG_ERROR, "VLDP ERROR : Did not find expected header.  Is this mpeg stream demultiplexed??");
+			vldp_mailbox_set_status(STAT_ERROR);
 		}
 	} // end if file exists
 	else
 	{
-		fprintf(stderr, "VLDP ERROR : Could not open file!\n");
-		g_out_info.status = STAT_ERROR;
+		vldp_log(VLDP_LOG_ERROR, "VLDP ERROR : Could not open file!");
+		vldp_mailbox_set_status(STAT_ERROR);
 	}
 }
 
@@ -838,7 +914,7 @@ static void idle_handler_precache(void)
 	SAFE_STRCPY(req_file, g_req_file, sizeof(req_file));	// after we ack the command, this string could become clobbered at any time
 
 	// always set the status before acknowledging the command so previous status doesn't get through
-	g_out_info.status = STAT_BUSY;	// make us busy while opening the file
+	vldp_mailbox_set_status(STAT_BUSY);	// make us busy while opening the file
 	ivldp_ack_command();
 
 	// if we still have room in our array to precache ...
@@ -898,20 +974,20 @@ static void idle_handler_precache(void)
 				// (this must be done after we've read in the file so that the index is correct for that operation)
 				++s_uPreCacheIdxCount;
 
-				g_out_info.status = STAT_STOPPED;	// success
+				vldp_mailbox_set_status(STAT_STOPPED);	// success
 			}
 			// else malloc failed
 			else
-				g_out_info.status = STAT_ERROR;
+				vldp_mailbox_set_status(STAT_ERROR);
 			fclose(F);
 		}
 		// else we couldn't open the file
 		else
-			g_out_info.status = STAT_ERROR;
+			vldp_mailbox_set_status(STAT_ERROR);
 	}
 	// else we're out of room, so return an error
 	else
-		g_out_info.status = STAT_ERROR;
+		vldp_mailbox_set_status(STAT_ERROR);
 }
 
 // starts playing the mpeg from the very beginning
@@ -929,10 +1005,10 @@ static void idle_handler_play(void)
 // responds to play request
 static void ivldp_respond_req_play(void)
 {
-	s_timer = g_req_timer;
+	ivldp_set_timer(g_req_timer);
 	//fprintf(stderr, "ivldp_respond_req_play() : g_req_timer is %u, and uMstimer is %u\n", g_req_timer, g_in_info->uMsTimer);	// REMOVE ME
 	s_uFramesShownSinceTimer = PLAY_FRAME_STALL;	// we want to render the currently shown frame for 1 frame before moving on
-	g_out_info.status = STAT_PLAYING;	// we strive for instant response (and catch-up to maintain timing)
+	vldp_mailbox_set_status(STAT_PLAYING);	// we strive for instant response (and catch-up to maintain timing)
 	ivldp_ack_command();	// acknowledge the play command
 	s_paused = 0;	// we to not want to pause on 1 frame
 	s_blanked = 0;	// we want to see the video
@@ -945,7 +1021,7 @@ static void ivldp_respond_req_play(void)
 static void ivldp_respond_req_pause_or_step(void)
 {
 	// if they've also requested a step forward
-	if ((g_req_cmdORcount & 0xF0) == VLDP_REQ_STEP_FORWARD)
+	if (ivldp_cur_cmd() == VLDP_REQ_STEP_FORWARD)
 		s_step_forward = 1;
 	// NOTE : by design, our status should not change until paused_handler is called, so we leave it at PLAYING for now
 	ivldp_ack_command();
@@ -963,6 +1039,165 @@ static void ivldp_respond_req_speedchange(void)
 	ivldp_ack_command();
 }
 
+// gets called while stalling before a frame is displayed, to handle any new command
+// returns VLDP_TRUE if the frame must not be displayed because the command has to be handled elsewhere
+static VLDP_BOOL ivldp_stall_check_cmd(void)
+{
+	VLDP_BOOL bFrameNotShownDueToCmd = VLDP_FALSE;
+
+	if (ivldp_got_new_command())
+	{
+		// strip off count and examine command
+		switch(ivldp_cur_cmd())
+		{
+			case VLDP_REQ_PAUSE:
+			case VLDP_REQ_STEP_FORWARD:
+				ivldp_respond_req_pause_or_step();
+				break;
+			case VLDP_REQ_SPEEDCHANGE:
+				ivldp_respond_req_speedchange();
+				break;
+			case VLDP_REQ_NONE:
+				break;
+
+				// Anything else, we will not show the next frame and will
+				//  immediately exit this loop in order to handle the command
+				//  elsewhere.
+			default:
+				bFrameNotShownDueToCmd = VLDP_TRUE;
+				break;
+		}
+	}
+
+	return bFrameNotShownDueToCmd;
+}
+
+// resets the FPS timer to 'uTimer' (which is in uMsTimer time)
+static void ivldp_set_timer(uint32_t uTimer)
+{
+	// uTimer may be a little behind uMsTimer (for example, the time the parent thread sent us a play command)
+	int32_t s32BehindMs = (int32_t) (g_in_info->uMsTimer - uTimer);
+
+	s_timer = uTimer;
+	s_u64TimerNs = ivldp_now_ns() - (int64_t) s32BehindMs * (int64_t) PACING_NS_PER_MS;
+}
+
+// returns the monotonic clock in nanoseconds (only used for precise pacing)
+static uint64_t ivldp_now_ns(void)
+{
+#ifndef _WIN32
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t) ts.tv_sec * 1000000000) + (uint64_t) ts.tv_nsec;
+#else
+	// no nanosecond clock here, so we fall back to millisecond precision
+	return (uint64_t) SDL_GetTicks() * PACING_NS_PER_MS;
+#endif
+}
+
+// sleeps until the monotonic clock reaches 'u64DeadlineNs'
+static void ivldp_sleep_until_ns(uint64_t u64DeadlineNs)
+{
+#if defined(__linux__) || defined(__FreeBSD__)
+	// an absolute deadline won't oversleep if we get preempted between computing it and going to sleep
+	struct timespec ts;
+	ts.tv_sec = (time_t) (u64DeadlineNs / 1000000000);
+	ts.tv_nsec = (long) (u64DeadlineNs % 1000000000);
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+		;
+#else
+	uint64_t u64Now = ivldp_now_ns();
+	if (u64Now < u64DeadlineNs)
+	{
+#ifndef _WIN32
+		struct timespec ts;
+		ts.tv_sec = (time_t) ((u64DeadlineNs - u64Now) / 1000000000);
+		ts.tv_nsec = (long) ((u64DeadlineNs - u64Now) % 1000000000);
+		nanosleep(&ts, NULL);
+#else
+		SDL_Delay((Uint32) ((u64DeadlineNs - u64Now) / PACING_NS_PER_MS));
+#endif
+	}
+#endif
+}
+
+// stalls until 'u64DeadlineNs' (on the monotonic clock) unless a command comes in that we can't handle here
+// returns VLDP_TRUE if the frame must not be displayed due to the command
+static VLDP_BOOL ivldp_stall_until_ns(uint64_t u64DeadlineNs)
+{
+	uint64_t u64Now = 0;
+
+	while ((u64Now = ivldp_now_ns()) < u64DeadlineNs)
+	{
+		uint64_t u64LeftNs = u64DeadlineNs - u64Now;
+
+		// Wait on the mailbox for most of the frame so that a command can still wake us up,
+		//  then sleep until the exact deadline for the last stretch.
+		if (u64LeftNs > PACING_FINE_SLEEP_NS + PACING_NS_PER_MS)
+		{
+			vldp_mailbox_wait_cmd(s_old_req_cmdORcount, (unsigned int) ((u64LeftNs - PACING_FINE_SLEEP_NS) / PACING_NS_PER_MS));
+		}
+		else
+		{
+			ivldp_sleep_until_ns(u64DeadlineNs);
+		}
+
+		if (ivldp_stall_check_cmd())
+		{
+			return VLDP_TRUE;
+		}
+	}
+
+	return VLDP_FALSE;
+}
+
+// returns how late the frame being drawn now is, relative to its deadline
+// ('u64DeadlineNs' is only used with precise pacing, 'correct_elapsed_ms' only without)
+static uint64_t ivldp_frame_late_ns(uint64_t u64DeadlineNs, int32_t correct_elapsed_ms)
+{
+	if (g_in_info->precise_pacing)
+	{
+		uint64_t u64Now = ivldp_now_ns();
+		return (u64Now > u64DeadlineNs) ? (u64Now - u64DeadlineNs) : 0;
+	}
+	else
+	{
+		// uMsTimer only has millisecond precision
+		int32_t s32LateMs = (int32_t) (g_in_info->uMsTimer - s_timer) - correct_elapsed_ms;
+		return (s32LateMs > 0) ? ((uint64_t) s32LateMs * PACING_NS_PER_MS) : 0;
+	}
+}
+
+// records how late a frame was displayed, relative to its deadline
+static void ivldp_pacing_stats_add(uint64_t u64LateNs)
+{
+	++s_uPacingFrames;
+	s_u64PacingSumNs += u64LateNs;
+	if (u64LateNs > s_u64PacingMaxNs)
+	{
+		s_u64PacingMaxNs = u64LateNs;
+	}
+	if (u64LateNs > PACING_NS_PER_MS)
+	{
+		++s_uPacingOver1Ms;
+	}
+}
+
+// prints the precise pacing statistics (if there are any) and resets them
+static void ivldp_pacing_stats_report(void)
+{
+	if (s_uPacingFrames | s_uPacingDropped)
+	{
+		uint64_t u64MeanNs = s_uPacingFrames ? (s_u64PacingSumNs / s_uPacingFrames) : 0;
+		vldp_log(VLDP_LOG_INFO, "VLDP INFO : pacing : %u frames displayed, %u dropped, %u over 1 ms late, mean lateness %u us, max %u us",
+			s_uPacingFrames, s_uPacingDropped, s_uPacingOver1Ms,
+			(unsigned int) (u64MeanNs / 1000), (unsigned int) (s_u64PacingMaxNs / 1000));
+	}
+
+	s_uPacingFrames = s_uPacingDropped = s_uPacingOver1Ms = 0;
+	s_u64PacingSumNs = s_u64PacingMaxNs = 0;
+}
+
 // displays 1 or more frames to the screen, according to the state variables.
 // This function can be used to do both still frames and moving video.  Play and search both use this function.
 static void ivldp_render(void)
@@ -978,8 +1213,8 @@ static void ivldp_render(void)
    if (!io_is_open())
    {
       render_finished = 1;
-      fprintf(stderr, "VLDP RENDER ERROR : we tried to render an mpeg but none was open!\n");
-      g_out_info.status = STAT_ERROR;
+      vldp_log(VLDP_LOG_ERROR, "VLDP RENDER ERROR : we tried to render an mpeg but none was open!");
+      vldp_mailbox_set_status(STAT_ERROR);
    }
 
    // while we're not finished playing and pausing		
@@ -996,7 +1231,7 @@ static void ivldp_render(void)
       // if we've read to the end of the mpeg2 file, then we can't play anymore, so we pause on last frame
       if (end != (g_buffer + BUFFER_SIZE))
       {
-         g_out_info.status = STAT_STOPPED;	// it's a toss-up between this and STAT_PAUSED
+         vldp_mailbox_set_status(STAT_STOPPED);	// it's a toss-up between this and STAT_PAUSED
          render_finished = 1;
 
          // reset libmpeg2 so it is prepared to begin reading from the beginning of the file
@@ -1009,13 +1244,13 @@ static void ivldp_render(void)
       if (ivldp_got_new_command())
       {
          // check to see if we need to suddenly abort the rendering process
-         switch (g_req_cmdORcount & 0xF0)
+         switch (ivldp_cur_cmd())
          {
             case VLDP_REQ_QUIT:
             case VLDP_REQ_OPEN:
             case VLDP_REQ_SEARCH:
             case VLDP_REQ_STOP:
-               g_out_info.status = STAT_BUSY;
+               vldp_mailbox_set_status(STAT_BUSY);
                render_finished = 1;
                break;
             case VLDP_REQ_SKIP:
@@ -1045,7 +1280,7 @@ static void idle_handler_search(int skip)
 	// status must be changed before acknowledging command, because previous status could be STAT_ERROR, which
 	//  causes problems with *_and_block vldp API commands.
 	if (!skip)
-      g_out_info.status = STAT_BUSY;
+      vldp_mailbox_set_status(STAT_BUSY);
 	else
 	{
       // else we're skipping
@@ -1076,7 +1311,7 @@ static void idle_handler_search(int skip)
 	if (!skip)
 	{
 		s_paused = 1;	// we do want to pause on the frame we search to
-		s_timer = g_in_info->uMsTimer;	// reset timer so framerate is correct
+		ivldp_set_timer(g_in_info->uMsTimer);	// reset timer so framerate is correct
 		// NOTE : resetting s_timer here doesn't do much if we aren't simulating
 		// artificial seek delay, because paused_handler() will reset it again anyway.
 		// (but it is important for seek delay!)
@@ -1111,6 +1346,11 @@ static void idle_handler_search(int skip)
 	// if we're using fields, then the requested frame must be doubled (2 fields per frame)
 	if (g_out_info.uses_fields) uAdjustedReqFrame <<= 1;
 
+	// if we don't have the complete .DAT file, make sure we've scanned far enough
+	// (this moves the file position, but we seek below anyway)
+	if (s_bCoarseIndex)
+		ivldp_coarse_index_extend(uAdjustedReqFrame);
+
 	actual_frame = uAdjustedReqFrame;
 
 	// do a bounds check
@@ -1169,8 +1409,8 @@ static void idle_handler_search(int skip)
 	} // end if the bounds check passed
 	else
 	{
-		fprintf(stderr, "SEARCH ERROR : frame %u was requested, but it is out of bounds\n", req_frame);
-		g_out_info.status = STAT_ERROR;
+		vldp_log(VLDP_LOG_ERROR, "SEARCH ERROR : frame %u was requested, but it is out of bounds", req_frame);
+		vldp_mailbox_set_status(STAT_ERROR);
 	}
 }
 
@@ -1184,9 +1424,10 @@ static VLDP_BOOL ivldp_get_mpeg_frame_offsets(char *mpeg_name)
 	VLDP_BOOL result             = VLDP_TRUE;
 	unsigned int mpeg_size       = io_length();
 
+	s_bCoarseIndex = VLDP_FALSE;	// assume we'll get a complete .DAT file
+
 	// change extension of file to be dat instead of (presumably) m2v
-	SAFE_STRCPY(datafilename, mpeg_name, sizeof(datafilename));
-	strcpy(&datafilename[strlen(mpeg_name)-3], "dat");
+	ivldp_index_dat_name(datafilename, mpeg_name, sizeof(datafilename));
 
 	// loop until we get a good datafile
 	// or until we get an error
@@ -1200,8 +1441,23 @@ static VLDP_BOOL ivldp_get_mpeg_frame_offsets(char *mpeg_name)
       // we could open the file here, but there is no need to
       // because we will loop back through and open the file anyway			
 		if (!data_file)
-			result = ivldp_parse_mpeg_frame_offsets(datafilename, mpeg_size);
-		// else if the file has been opened
+		{
+			int iState = ivldp_index_get_state(mpeg_name);
+
+			// if the background indexer hasn't gotten this file done yet
+			if ((iState == INDEX_PENDING) || (iState == INDEX_BUSY))
+			{
+				// don't wait, just scan as far as we need to
+				if (g_in_info->index_fallback_coarse)
+					return ivldp_coarse_index_begin();
+
+				// wait for this file only
+				// (if the indexer fails, we'll try it ourselves on the next time through the loop)
+				ivldp_index_wait(mpeg_name);
+			}
+			else
+				result = ivldp_index_build_dat(mpeg_name, VLDP_TRUE);
+		}
 		else
 		{
 			// now that file exists and we have it open, we have to read it
@@ -1215,14 +1471,14 @@ static VLDP_BOOL ivldp_get_mpeg_frame_offsets(char *mpeg_name)
 //				printf("*** Alleged mpeg size is %u, actual size is %u\n", header.length, mpeg_size);
 //				printf("Finished flag is %x\n", header.finished);
 //				printf("DAT version is %x\n", header.version);
-				printf("NOTICE : MPEG data file has to be created again!\n");
+				vldp_log(VLDP_LOG_INFO, "NOTICE : MPEG data file has to be created again!");
 				fclose(data_file);
 				data_file = NULL;
 				
 				// try to delete obsolete .DAT file so we can create a modern one
 				if (unlink(datafilename) == -1)
 				{
-					fprintf(stderr, "Couldn't delete obsolete .DAT file!\n");
+					vldp_log(VLDP_LOG_WARNING, "Couldn't delete obsolete .DAT file!");
 					result = VLDP_FALSE;
 				}
 			}
@@ -1249,7 +1505,7 @@ static VLDP_BOOL ivldp_get_mpeg_frame_offsets(char *mpeg_name)
 			// (in fact I did this, and it caused a lot of problems in the debug stages hehe)
 			if (g_totalframes >= MAX_LDP_FRAMES)
 			{
-				fprintf(stderr, "ERROR : current mpeg has too many frames, VLDP will ignore any frames above %u\n", MAX_LDP_FRAMES);
+				vldp_log(VLDP_LOG_ERROR, "ERROR : current mpeg has too many frames, VLDP will ignore any frames above %u", MAX_LDP_FRAMES);
 				break;
 			}
 		}
@@ -1265,92 +1521,48 @@ static VLDP_BOOL ivldp_get_mpeg_frame_offsets(char *mpeg_name)
 }
 
 
-static VLDP_BOOL ivldp_parse_mpeg_frame_offsets(char *datafilename,
-      uint32_t mpeg_size)
+static void ivldp_coarse_report_picture(void *user, uint32_t offset)
 {
-	FILE *data_file = fopen(datafilename, "wb");	// create file
-	struct dat_header header;	// header to put inside .DAT file
-
-	// if we could create the file successfully, then we need to populate it
-	if (data_file)
-	{
-		uint32_t pos = 0;	// position in the file
-		int count = 0;
-		int parse_result = 0;
-
-		header.version = DAT_VERSION;
-		header.finished = 0;
-		header.uses_fields = 0;
-		header.length = mpeg_size;
-		fwrite(&header, sizeof(header), 1, data_file);
-		// first thing that goes in the file is the .DAT header
-		// That way we can re-use the file another time with confidence that it's
-		// the right one
-
-		init_mpegscan();
-
-		g_in_info->report_parse_progress(-1);	// notify other thread that we're starting
-
-		// keep reading the file while there is a file left to be read
-		do
-		{
-#define PARSE_CHUNK 200000
-
-			parse_result = parse_video_stream(data_file, PARSE_CHUNK);
-			pos += PARSE_CHUNK;
-
-			// we want to give the user updates but don't want to flood them
-			if (count > 10)
-			{
-				count = 0;
-				
-				// report progress to parent thread
-				g_in_info->report_parse_progress((double) pos / mpeg_size);
-			}
-			count++;
-
-		} while (parse_result == P_IN_PROGRESS);
+	if (g_totalframes < MAX_LDP_FRAMES)
+		g_frame_position[g_totalframes++] = offset;
+}
 
-		g_in_info->report_parse_progress(1);	// notify other thread that we're done
+// starts finding the I frames of the open mpeg ourselves, instead of using a .DAT file
+static VLDP_BOOL ivldp_coarse_index_begin(void)
+{
+	g_totalframes = 0;
+	s_uCoarseScanPos = 0;
+	s_bCoarseIndex = VLDP_TRUE;
+	init_mpegscan(&s_coarse_scan, ivldp_coarse_report_picture, NULL);
+
+	// A picture's coding extension (if it has one) comes right after its header, so once the second
+	//  picture has been found we know whether the stream uses fields (mpeg1 has no extensions, so it uses frames).
+	// A big I frame can span several chunks, so this may take more than one.
+	ivldp_coarse_index_extend(1);
+	g_out_info.uses_fields = (s_coarse_scan.fields_detected && !s_coarse_scan.frames_detected);
+
+	return (g_totalframes > 0) ? VLDP_TRUE : VLDP_FALSE;
+}
 
-		// if parse finished, then we have to update the header
-		if (parse_result != P_ERROR)
-		{
-			header.finished = 1;
-			header.uses_fields = 0;
-			if (parse_result == P_FINISHED_FIELDS)
-				header.uses_fields = 1;
-			fseek(data_file, 0L, SEEK_SET);
-			fwrite(&header, sizeof(header), 1, data_file);	// save changes
-		}
+// scans the mpeg until we know where 'uFrame' is (or until we run out of mpeg)
+// NOTE : this changes the file position
+static void ivldp_coarse_index_extend(unsigned int uFrame)
+{
+	while (s_bCoarseIndex && (uFrame >= g_totalframes))
+	{
+		unsigned int uBytesRead = 0;
 
-		// we have to close data file because it's write-only
-		// and it needs to be re-opened read-only
-		fclose(data_file);
-		data_file = NULL;
+		io_seek(s_uCoarseScanPos);
+		uBytesRead = io_read(s_coarse_buf, sizeof(s_coarse_buf));
+		s_uCoarseScanPos += uBytesRead;
 
-		// if the mpeg did not finish parsing gracefully, we've got problems
-		// NOTE : I separated this from the other if above to guarantee that the file gets closed
-		if (parse_result == P_ERROR)
+		// once we hit the end of the mpeg, g_frame_position is complete
+		if ((parse_video_stream(&s_coarse_scan, s_coarse_buf, uBytesRead) != P_IN_PROGRESS) ||
+			(g_totalframes >= MAX_LDP_FRAMES))
 		{
-			fprintf(stderr, "There was an error parsing the MPEG file.\n");
-			fprintf(stderr, "Either there is a bug in the parser or the MPEG file is corrupt.\n");
-			fprintf(stderr, "OR the user aborted the decoding process :)\n");
-			unlink(datafilename);
-			return VLDP_FALSE;
+			s_bCoarseIndex = VLDP_FALSE;
 		}
-	} // end if we could create the file successfully
-
-	// we couldn't create data file which means no write permission probably
-	// this is probably a good time to shut VLDP down =]
-	else
-	{
-		fprintf(stderr, "Could not create file %s\n", datafilename);
-		fprintf(stderr, "This probably means you don't have permission to create the file\n");
-		return VLDP_FALSE;
 	}
-
-	return VLDP_TRUE;
 }
 
 static VLDP_BOOL io_open(const char *cpszFilename)
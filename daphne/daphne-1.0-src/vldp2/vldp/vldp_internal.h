@@ -60,6 +60,8 @@ extern int s_skip_all;	// skip all subsequent frames.  Used to bail out of the m
 extern unsigned int s_uSkipAllCount;	// how many frames we've skipped when s_skip_all is enabled.
 extern int s_step_forward;	// if this is set, we step forward 1 frame
 extern uint32_t s_timer;	// FPS timer used by the blitting code to run at the right speed
+extern uint64_t s_u64TimerNs;	// s_timer converted to the monotonic clock (in nanoseconds), for precise pacing
+extern unsigned int s_uPacingDropped;	// how many frames precise pacing has dropped since the file was opened
 extern uint32_t s_extra_delay_ms;	// any extra delay that null_draw_frame() will use before drawing a frame (intended for laserdisc seek delay simulation)
 extern uint32_t s_uFramesShownSinceTimer;	// how many frames should've been rendered (relative to s_timer) before we advance
 extern int s_overlay_allocated;	// whether the SDL overlays have been allocated
@@ -29,6 +29,9 @@
 #include "../daphne-1.0-src/io/input.h"
 #include "../daphne-1.0-src/daphne.h"
 #include "../daphne-1.0-src/game/game.h"
+#include "../daphne-1.0-src/video/present.h"
+#include "../daphne-1.0-src/timer/telemetry.h"
+#include "../daphne-1.0-src/io/threads.h"
 #include "../main_android.h"
 #include "../include/SDL_render.h"
 
@@ -61,6 +64,11 @@ char gstr_rom_path[1024];
 char gstr_rom_name[DAPHNE_MAX_ROMNAME];
 char gstr_rom_extension[sizeof(DAPHNE_ROM_EXTENSION)];
 
+// Whether the frontend lets us repeat the last frame by passing NULL to video_cb, and the size of that frame.
+static bool				gf_can_dupe				= false;
+static unsigned int		gn_last_frame_w			= 0;
+static unsigned int		gn_last_frame_h			= 0;
+
 /**************************************************************************************************
 * Callbacks.
 * retro_log_printf_t			Logging function, takes enum level argurment.
@@ -191,6 +199,7 @@ void retro_init(void)
 		// itself uses YUY2 (16 bpp).
 		enum retro_pixel_format n_pixelformat = RETRO_PIXEL_FORMAT_RGB565;
 		environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &n_pixelformat);
+		present_set_format(PRESENT_RGB565);	// overlay-only frames have to match
 	}
 
 	// Set the available buttons for the user.  Not doing analogs for right now.
@@ -225,6 +234,10 @@ void retro_init(void)
 	if (log_cb)
       log_cb(RETRO_LOG_INFO, "daphne-libretro: In retro_init.\n");
 
+	// Find out whether we can hand the frontend a NULL frame when nothing on the screen has changed.
+	if (!environ_cb(RETRO_ENVIRONMENT_GET_CAN_DUPE, &gf_can_dupe))
+		gf_can_dupe = false;
+
     // Set the performance level, not sure what "4" means
     unsigned int n_perflevel = 4;
     environ_cb(RETRO_ENVIRONMENT_SET_PERFORMANCE_LEVEL, &n_perflevel);
@@ -372,8 +385,23 @@ int retro_run_frames	= 0;
 
 bool retro_run_once = false;
 
+// records the time since the last new frame was handed to the frontend (duplicate frames don't count)
+static void retro_video_telemetry()
+{
+	static uint64_t u64LastFrame = 0;
+	uint64_t u64Now = telemetry_start();
+
+	if (u64Now && u64LastFrame)
+	{
+		telemetry_record(TELEM_VIDEO_INTERVAL, u64Now - u64LastFrame);
+	}
+	u64LastFrame = u64Now;
+}
+
 void retro_run(void)
 {
+	uint64_t u64RunStart = telemetry_start();
+
 	if (retro_run_frames_delta >= RETRO_RUN_FRAMES_PAUSED_THRESHOLD)
 	{
 		retro_run_frames_delta = 0;
@@ -383,6 +411,10 @@ void retro_run(void)
 
 	// Some of the back end needs to know when certain systems have been init'd.  When
 	// retro_run has run once, all relavent system have been initialized.
+	if (!retro_run_once)
+	{
+		threads_setup("frontend");	// the frontend calls us from the same thread every time
+	}
 	retro_run_once = true;
 
 	// Poll input.
@@ -450,6 +482,10 @@ void retro_run(void)
 	// struct VIDEO_BUFFER tVB[4];
 	int vb_ndx						= -1;
 	SDL_SW_YUVTexture * sw_overlay	= NULL;
+	const void * p_present_frame	= NULL;
+	unsigned int n_present_w		= 0;
+	unsigned int n_present_h		= 0;
+	unsigned int n_present_pitch	= 0;
 
 	sw_overlay = get_vb_waiting(&vb_ndx);
 	if (sw_overlay && video_cb) 
@@ -457,9 +493,25 @@ void retro_run(void)
 
       	video_cb(sw_overlay->pixels, sw_overlay->w, sw_overlay->h, sw_overlay->w * DAPHNE_VIDEO_ByPP);
 	set_vb_rendering_done(vb_ndx);
+		gn_last_frame_w = sw_overlay->w;
+		gn_last_frame_h = sw_overlay->h;
+		retro_video_telemetry();
+	}
+	// Without VLDP, the game's overlay is the whole picture (see present.h).
+	else if (video_cb && ((p_present_frame = present_get_frame(&n_present_w, &n_present_h, &n_present_pitch)) != NULL))
+	{
+		video_cb(p_present_frame, n_present_w, n_present_h, n_present_pitch);
+		gn_last_frame_w = n_present_w;
+		gn_last_frame_h = n_present_h;
+		retro_video_telemetry();
+	}
+	// Nothing new was rendered (disc paused, overlay unchanged, etc), so tell the frontend this is a duplicate frame.
+	else if (video_cb && gf_can_dupe && gn_last_frame_w)
+	{
+		video_cb(NULL, gn_last_frame_w, gn_last_frame_h, gn_last_frame_w * DAPHNE_VIDEO_ByPP);
 	}
 
-	
+	telemetry_stop(TELEM_RUN_TIME, u64RunStart);
 }
 
 